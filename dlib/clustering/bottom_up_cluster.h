@@ -3,14 +3,16 @@
 #ifndef DLIB_BOTTOM_uP_CLUSTER_Hh_
 #define DLIB_BOTTOM_uP_CLUSTER_Hh_
 
-#include <queue>
-#include <map>
+#include <vector>
+#include <algorithm>
+#include <limits>
 
 #include "bottom_up_cluster_abstract.h"
 #include "../algs.h"
 #include "../matrix.h"
 #include "../disjoint_subsets.h"
 #include "../graph_utils.h"
+#include "../threads.h"
 
 
 namespace dlib
@@ -20,26 +22,160 @@ namespace dlib
 
     namespace buc_impl
     {
-        inline void merge_sets (
-            matrix<double>& dists,
-            unsigned long dest,
-            unsigned long src
-        )
+        class packed_distances
         {
-            for (long r = 0; r < dists.nr(); ++r)
-                dists(dest,r) = dists(r,dest) = std::max(dists(r,dest), dists(r,src));
-        }
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    This object stores a symmetric matrix of distances with an unused
+                    diagonal.  It only keeps the strictly upper triangular part so it needs
+                    half the memory of a full matrix.
+            !*/
+        public:
+            explicit packed_distances (
+                unsigned long n_
+            ) : n(n_), d(n_*(n_-1)/2) {}
+
+            double& operator() (
+                unsigned long i,
+                unsigned long j
+            )
+            {
+                DLIB_ASSERT(i != j && i < n && j < n);
+                if (i > j)
+                    std::swap(i,j);
+                return d[i*n - i*(i+1)/2 + (j-i-1)];
+            }
+
+            unsigned long size (
+            ) const { return n; }
 
-        struct compare_dist
+        private:
+            unsigned long n;
+            std::vector<double> d;
+        };
+
+        inline unsigned long cluster_using_nn_chain (
+            packed_distances& dists,
+            std::vector<unsigned long>& labels,
+            unsigned long min_num_clusters,
+            double max_dist
+        )
+        /*!
+            ensures
+                - Runs complete linkage agglomerative clustering on dists using the nearest
+                  neighbor chain algorithm.  dists is used as scratch space and is
+                  therefore modified by this function.
+                - The outputs are as described in bottom_up_cluster()
+        !*/
         {
-            bool operator() (
-                const sample_pair& a,
-                const sample_pair& b
-            ) const
+            const unsigned long n = dists.size();
+            labels.resize(n);
+            if (n == 0)
+                return 0;
+
+            /*
+                The nearest neighbor chain algorithm builds a chain of clusters where each
+                is the nearest neighbor of the one before it.  When the last two clusters on
+                the chain are each other's nearest neighbors they are merged.  Since the
+                complete linkage distance is reducible, merging them never changes the
+                nearest neighbors of the other clusters on the chain, so the chain remains
+                valid and the algorithm only needs O(n^2) time overall.  The merges are
+                found out of order, so we record them all and then apply them in order of
+                increasing distance.  This produces the same dendrogram as repeatedly
+                merging the two closest clusters.
+
+                Clusters are identified by one of their elements, and dists(a,b) is always
+                the complete linkage distance between the clusters a and b.
+            */
+
+            // The clusters that haven't been merged away yet.  active_pos lets us remove
+            // elements from active in constant time.
+            std::vector<unsigned long> active(n), active_pos(n);
+            for (unsigned long i = 0; i < n; ++i)
+                active[i] = active_pos[i] = i;
+
+            std::vector<sample_pair> merges;
+            merges.reserve(n-1);
+            std::vector<unsigned long> chain;
+            while (active.size() > 1)
             {
-                return a.distance() > b.distance();
+                if (chain.size() == 0)
+                    chain.push_back(active[0]);
+
+                const unsigned long a = chain.back();
+                // If there is a tie then prefer the previous element of the chain.  This
+                // is what guarantees the algorithm makes progress.
+                unsigned long b = (chain.size() > 1) ? chain[chain.size()-2] : a;
+                double best = (b != a) ? dists(a,b) : std::numeric_limits<double>::infinity();
+                for (unsigned long i = 0; i < active.size(); ++i)
+                {
+                    const unsigned long c = active[i];
+                    if (c != a && dists(a,c) < best)
+                    {
+                        best = dists(a,c);
+                        b = c;
+                    }
+                }
+                // This only happens if all the distances are infinite, in which case any
+                // pair is as good as any other.
+                if (b == a)
+                {
+                    b = (active[0] != a) ? active[0] : active[1];
+                    best = dists(a,b);
+                }
+
+                if (chain.size() > 1 && b == chain[chain.size()-2])
+                {
+                    chain.resize(chain.size()-2);
+                    merges.push_back(sample_pair(a,b,best));
+
+                    // Merge b into a.  The complete linkage distance to the new cluster is
+                    // the max of the distances to the two parts.
+                    const unsigned long pos = active_pos[b];
+                    active[pos] = active.back();
+                    active_pos[active[pos]] = pos;
+                    active.pop_back();
+                    for (unsigned long i = 0; i < active.size(); ++i)
+                    {
+                        const unsigned long c = active[i];
+                        if (c != a)
+                            dists(a,c) = std::max(dists(a,c), dists(b,c));
+                    }
+                }
+                else
+                {
+                    chain.push_back(b);
+                }
             }
-        };
+
+            // Now apply the merges in order of increasing distance until we hit one of
+            // the stopping conditions.
+            std::stable_sort(merges.begin(), merges.end(), order_by_distance<sample_pair>);
+            disjoint_subsets sets;
+            sets.set_size(n);
+            unsigned long num_clusters = n;
+            for (unsigned long i = 0; i < merges.size() && num_clusters > min_num_clusters; ++i)
+            {
+                if (merges[i].distance() > max_dist)
+                    break;
+                sets.merge_sets(sets.find_set(merges[i].index1()), sets.find_set(merges[i].index2()));
+                --num_clusters;
+            }
+
+            // figure out which cluster each element is in.  Also make sure the labels are
+            // contiguous.
+            std::vector<unsigned long> relabel(n, n);
+            unsigned long next = 0;
+            for (unsigned long r = 0; r < n; ++r)
+            {
+                const unsigned long l = sets.find_set(r);
+                if (relabel[l] == n)
+                    relabel[l] = next++;
+                labels[r] = relabel[l];
+            }
+
+            return next;
+        }
     }
 
 // ----------------------------------------------------------------------------------------
@@ -48,13 +184,12 @@ namespace dlib
         typename EXP
         >
     unsigned long bottom_up_cluster (
-        const matrix_exp<EXP>& dists_,
+        const matrix_exp<EXP>& dists,
         std::vector<unsigned long>& labels,
         unsigned long min_num_clusters,
         double max_dist = std::numeric_limits<double>::infinity()
     )
     {
-        matrix<double> dists = matrix_cast<double>(dists_);
         // make sure requires clause is not broken
         DLIB_CASSERT(dists.nr() == dists.nc() && min_num_clusters > 0, 
             "\t unsigned long bottom_up_cluster()"
@@ -64,70 +199,50 @@ namespace dlib
             << "\n\t min_num_clusters: " << min_num_clusters 
             );
 
-        using namespace buc_impl;
-
-        labels.resize(dists.nr());
-        disjoint_subsets sets;
-        sets.set_size(dists.nr());
-        if (labels.size() == 0)
-            return 0;
-
-        // push all the edges in the graph into a priority queue so the best edges to merge
-        // come first.
-        std::priority_queue<sample_pair, std::vector<sample_pair>, compare_dist> que;
+        buc_impl::packed_distances d(dists.nr());
         for (long r = 0; r < dists.nr(); ++r)
             for (long c = r+1; c < dists.nc(); ++c)
-                que.push(sample_pair(r,c,dists(r,c)));
+                d(r,c) = dists(r,c);
 
-        // Now start merging nodes.
-        for (unsigned long iter = min_num_clusters; iter < sets.size(); ++iter)
-        {
-            // find the next best thing to merge.
-            double best_dist = que.top().distance();
-            unsigned long a = sets.find_set(que.top().index1());
-            unsigned long b = sets.find_set(que.top().index2());
-            que.pop();
-            // we have been merging and modifying the distances, so make sure this distance
-            // is still valid and these guys haven't been merged already.
-            while(a == b || best_dist < dists(a,b))
-            {
-                // Haven't merged it yet, so put it back in with updated distance for
-                // reconsideration later.
-                if (a != b)
-                    que.push(sample_pair(a, b, dists(a, b)));
-
-                best_dist = que.top().distance();
-                a = sets.find_set(que.top().index1());
-                b = sets.find_set(que.top().index2());
-                que.pop();
-            }
+        return buc_impl::cluster_using_nn_chain(d, labels, min_num_clusters, max_dist);
+    }
 
+// ----------------------------------------------------------------------------------------
 
-            // now merge these sets if the best distance is small enough
-            if (best_dist > max_dist)
-                break;
-            unsigned long news = sets.merge_sets(a,b);
-            unsigned long olds = (news==a)?b:a;
-            merge_sets(dists, news, olds);
-        }
+    template <
+        typename T,
+        typename alloc,
+        typename distance_function_type
+        >
+    unsigned long bottom_up_cluster (
+        const std::vector<T,alloc>& samples,
+        const distance_function_type& distance,
+        std::vector<unsigned long>& labels,
+        unsigned long min_num_clusters,
+        double max_dist = std::numeric_limits<double>::infinity(),
+        unsigned long num_threads = 1
+    )
+    {
+        // make sure requires clause is not broken
+        DLIB_CASSERT(min_num_clusters > 0 && num_threads > 0, 
+            "\t unsigned long bottom_up_cluster()"
+            << "\n\t Invalid inputs were given to this function."
+            << "\n\t min_num_clusters: " << min_num_clusters 
+            << "\n\t num_threads:      " << num_threads 
+            );
 
-        // figure out which cluster each element is in.  Also make sure the labels are
-        // contiguous.
-        std::map<unsigned long, unsigned long> relabel;
-        for (unsigned long r = 0; r < labels.size(); ++r)
+        const long n = samples.size();
+        buc_impl::packed_distances d(n);
+        // Rows near the top of the triangle have the most work, so use lots of small
+        // chunks to keep the threads balanced.
+        thread_pool tp(num_threads > 1 ? num_threads : 0);
+        parallel_for(tp, 0, n, [&](long r)
         {
-            unsigned long l = sets.find_set(r);
-            // relabel to make contiguous
-            if (relabel.count(l) == 0)
-            {
-                unsigned long next = relabel.size();
-                relabel[l] = next;
-            }
-            labels[r] = relabel[l];
-        }
-
+            for (long c = r+1; c < n; ++c)
+                d(r,c) = distance(samples[r], samples[c]);
+        }, 32);
 
-        return relabel.size();
+        return buc_impl::cluster_using_nn_chain(d, labels, min_num_clusters, max_dist);
     }
 
 // ----------------------------------------------------------------------------------------
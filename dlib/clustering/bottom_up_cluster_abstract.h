@@ -3,6 +3,8 @@
 #undef DLIB_BOTTOM_uP_CLUSTER_ABSTRACT_Hh_
 #ifdef DLIB_BOTTOM_uP_CLUSTER_ABSTRACT_Hh_
 
+#include <vector>
+#include <limits>
 #include "../matrix.h"
 
 namespace dlib
@@ -40,6 +42,44 @@ namespace dlib
                   corresponding to the distances dists(i,*)).  
                 - 0 <= #labels[i] < the number of clusters found
                   (i.e. cluster IDs are assigned contiguously and start at 0) 
+            - The clustering uses complete linkage.  That is, the distance between two
+              clusters is the largest distance between any of their elements.  It is
+              computed with the nearest neighbor chain algorithm, so it takes O(N^2) time
+              and, beyond a copy of the upper triangle of dists, O(N) memory, where N ==
+              dists.nr().
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename T,
+        typename alloc,
+        typename distance_function_type
+        >
+    unsigned long bottom_up_cluster (
+        const std::vector<T,alloc>& samples,
+        const distance_function_type& distance,
+        std::vector<unsigned long>& labels,
+        unsigned long min_num_clusters,
+        double max_dist = std::numeric_limits<double>::infinity(),
+        unsigned long num_threads = 1
+    );
+    /*!
+        requires
+            - min_num_clusters > 0
+            - num_threads > 0
+            - distance(samples[i],samples[j]) must be a valid expression that returns a
+              value convertible to double.  It must be symmetric, i.e.
+              distance(samples[i],samples[j]) == distance(samples[j],samples[i]).
+            - It must be safe to call distance() concurrently from multiple threads.
+        ensures
+            - This function is identical to the bottom_up_cluster() routine defined above
+              except that the distances are computed from the samples rather than supplied
+              as a matrix.  That is, it performs bottom_up_cluster(D, labels,
+              min_num_clusters, max_dist) where D(i,j) == distance(samples[i],samples[j]).
+            - The distances are computed using num_threads threads.  Only the upper
+              triangle of D is ever computed or stored, so this takes about half the
+              memory of building D yourself.
     !*/
 
 // ----------------------------------------------------------------------------------------
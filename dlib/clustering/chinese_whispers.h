@@ -5,12 +5,46 @@
 
 #include "chinese_whispers_abstract.h"
 #include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
 #include "../rand.h"
+#include "../threads.h"
 #include "../graph_utils/edge_list_graphs.h"
 
 namespace dlib
 {
 
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        inline unsigned long make_labels_contiguous (
+            std::vector<unsigned long>& labels
+        )
+        /*!
+            requires
+                - all elements of labels are < labels.size()
+            ensures
+                - Renumbers the labels so they take the values 0, 1, 2, ..., N-1 in order of
+                  first appearance.  Two elements of #labels are equal if and only if they
+                  were equal in labels.
+                - returns N, the number of distinct labels.
+        !*/
+        {
+            std::vector<unsigned long> label_remap(labels.size(), labels.size());
+            unsigned long next_id = 0;
+            for (unsigned long i = 0; i < labels.size(); ++i)
+            {
+                if (label_remap[labels[i]] == labels.size())
+                    label_remap[labels[i]] = next_id++;
+                labels[i] = label_remap[labels[i]];
+            }
+            return next_id;
+        }
+    }
+
 // ----------------------------------------------------------------------------------------
 
     inline unsigned long chinese_whispers (
@@ -39,52 +73,46 @@ namespace dlib
             labels[i] = i;
 
 
+        // These are used to tally up the votes for each label.  labels_to_counts is
+        // indexed by label and is reset to all zeros after each vote.
+        std::vector<double> labels_to_counts(labels.size(), 0);
+        std::vector<unsigned long> touched_labels;
+
         for (unsigned long iter = 0; iter < neighbors.size()*num_iterations; ++iter)
         {
             // Pick a random node.
             const unsigned long idx = rnd.get_random_64bit_number()%neighbors.size();
 
             // Count how many times each label happens amongst our neighbors.
-            std::map<unsigned long, double> labels_to_counts;
+            touched_labels.clear();
             const unsigned long end = neighbors[idx].second;
             for (unsigned long i = neighbors[idx].first; i != end; ++i)
             {
-                labels_to_counts[labels[edges[i].index2()]] += edges[i].distance();
+                const unsigned long l = labels[edges[i].index2()];
+                touched_labels.push_back(l);
+                labels_to_counts[l] += edges[i].distance();
             }
 
-            // find the most common label
-            std::map<unsigned long, double>::iterator i;
+            // find the most common label.  Ties go to the smallest label.
+            std::sort(touched_labels.begin(), touched_labels.end());
+            touched_labels.erase(std::unique(touched_labels.begin(), touched_labels.end()), touched_labels.end());
             double best_score = -std::numeric_limits<double>::infinity();
             unsigned long best_label = labels[idx];
-            for (i = labels_to_counts.begin(); i != labels_to_counts.end(); ++i)
+            for (unsigned long i = 0; i < touched_labels.size(); ++i)
             {
-                if (i->second > best_score)
+                const unsigned long l = touched_labels[i];
+                if (labels_to_counts[l] > best_score)
                 {
-                    best_score = i->second;
-                    best_label = i->first;
+                    best_score = labels_to_counts[l];
+                    best_label = l;
                 }
+                labels_to_counts[l] = 0;
             }
 
             labels[idx] = best_label;
         }
 
-
-        // Remap the labels into a contiguous range.  First we find the
-        // mapping.
-        std::map<unsigned long,unsigned long> label_remap;
-        for (unsigned long i = 0; i < labels.size(); ++i)
-        {
-            const unsigned long next_id = label_remap.size();
-            if (label_remap.count(labels[i]) == 0)
-                label_remap[labels[i]] = next_id;
-        }
-        // now apply the mapping to all the labels.
-        for (unsigned long i = 0; i < labels.size(); ++i)
-        {
-            labels[i] = label_remap[labels[i]];
-        }
-
-        return label_remap.size();
+        return impl::make_labels_contiguous(labels);
     }
 
 // ----------------------------------------------------------------------------------------
@@ -127,6 +155,243 @@ namespace dlib
         return chinese_whispers(edges, labels, num_iterations, rnd);
     }
 
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        struct cw_graph
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    This is a graph in compressed sparse row form.  The edges leaving node
+                    i go to the nodes neighbors[offsets[i]] through
+                    neighbors[offsets[i+1]-1] and have the corresponding weights.
+            !*/
+            std::vector<unsigned long> offsets;
+            std::vector<unsigned long> neighbors;
+            std::vector<double> weights;
+        };
+
+        template <typename edge_type>
+        void make_cw_graph (
+            const std::vector<edge_type>& edges,
+            const bool add_reverse_edges,
+            cw_graph& g
+        )
+        {
+            // This is a counting sort on the edges by their first index, so it works
+            // regardless of the order of edges.
+            const unsigned long num_nodes = max_index_plus_one(edges);
+            g.offsets.assign(num_nodes+1, 0);
+            for (unsigned long i = 0; i < edges.size(); ++i)
+            {
+                g.offsets[edges[i].index1()+1] += 1;
+                if (add_reverse_edges && edges[i].index1() != edges[i].index2())
+                    g.offsets[edges[i].index2()+1] += 1;
+            }
+            for (unsigned long i = 0; i < num_nodes; ++i)
+                g.offsets[i+1] += g.offsets[i];
+
+            g.neighbors.resize(g.offsets.back());
+            g.weights.resize(g.offsets.back());
+            std::vector<unsigned long> pos(g.offsets.begin(), g.offsets.end()-1);
+            for (unsigned long i = 0; i < edges.size(); ++i)
+            {
+                unsigned long& p1 = pos[edges[i].index1()];
+                g.neighbors[p1] = edges[i].index2();
+                g.weights[p1] = edges[i].distance();
+                ++p1;
+                if (add_reverse_edges && edges[i].index1() != edges[i].index2())
+                {
+                    unsigned long& p2 = pos[edges[i].index2()];
+                    g.neighbors[p2] = edges[i].index1();
+                    g.weights[p2] = edges[i].distance();
+                    ++p2;
+                }
+            }
+        }
+
+        inline unsigned long parallel_chinese_whispers (
+            const cw_graph& g,
+            std::vector<unsigned long>& labels,
+            const unsigned long num_threads,
+            const unsigned long max_iterations,
+            const std::chrono::nanoseconds max_runtime,
+            dlib::rand& rnd
+        )
+        {
+            const auto start_time = std::chrono::steady_clock::now();
+
+            labels.clear();
+            const unsigned long num_nodes = g.offsets.size()-1;
+            if (num_nodes == 0)
+                return 0;
+
+            // Initialize the labels, each node gets a different label.  The labels are
+            // atomic since threads read their neighbors' labels while other threads might
+            // be updating them.
+            std::vector<std::atomic<unsigned long> > cur_labels(num_nodes);
+            for (unsigned long i = 0; i < num_nodes; ++i)
+                cur_labels[i].store(i, std::memory_order_relaxed);
+
+            std::vector<unsigned long> order(num_nodes);
+            for (unsigned long i = 0; i < num_nodes; ++i)
+                order[i] = i;
+
+            // A pool with 0 threads just runs everything in the calling thread.
+            thread_pool tp(num_threads > 1 ? num_threads : 0);
+
+            for (unsigned long iter = 0; iter < max_iterations; ++iter)
+            {
+                // Visit the nodes in a new random order on each pass.
+                for (unsigned long i = num_nodes-1; i > 0; --i)
+                    std::swap(order[i], order[rnd.get_random_64bit_number()%(i+1)]);
+
+                std::atomic<bool> labels_changed(false);
+                std::atomic<bool> out_of_time(false);
+                parallel_for_blocked(tp, 0, num_nodes, [&](long begin, long end)
+                {
+                    std::vector<std::pair<unsigned long,double> > votes;
+                    bool changed = false;
+                    for (long k = begin; k < end; ++k)
+                    {
+                        // Check the clock every so often so we can stop in the middle of a
+                        // pass if we run out of time.
+                        if ((k-begin)%1024 == 0)
+                        {
+                            if (out_of_time.load(std::memory_order_relaxed) ||
+                                std::chrono::steady_clock::now() - start_time > max_runtime)
+                            {
+                                out_of_time = true;
+                                break;
+                            }
+                        }
+
+                        const unsigned long idx = order[k];
+                        const unsigned long ebegin = g.offsets[idx];
+                        const unsigned long eend = g.offsets[idx+1];
+                        if (ebegin == eend)
+                            continue;
+
+                        // Count how many times each label happens amongst our neighbors by
+                        // sorting the votes by label and summing runs of the same label.
+                        votes.clear();
+                        for (unsigned long i = ebegin; i != eend; ++i)
+                            votes.push_back(std::make_pair(cur_labels[g.neighbors[i]].load(std::memory_order_relaxed), g.weights[i]));
+                        std::sort(votes.begin(), votes.end());
+
+                        // find the most common label.  Ties go to the smallest label.
+                        double best_score = -std::numeric_limits<double>::infinity();
+                        unsigned long best_label = cur_labels[idx].load(std::memory_order_relaxed);
+                        for (unsigned long i = 0; i < votes.size(); )
+                        {
+                            const unsigned long l = votes[i].first;
+                            double score = 0;
+                            for (; i < votes.size() && votes[i].first == l; ++i)
+                                score += votes[i].second;
+                            if (score > best_score)
+                            {
+                                best_score = score;
+                                best_label = l;
+                            }
+                        }
+
+                        if (best_label != cur_labels[idx].load(std::memory_order_relaxed))
+                        {
+                            cur_labels[idx].store(best_label, std::memory_order_relaxed);
+                            changed = true;
+                        }
+                    }
+
+                    if (changed)
+                        labels_changed = true;
+                });
+
+                if (!labels_changed || out_of_time)
+                    break;
+            }
+
+            labels.resize(num_nodes);
+            for (unsigned long i = 0; i < num_nodes; ++i)
+                labels[i] = cur_labels[i].load(std::memory_order_relaxed);
+            return make_labels_contiguous(labels);
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    inline unsigned long parallel_chinese_whispers (
+        const std::vector<ordered_sample_pair>& edges,
+        std::vector<unsigned long>& labels,
+        const unsigned long num_threads,
+        const unsigned long max_iterations,
+        const std::chrono::nanoseconds max_runtime,
+        dlib::rand& rnd
+    )
+    {
+        // make sure requires clause is not broken
+        DLIB_ASSERT(num_threads > 0,
+                    "\t unsigned long parallel_chinese_whispers()"
+                    << "\n\t Invalid inputs were given to this function"
+                    << "\n\t num_threads: " << num_threads
+        );
+
+        impl::cw_graph g;
+        impl::make_cw_graph(edges, false, g);
+        return impl::parallel_chinese_whispers(g, labels, num_threads, max_iterations, max_runtime, rnd);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    inline unsigned long parallel_chinese_whispers (
+        const std::vector<sample_pair>& edges,
+        std::vector<unsigned long>& labels,
+        const unsigned long num_threads,
+        const unsigned long max_iterations,
+        const std::chrono::nanoseconds max_runtime,
+        dlib::rand& rnd
+    )
+    {
+        // make sure requires clause is not broken
+        DLIB_ASSERT(num_threads > 0,
+                    "\t unsigned long parallel_chinese_whispers()"
+                    << "\n\t Invalid inputs were given to this function"
+                    << "\n\t num_threads: " << num_threads
+        );
+
+        impl::cw_graph g;
+        impl::make_cw_graph(edges, true, g);
+        return impl::parallel_chinese_whispers(g, labels, num_threads, max_iterations, max_runtime, rnd);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    inline unsigned long parallel_chinese_whispers (
+        const std::vector<ordered_sample_pair>& edges,
+        std::vector<unsigned long>& labels,
+        const unsigned long num_threads,
+        const unsigned long max_iterations = 100,
+        const std::chrono::nanoseconds max_runtime = std::chrono::nanoseconds::max()
+    )
+    {
+        dlib::rand rnd;
+        return parallel_chinese_whispers(edges, labels, num_threads, max_iterations, max_runtime, rnd);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    inline unsigned long parallel_chinese_whispers (
+        const std::vector<sample_pair>& edges,
+        std::vector<unsigned long>& labels,
+        const unsigned long num_threads,
+        const unsigned long max_iterations = 100,
+        const std::chrono::nanoseconds max_runtime = std::chrono::nanoseconds::max()
+    )
+    {
+        dlib::rand rnd;
+        return parallel_chinese_whispers(edges, labels, num_threads, max_iterations, max_runtime, rnd);
+    }
+
 // ----------------------------------------------------------------------------------------
 
 }
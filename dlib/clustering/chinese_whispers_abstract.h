@@ -4,6 +4,7 @@
 #ifdef DLIB_CHINESE_WHISPErS_ABSTRACT_Hh_
 
 #include <vector>
+#include <chrono>
 #include "../rand.h"
 #include "../graph_utils/ordered_sample_pair_abstract.h"
 #include "../graph_utils/sample_pair_abstract.h"
@@ -89,6 +90,97 @@ namespace dlib
               where rnd is a default initialized dlib::rand object.
     !*/
 
+// ----------------------------------------------------------------------------------------
+
+    unsigned long parallel_chinese_whispers (
+        const std::vector<ordered_sample_pair>& edges,
+        std::vector<unsigned long>& labels,
+        const unsigned long num_threads,
+        const unsigned long max_iterations,
+        const std::chrono::nanoseconds max_runtime,
+        dlib::rand& rnd
+    );
+    /*!
+        requires
+            - num_threads > 0
+        ensures
+            - This function runs the same clustering algorithm as chinese_whispers() and
+              interprets edges the same way.  However, it is designed for very large graphs
+              and uses multiple threads.  In particular:
+                - edges are converted into a flat compressed sparse row representation,
+                  which takes O(edges.size()) time and doesn't need edges to be sorted.
+                - Each iteration visits every node exactly once, in a random order, and
+                  updates its label.  The nodes are split among num_threads threads which
+                  update the labels concurrently.  So when num_threads > 1 the results are
+                  not deterministic, since they depend on the order in which the threads
+                  happen to see each other's label updates.
+                - The algorithm stops as soon as any of the following happens:
+                    - max_iterations passes over the graph have been performed.
+                    - A pass over the graph didn't change any labels.
+                    - max_runtime time has elapsed.  This is checked frequently, so the
+                      algorithm may stop in the middle of a pass.
+            - returns the number of clusters found.
+            - #labels.size() == max_index_plus_one(edges)
+            - for all valid i:
+                - #labels[i] == the cluster ID of the node with index i in the graph.  
+                - 0 <= #labels[i] < the number of clusters found
+                  (i.e. cluster IDs are assigned contiguously and start at 0) 
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    unsigned long parallel_chinese_whispers (
+        const std::vector<sample_pair>& edges,
+        std::vector<unsigned long>& labels,
+        const unsigned long num_threads,
+        const unsigned long max_iterations,
+        const std::chrono::nanoseconds max_runtime,
+        dlib::rand& rnd
+    );
+    /*!
+        requires
+            - num_threads > 0
+        ensures
+            - This function is identical to the above parallel_chinese_whispers() routine
+              except that it operates on a vector of sample_pair objects instead of
+              ordered_sample_pairs.  That is, each sample_pair is treated as an edge in
+              both directions.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    unsigned long parallel_chinese_whispers (
+        const std::vector<ordered_sample_pair>& edges,
+        std::vector<unsigned long>& labels,
+        const unsigned long num_threads,
+        const unsigned long max_iterations = 100,
+        const std::chrono::nanoseconds max_runtime = std::chrono::nanoseconds::max()
+    );
+    /*!
+        requires
+            - num_threads > 0
+        ensures
+            - performs: return parallel_chinese_whispers(edges, labels, num_threads, max_iterations, max_runtime, rnd)
+              where rnd is a default initialized dlib::rand object.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    unsigned long parallel_chinese_whispers (
+        const std::vector<sample_pair>& edges,
+        std::vector<unsigned long>& labels,
+        const unsigned long num_threads,
+        const unsigned long max_iterations = 100,
+        const std::chrono::nanoseconds max_runtime = std::chrono::nanoseconds::max()
+    );
+    /*!
+        requires
+            - num_threads > 0
+        ensures
+            - performs: return parallel_chinese_whispers(edges, labels, num_threads, max_iterations, max_runtime, rnd)
+              where rnd is a default initialized dlib::rand object.
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
 }
@@ -8,6 +8,8 @@
 #include "../graph_utils/edge_list_graphs.h"
 #include "../matrix.h"
 #include "../rand.h"
+#include "../threads.h"
+#include <algorithm>
 
 namespace dlib
 {
@@ -507,6 +509,355 @@ namespace dlib
         return 1.0/m*Q;
     }
 
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        struct louvain_graph
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    This is a weighted graph in compressed sparse row form.  The edges
+                    leaving node i go to the nodes neighbors[offsets[i]] through
+                    neighbors[offsets[i+1]-1] and have the corresponding weights.  Self
+                    loops are stored like any other edge.  degrees[i] is the sum of the
+                    weights of the edges leaving node i.
+            !*/
+            std::vector<unsigned long> offsets;
+            std::vector<unsigned long> neighbors;
+            std::vector<double> weights;
+            std::vector<double> degrees;
+
+            unsigned long size() const { return offsets.size()-1; }
+        };
+
+        inline bool louvain_move_nodes (
+            const louvain_graph& g,
+            const double total_weight,
+            std::vector<unsigned long>& comm,
+            thread_pool& tp
+        )
+        /*!
+            requires
+                - total_weight == the sum of all the weights in g.
+                - total_weight > 0
+            ensures
+                - Runs the local moving phase of the Louvain method on g.  That is, each
+                  node starts out in its own community and nodes are repeatedly moved into
+                  whichever neighboring community increases the modularity the most.
+                - #comm.size() == g.size()
+                - #comm[i] == the community node i ended up in.  The community ids are
+                  node ids, so they are in the range [0, g.size()) but are not
+                  contiguous.
+                - returns true if any node moved, i.e. if #comm isn't just the identity
+                  mapping.
+        !*/
+        {
+            const unsigned long num_nodes = g.size();
+            comm.resize(num_nodes);
+            for (unsigned long i = 0; i < num_nodes; ++i)
+                comm[i] = i;
+            // tot[c] == the sum of the degrees of the nodes in community c.
+            std::vector<double> tot(g.degrees);
+            std::vector<unsigned long> comm_size(num_nodes, 1);
+            std::vector<unsigned long> new_comm(num_nodes);
+            // The amount each node's move would increase the modularity, times
+            // total_weight/2.
+            std::vector<double> gains(num_nodes);
+
+            // Only nodes with a neighbor that moved during the last pass can possibly want
+            // to move, so each pass only looks at those nodes.  They are visited in a
+            // random order since going through them in index order tends to get stuck in
+            // worse solutions when similar nodes have nearby indices.
+            std::vector<unsigned long> active(num_nodes);
+            for (unsigned long i = 0; i < num_nodes; ++i)
+                active[i] = i;
+            std::vector<char> is_active(num_nodes, 1);
+            dlib::rand rnd;
+
+            auto pick_moves = [&](long begin, long end)
+            {
+                std::vector<std::pair<unsigned long,double> > links;
+                for (long n = begin; n < end; ++n)
+                {
+                    const unsigned long i = active[n];
+                    const unsigned long ci = comm[i];
+                    const double ki = g.degrees[i];
+
+                    // Find the total weight of the edges from i to each neighboring
+                    // community.
+                    links.clear();
+                    for (unsigned long k = g.offsets[i]; k < g.offsets[i+1]; ++k)
+                    {
+                        if (g.neighbors[k] != i)
+                            links.push_back(std::make_pair(comm[g.neighbors[k]], g.weights[k]));
+                    }
+                    std::sort(links.begin(), links.end());
+
+                    // The gain in modularity from moving i into community c, after taking
+                    // i out of its current community, is proportional to:
+                    //    links_to_c - ki*tot[c]/total_weight
+                    double stay_gain = -ki*(tot[ci]-ki)/total_weight;
+                    for (unsigned long k = 0; k < links.size() && links[k].first <= ci; ++k)
+                    {
+                        if (links[k].first == ci)
+                            stay_gain += links[k].second;
+                    }
+                    double best_gain = stay_gain;
+                    unsigned long best_comm = ci;
+
+                    for (unsigned long k = 0; k < links.size(); )
+                    {
+                        const unsigned long c = links[k].first;
+                        double w = 0;
+                        for (; k < links.size() && links[k].first == c; ++k)
+                            w += links[k].second;
+
+                        // Don't let two singletons swap places with each other.  Only the
+                        // one with the larger id is allowed to join the other.
+                        if (c == ci || (comm_size[ci] == 1 && comm_size[c] == 1 && c > ci))
+                            continue;
+
+                        const double gain = w - ki*tot[c]/total_weight;
+                        if (gain > best_gain)
+                        {
+                            best_gain = gain;
+                            best_comm = c;
+                        }
+                    }
+                    new_comm[i] = best_comm;
+                    gains[i] = best_gain - stay_gain;
+                }
+            };
+
+            // The nodes are processed in batches.  Every node in a batch picks its move
+            // based on where the other nodes were at the start of the batch, which is what
+            // lets us process a batch in parallel.  The batch size depends only on the size
+            // of the graph, so the output is the same no matter how many threads are used.
+            // Small graphs get a batch size of 1, which is the ordinary sequential Louvain
+            // method.
+            const unsigned long batch_size = std::min<unsigned long>(4096, std::max<unsigned long>(1, num_nodes/256));
+
+            bool moved_any = false;
+            std::vector<unsigned long> next_active;
+            for (unsigned long pass = 0; pass < 1000 && active.size() != 0; ++pass)
+            {
+                for (unsigned long i = active.size()-1; i > 0; --i)
+                    std::swap(active[i], active[rnd.get_random_64bit_number()%(i+1)]);
+                for (unsigned long i : active)
+                    is_active[i] = 0;
+
+                next_active.clear();
+                double pass_gain = 0;
+                for (unsigned long begin = 0; begin < active.size(); begin += batch_size)
+                {
+                    const unsigned long end = std::min<unsigned long>(begin+batch_size, active.size());
+                    if (end-begin == 1)
+                        pick_moves(begin, end);
+                    else
+                        parallel_for_blocked(tp, begin, end, pick_moves);
+
+                    for (unsigned long n = begin; n < end; ++n)
+                    {
+                        const unsigned long i = active[n];
+                        if (new_comm[i] != comm[i])
+                        {
+                            tot[comm[i]] -= g.degrees[i];
+                            comm_size[comm[i]] -= 1;
+                            comm[i] = new_comm[i];
+                            tot[comm[i]] += g.degrees[i];
+                            comm_size[comm[i]] += 1;
+                            pass_gain += gains[i];
+
+                            for (unsigned long k = g.offsets[i]; k < g.offsets[i+1]; ++k)
+                            {
+                                const unsigned long j = g.neighbors[k];
+                                if (!is_active[j])
+                                {
+                                    is_active[j] = 1;
+                                    next_active.push_back(j);
+                                }
+                            }
+                        }
+                    }
+                }
+
+                if (next_active.size() == 0)
+                    break;
+                moved_any = true;
+
+                // Stop once a pass no longer improves the modularity by a meaningful
+                // amount.  This also guards against nodes in the same batch endlessly
+                // trading places.
+                if (2*pass_gain/total_weight < 1e-9)
+                    break;
+
+                // Keep the active nodes in index order so the random shuffle above doesn't
+                // depend on the order nodes happened to be activated in.
+                std::sort(next_active.begin(), next_active.end());
+                active.swap(next_active);
+            }
+
+            return moved_any;
+        }
+
+        inline void louvain_aggregate (
+            const louvain_graph& g,
+            const std::vector<unsigned long>& comm,
+            const unsigned long num_comms,
+            louvain_graph& out
+        )
+        /*!
+            requires
+                - for all valid i: comm[i] < num_comms
+            ensures
+                - #out == the graph with one node for each community in g.  The weight of
+                  the edge between two communities is the sum of the weights of the edges
+                  between their members, and edges inside a community become a self loop.
+        !*/
+        {
+            // Group the nodes by community with a counting sort.
+            std::vector<unsigned long> members_start(num_comms+1, 0);
+            for (unsigned long i = 0; i < comm.size(); ++i)
+                members_start[comm[i]+1] += 1;
+            for (unsigned long c = 0; c < num_comms; ++c)
+                members_start[c+1] += members_start[c];
+            std::vector<unsigned long> members(comm.size());
+            std::vector<unsigned long> pos(members_start.begin(), members_start.end()-1);
+            for (unsigned long i = 0; i < comm.size(); ++i)
+                members[pos[comm[i]]++] = i;
+
+            out.offsets.assign(1, 0);
+            out.neighbors.clear();
+            out.weights.clear();
+            out.degrees.assign(num_comms, 0);
+
+            std::vector<double> link_weights(num_comms, 0);
+            std::vector<unsigned long> touched;
+            for (unsigned long c = 0; c < num_comms; ++c)
+            {
+                touched.clear();
+                for (unsigned long m = members_start[c]; m < members_start[c+1]; ++m)
+                {
+                    const unsigned long i = members[m];
+                    out.degrees[c] += g.degrees[i];
+                    for (unsigned long k = g.offsets[i]; k < g.offsets[i+1]; ++k)
+                    {
+                        const unsigned long d = comm[g.neighbors[k]];
+                        if (link_weights[d] == 0)
+                            touched.push_back(d);
+                        link_weights[d] += g.weights[k];
+                    }
+                }
+
+                // touched might contain duplicates if some edges have 0 weight.
+                std::sort(touched.begin(), touched.end());
+                touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+                for (unsigned long d : touched)
+                {
+                    out.neighbors.push_back(d);
+                    out.weights.push_back(link_weights[d]);
+                    link_weights[d] = 0;
+                }
+                out.offsets.push_back(out.neighbors.size());
+            }
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    inline unsigned long louvain_cluster (
+        const std::vector<ordered_sample_pair>& edges,
+        std::vector<unsigned long>& labels,
+        const unsigned long num_threads = 1
+    )
+    {
+#ifdef ENABLE_ASSERTS
+        for (unsigned long i = 0; i < edges.size(); ++i)
+        {
+            DLIB_ASSERT(edges[i].distance() >= 0,
+                "\t unsigned long louvain_cluster()"
+                << "\n\t Invalid inputs were given to this function"
+                << "\n\t i:                   " << i
+                << "\n\t edges[i].distance(): " << edges[i].distance()
+            );
+        }
+#endif
+
+        labels.clear();
+        if (edges.size() == 0)
+            return 0;
+
+        // Build the graph.  This is a counting sort on the edges by their first index, so
+        // edges doesn't need to be sorted.
+        const unsigned long num_nodes = max_index_plus_one(edges);
+        impl::louvain_graph g;
+        g.offsets.assign(num_nodes+1, 0);
+        for (unsigned long i = 0; i < edges.size(); ++i)
+            g.offsets[edges[i].index1()+1] += 1;
+        for (unsigned long i = 0; i < num_nodes; ++i)
+            g.offsets[i+1] += g.offsets[i];
+        g.neighbors.resize(edges.size());
+        g.weights.resize(edges.size());
+        g.degrees.assign(num_nodes, 0);
+        double total_weight = 0;
+        std::vector<unsigned long> pos(g.offsets.begin(), g.offsets.end()-1);
+        for (unsigned long i = 0; i < edges.size(); ++i)
+        {
+            const unsigned long p = pos[edges[i].index1()]++;
+            g.neighbors[p] = edges[i].index2();
+            g.weights[p] = edges[i].distance();
+            g.degrees[edges[i].index1()] += edges[i].distance();
+            total_weight += edges[i].distance();
+        }
+
+        labels.resize(num_nodes);
+        for (unsigned long i = 0; i < num_nodes; ++i)
+            labels[i] = i;
+        if (total_weight <= 0)
+            return num_nodes;
+
+        // A pool with 0 threads just runs everything in the calling thread.
+        thread_pool tp(num_threads > 1 ? num_threads : 0);
+
+        // Alternate between moving nodes between communities and collapsing each
+        // community into a single node until nothing moves anymore.
+        std::vector<unsigned long> comm;
+        impl::louvain_graph next_g;
+        while (impl::louvain_move_nodes(g, total_weight, comm, tp))
+        {
+            unsigned long num_comms;
+            comm = impl::remap_labels(comm, num_comms);
+            for (unsigned long i = 0; i < num_nodes; ++i)
+                labels[i] = comm[labels[i]];
+
+            if (num_comms == g.size())
+                break;
+            impl::louvain_aggregate(g, comm, num_comms, next_g);
+            g.offsets.swap(next_g.offsets);
+            g.neighbors.swap(next_g.neighbors);
+            g.weights.swap(next_g.weights);
+            g.degrees.swap(next_g.degrees);
+        }
+
+        unsigned long num_labels;
+        labels = impl::remap_labels(labels, num_labels);
+        return num_labels;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    inline unsigned long louvain_cluster (
+        const std::vector<sample_pair>& edges,
+        std::vector<unsigned long>& labels,
+        const unsigned long num_threads = 1
+    )
+    {
+        std::vector<ordered_sample_pair> oedges;
+        convert_unordered_to_ordered(edges, oedges);
+        return louvain_cluster(oedges, labels, num_threads);
+    }
+
 // ----------------------------------------------------------------------------------------
 
 }
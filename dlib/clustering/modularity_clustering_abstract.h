@@ -117,6 +117,60 @@ namespace dlib
               above.  
     !*/
 
+// ----------------------------------------------------------------------------------------
+
+    unsigned long louvain_cluster (
+        const std::vector<ordered_sample_pair>& edges,
+        std::vector<unsigned long>& labels,
+        const unsigned long num_threads = 1
+    );
+    /*!
+        requires
+            - for all valid i:
+                - 0 <= edges[i].distance() < std::numeric_limits<double>::infinity()
+            - edges represents an undirected graph.  That is, if edges contains an edge
+              from node i to node j with a given weight then it also contains an edge from
+              j to i with the same weight.
+        ensures
+            - This function performs the Louvain method described in the paper
+              Fast unfolding of communities in large networks by Blondel et al.
+            - This function interprets edges as a graph and attempts to find the labeling
+              that maximizes modularity(edges, #labels).  It does this greedily, by
+              repeatedly moving nodes into whichever neighboring cluster most increases
+              the modularity and then merging each cluster into a single node.  This is
+              much faster than newman_cluster() and scales to graphs with millions of
+              nodes.
+            - The node moving steps are run in parallel using num_threads threads.  The
+              output does not depend on num_threads.
+            - edges does not need to be sorted.
+            - returns the number of clusters found.
+            - #labels.size() == max_index_plus_one(edges)
+            - for all valid i:
+                - #labels[i] == the cluster ID of the node with index i in the graph.  
+                - 0 <= #labels[i] < the number of clusters found
+                  (i.e. cluster IDs are assigned contiguously and start at 0) 
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    unsigned long louvain_cluster (
+        const std::vector<sample_pair>& edges,
+        std::vector<unsigned long>& labels,
+        const unsigned long num_threads = 1
+    );
+    /*!
+        requires
+            - for all valid i:
+                - 0 <= edges[i].distance() < std::numeric_limits<double>::infinity()
+        ensures
+            - This function is identical to the above louvain_cluster() routine except that
+              it operates on a vector of sample_pair objects instead of
+              ordered_sample_pairs.  Therefore, this is simply a convenience routine.  In
+              particular, it is implemented by transforming the given edges into
+              ordered_sample_pairs and then calling the louvain_cluster() routine defined
+              above.  
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
 }
@@ -7,9 +7,48 @@
 #include <vector>
 #include "../matrix.h"
 #include "../svm/kkmeans.h"
+#include "../graph_utils/edge_list_graphs.h"
 
 namespace dlib
 {
+
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        inline std::vector<unsigned long> cluster_spectral_vectors (
+            const matrix<double>& v,
+            const unsigned long num_clusters
+        )
+        /*!
+            ensures
+                - Runs k-means on the rows of v, each normalized to unit length, and
+                  returns the cluster each row falls into.
+        !*/
+        {
+            // Build the normalized spectral vectors, one for each input vector.
+            std::vector<matrix<double,0,1> > spec_samps, centers;
+            for (long r = 0; r < v.nr(); ++r)
+            {
+                spec_samps.push_back(trans(rowm(v,r)));
+                const double len = length(spec_samps.back());
+                if (len != 0)
+                    spec_samps.back() /= len;
+            }
+            // Finally do the K-means clustering
+            pick_initial_centers(num_clusters, centers, spec_samps);
+            find_clusters_using_kmeans(spec_samps, centers);
+            // And then compute the cluster assignments based on the output of K-means.
+            std::vector<unsigned long> assignments;
+            for (unsigned long i = 0; i < spec_samps.size(); ++i)
+                assignments.push_back(nearest_center(centers, spec_samps[i]));
+
+            return assignments;
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
     template <
         typename kernel_type,
         typename vector_type
@@ -54,26 +93,134 @@ namespace dlib
         // Pick out the eigenvectors associated with the largest eigenvalues.
         rsort_columns(v,w);
         v = colm(v, range(0,num_clusters-1));
-        // Now build the normalized spectral vectors, one for each input vector.
-        std::vector<matrix<double,0,1> > spec_samps, centers;
-        for (long r = 0; r < v.nr(); ++r)
+        return impl::cluster_spectral_vectors(v, num_clusters);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    inline std::vector<unsigned long> spectral_cluster (
+        const std::vector<sample_pair>& edges,
+        const unsigned long num_clusters
+    )
+    {
+        const unsigned long num_nodes = max_index_plus_one(edges);
+        DLIB_CASSERT(num_clusters > 0 && num_clusters <= std::max<unsigned long>(num_nodes,1), 
+            "\t std::vector<unsigned long> spectral_cluster(edges,num_clusters)"
+            << "\n\t Invalid inputs were given to this function."
+            << "\n\t num_clusters:                " << num_clusters
+            << "\n\t max_index_plus_one(edges):   " << num_nodes
+            );
+
+        if (num_clusters == 1)
+        {
+            // nothing to do, just assign everything to the 0 cluster.
+            return std::vector<unsigned long>(num_nodes, 0);
+        }
+
+        // Build the normalized affinity matrix D^(-1/2)*W*D^(-1/2) in compressed sparse
+        // row form.  Self loops are ignored, just like the diagonal of the dense kernel
+        // matrix is in the other version of spectral_cluster().
+        std::vector<unsigned long> row_start(num_nodes+1, 0);
+        for (auto& e : edges)
+        {
+            if (e.index1() != e.index2())
+            {
+                ++row_start[e.index1()+1];
+                ++row_start[e.index2()+1];
+            }
+        }
+        for (unsigned long i = 0; i < num_nodes; ++i)
+            row_start[i+1] += row_start[i];
+
+        std::vector<unsigned long> cols(row_start.back());
+        std::vector<double> vals(row_start.back());
+        std::vector<unsigned long> next(row_start.begin(), row_start.end()-1);
+        matrix<double,0,1> D(num_nodes);
+        D = 0;
+        for (auto& e : edges)
+        {
+            if (e.index1() != e.index2())
+            {
+                cols[next[e.index1()]] = e.index2();
+                vals[next[e.index1()]++] = e.distance();
+                cols[next[e.index2()]] = e.index1();
+                vals[next[e.index2()]++] = e.distance();
+                D(e.index1()) += e.distance();
+                D(e.index2()) += e.distance();
+            }
+        }
+        // Nodes with no edges get a 0 row rather than a division by 0.
+        for (long i = 0; i < D.size(); ++i)
+            D(i) = (D(i) > 0) ? 1/std::sqrt(D(i)) : 0;
+        for (unsigned long r = 0; r < num_nodes; ++r)
         {
-            spec_samps.push_back(trans(rowm(v,r)));
-            const double len = length(spec_samps.back());
-            if (len != 0)
-                spec_samps.back() /= len;
+            for (unsigned long i = row_start[r]; i < row_start[r+1]; ++i)
+                vals[i] *= D(r)*D(cols[i]);
         }
-        // Finally do the K-means clustering
-        pick_initial_centers(num_clusters, centers, spec_samps);
-        find_clusters_using_kmeans(spec_samps, centers);
-        // And then compute the cluster assignments based on the output of K-means.
-        std::vector<unsigned long> assignments;
-        for (unsigned long i = 0; i < spec_samps.size(); ++i)
-            assignments.push_back(nearest_center(centers, spec_samps[i]));
-
-        return assignments;
+
+        matrix<double,0,1> w;
+        matrix<double> v;
+        find_largest_eigenvectors([&](const matrix<double,0,1>& x, matrix<double,0,1>& y)
+            {
+                y.set_size(x.size());
+                for (unsigned long r = 0; r < num_nodes; ++r)
+                {
+                    double temp = 0;
+                    for (unsigned long i = row_start[r]; i < row_start[r+1]; ++i)
+                        temp += vals[i]*x(cols[i]);
+                    y(r) = temp;
+                }
+            }, num_nodes, num_clusters, w, v, 1e-6);
+
+        return impl::cluster_spectral_vectors(v, num_clusters);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename kernel_type,
+        typename vector_type
+        >
+    std::vector<unsigned long> spectral_cluster (
+        const kernel_type& k,
+        const vector_type& samples,
+        const unsigned long num_clusters,
+        const unsigned long num_neighbors
+    )
+    {
+        DLIB_CASSERT(num_clusters > 0 && num_neighbors > 0, 
+            "\t std::vector<unsigned long> spectral_cluster(k,samples,num_clusters,num_neighbors)"
+            << "\n\t Invalid inputs were given to this function."
+            << "\n\t num_clusters:  " << num_clusters
+            << "\n\t num_neighbors: " << num_neighbors
+            );
+
+        if (num_clusters == 1 || samples.size() <= 1)
+            return std::vector<unsigned long>(samples.size(), 0);
+
+        // Find the nearest neighbors of each sample in the feature space induced by k.
+        // That is, using the distance ||a-b||^2 == k(a,a) + k(b,b) - 2*k(a,b).
+        std::vector<double> self_sim(samples.size());
+        for (unsigned long i = 0; i < samples.size(); ++i)
+            self_sim[i] = k(samples[i], samples[i]);
+        std::vector<unsigned long> idx(samples.size());
+        for (unsigned long i = 0; i < idx.size(); ++i)
+            idx[i] = i;
+        std::vector<sample_pair> edges;
+        find_k_nearest_neighbors(idx, 
+            [&](unsigned long a, unsigned long b) 
+            { return self_sim[a] + self_sim[b] - 2*(double)k(samples[a], samples[b]); },
+            num_neighbors, edges);
+
+        // Then weight each edge by the similarity of its endpoints.
+        for (auto& e : edges)
+            e = sample_pair(e.index1(), e.index2(), k(samples[e.index1()], samples[e.index2()]));
+
+        return spectral_cluster(edges, std::min<unsigned long>(num_clusters, samples.size()));
     }
 
+// ----------------------------------------------------------------------------------------
+
 }
 
 #endif // DLIB_SPECTRAL_CLUSTEr_H_
@@ -4,6 +4,7 @@
 #ifdef DLIB_SPECTRAL_CLUSTEr_ABSTRACT_H_
 
 #include <vector>
+#include "../graph_utils/sample_pair_abstract.h"
 
 namespace dlib
 {
@@ -35,7 +36,78 @@ namespace dlib
             - The "similarity" of samples[i] with samples[j] is given by
               k(samples[i],samples[j]).  This means that k() should output a number >= 0
               and the number should be larger for samples that are more similar.
+            - This function builds a dense samples.size() by samples.size() similarity
+              matrix.  So it is only appropriate for a few thousand samples.  Use one of
+              the sparse versions below for larger problems.
     !*/
+
+// ----------------------------------------------------------------------------------------
+
+    std::vector<unsigned long> spectral_cluster (
+        const std::vector<sample_pair>& edges,
+        const unsigned long num_clusters
+    );
+    /*!
+        requires
+            - num_clusters > 0
+            - num_clusters <= max(1, max_index_plus_one(edges))
+            - for all valid i: edges[i].distance() >= 0
+        ensures
+            - This function is identical to the above spectral_cluster() routine except
+              that the similarity between samples is given by a sparse graph rather than a
+              kernel function.  In particular, edges[i].distance() is the similarity
+              between the nodes edges[i].index1() and edges[i].index2(), and any pair of
+              nodes without an edge between them has a similarity of 0.  Self loops are
+              ignored and duplicate edges have their similarities added together.
+            - The top eigenvectors of the normalized similarity matrix are found with
+              find_largest_eigenvectors(), which only needs to multiply vectors by the
+              matrix.  Therefore, the time and memory needed by this function are linear
+              in edges.size() and the number of nodes.  This makes it suitable for graphs
+              with millions of nodes.
+            - returns an array A such that:
+                - A.size() == max_index_plus_one(edges)
+                - A[i] == the cluster assignment of node i.
+                - for all valid i: 0 <= A[i] < num_clusters 
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename kernel_type,
+        typename vector_type
+        >
+    std::vector<unsigned long> spectral_cluster (
+        const kernel_type& k,
+        const vector_type& samples,
+        const unsigned long num_clusters,
+        const unsigned long num_neighbors
+    );
+    /*!
+        requires
+            - samples must be something with an interface compatible with std::vector.
+            - The following expression must evaluate to a double or float:
+                k(samples[i], samples[j])
+            - num_clusters > 0
+            - num_neighbors > 0
+        ensures
+            - This function is identical to the first spectral_cluster() routine except
+              that each sample is only connected to its num_neighbors nearest neighbors,
+              as measured by the distance in the feature space induced by k.  That is, the
+              similarity matrix is the sparse k-nearest-neighbor graph, with each edge
+              weighted by k(), and the clustering is done by spectral_cluster(edges,
+              num_clusters).
+            - Finding the neighbors takes O(samples.size()^2) kernel evaluations but only
+              O(samples.size()*num_neighbors) memory.  For very large datasets you can
+              instead build the graph with find_approximate_k_nearest_neighbors() and call
+              spectral_cluster(edges, num_clusters) directly.
+            - returns an array A such that:
+                - A.size() == samples.size()
+                - A[i] == the cluster assignment of samples[i].
+                - for all valid i: 0 <= A[i] < num_clusters 
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
 }
 
 #endif // DLIB_SPECTRAL_CLUSTEr_ABSTRACT_H_
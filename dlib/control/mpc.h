@@ -45,7 +45,6 @@ namespace dlib
                 controls[i].set_size(B.nc());
                 controls[i] = 0;
             }
-            lambda = 0;
         }
 
         mpc (
@@ -110,18 +109,6 @@ namespace dlib
                 controls[i].set_size(B.nc());
                 controls[i] = 0;
             }
-
-            // Bound the maximum eigenvalue of the hessian by computing the trace of the
-            // hessian matrix. 
-            lambda = sum(R)*horizon;
-            matrix<double,S,S> temp = diagm(Q);
-            for (unsigned long c = 0; c < horizon; ++c)
-            {
-                lambda += trace(trans(B)*temp*B);
-                Q_diag[horizon-c-1] = diag(trans(B)*temp*B);
-                temp = trans(A)*temp*A + diagm(Q);
-            }
-
         }
 
         const matrix<double,S,S>& get_A (
@@ -248,7 +235,30 @@ namespace dlib
         matrix<double,I,1> MM[horizon];
         matrix<double,I,1> df[horizon]; 
         matrix<double,I,1> v[horizon]; 
-        matrix<double,I,1> v_old[horizon]; 
+        matrix<double,I,1> step[horizon]; 
+        matrix<double,I,S> K[horizon]; 
+        matrix<double,I,1> k[horizon]; 
+        matrix<unsigned char,I,1> fixed[horizon]; 
+
+        double objective (
+            const matrix<double,S,1>& initial_state,
+            const matrix<double,I,1> (&u)[horizon]
+        ) const
+        /*!
+            ensures
+                - returns the value of the QP objective at the controls u, scaled by 0.5 so
+                  that df is its gradient.
+        !*/
+        {
+            double cost = 0;
+            matrix<double,S,1> x = initial_state;
+            for (unsigned long i = 0; i < horizon; ++i)
+            {
+                x = A*x + B*u[i] + C;
+                cost += 0.5*(trans(x-target[i])*diagm(Q)*(x-target[i]) + trans(u[i])*diagm(R)*u[i]);
+            }
+            return cost;
+        }
 
         void solve_linear_mpc (
             const matrix<double,S,1>& initial_state
@@ -267,8 +277,7 @@ namespace dlib
 
 
 
-            unsigned long iter = 0;
-            for (; iter < max_iterations; ++iter)
+            for (unsigned long iter = 0; iter < max_iterations; ++iter)
             {
                 // compute current gradient and put it into df.
                 // df == H*controls + MM;
@@ -287,24 +296,14 @@ namespace dlib
                 // Check the stopping condition, which is the magnitude of the largest element
                 // of the gradient.
                 double max_df = 0;
-                unsigned long max_t = 0;
-                long max_v = 0;
                 for (unsigned long i = 0; i < horizon; ++i)
                 {
                     for (long j = 0; j < controls[i].size(); ++j)
                     {
                         // if this variable isn't an active constraint then we care about it's
                         // derivative.
-                        if (!((controls[i](j) <= lower(j) && df[i](j) > 0) || 
-                              (controls[i](j) >= upper(j) && df[i](j) < 0)))
-                        {
-                            if (std::abs(df[i](j)) > max_df)
-                            {
-                                max_df = std::abs(df[i](j));
-                                max_t = i;
-                                max_v = j;
-                            }
-                        }
+                        if (!is_active(i,j))
+                            max_df = std::max(max_df, std::abs(df[i](j)));
                     }
                 }
                 if (max_df < eps)
@@ -312,40 +311,151 @@ namespace dlib
 
 
 
-                // We will start out by doing a little bit of coordinate descent because it
-                // allows us to optimize individual variables exactly.  Since we are warm
-                // starting each iteration with a really good solution this helps speed
-                // things up a lot.
-                const unsigned long smo_iters = 50;
-                if (iter < smo_iters)
+                // Now take a projected Newton step.  The active constraints are held fixed
+                // and the Newton step for the remaining variables is the solution of an
+                // unconstrained LQR problem, which we find with a Riccati recursion.  So
+                // each iteration takes time linear in the horizon even though the hessian
+                // of the QP is dense.
+                for (unsigned long i = 0; i < horizon; ++i)
                 {
-                    if (Q_diag[max_t](max_v) == 0) continue;
-
-                    // Take the optimal step but just for one variable.
-                    controls[max_t](max_v) = -(df[max_t](max_v)-Q_diag[max_t](max_v)*controls[max_t](max_v))/Q_diag[max_t](max_v);
-                    controls[max_t](max_v) = put_in_range(lower(max_v), upper(max_v), controls[max_t](max_v));
+                    fixed[i].set_size(controls[i].size());
+                    for (long j = 0; j < controls[i].size(); ++j)
+                        fixed[i](j) = is_active(i,j);
+                }
+                // If the step wants to push a variable that is already at a bound further
+                // out then projecting it back would spoil the step for the other variables.
+                // So hold such variables fixed as well and compute the step again.
+                for (unsigned long pass = 0; pass < 10; ++pass)
+                {
+                    compute_newton_step();
+                    bool changed = false;
+                    for (unsigned long i = 0; i < horizon; ++i)
+                    {
+                        for (long j = 0; j < controls[i].size(); ++j)
+                        {
+                            if (!fixed[i](j) && 
+                                ((controls[i](j) <= lower(j) && step[i](j) < 0) ||
+                                 (controls[i](j) >= upper(j) && step[i](j) > 0)))
+                            {
+                                fixed[i](j) = true;
+                                changed = true;
+                            }
+                        }
+                    }
+                    if (!changed)
+                        break;
+                }
 
-                    // If this is the last SMO iteration then don't forget to initialize v
-                    // for the gradient steps.
-                    if (iter+1 == smo_iters)
+                // Backtrack along the projected search path until we get a sufficient
+                // decrease in the objective.
+                const double f = objective(initial_state, controls);
+                bool found_better = false;
+                double alpha = 1;
+                for (int attempt = 0; attempt < 20 && !found_better; ++attempt, alpha *= 0.5)
+                {
+                    double decrease = 0;
+                    for (unsigned long i = 0; i < horizon; ++i)
                     {
-                        for (unsigned long i = 0; i < horizon; ++i)
-                            v[i] = controls[i];
+                        v[i] = dlib::clamp(controls[i] + alpha*step[i], lower, upper);
+                        decrease += dot(df[i], v[i]-controls[i]);
                     }
+                    found_better = objective(initial_state, v) <= f + 1e-4*decrease;
                 }
-                else
+
+                // If that fails then move along the Newton step until the first variable
+                // hits a bound.  The objective is a convex quadratic which is minimized
+                // at the end of the full Newton step, so this always makes progress.
+                if (!found_better)
                 {
-                    // Take a projected gradient step.
+                    alpha = 1;
+                    for (unsigned long i = 0; i < horizon; ++i)
+                    {
+                        for (long j = 0; j < controls[i].size(); ++j)
+                        {
+                            if (step[i](j) < 0)
+                                alpha = std::min(alpha, (lower(j)-controls[i](j))/step[i](j));
+                            else if (step[i](j) > 0)
+                                alpha = std::min(alpha, (upper(j)-controls[i](j))/step[i](j));
+                        }
+                    }
                     for (unsigned long i = 0; i < horizon; ++i)
+                        v[i] = dlib::clamp(controls[i] + alpha*step[i], lower, upper);
+                    found_better = alpha > 0 && objective(initial_state, v) < f;
+                }
+
+                // If we can't make any progress then we are as close to the optimum as
+                // numerical precision allows.
+                if (!found_better)
+                    break;
+
+                for (unsigned long i = 0; i < horizon; ++i)
+                    controls[i] = v[i];
+            }
+        }
+
+        void compute_newton_step (
+        )
+        /*!
+            ensures
+                - #step == the Newton step for the QP when the variables flagged in fixed
+                  are held constant.  That is, step minimizes the quadratic model of the
+                  objective at controls (whose gradient is df) subject to step[i](j) == 0
+                  for all fixed[i](j).
+        !*/
+        {
+            // Backward pass.  P and p define the cost-to-go, as a function of the change
+            // in the state, of the remaining part of the horizon.
+            matrix<double,S,S> P = zeros_matrix(A), W;
+            matrix<double,S,1> p = zeros_matrix(C), w;
+            matrix<double,S,I> Bt;
+            matrix<double,I,1> g;
+            matrix<double,I,I> H;
+            for (long i = (long)horizon-1; i >= 0; --i)
+            {
+                Bt = B;
+                g = df[i];
+                for (long j = 0; j < g.size(); ++j)
+                {
+                    if (fixed[i](j))
                     {
-                        v_old[i] = v[i];
-                        v[i] = dlib::clamp(controls[i] - 1.0/lambda * df[i], lower, upper);
-                        controls[i] = dlib::clamp(v[i] + (std::sqrt(lambda)-1)/(std::sqrt(lambda)+1)*(v[i]-v_old[i]), lower, upper);
+                        set_colm(Bt,j) = 0;
+                        g(j) = 0;
                     }
                 }
+
+                W = P + diagm(Q);
+                w = p;
+                H = inv(trans(Bt)*W*Bt + diagm(R));
+                K[i] = -H*trans(Bt)*W*A;
+                k[i] = -H*(g + trans(Bt)*w);
+                P = trans(A)*W*(A + Bt*K[i]);
+                P = 0.5*(P + trans(P));
+                p = trans(A)*(w + W*Bt*k[i]);
+            }
+
+            // Forward pass
+            matrix<double,S,1> dx = zeros_matrix(C);
+            for (unsigned long i = 0; i < horizon; ++i)
+            {
+                step[i] = k[i] + K[i]*dx;
+                dx = A*dx + B*step[i];
             }
         }
 
+        bool is_active (
+            unsigned long i,
+            long j
+        ) const
+        /*!
+            ensures
+                - returns true if controls[i](j) is at one of its bounds and the gradient
+                  is pushing it further past that bound.
+        !*/
+        {
+            return (controls[i](j) <= lower(j) && df[i](j) > 0) || 
+                   (controls[i](j) >= upper(j) && df[i](j) < 0);
+        }
+
         unsigned long max_iterations;
         double eps;
 
@@ -358,8 +468,6 @@ namespace dlib
         matrix<double,I,1> upper;
         matrix<double,S,1> target[horizon]; 
 
-        double lambda; // abound on the largest eigenvalue of the hessian matrix.
-        matrix<double,I,1> Q_diag[horizon]; 
         matrix<double,I,1> controls[horizon]; 
 
     };
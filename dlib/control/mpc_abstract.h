@@ -55,10 +55,14 @@ namespace dlib
                 penalize variations away from the target state as well as how much we want
                 to avoid generating large control signals.  
                 
-                Finally, the algorithm we use to solve this quadratic program is based
-                largely on the method described in:
-                  A Fast Gradient method for embedded linear predictive control (2011)
-                  by Markus Kogel and Rolf Findeisen
+                Finally, we solve this quadratic program with the projected Newton
+                method described in:
+                  Projected Newton Methods for Optimization Problems with Simple
+                  Constraints (1982) by Dimitri P. Bertsekas
+                Each Newton step is found by a Riccati recursion over the horizon, so the
+                cost of each solver iteration grows only linearly with horizon_.  The
+                solver is also warm started with the solution from the previous call to
+                operator(), shifted by one time step.
         !*/
 
     public:
@@ -6,8 +6,13 @@
 #include "find_max_global_abstract.h"
 #include "global_function_search.h"
 #include "../metaprogramming.h"
+#include "../threads/thread_pool_extension.h"
 #include <utility>
 #include <chrono>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
 
 namespace dlib
 {
@@ -118,6 +123,7 @@ template <typename T> static auto go(T&& f, const matrix<double, 0, 1>& a) -> de
             typename funct
             >
         std::pair<size_t,function_evaluation> find_max_global (
+            thread_pool* tp,
             std::vector<funct>& functions,
             std::vector<function_spec> specs,
             const max_function_calls num,
@@ -125,6 +131,14 @@ template <typename T> static auto go(T&& f, const matrix<double, 0, 1>& a) -> de
             double solver_epsilon,
             double ymult
         ) 
+        /*!
+            ensures
+                - if (tp == nullptr) then
+                    - the functions are evaluated one at a time in the calling thread.
+                - else
+                    - the functions are evaluated by tp, keeping up to
+                      max(1,tp->num_threads_in_pool()) evaluations running at once.
+        !*/
         {
             // Decide which parameters should be searched on a log scale.  Basically, it's
             // common for machine learning models to have parameters that should be searched on
@@ -156,10 +170,8 @@ template <typename T> static auto go(T&& f, const matrix<double, 0, 1>& a) -> de
 
             const auto time_to_stop = std::chrono::steady_clock::now() + max_runtime;
 
-            // Now run the main solver loop.
-            for (size_t i = 0; i < num.max_calls && std::chrono::steady_clock::now() < time_to_stop; ++i)
+            auto evaluate = [&functions,&log_scale,ymult](const function_evaluation_request& next)
             {
-                auto next = opt.get_next_x();
                 matrix<double,0,1> x = next.x();
                 // Undo any log-scaling that was applied to the variables before we pass them
                 // to the functions being optimized.
@@ -168,8 +180,67 @@ template <typename T> static auto go(T&& f, const matrix<double, 0, 1>& a) -> de
                     if (log_scale[next.function_idx()][j])
                         x(j) = std::exp(x(j));
                 }
-                double y = ymult*call_function_and_expand_args(functions[next.function_idx()], x);
-                next.set(y);
+                return ymult*call_function_and_expand_args(functions[next.function_idx()], x);
+            };
+
+            if (tp == nullptr)
+            {
+                // Now run the main solver loop.
+                for (size_t i = 0; i < num.max_calls && std::chrono::steady_clock::now() < time_to_stop; ++i)
+                {
+                    auto next = opt.get_next_x();
+                    next.set(evaluate(next));
+                }
+            }
+            else
+            {
+                // Run the same loop but hand each evaluation to the thread pool and only
+                // wait when max_in_flight of them are already running.  It's fine to call
+                // opt.get_next_x() while other threads are calling set() on their requests
+                // since global_function_search synchronizes that itself.
+                const size_t max_in_flight = std::max<size_t>(1, tp->num_threads_in_pool());
+                std::mutex m;
+                std::condition_variable cv;
+                size_t in_flight = 0;
+                std::exception_ptr eptr;
+                for (size_t i = 0; i < num.max_calls; ++i)
+                {
+                    {
+                        std::unique_lock<std::mutex> lock(m);
+                        cv.wait(lock, [&]{ return in_flight < max_in_flight; });
+                        // Stop handing out new work if any evaluation failed or we are out
+                        // of time.  The evaluations already running are allowed to finish.
+                        if (eptr || std::chrono::steady_clock::now() >= time_to_stop)
+                            break;
+                        ++in_flight;
+                    }
+
+                    auto next = std::make_shared<function_evaluation_request>(opt.get_next_x());
+                    tp->add_task_by_value([&m,&cv,&in_flight,&eptr,&evaluate,next]() mutable
+                    {
+                        try
+                        {
+                            next->set(evaluate(*next));
+                        }
+                        catch (...)
+                        {
+                            std::lock_guard<std::mutex> lock(m);
+                            if (!eptr)
+                                eptr = std::current_exception();
+                        }
+                        // Release the request before telling the main thread we are done
+                        // since it might destroy opt as soon as in_flight hits 0.
+                        next.reset();
+                        std::lock_guard<std::mutex> lock(m);
+                        --in_flight;
+                        cv.notify_all();
+                    });
+                }
+
+                std::unique_lock<std::mutex> lock(m);
+                cv.wait(lock, [&]{ return in_flight == 0; });
+                if (eptr)
+                    std::rethrow_exception(eptr);
             }
 
 
@@ -200,7 +271,7 @@ template <typename T> static auto go(T&& f, const matrix<double, 0, 1>& a) -> de
         double solver_epsilon = 0
     ) 
     {
-        return impl::find_max_global(functions, std::move(specs), num, max_runtime, solver_epsilon, +1);
+        return impl::find_max_global(nullptr, functions, std::move(specs), num, max_runtime, solver_epsilon, +1);
     }
 
     template <
@@ -214,7 +285,7 @@ template <typename T> static auto go(T&& f, const matrix<double, 0, 1>& a) -> de
         double solver_epsilon = 0
     ) 
     {
-        return impl::find_max_global(functions, std::move(specs), num, max_runtime, solver_epsilon, -1);
+        return impl::find_max_global(nullptr, functions, std::move(specs), num, max_runtime, solver_epsilon, -1);
     }
 
 // ----------------------------------------------------------------------------------------
@@ -503,6 +574,182 @@ template <typename T> static auto go(T&& f, const matrix<double, 0, 1>& a) -> de
         return find_min_global(std::move(f), bound1, bound2, is_integer_variable, max_function_calls(), max_runtime, solver_epsilon);
     }
 
+// ----------------------------------------------------------------------------------------
+// ----------------------------------------------------------------------------------------
+//                      Versions that evaluate the functions in parallel
+// ----------------------------------------------------------------------------------------
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename funct
+        >
+    std::pair<size_t,function_evaluation> find_max_global (
+        thread_pool& tp,
+        std::vector<funct>& functions,
+        std::vector<function_spec> specs,
+        const max_function_calls num,
+        const std::chrono::nanoseconds max_runtime = FOREVER,
+        double solver_epsilon = 0
+    ) 
+    {
+        return impl::find_max_global(&tp, functions, std::move(specs), num, max_runtime, solver_epsilon, +1);
+    }
+
+    template <
+        typename funct
+        >
+    std::pair<size_t,function_evaluation> find_min_global (
+        thread_pool& tp,
+        std::vector<funct>& functions,
+        std::vector<function_spec> specs,
+        const max_function_calls num,
+        const std::chrono::nanoseconds max_runtime = FOREVER,
+        double solver_epsilon = 0
+    ) 
+    {
+        return impl::find_max_global(&tp, functions, std::move(specs), num, max_runtime, solver_epsilon, -1);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename funct
+        >
+    function_evaluation find_max_global (
+        thread_pool& tp,
+        funct f,
+        const matrix<double,0,1>& bound1,
+        const matrix<double,0,1>& bound2,
+        const std::vector<bool>& is_integer_variable,
+        const max_function_calls num,
+        const std::chrono::nanoseconds max_runtime = FOREVER,
+        double solver_epsilon = 0
+    ) 
+    {
+        std::vector<funct> functions(1,std::move(f));
+        std::vector<function_spec> specs(1, function_spec(bound1, bound2, is_integer_variable));
+        return find_max_global(tp, functions, std::move(specs), num, max_runtime, solver_epsilon).second;
+    }
+
+    template <
+        typename funct
+        >
+    function_evaluation find_min_global (
+        thread_pool& tp,
+        funct f,
+        const matrix<double,0,1>& bound1,
+        const matrix<double,0,1>& bound2,
+        const std::vector<bool>& is_integer_variable,
+        const max_function_calls num,
+        const std::chrono::nanoseconds max_runtime = FOREVER,
+        double solver_epsilon = 0
+    ) 
+    {
+        std::vector<funct> functions(1,std::move(f));
+        std::vector<function_spec> specs(1, function_spec(bound1, bound2, is_integer_variable));
+        return find_min_global(tp, functions, std::move(specs), num, max_runtime, solver_epsilon).second;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename funct
+        >
+    function_evaluation find_max_global (
+        thread_pool& tp,
+        funct f,
+        const matrix<double,0,1>& bound1,
+        const matrix<double,0,1>& bound2,
+        const max_function_calls num,
+        const std::chrono::nanoseconds max_runtime = FOREVER,
+        double solver_epsilon = 0
+    ) 
+    {
+        return find_max_global(tp, std::move(f), bound1, bound2, std::vector<bool>(bound1.size(),false), num, max_runtime, solver_epsilon);
+    }
+
+    template <
+        typename funct
+        >
+    function_evaluation find_min_global (
+        thread_pool& tp,
+        funct f,
+        const matrix<double,0,1>& bound1,
+        const matrix<double,0,1>& bound2,
+        const max_function_calls num,
+        const std::chrono::nanoseconds max_runtime = FOREVER,
+        double solver_epsilon = 0
+    ) 
+    {
+        return find_min_global(tp, std::move(f), bound1, bound2, std::vector<bool>(bound1.size(),false), num, max_runtime, solver_epsilon);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename funct
+        >
+    function_evaluation find_max_global (
+        thread_pool& tp,
+        funct f,
+        const double bound1,
+        const double bound2,
+        const max_function_calls num,
+        const std::chrono::nanoseconds max_runtime = FOREVER,
+        double solver_epsilon = 0
+    ) 
+    {
+        return find_max_global(tp, std::move(f), matrix<double,0,1>({bound1}), matrix<double,0,1>({bound2}), num, max_runtime, solver_epsilon);
+    }
+
+    template <
+        typename funct
+        >
+    function_evaluation find_min_global (
+        thread_pool& tp,
+        funct f,
+        const double bound1,
+        const double bound2,
+        const max_function_calls num,
+        const std::chrono::nanoseconds max_runtime = FOREVER,
+        double solver_epsilon = 0
+    ) 
+    {
+        return find_min_global(tp, std::move(f), matrix<double,0,1>({bound1}), matrix<double,0,1>({bound2}), num, max_runtime, solver_epsilon);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename funct
+        >
+    function_evaluation find_max_global (
+        thread_pool& tp,
+        funct f,
+        const matrix<double,0,1>& bound1,
+        const matrix<double,0,1>& bound2,
+        const std::chrono::nanoseconds max_runtime,
+        double solver_epsilon = 0
+    ) 
+    {
+        return find_max_global(tp, std::move(f), bound1, bound2, max_function_calls(), max_runtime, solver_epsilon);
+    }
+
+    template <
+        typename funct
+        >
+    function_evaluation find_min_global (
+        thread_pool& tp,
+        funct f,
+        const matrix<double,0,1>& bound1,
+        const matrix<double,0,1>& bound2,
+        const std::chrono::nanoseconds max_runtime,
+        double solver_epsilon = 0
+    ) 
+    {
+        return find_min_global(tp, std::move(f), bound1, bound2, max_function_calls(), max_runtime, solver_epsilon);
+    }
+
 // ----------------------------------------------------------------------------------------
 
 }
@@ -236,6 +236,117 @@ namespace dlib
         except that we perform minimization rather than maximization.
     !*/
 
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename funct
+        >
+    std::pair<size_t,function_evaluation> find_max_global (
+        thread_pool& tp,
+        std::vector<funct>& functions,
+        const std::vector<function_spec>& specs,
+        const max_function_calls num,
+        const std::chrono::nanoseconds max_runtime = FOREVER,
+        double solver_epsilon = 0
+    );
+    /*!
+        requires
+            - The requirements of find_max_global(functions,specs,num,max_runtime,solver_epsilon)
+              defined above are satisfied.
+            - It must be safe to call the functions in functions concurrently from
+              multiple threads.
+        ensures
+            - This function is identical to find_max_global(functions,specs,num,max_runtime,solver_epsilon)
+              except that the functions are evaluated by the threads in tp rather than in
+              the calling thread.  In particular:
+                - Up to max(1,tp.num_threads_in_pool()) function evaluations are in
+                  progress at any one time.  New points to evaluate are picked by the
+                  global_function_search while these evaluations are outstanding, so
+                  running N evaluations at once gives close to an N times speedup when the
+                  functions are expensive.
+                - The total number of calls made to the functions is still at most
+                  num.max_calls.
+                - No new function evaluations are started once max_runtime has elapsed.
+                  However, this function waits for any evaluations already in progress to
+                  finish before returning.
+                - If one of the functions throws an exception then no new evaluations are
+                  started, the outstanding ones are allowed to finish, and then the
+                  exception is rethrown from this function.
+            - Since the evaluations complete in a nondeterministic order, the sequence of
+              points examined may differ from run to run when tp contains more than one
+              thread.
+    !*/
+
+    template <
+        typename funct
+        >
+    std::pair<size_t,function_evaluation> find_min_global (
+        thread_pool& tp,
+        std::vector<funct>& functions,
+        const std::vector<function_spec>& specs,
+        const max_function_calls num,
+        const std::chrono::nanoseconds max_runtime = FOREVER,
+        double solver_epsilon = 0
+    );
+    /*!
+        This function is identical to the find_max_global() defined immediately above,
+        except that we perform minimization rather than maximization.
+    !*/
+
+    template <
+        typename funct
+        >
+    function_evaluation find_max_global (
+        thread_pool& tp,
+        funct f,
+        const matrix<double,0,1>& bound1,
+        const matrix<double,0,1>& bound2,
+        const std::vector<bool>& is_integer_variable,
+        const max_function_calls num,
+        const std::chrono::nanoseconds max_runtime = FOREVER,
+        double solver_epsilon = 0
+    );
+    /*!
+        requires
+            - The requirements of find_max_global(f,bound1,bound2,is_integer_variable,num,max_runtime,solver_epsilon)
+              defined above are satisfied.
+            - It must be safe to call f() concurrently from multiple threads.
+        ensures
+            - This function is identical to find_max_global(f,bound1,bound2,is_integer_variable,num,max_runtime,solver_epsilon)
+              except that f() is evaluated in parallel by tp, exactly as described in
+              the thread_pool version of find_max_global(tp,functions,specs,...) above.
+    !*/
+
+    template <
+        typename funct
+        >
+    function_evaluation find_min_global (
+        thread_pool& tp,
+        funct f,
+        const matrix<double,0,1>& bound1,
+        const matrix<double,0,1>& bound2,
+        const std::vector<bool>& is_integer_variable,
+        const max_function_calls num,
+        const std::chrono::nanoseconds max_runtime = FOREVER,
+        double solver_epsilon = 0
+    );
+    /*!
+        This function is identical to the find_max_global() defined immediately above,
+        except that we perform minimization rather than maximization.
+    !*/
+
+    /*
+        The following thread_pool overloads are also provided.  They behave like the
+        corresponding overloads without the thread_pool argument but evaluate the
+        objective in parallel as described above.
+            find_max_global(tp, f, bound1, bound2, num, max_runtime=FOREVER, solver_epsilon=0)
+            find_min_global(tp, f, bound1, bound2, num, max_runtime=FOREVER, solver_epsilon=0)
+            find_max_global(tp, f, double bound1, double bound2, num, max_runtime=FOREVER, solver_epsilon=0)
+            find_min_global(tp, f, double bound1, double bound2, num, max_runtime=FOREVER, solver_epsilon=0)
+            find_max_global(tp, f, bound1, bound2, max_runtime, solver_epsilon=0)
+            find_min_global(tp, f, bound1, bound2, max_runtime, solver_epsilon=0)
+    */
+
 // ----------------------------------------------------------------------------------------
 // The following functions are just convenient overloads for calling the above defined
 // find_max_global() and find_min_global() routines.
@@ -4,10 +4,14 @@
 #define DLIB_UPPER_bOUND_FUNCTION_Hh_
 
 #include "upper_bound_function_abstract.h"
+#include "../matrix.h"
 #include "../svm/svm_c_linear_dcd_trainer.h"
 #include "../statistics.h"
+#include <algorithm>
+#include <cmath>
 #include <limits>
 #include <utility>
+#include <vector>
 
 namespace dlib
 {
@@ -87,7 +91,10 @@ namespace dlib
             points.push_back(point);
             // add constraints between the new point and the old points
             for (size_t i = 0; i < points.size()-1; ++i)
+            {
                 active_constraints.push_back(std::make_pair(i,points.size()-1));
+                alpha.push_back(0);
+            }
 
             learn_params();
         }
@@ -120,14 +127,62 @@ namespace dlib
             DLIB_CASSERT(num_points() > 0);
             DLIB_CASSERT(x.size() == dimensionality());
 
-
-
             double upper_bound = std::numeric_limits<double>::infinity();
+            if (nodes.size() == 0)
+                return upper_bound;
 
-            for (size_t i = 0; i < points.size(); ++i)
+            const long dims = dimensionality();
+            auto check_point = [&](double y, double offset, double sqrt_offset, const double* p)
+            {
+                if (y + sqrt_offset >= upper_bound)
+                    return;
+                double dist = 0;
+                for (long k = 0; k < dims; ++k)
+                    dist += slopes(k)*(x(k)-p[k])*(x(k)-p[k]);
+                upper_bound = std::min(upper_bound, y + std::sqrt(offset + dist));
+            };
+
+            // The most recently added points aren't in the kd-tree yet so just check them
+            // directly.  Doing these first also tends to give a good initial upper_bound
+            // since new points are usually where the search is currently focused.
+            for (size_t i = num_indexed; i < points.size(); ++i)
+                check_point(points[i].y, offsets[i], std::sqrt(offsets[i]), &points[i].x(0));
+
+            // Now do a best first, branch and bound, search of the kd-tree.  Each node
+            // knows a lower bound on the local_bound of every point inside it, so we can
+            // skip any node that can't contain a point that improves upper_bound.
+            std::vector<std::pair<double,long>> stack;
+            stack.reserve(64);
+            stack.push_back(std::make_pair(node_lower_bound(0,x), 0));
+            while (stack.size() != 0)
             {
-                const double local_bound = points[i].y + std::sqrt(offsets[i] + dot(slopes, squared(x-points[i].x)));
-                upper_bound = std::min(upper_bound, local_bound);
+                const auto item = stack.back();
+                stack.pop_back();
+                if (item.first >= upper_bound)
+                    continue;
+
+                const kd_node& node = nodes[item.second];
+                if (node.left == -1)
+                {
+                    for (long i = node.begin; i < node.end; ++i)
+                        check_point(tree_y[i], tree_offsets[i], tree_sqrt_offsets[i], &tree_x[i*dims]);
+                }
+                else
+                {
+                    const double lb_left = node_lower_bound(node.left, x);
+                    const double lb_right = node_lower_bound(node.right, x);
+                    // push the more promising child last so it gets searched first.
+                    if (lb_left < lb_right)
+                    {
+                        stack.push_back(std::make_pair(lb_right, node.right));
+                        stack.push_back(std::make_pair(lb_left, node.left));
+                    }
+                    else
+                    {
+                        stack.push_back(std::make_pair(lb_left, node.left));
+                        stack.push_back(std::make_pair(lb_right, node.right));
+                    }
+                }
             }
 
             return upper_bound;
@@ -140,11 +195,6 @@ namespace dlib
         {
             const long dims = points[0].x.size();
 
-            using sample_type = std::vector<std::pair<size_t,double>>;
-            using kernel_type = sparse_linear_kernel<sample_type>;
-            std::vector<sample_type> x;
-            std::vector<double> y;
-
             // We are going to normalize the data so the values aren't extreme.  First, we
             // collect statistics on our data.
             std::vector<running_stats<double>> x_rs(dims);
@@ -169,12 +219,36 @@ namespace dlib
             for (size_t i = 0; i < xscale.size(); ++i)
                 xscale[i] = 1.0/(x_rs[i].stddev()*yscale); // make it so that xscale[i]*yscale ==  1/x_rs[i].stddev()
 
-            sample_type samp;
-            auto add_constraint = [&](long i, long j) {
-                samp.clear();
+            if (active_constraints.size() == 0)
+            {
+                active_constraints.reserve(points.size()*(points.size()-1)/2);
+                for (size_t i = 0; i < points.size(); ++i)
+                {
+                    for (size_t j = i+1; j < points.size(); ++j)
+                        active_constraints.push_back(std::make_pair(i,j));
+                }
+                alpha.assign(active_constraints.size(), 0);
+            }
+            DLIB_CASSERT(alpha.size() == active_constraints.size());
+
+            // Each constraint (i,j) is a linear constraint on the vector w == [slopes,
+            // noise terms].  Its sample has the squared and scaled differences between
+            // points i and j in its first dims elements, relative_noise_magnitude in the
+            // element for the noise term of whichever of i or j has the smaller y value,
+            // and 1-diff*diff in a last element whose weight the trainer forces to 1.
+            using sample_type = std::vector<std::pair<size_t,double>>;
+            using kernel_type = sparse_linear_kernel<sample_type>;
+            std::vector<sample_type> x(active_constraints.size());
+            std::vector<double> y(active_constraints.size(), 1);
+            for (size_t c = 0; c < active_constraints.size(); ++c)
+            {
+                const size_t i = active_constraints[c].first;
+                const size_t j = active_constraints[c].second;
+                sample_type& samp = x[c];
+                samp.reserve(dims+2);
                 for (long k = 0; k < dims; ++k)
                 {
-                    double temp = (points[i].x(k) - points[j].x(k))*xscale[k]*yscale;
+                    const double temp = (points[i].x(k) - points[j].x(k))*xscale[k]*yscale;
                     samp.push_back(std::make_pair(k, temp*temp));
                 }
 
@@ -185,31 +259,7 @@ namespace dlib
 
                 const double diff = (points[i].y - points[j].y)*yscale;
                 samp.push_back(std::make_pair(dims + points.size(), 1-diff*diff));
-
-                x.push_back(samp);
-                y.push_back(1);
-            };
-
-            if (active_constraints.size() == 0)
-            {
-                x.reserve(points.size()*(points.size()-1)/2);
-                y.reserve(points.size()*(points.size()-1)/2);
-                for (size_t i = 0; i < points.size(); ++i)
-                {
-                    for (size_t j = i+1; j < points.size(); ++j)
-                    {
-                        add_constraint(i,j);
-                    }
-                }
             }
-            else
-            {
-                for (auto& p : active_constraints)
-                    add_constraint(p.first, p.second);
-            }
-
-
-
 
             svm_c_linear_dcd_trainer<kernel_type> trainer;
             trainer.set_c(std::numeric_limits<double>::infinity());
@@ -217,52 +267,220 @@ namespace dlib
             trainer.force_last_weight_to_1(true);
             trainer.set_epsilon(solver_eps);
 
-            svm_c_linear_dcd_trainer<kernel_type>::optimizer_state state;
-            auto df = trainer.train(x,y, state);
+            // Warm start from the dual variables of the previous solution.  These are
+            // still feasible since the only dual constraint is alpha >= 0, and since the
+            // scaling changes only a little when a point is added they are usually close
+            // to optimal.
+            svm_c_linear_dcd_trainer<kernel_type>::optimizer_state state(alpha);
+            const auto df = trainer.train(x, y, state);
+            alpha = state.get_alpha();
 
-            // save the active constraints for later so we can use them inside add() to add
-            // new points efficiently.
-            if (active_constraints.size() == 0)
+            std::vector<double> w(dims + points.size(), 0);
+            for (auto& v : df.basis_vectors(0))
             {
-                long k = 0;
-                for (size_t i = 0; i < points.size(); ++i)
-                {
-                    for (size_t j = i+1; j < points.size(); ++j)
-                    {
-                        if (state.get_alpha()[k++] != 0)
-                            active_constraints.push_back(std::make_pair(i,j));
-                    }
-                }
+                if (v.first < w.size())
+                    w[v.first] = v.second;
             }
-            else
+
+            // Save the active constraints, along with their dual variables, for later so
+            // we can use them inside add() to add new points efficiently.
+            size_t num_active = 0;
+            for (size_t c = 0; c < active_constraints.size(); ++c)
             {
-                DLIB_CASSERT(state.get_alpha().size() == active_constraints.size());
-                new_active_constraints.clear();
-                for (size_t i = 0; i < state.get_alpha().size(); ++i)
+                if (alpha[c] != 0)
                 {
-                    if (state.get_alpha()[i] != 0)
-                        new_active_constraints.push_back(active_constraints[i]);
+                    active_constraints[num_active] = active_constraints[c];
+                    alpha[num_active] = alpha[c];
+                    ++num_active;
                 }
-                active_constraints.swap(new_active_constraints);
             }
+            active_constraints.resize(num_active);
+            alpha.resize(num_active);
 
             //std::cout << "points.size(): " << points.size() << std::endl;
             //std::cout << "active_constraints.size(): " << active_constraints.size() << std::endl;
 
 
-            const auto& bv = df.basis_vectors(0);
             slopes.set_size(dims);
             for (long i = 0; i < dims; ++i)
-                slopes(i) = bv[i].second*xscale[i]*xscale[i];
+                slopes(i) = w[i]*xscale[i]*xscale[i];
 
             //std::cout << "slopes:" << trans(slopes);
 
             offsets.assign(points.size(),0);
+            for (size_t i = 0; i < points.size(); ++i)
+                offsets[i] = w[dims+i]*relative_noise_magnitude;
+
+            // Rebuilding the kd-tree costs O(N*log(N)) so we only do it once enough new
+            // points have piled up outside it.  Otherwise we just refresh the noise terms
+            // it stores, which is O(N).
+            const double max_unindexed = 2*std::sqrt((double)points.size());
+            if (nodes.size() == 0 || points.size()-num_indexed > max_unindexed)
+                build_kd_tree();
+            else
+                update_kd_tree_offsets();
+        }
 
+    // ------------------------------------------------------------------------------------
 
-            for (size_t i = 0; i < points.size(); ++i)
+        struct kd_node
+        {
+            // This node contains the points tree_x[begin] through tree_x[end-1].
+            long begin = 0;
+            long end = 0;
+            // The children of this node or -1 if this is a leaf.
+            long left = -1;
+            long right = -1;
+            // Lower bounds on tree_y and tree_offsets for the points in this node.
+            double min_y = 0;
+            double min_offset = 0;
+        };
+
+        double node_lower_bound (
+            long node_idx,
+            const matrix<double,0,1>& x
+        ) const
+        /*!
+            ensures
+                - returns a number <= the local_bound of every point in the given node.
+        !*/
+        {
+            const long dims = slopes.size();
+            const double* lower = &box_lower[node_idx*dims];
+            const double* upper = &box_upper[node_idx*dims];
+            double dist = 0;
+            for (long k = 0; k < dims; ++k)
             {
-                offsets[i] += bv[slopes.size()+i].second*relative_noise_magnitude;
+                double gap = 0;
+                if (x(k) < lower[k])
+                    gap = lower[k]-x(k);
+                else if (x(k) > upper[k])
+                    gap = x(k)-upper[k];
+                dist += slopes(k)*gap*gap;
+            }
+            return nodes[node_idx].min_y + std::sqrt(nodes[node_idx].min_offset + dist);
+        }
+
+        long build_kd_node (
+            std::vector<long>& idx,
+            long begin,
+            long end
+        )
+        {
+            const long dims = slopes.size();
+            const long node_idx = nodes.size();
+            nodes.push_back(kd_node());
+            box_lower.resize(box_lower.size()+dims, std::numeric_limits<double>::infinity());
+            box_upper.resize(box_upper.size()+dims, -std::numeric_limits<double>::infinity());
+
+            kd_node node;
+            node.begin = begin;
+            node.end = end;
+            node.min_y = std::numeric_limits<double>::infinity();
+            for (long i = begin; i < end; ++i)
+            {
+                const function_evaluation& p = points[idx[i]];
+                node.min_y = std::min(node.min_y, p.y);
+                for (long k = 0; k < dims; ++k)
+                {
+                    box_lower[node_idx*dims+k] = std::min(box_lower[node_idx*dims+k], p.x(k));
+                    box_upper[node_idx*dims+k] = std::max(box_upper[node_idx*dims+k], p.x(k));
+                }
+            }
+
+            // Split along the dimension with the largest extent, as measured by the
+            // upper bound's own distance metric.
+            const long max_leaf_size = 16;
+            long split_dim = -1;
+            double best_extent = 0;
+            for (long k = 0; k < dims && end-begin > max_leaf_size; ++k)
+            {
+                const double extent = slopes(k)*(box_upper[node_idx*dims+k]-box_lower[node_idx*dims+k]);
+                if (extent > best_extent)
+                {
+                    best_extent = extent;
+                    split_dim = k;
+                }
+            }
+
+            if (split_dim != -1)
+            {
+                const long mid = (begin+end)/2;
+                std::nth_element(idx.begin()+begin, idx.begin()+mid, idx.begin()+end, 
+                    [&](long a, long b) { return points[a].x(split_dim) < points[b].x(split_dim); });
+                node.left = build_kd_node(idx, begin, mid);
+                node.right = build_kd_node(idx, mid, end);
+            }
+
+            nodes[node_idx] = node;
+            return node_idx;
+        }
+
+        void build_kd_tree (
+        )
+        /*!
+            requires
+                - slopes and offsets have been computed for all the points.
+            ensures
+                - builds the kd-tree operator() uses to avoid looking at every point.
+                - #num_indexed == points.size()
+        !*/
+        {
+            const long dims = slopes.size();
+            tree_idx.resize(points.size());
+            for (size_t i = 0; i < tree_idx.size(); ++i)
+                tree_idx[i] = i;
+
+            nodes.clear();
+            box_lower.clear();
+            box_upper.clear();
+            build_kd_node(tree_idx, 0, tree_idx.size());
+            num_indexed = points.size();
+
+            // Store the points in the order the tree visits them so leaf scans touch
+            // contiguous memory.
+            tree_x.resize(points.size()*dims);
+            tree_y.resize(points.size());
+            for (size_t i = 0; i < tree_idx.size(); ++i)
+            {
+                for (long k = 0; k < dims; ++k)
+                    tree_x[i*dims+k] = points[tree_idx[i]].x(k);
+                tree_y[i] = points[tree_idx[i]].y;
+            }
+            update_kd_tree_offsets();
+        }
+
+        void update_kd_tree_offsets (
+        )
+        /*!
+            ensures
+                - copies the current offsets into the kd-tree and recomputes the
+                  min_offset value of each node.
+        !*/
+        {
+            tree_offsets.resize(tree_idx.size());
+            tree_sqrt_offsets.resize(tree_idx.size());
+            for (size_t i = 0; i < tree_idx.size(); ++i)
+            {
+                tree_offsets[i] = offsets[tree_idx[i]];
+                tree_sqrt_offsets[i] = std::sqrt(tree_offsets[i]);
+            }
+
+            // Children always come after their parents in nodes so we can go backwards
+            // through it to compute the min_offset values bottom up.
+            for (size_t i = nodes.size(); i-- > 0;)
+            {
+                kd_node& node = nodes[i];
+                if (node.left == -1)
+                {
+                    node.min_offset = std::numeric_limits<double>::infinity();
+                    for (long j = node.begin; j < node.end; ++j)
+                        node.min_offset = std::min(node.min_offset, tree_offsets[j]);
+                }
+                else
+                {
+                    node.min_offset = std::min(nodes[node.left].min_offset, nodes[node.right].min_offset);
+                }
             }
         }
 
@@ -270,11 +488,18 @@ namespace dlib
 
         double relative_noise_magnitude = 0.001;
         double solver_eps = 0.0001; 
-        std::vector<std::pair<size_t,size_t>> active_constraints, new_active_constraints;
+        std::vector<std::pair<size_t,size_t>> active_constraints;
+        std::vector<double> alpha; // alpha.size() == active_constraints.size()
 
         std::vector<function_evaluation> points;
         std::vector<double> offsets; // offsets.size() == points.size()
         matrix<double,0,1> slopes; // slopes.size() == points[0].first.size()
+
+        std::vector<kd_node> nodes;
+        std::vector<double> box_lower, box_upper; // bounding boxes of the nodes
+        std::vector<long> tree_idx; // the points in the order they appear in the tree
+        std::vector<double> tree_x, tree_y, tree_offsets, tree_sqrt_offsets;
+        size_t num_indexed = 0; // points[num_indexed] onward aren't in the tree
     };
 
 // ----------------------------------------------------------------------------------------
@@ -162,7 +162,10 @@ namespace dlib
                   constraints and the new constraints formed by all the pairs of the new
                   point and the old points.  This means the QP solved by add() is much
                   smaller than the QP that would be solved by a fresh call to the
-                  upper_bound_function constructor.
+                  upper_bound_function constructor.  Moreover, the QP solver starts from
+                  the dual variables found by the previous call, so it usually needs only
+                  a few passes over the constraints.  Overall, add() takes time roughly
+                  linear in num_points().
         !*/
 
         const std::vector<function_evaluation>& get_points(
@@ -199,6 +202,11 @@ namespace dlib
             ensures
                 - return U(x)
                   (i.e. returns the upper bound on F(x) at x given by our upper bounding function)
+                - This function does not look at every point to compute U(x).  Instead, the
+                  points are kept in a kd-tree and a branch and bound search skips any
+                  part of the tree that can't contain the point that attains the minimum
+                  in U(x).  So when there are many points it is usually much faster than
+                  O(num_points()).
         !*/
 
     };
@@ -5,6 +5,7 @@
 
 #include "graph_cuts/min_cut.h"
 #include "graph_cuts/general_flow_graph.h"
+#include "graph_cuts/grid_min_cut.h"
 #include "graph_cuts/find_max_factor_graph_potts.h"
 #include "graph_cuts/graph_labeler.h"
 
@@ -0,0 +1,766 @@
+// Copyright (C) 2018  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_GRID_MIN_CuT_Hh_
+#define DLIB_GRID_MIN_CuT_Hh_
+
+#include "grid_min_cut_abstract.h"
+#include "min_cut.h"
+#include "../geometry.h"
+#include "../algs.h"
+
+#include <vector>
+#include <deque>
+#include <limits>
+#include <algorithm>
+
+// ----------------------------------------------------------------------------------------
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename T
+        >
+    class grid_min_cut
+    {
+        /*!
+            CONVENTION
+                - K == the number of neighbors of each node, either 4 or 8.
+                - Node i is the pixel at row i/nc and column i%nc.  Its neighbor in
+                  direction d is the pixel offset by (dx[d],dy[d]), which is node
+                  i+off[d], and exists only if (valid[i]>>d)&1.
+                  Direction rev[d] points back from that neighbor to node i.
+                - cap_s[i], cap_t[i], and cap_e[i*K+d] are the capacities given by the
+                  user while rs[i], rt[i], and res[i*K+d] are the corresponding residuals.
+                  When a change to a capacity would make a residual negative the graph
+                  is reparameterized (Kohli and Torr) so every residual stays >= 0.  This
+                  changes the max flow by a constant but leaves the min cut unchanged.
+                - The two search trees of the Boykov-Kolmogorov algorithm are kept
+                  between calls to solve().  label[i] says which tree node i is in and
+                  parent[i] is the direction to its parent, TERMINAL if the parent is
+                  the source or sink, or NONE if i is an orphan or free.
+                - changed contains the nodes whose edges were modified since the last
+                  call to solve().  They are the only nodes whose place in the search
+                  trees needs to be revisited.
+        !*/
+
+        COMPILE_TIME_ASSERT(is_signed_type<T>::value);
+
+    public:
+
+        typedef T value_type;
+
+        grid_min_cut(
+        ) : nr_(0), nc_(0), K(4) {}
+
+        grid_min_cut(
+            long nr,
+            long nc,
+            int connectivity = 4
+        ) : nr_(0), nc_(0), K(4) { set_size(nr,nc,connectivity); }
+
+        void set_size (
+            long nr,
+            long nc,
+            int connectivity = 4
+        )
+        {
+            DLIB_ASSERT(nr >= 0 && nc >= 0 && (connectivity == 4 || connectivity == 8),
+                "\t void grid_min_cut::set_size()"
+                << "\n\t Invalid arguments were given to this function."
+                << "\n\t nr: " << nr
+                << "\n\t nc: " << nc
+                << "\n\t connectivity: " << connectivity
+                << "\n\t this: " << this
+                );
+
+            nr_ = nr;
+            nc_ = nc;
+            K = connectivity;
+            TERMINAL = K;
+            NONE = K+1;
+
+            const long xs[8] = {1, 0, -1,  0, 1, -1, -1,  1};
+            const long ys[8] = {0, 1,  0, -1, 1,  1, -1, -1};
+            for (int d = 0; d < 8; ++d)
+            {
+                dx[d] = xs[d];
+                dy[d] = ys[d];
+            }
+            for (int d = 0; d < K; ++d)
+            {
+                off[d] = dy[d]*nc_ + dx[d];
+                rev[d] = (d < 4) ? (d+2)%4 : 4 + (d-4+2)%4;
+            }
+
+            const long n = size();
+            valid.assign(n, 0);
+            for (long r = 0; r < nr_; ++r)
+            {
+                for (long c = 0; c < nc_; ++c)
+                {
+                    unsigned char mask = 0;
+                    for (int d = 0; d < K; ++d)
+                    {
+                        const long rr = r + dy[d];
+                        const long cc = c + dx[d];
+                        if (0 <= rr && rr < nr_ && 0 <= cc && cc < nc_)
+                            mask |= 1<<d;
+                    }
+                    valid[r*nc_+c] = mask;
+                }
+            }
+
+            cap_s.assign(n, 0);
+            cap_t.assign(n, 0);
+            cap_e.assign(n*K, 0);
+            rs.assign(n, 0);
+            rt.assign(n, 0);
+            res.assign(n*K, 0);
+
+            label.assign(n, FREE_NODE);
+            parent.assign(n, NONE);
+            time = 0;
+            ts.assign(n, 0);
+            dist.assign(n, 0);
+            is_active.assign(n, 0);
+            active.clear();
+            orphans.clear();
+
+            is_changed.assign(n, 1);
+            changed.resize(n);
+            for (long i = 0; i < n; ++i)
+                changed[i] = i;
+        }
+
+        long nr (
+        ) const { return nr_; }
+
+        long nc (
+        ) const { return nc_; }
+
+        long size (
+        ) const { return nr_*nc_; }
+
+        int connectivity (
+        ) const { return K; }
+
+        void set_terminal_capacities (
+            const point& p,
+            const T& source_cap,
+            const T& sink_cap
+        )
+        {
+            DLIB_ASSERT(rectangle(0,0,nc_-1,nr_-1).contains(p) && source_cap >= 0 && sink_cap >= 0,
+                "\t void grid_min_cut::set_terminal_capacities()"
+                << "\n\t Invalid arguments were given to this function."
+                << "\n\t p: " << p
+                << "\n\t nr(): " << nr()
+                << "\n\t nc(): " << nc()
+                << "\n\t source_cap: " << source_cap
+                << "\n\t sink_cap: " << sink_cap
+                << "\n\t this: " << this
+                );
+
+            const long i = p.y()*nc_ + p.x();
+            rs[i] += source_cap - cap_s[i];
+            rt[i] += sink_cap - cap_t[i];
+            cap_s[i] = source_cap;
+            cap_t[i] = sink_cap;
+            mark_changed(i);
+        }
+
+        const T& get_source_capacity (
+            const point& p
+        ) const
+        {
+            DLIB_ASSERT(rectangle(0,0,nc_-1,nr_-1).contains(p),
+                "\t T grid_min_cut::get_source_capacity()"
+                << "\n\t Invalid arguments were given to this function."
+                << "\n\t p: " << p
+                << "\n\t this: " << this
+                );
+            return cap_s[p.y()*nc_ + p.x()];
+        }
+
+        const T& get_sink_capacity (
+            const point& p
+        ) const
+        {
+            DLIB_ASSERT(rectangle(0,0,nc_-1,nr_-1).contains(p),
+                "\t T grid_min_cut::get_sink_capacity()"
+                << "\n\t Invalid arguments were given to this function."
+                << "\n\t p: " << p
+                << "\n\t this: " << this
+                );
+            return cap_t[p.y()*nc_ + p.x()];
+        }
+
+        bool are_neighbors (
+            const point& p,
+            const point& q
+        ) const
+        {
+            const rectangle rect(0,0,nc_-1,nr_-1);
+            return rect.contains(p) && rect.contains(q) && direction(p,q) != K;
+        }
+
+        void set_edge_capacity (
+            const point& p,
+            const point& q,
+            const T& cap
+        )
+        {
+            DLIB_ASSERT(are_neighbors(p,q) && cap >= 0,
+                "\t void grid_min_cut::set_edge_capacity()"
+                << "\n\t Invalid arguments were given to this function."
+                << "\n\t p: " << p
+                << "\n\t q: " << q
+                << "\n\t cap: " << cap
+                << "\n\t connectivity(): " << connectivity()
+                << "\n\t this: " << this
+                );
+
+            const int d = direction(p,q);
+            const long i = p.y()*nc_ + p.x();
+            const long j = i + off[d];
+            const long e = i*K + d;
+
+            res[e] += cap - cap_e[e];
+            cap_e[e] = cap;
+            if (res[e] < 0)
+            {
+                // More flow is going from i to j than the new capacity allows.  So
+                // add alpha to the i->j edge, i's source edge, and j's sink edge and
+                // remove it from the j->i edge.  This adds alpha to every cut and
+                // makes the residual non-negative again.
+                const T alpha = -res[e];
+                res[e] = 0;
+                res[j*K + rev[d]] -= alpha;
+                rs[i] += alpha;
+                rt[j] += alpha;
+            }
+            mark_changed(i);
+            mark_changed(j);
+        }
+
+        const T& get_edge_capacity (
+            const point& p,
+            const point& q
+        ) const
+        {
+            DLIB_ASSERT(are_neighbors(p,q),
+                "\t T grid_min_cut::get_edge_capacity()"
+                << "\n\t Invalid arguments were given to this function."
+                << "\n\t p: " << p
+                << "\n\t q: " << q
+                << "\n\t connectivity(): " << connectivity()
+                << "\n\t this: " << this
+                );
+            return cap_e[(p.y()*nc_ + p.x())*K + direction(p,q)];
+        }
+
+        T solve (
+        )
+        {
+            ++time;
+
+            // Repair the search trees around the nodes whose edges changed.
+            for (unsigned long k = 0; k < changed.size(); ++k)
+                repair_node(changed[k]);
+            for (unsigned long k = 0; k < changed.size(); ++k)
+                is_changed[changed[k]] = 0;
+            changed.clear();
+
+            adopt();
+
+            long source_side, sink_side;
+            int dir;
+            while (grow(source_side, sink_side, dir))
+            {
+                ++time;
+                augment(source_side, sink_side, dir);
+                adopt();
+            }
+
+            return cut_cost();
+        }
+
+        node_label get_label (
+            const point& p
+        ) const
+        {
+            DLIB_ASSERT(rectangle(0,0,nc_-1,nr_-1).contains(p),
+                "\t node_label grid_min_cut::get_label()"
+                << "\n\t Invalid arguments were given to this function."
+                << "\n\t p: " << p
+                << "\n\t this: " << this
+                );
+            return (label[p.y()*nc_ + p.x()] == SOURCE_CUT) ? SOURCE_CUT : SINK_CUT;
+        }
+
+    private:
+
+        int direction (
+            const point& p,
+            const point& q
+        ) const
+        /*!
+            ensures
+                - returns the direction d such that q is p's neighbor in direction d.
+                  Returns K if there is no such direction.
+        !*/
+        {
+            for (int d = 0; d < K; ++d)
+            {
+                if (q.x() - p.x() == dx[d] && q.y() - p.y() == dy[d])
+                    return d;
+            }
+            return K;
+        }
+
+        void mark_changed (
+            long i
+        )
+        {
+            if (!is_changed[i])
+            {
+                is_changed[i] = 1;
+                changed.push_back(i);
+            }
+        }
+
+        void activate (
+            long i
+        )
+        {
+            if (!is_active[i])
+            {
+                is_active[i] = 1;
+                active.push_back(i);
+            }
+        }
+
+        void make_orphan (
+            long i
+        )
+        {
+            parent[i] = NONE;
+            orphans.push_back(i);
+        }
+
+        void orphan_children (
+            long i
+        )
+        /*!
+            ensures
+                - all the nodes whose parent is node i become orphans.
+        !*/
+        {
+            const unsigned char mask = valid[i];
+            for (int d = 0; d < K; ++d)
+            {
+                if ((mask>>d)&1)
+                {
+                    const long j = i + off[d];
+                    if (label[j] == label[i] && parent[j] == rev[d])
+                        make_orphan(j);
+                }
+            }
+        }
+
+        void activate_neighbors (
+            long i
+        )
+        {
+            const unsigned char mask = valid[i];
+            for (int d = 0; d < K; ++d)
+            {
+                if (((mask>>d)&1) && label[i+off[d]] != FREE_NODE)
+                    activate(i+off[d]);
+            }
+        }
+
+        bool has_valid_parent_edge (
+            long i
+        ) const
+        {
+            const int d = parent[i];
+            if (d == NONE)
+                return false;
+            if (d == TERMINAL)
+                return (label[i] == SOURCE_CUT) ? rs[i] > 0 : rt[i] > 0;
+            if (label[i] == SOURCE_CUT)
+                return res[(i+off[d])*K + rev[d]] > 0;
+            else
+                return res[i*K + d] > 0;
+        }
+
+        void repair_node (
+            long i
+        )
+        {
+            // Adding the same amount to both terminal edges adds a constant to every
+            // cut, so we can always make both residuals non-negative.
+            if (rs[i] < 0)
+            {
+                rt[i] -= rs[i];
+                rs[i] = 0;
+            }
+            if (rt[i] < 0)
+            {
+                rs[i] -= rt[i];
+                rt[i] = 0;
+            }
+            // Push the flow that can go straight from the source to the sink.  This
+            // way at most one terminal edge of each node has any residual left.
+            const T m = std::min(rs[i], rt[i]);
+            rs[i] -= m;
+            rt[i] -= m;
+
+            if (rs[i] > 0 || rt[i] > 0)
+            {
+                const node_label l = (rs[i] > 0) ? SOURCE_CUT : SINK_CUT;
+                if (label[i] != l && label[i] != FREE_NODE)
+                {
+                    // i is jumping straight to the other tree.  Its old children lose
+                    // their parent and its old neighbors must look at i again since
+                    // they only ever saw it as a member of their own tree.
+                    orphan_children(i);
+                    activate_neighbors(i);
+                }
+                label[i] = l;
+                parent[i] = TERMINAL;
+                ts[i] = time;
+                dist[i] = 1;
+                activate(i);
+            }
+            else if (label[i] != FREE_NODE)
+            {
+                if (parent[i] == TERMINAL || !has_valid_parent_edge(i))
+                    make_orphan(i);
+                activate(i);
+            }
+        }
+
+        bool grow (
+            long& source_side,
+            long& sink_side,
+            int& dir
+        )
+        /*!
+            ensures
+                - if (an augmenting path is found) then
+                    - returns true
+                    - source_side and sink_side are neighbors in the source and sink
+                      trees respectively and source_side is sink_side's neighbor in
+                      direction dir.
+                - else
+                    - returns false
+        !*/
+        {
+            while (active.size() != 0)
+            {
+                const long i = active.front();
+                const node_label l = label[i];
+                if (l == FREE_NODE)
+                {
+                    is_active[i] = 0;
+                    active.pop_front();
+                    continue;
+                }
+
+                const unsigned char mask = valid[i];
+                if (l == SOURCE_CUT)
+                {
+                    for (int d = 0; d < K; ++d)
+                    {
+                        if (((mask>>d)&1) && res[i*K+d] > 0)
+                        {
+                            const long j = i + off[d];
+                            if (label[j] == FREE_NODE)
+                            {
+                                label[j] = SOURCE_CUT;
+                                parent[j] = rev[d];
+                                ts[j] = ts[i];
+                                dist[j] = dist[i] + 1;
+                                activate(j);
+                            }
+                            else if (label[j] == SINK_CUT)
+                            {
+                                source_side = i;
+                                sink_side = j;
+                                dir = d;
+                                return true;
+                            }
+                        }
+                    }
+                }
+                else
+                {
+                    for (int d = 0; d < K; ++d)
+                    {
+                        if ((mask>>d)&1)
+                        {
+                            const long j = i + off[d];
+                            if (res[j*K+rev[d]] > 0)
+                            {
+                                if (label[j] == FREE_NODE)
+                                {
+                                    label[j] = SINK_CUT;
+                                    parent[j] = rev[d];
+                                    ts[j] = ts[i];
+                                    dist[j] = dist[i] + 1;
+                                    activate(j);
+                                }
+                                else if (label[j] == SOURCE_CUT)
+                                {
+                                    source_side = j;
+                                    sink_side = i;
+                                    dir = rev[d];
+                                    return true;
+                                }
+                            }
+                        }
+                    }
+                }
+
+                is_active[i] = 0;
+                active.pop_front();
+            }
+            return false;
+        }
+
+        void augment (
+            const long source_side,
+            const long sink_side,
+            const int dir
+        )
+        {
+            // find the bottleneck capacity on the path
+            T bottleneck = res[source_side*K + dir];
+            long i = source_side;
+            while (parent[i] != TERMINAL)
+            {
+                const int d = parent[i];
+                const long j = i + off[d];
+                bottleneck = std::min(bottleneck, res[j*K + rev[d]]);
+                i = j;
+            }
+            bottleneck = std::min(bottleneck, rs[i]);
+            i = sink_side;
+            while (parent[i] != TERMINAL)
+            {
+                const int d = parent[i];
+                bottleneck = std::min(bottleneck, res[i*K + d]);
+                i += off[d];
+            }
+            bottleneck = std::min(bottleneck, rt[i]);
+
+            // now push the flow through the path
+            res[source_side*K + dir] -= bottleneck;
+            res[sink_side*K + rev[dir]] += bottleneck;
+
+            i = source_side;
+            while (parent[i] != TERMINAL)
+            {
+                const int d = parent[i];
+                const long j = i + off[d];
+                res[j*K + rev[d]] -= bottleneck;
+                res[i*K + d] += bottleneck;
+                if (res[j*K + rev[d]] <= 0)
+                    make_orphan(i);
+                i = j;
+            }
+            rs[i] -= bottleneck;
+            if (rs[i] <= 0)
+                make_orphan(i);
+
+            i = sink_side;
+            while (parent[i] != TERMINAL)
+            {
+                const int d = parent[i];
+                const long j = i + off[d];
+                res[i*K + d] -= bottleneck;
+                res[j*K + rev[d]] += bottleneck;
+                if (res[i*K + d] <= 0)
+                    make_orphan(i);
+                i = j;
+            }
+            rt[i] -= bottleneck;
+            if (rt[i] <= 0)
+                make_orphan(i);
+        }
+
+        unsigned long distance_to_origin (
+            long i
+        )
+        /*!
+            ensures
+                - returns the number of nodes on the path from i to its terminal or
+                  std::numeric_limits<unsigned long>::max() if the path runs into an
+                  orphan.  Also caches the distances found along the way.
+        !*/
+        {
+            unsigned long count = 0;
+            long j = i;
+            while (true)
+            {
+                if (ts[j] == time)
+                {
+                    count += dist[j];
+                    break;
+                }
+                ++count;
+                if (parent[j] == TERMINAL)
+                {
+                    ts[j] = time;
+                    dist[j] = 1;
+                    break;
+                }
+                if (parent[j] == NONE)
+                    return std::numeric_limits<unsigned long>::max();
+                j += off[parent[j]];
+            }
+
+            unsigned long count_down = count;
+            for (j = i; ts[j] != time; j += off[parent[j]])
+            {
+                ts[j] = time;
+                dist[j] = count_down--;
+            }
+            return count;
+        }
+
+        void adopt (
+        )
+        {
+            while (orphans.size() != 0)
+            {
+                const long i = orphans.front();
+                orphans.pop_front();
+
+                const node_label l = label[i];
+                if (l == FREE_NODE || parent[i] != NONE)
+                    continue;
+
+                if ((l == SOURCE_CUT && rs[i] > 0) || (l == SINK_CUT && rt[i] > 0))
+                {
+                    parent[i] = TERMINAL;
+                    ts[i] = time;
+                    dist[i] = 1;
+                    continue;
+                }
+
+                // Try to find a valid parent for i.
+                const unsigned char mask = valid[i];
+                unsigned long best_dist = std::numeric_limits<unsigned long>::max();
+                int best_dir = NONE;
+                for (int d = 0; d < K; ++d)
+                {
+                    if (!((mask>>d)&1))
+                        continue;
+                    const long j = i + off[d];
+                    if (label[j] != l)
+                        continue;
+                    if (l == SOURCE_CUT ? res[j*K+rev[d]] <= 0 : res[i*K+d] <= 0)
+                        continue;
+
+                    const unsigned long temp = distance_to_origin(j);
+                    if (temp < best_dist)
+                    {
+                        best_dist = temp;
+                        best_dir = d;
+                    }
+                }
+
+                if (best_dir != NONE)
+                {
+                    parent[i] = best_dir;
+                    ts[i] = time;
+                    dist[i] = best_dist + 1;
+                    continue;
+                }
+
+                // No parent was found so i becomes a free node.  Its neighbors in the
+                // same tree might be able to grab it later so make them active and
+                // orphan any children of i.
+                for (int d = 0; d < K; ++d)
+                {
+                    if (!((mask>>d)&1))
+                        continue;
+                    const long j = i + off[d];
+                    if (label[j] != l)
+                        continue;
+                    if (l == SOURCE_CUT ? res[j*K+rev[d]] > 0 : res[i*K+d] > 0)
+                        activate(j);
+                    if (parent[j] == rev[d])
+                        make_orphan(j);
+                }
+                label[i] = FREE_NODE;
+            }
+        }
+
+        T cut_cost (
+        ) const
+        {
+            T cost = 0;
+            const long n = size();
+            for (long i = 0; i < n; ++i)
+            {
+                if (label[i] == SOURCE_CUT)
+                {
+                    cost += cap_t[i];
+                    const unsigned char mask = valid[i];
+                    for (int d = 0; d < K; ++d)
+                    {
+                        if (((mask>>d)&1) && label[i+off[d]] != SOURCE_CUT)
+                            cost += cap_e[i*K+d];
+                    }
+                }
+                else
+                {
+                    cost += cap_s[i];
+                }
+            }
+            return cost;
+        }
+
+        long nr_;
+        long nc_;
+        int K;
+        int TERMINAL;
+        int NONE;
+        long dx[8];
+        long dy[8];
+        long off[8];
+        int rev[8];
+        std::vector<unsigned char> valid;
+
+        std::vector<T> cap_s;
+        std::vector<T> cap_t;
+        std::vector<T> cap_e;
+        std::vector<T> rs;
+        std::vector<T> rt;
+        std::vector<T> res;
+
+        std::vector<node_label> label;
+        std::vector<unsigned char> parent;
+        unsigned long time;
+        std::vector<unsigned long> ts;
+        std::vector<unsigned long> dist;
+        std::vector<unsigned char> is_active;
+        std::deque<long> active;
+        std::deque<long> orphans;
+
+        std::vector<unsigned char> is_changed;
+        std::vector<long> changed;
+    };
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_GRID_MIN_CuT_Hh_
@@ -0,0 +1,239 @@
+// Copyright (C) 2018  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#undef DLIB_GRID_MIN_CuT_ABSTRACT_Hh_
+#ifdef DLIB_GRID_MIN_CuT_ABSTRACT_Hh_
+
+#include "min_cut_abstract.h"
+#include "../geometry.h"
+
+// ----------------------------------------------------------------------------------------
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename T
+        >
+    class grid_min_cut
+    {
+        /*!
+            REQUIREMENTS ON T
+                T must be a signed integer or floating point type.
+
+            WHAT THIS OBJECT REPRESENTS
+                This object is a min cut solver for flow graphs laid out on the pixels
+                of an image, which is the kind of graph used to label images with a
+                potts model.  Each pixel is a node which is connected to a source node,
+                a sink node, and its 4 or 8 neighboring pixels.  All the edge
+                capacities are kept in flat arrays so no general graph object is
+                needed.
+
+                More importantly, this object is incremental.  It remembers the flow and
+                the search trees computed by the last call to solve().  So if you change
+                a few capacities and call solve() again, say when moving from one video
+                frame to the next, only the parts of the graph around the changed edges
+                need to be revisited.  This is usually much faster than solving the new
+                graph from scratch.
+
+                The implementation is based on the method described in the following
+                papers:
+                    An Experimental Comparison of Min-Cut/Max-Flow Algorithms for
+                    Energy Minimization in Vision, by Yuri Boykov and Vladimir Kolmogorov,
+                    in PAMI 2004.
+
+                    Dynamic Graph Cuts for Efficient Inference in Markov Random Fields,
+                    by Pushmeet Kohli and Philip H. S. Torr, in PAMI 2007.
+        !*/
+
+    public:
+
+        typedef T value_type;
+
+        grid_min_cut(
+        );
+        /*!
+            ensures
+                - #size() == 0
+                - #connectivity() == 4
+        !*/
+
+        grid_min_cut(
+            long nr,
+            long nc,
+            int connectivity = 4
+        );
+        /*!
+            requires
+                - nr >= 0
+                - nc >= 0
+                - connectivity == 4 or 8
+            ensures
+                - performs set_size(nr,nc,connectivity)
+        !*/
+
+        void set_size (
+            long nr,
+            long nc,
+            int connectivity = 4
+        );
+        /*!
+            requires
+                - nr >= 0
+                - nc >= 0
+                - connectivity == 4 or 8
+            ensures
+                - #nr() == nr
+                - #nc() == nc
+                - #connectivity() == connectivity
+                - All the edge capacities are set to 0 and any flow or search trees
+                  saved from previous calls to solve() are discarded.
+        !*/
+
+        long nr (
+        ) const;
+        /*!
+            ensures
+                - returns the number of rows in the grid
+        !*/
+
+        long nc (
+        ) const;
+        /*!
+            ensures
+                - returns the number of columns in the grid
+        !*/
+
+        long size (
+        ) const;
+        /*!
+            ensures
+                - returns nr()*nc()
+        !*/
+
+        int connectivity (
+        ) const;
+        /*!
+            ensures
+                - returns the number of neighbors each pixel is connected to.  This is
+                  4 (left, right, up, and down) or 8 (those plus the diagonals).
+        !*/
+
+        void set_terminal_capacities (
+            const point& p,
+            const T& source_cap,
+            const T& sink_cap
+        );
+        /*!
+            requires
+                - 0 <= p.x() < nc()
+                - 0 <= p.y() < nr()
+                  (i.e. p is a pixel in the grid, p.x() is its column and p.y() its row)
+                - source_cap >= 0
+                - sink_cap >= 0
+            ensures
+                - #get_source_capacity(p) == source_cap
+                - #get_sink_capacity(p) == sink_cap
+                - The change takes effect the next time solve() is called.
+        !*/
+
+        const T& get_source_capacity (
+            const point& p
+        ) const;
+        /*!
+            requires
+                - 0 <= p.x() < nc()
+                - 0 <= p.y() < nr()
+            ensures
+                - returns the capacity of the edge from the source node to p.  This is
+                  the cost paid when p ends up on the sink side of the cut.
+        !*/
+
+        const T& get_sink_capacity (
+            const point& p
+        ) const;
+        /*!
+            requires
+                - 0 <= p.x() < nc()
+                - 0 <= p.y() < nr()
+            ensures
+                - returns the capacity of the edge from p to the sink node.  This is
+                  the cost paid when p ends up on the source side of the cut.
+        !*/
+
+        bool are_neighbors (
+            const point& p,
+            const point& q
+        ) const;
+        /*!
+            ensures
+                - returns true if p and q are both pixels in the grid and they are
+                  connected by an edge given the current connectivity() and false
+                  otherwise.
+        !*/
+
+        void set_edge_capacity (
+            const point& p,
+            const point& q,
+            const T& cap
+        );
+        /*!
+            requires
+                - are_neighbors(p,q) == true
+                - cap >= 0
+            ensures
+                - #get_edge_capacity(p,q) == cap
+                - The change takes effect the next time solve() is called.  Note that
+                  the edge from q to p is a separate edge with its own capacity.
+        !*/
+
+        const T& get_edge_capacity (
+            const point& p,
+            const point& q
+        ) const;
+        /*!
+            requires
+                - are_neighbors(p,q) == true
+            ensures
+                - returns the capacity of the edge going from p to q.  This is the
+                  cost paid when p is on the source side of the cut and q is on the
+                  sink side.
+        !*/
+
+        T solve (
+        );
+        /*!
+            ensures
+                - Finds the minimum cut of the graph defined by the current edge
+                  capacities.  That is, it finds the labeling of pixels which minimizes
+                  the sum of the capacities of the edges going from the source side of
+                  the cut to the sink side.
+                - returns the value of the minimum cut.
+                - #get_label() reports the labels of this cut.
+                - The flow found by the previous call to solve() is reused.  Therefore,
+                  the run time of this function depends on how much the capacities
+                  changed since the last call rather than just on size().
+        !*/
+
+        node_label get_label (
+            const point& p
+        ) const;
+        /*!
+            requires
+                - 0 <= p.x() < nc()
+                - 0 <= p.y() < nr()
+            ensures
+                - returns SOURCE_CUT if p is on the source side of the cut found by the
+                  last call to solve() and SINK_CUT otherwise.
+                - if (solve() has not been called since the last set_size()) then
+                    - returns SINK_CUT
+        !*/
+
+    };
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_GRID_MIN_CuT_ABSTRACT_Hh_
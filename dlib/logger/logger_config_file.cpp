@@ -191,6 +191,34 @@ namespace dlib
 
             } // if (cr.is_key_defined("output"))
 
+            if (cr.is_key_defined("async"))
+            {
+                const string async = cr["async"];
+                if (async != "true" && async != "false")
+                    throw logger_config_file_error("logger_config: invalid argument to async option: " + async);
+
+                unsigned long max_queued_messages = 10000;
+                if (cr.is_key_defined("async_queue_size"))
+                {
+                    try { max_queued_messages = string_cast<unsigned long>(cr["async_queue_size"]); }
+                    catch (string_cast_error&) { max_queued_messages = 0; }
+                    if (max_queued_messages == 0)
+                        throw logger_config_file_error("logger_config: invalid argument to async_queue_size option: " + cr["async_queue_size"]);
+                }
+
+                log_queue_overflow overflow = log_queue_overflow::block;
+                if (cr.is_key_defined("async_overflow"))
+                {
+                    const string policy = cr["async_overflow"];
+                    if (policy == "drop")
+                        overflow = log_queue_overflow::drop;
+                    else if (policy != "block")
+                        throw logger_config_file_error("logger_config: invalid argument to async_overflow option: " + policy);
+                }
+
+                set_all_logging_async(async == "true", max_queued_messages, overflow);
+            }
+
             // now configure all the sub-blocks
             std_vector_c<std::string> blocks;
             cr.get_blocks(blocks);
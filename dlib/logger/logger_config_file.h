@@ -74,6 +74,16 @@ namespace dlib
             # to avoid a conflict).
             # logging_level = 100 
 
+            # Hand log messages to a background thread that does the actual writing, so
+            # logging threads don't wait on each other or on the output stream.  At most
+            # async_queue_size messages wait in the queue.  When it is full
+            # async_overflow says whether to block the logging thread or drop the
+            # message.  Only async is required; the other two default to 10000 and
+            # block.  These options only go directly inside the logger_config block.
+            # async = true
+            # async_queue_size = 10000
+            # async_overflow = drop
+
             parent_logger 
             {
                 # This sets all loggers named "parent_logger" or children of
@@ -105,8 +115,9 @@ namespace dlib
         }
 
         # So in summary, all logger config stuff goes inside a block named logger_config.  Then
-        # inside that block all blocks must be the names of loggers.  There are only two keys,
-        # logging_level and output.
+        # inside that block all blocks must be the names of loggers.  Logger blocks have only
+        # two keys, logging_level and output.  The logger_config block itself may also have
+        # the async, async_queue_size, and async_overflow keys.
         #
         # The valid values of logging_level are:
         #   "LALL", "LNONE", "LTRACE", "LDEBUG", "LINFO", "LWARN", "LERROR", "LFATAL",  
@@ -118,6 +129,9 @@ namespace dlib
         #   "cout", "cerr", "clog", or a string of the form "file some_file_name"
         #   which causes the output to be logged to the specified file.
         #
+        # The valid values of async are "true" and "false", async_queue_size must be a
+        # positive integer, and async_overflow must be "block" or "drop".
+        #
     !*/
 
 
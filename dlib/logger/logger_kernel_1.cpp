@@ -4,8 +4,14 @@
 #define DLIB_LOGGER_KERNEL_1_CPp_
 
 #include "logger_kernel_1.h"
+#include "../pipe/lockfree_pipe.h"
+#include <algorithm>
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 namespace dlib
 {
@@ -62,10 +68,42 @@ namespace dlib
         gd.set_logger_header("",new_header);
     }
 
+    void set_all_logging_async (
+        bool enabled,
+        unsigned long max_queued_messages,
+        log_queue_overflow overflow
+    )
+    {
+        // make sure requires clause is not broken
+        DLIB_ASSERT(max_queued_messages > 0,
+            "\t void set_all_logging_async()"
+            << "\n\t The async logging queue must be able to hold at least one message."
+            );
+
+        logger::global_data& gd = logger::get_global_data();
+        auto_mutex M(gd.async_config_m);
+        gd.stop_async();
+        if (enabled)
+            gd.start_async(max_queued_messages, overflow);
+    }
+
 // ----------------------------------------------------------------------------------------
 
     namespace logger_helper_stuff
     {
+        uint64 elapsed_microseconds (
+        )
+        {
+            static timestamper ts;
+            static const uint64 first_time = ts.get_timestamp();
+            return ts.get_timestamp() - first_time;
+        }
+
+        // The async writer thread points this at the timestamp of the message it is
+        // printing so that print_default_logger_header() shows when the message was
+        // logged rather than when it got written.
+        thread_local const uint64* header_time_override = 0;
+
         class helper
         {
         public:
@@ -83,6 +121,19 @@ namespace dlib
         // at least one logger so that the global data won't be deleted until the 
         // program is terminating.
         static logger log("dlib");
+
+        // Write out anything still sitting in the async logging queue when the program
+        // terminates.  This is declared after log so it runs while the global_data is
+        // still alive.
+        class async_logging_exit_flusher
+        {
+        public:
+            ~async_logging_exit_flusher()
+            {
+                set_all_logging_async(false);
+            }
+        };
+        static async_logging_exit_flusher exit_flusher;
     }
 
 // ----------------------------------------------------------------------------------------
@@ -95,10 +146,9 @@ namespace dlib
     )
     {
         using namespace std;
-        static timestamper ts;
-        static const uint64 first_time = ts.get_timestamp();
+        using namespace logger_helper_stuff;
 
-        const uint64 cur_time = (ts.get_timestamp() - first_time)/1000;
+        const uint64 cur_time = (header_time_override ? *header_time_override : elapsed_microseconds())/1000;
         streamsize old_width = out.width(); out.width(5);
         out << cur_time << " " << l.name; 
         out.width(old_width);
@@ -116,6 +166,10 @@ namespace dlib
     ~global_data (
     )
     {
+        {
+            auto_mutex M(async_config_m);
+            stop_async();
+        }
         unregister_thread_end_handler(*this,&global_data::thread_end_handler);
     }
 
@@ -124,7 +178,9 @@ namespace dlib
     logger::global_data::
     global_data(
     ) : 
-        next_thread_name(1) 
+        next_thread_name(1),
+        async_enabled(false),
+        async_in_flight(0)
     { 
         // make sure the main program thread always has id 0.  Since there is
         // a global logger object declared in this file we should expect that 
@@ -384,6 +440,361 @@ namespace dlib
         return thread_name;
     }
 
+// ----------------------------------------------------------------------------------------
+// ----------------------------------------------------------------------------------------
+//               async logging stuff
+// ----------------------------------------------------------------------------------------
+// ----------------------------------------------------------------------------------------
+
+    namespace logger_helper_stuff
+    {
+        struct async_log_record
+        {
+            enum record_kind
+            {
+                message,
+                flush_marker,
+                stop_marker
+            };
+
+            async_log_record (
+            ) : kind(message), level(LNONE), thread_name(0), timestamp(0), flush_id(0) {}
+
+            record_kind kind;
+            log_level level;
+            std::string logger_name;
+            uint64 thread_name;
+            uint64 timestamp;
+            uint64 flush_id;
+            std::string text;
+
+            friend void swap (
+                async_log_record& a,
+                async_log_record& b
+            )
+            {
+                std::swap(a.kind, b.kind);
+                std::swap(a.level, b.level);
+                a.logger_name.swap(b.logger_name);
+                std::swap(a.thread_name, b.thread_name);
+                std::swap(a.timestamp, b.timestamp);
+                std::swap(a.flush_id, b.flush_id);
+                a.text.swap(b.text);
+            }
+        };
+
+        // A streambuf that appends to a std::string.  Since records are swapped in and
+        // out of the queue, the strings just circulate between the logging threads and
+        // the writer and after warm up no memory gets allocated.
+        class string_streambuf : public std::streambuf
+        {
+        public:
+            std::string* str = 0;
+
+            int_type overflow ( int_type c)
+            {
+                if (c != EOF) str->push_back(static_cast<char>(c));
+                return c;
+            }
+
+            std::streamsize xsputn ( const char* s, std::streamsize num)
+            {
+                str->append(s, static_cast<std::string::size_type>(num));
+                return num;
+            }
+        };
+
+        // Set once the calling thread's async_thread_state has been destroyed.  When the
+        // program exits, the main thread's thread_local objects go away before the static
+        // ones, and static destructors might still log something.
+        thread_local bool async_thread_state_gone = false;
+
+        // The number of synchronous messages the calling thread is in the middle of
+        // writing.  While it is non-zero the thread holds gd.m, which the writer thread
+        // needs to drain the queue, so it must not enqueue anything that might block.
+        thread_local unsigned long sync_message_depth = 0;
+
+        struct async_thread_state
+        {
+            async_thread_state (
+            ) : out(&buf), busy(false), have_thread_name(false), thread_name(0)
+            {
+                buf.str = &rec.text;
+            }
+
+            ~async_thread_state (
+            )
+            {
+                async_thread_state_gone = true;
+            }
+
+            async_log_record rec;
+            string_streambuf buf;
+            std::ostream out;
+            // true while this thread is writing an async message, or always if this is
+            // the writer thread itself.
+            bool busy;
+            bool have_thread_name;
+            uint64 thread_name;
+        };
+
+        async_thread_state& get_async_thread_state (
+        )
+        {
+            static thread_local async_thread_state state;
+            return state;
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    struct logger::global_data::async_state
+    {
+        async_state (
+            unsigned long max_queued_messages,
+            log_queue_overflow overflow_
+        ) : queue(max_queued_messages), overflow(overflow_), dropped(0), reported_dropped(0),
+            next_flush_id(0), flushed_through(0)
+        {}
+
+        mpmc_pipe<logger_helper_stuff::async_log_record> queue;
+        const log_queue_overflow overflow;
+        std::thread writer;
+
+        std::atomic<uint64> dropped;
+        uint64 reported_dropped;
+
+        std::mutex flush_m;
+        std::condition_variable flush_cv;
+        uint64 next_flush_id;
+        uint64 flushed_through;
+    };
+
+// ----------------------------------------------------------------------------------------
+
+    std::ostream* logger::global_data::
+    begin_async_message (
+    )
+    {
+        using namespace logger_helper_stuff;
+        if (async_thread_state_gone || sync_message_depth != 0)
+            return 0;
+        async_thread_state& state = get_async_thread_state();
+        // If this thread is already writing a message (e.g. some operator<< logs
+        // something) then let the nested message take the synchronous route.
+        if (state.busy)
+            return 0;
+
+        // This pairs with stop_async(), which clears async_enabled and then waits for
+        // async_in_flight to drain.  Both are sequentially consistent so either we see
+        // async_enabled == false or stop_async() sees our increment.
+        ++async_in_flight;
+        if (!async_enabled)
+        {
+            --async_in_flight;
+            return 0;
+        }
+
+        state.busy = true;
+        state.rec.kind = async_log_record::message;
+        state.rec.timestamp = elapsed_microseconds();
+        state.rec.text.clear();
+        state.out.flags(std::ios_base::dec | std::ios_base::skipws);
+        state.out.precision(6);
+        state.out.fill(' ');
+        state.out.clear();
+        return &state.out;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void logger::global_data::
+    end_async_message (
+        const std::string& logger_name,
+        const log_level& l
+    )
+    {
+        using namespace logger_helper_stuff;
+        async_thread_state& state = get_async_thread_state();
+        if (!state.have_thread_name)
+        {
+            auto_mutex M(m);
+            state.thread_name = get_thread_name();
+            state.have_thread_name = true;
+        }
+
+        state.rec.level = l;
+        state.rec.logger_name = logger_name;
+        state.rec.thread_name = state.thread_name;
+
+        if (async->overflow == log_queue_overflow::drop)
+        {
+            if (!async->queue.enqueue_or_timeout(state.rec, 0))
+                ++async->dropped;
+        }
+        else
+        {
+            async->queue.enqueue(state.rec);
+        }
+
+        state.busy = false;
+        --async_in_flight;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void logger::global_data::
+    start_async (
+        unsigned long max_queued_messages,
+        log_queue_overflow overflow
+    )
+    {
+        async.reset(new async_state(max_queued_messages, overflow));
+        async->writer = std::thread(&global_data::async_writer_loop, this, std::ref(*async));
+        async_enabled = true;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void logger::global_data::
+    stop_async (
+    )
+    {
+        if (!async)
+            return;
+
+        async_enabled = false;
+        while (async_in_flight != 0)
+            std::this_thread::yield();
+
+        // Everything that got queued is ahead of this marker, so once the writer sees it
+        // all the messages have been written.
+        logger_helper_stuff::async_log_record stop;
+        stop.kind = logger_helper_stuff::async_log_record::stop_marker;
+        async->queue.enqueue(stop);
+        async->writer.join();
+        async.reset();
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void logger::global_data::
+    async_writer_loop (
+        async_state& st
+    )
+    {
+        using namespace logger_helper_stuff;
+
+        // Anything logged from inside a hook or header function on this thread has to be
+        // written synchronously, otherwise we could end up waiting on ourselves.
+        get_async_thread_state().busy = true;
+        logger dlog("dlib.logger");
+
+        async_log_record rec;
+        std::ostream out(0);
+        std::vector<std::streambuf*> to_flush;
+
+        std::string cur_name;
+        bool have_cur = false;
+        hook_mfp cur_hook;
+        std::streambuf* cur_buf = 0;
+        print_header_type cur_header = 0;
+        bool cur_auto_flush = false;
+
+        const unsigned long max_batch_size = 1000;
+        bool stop = false;
+        while (!stop)
+        {
+            st.queue.dequeue(rec);
+
+            auto_mutex M(m);
+            // The settings may have changed since the last batch.
+            have_cur = false;
+            uint64 flush_id = 0;
+            unsigned long num = 0;
+            do
+            {
+                if (rec.kind == async_log_record::stop_marker)
+                {
+                    stop = true;
+                    break;
+                }
+                else if (rec.kind == async_log_record::flush_marker)
+                {
+                    flush_id = std::max(flush_id, rec.flush_id);
+                    continue;
+                }
+
+                if (!have_cur || rec.logger_name != cur_name)
+                {
+                    cur_name = rec.logger_name;
+                    cur_hook = output_hook(cur_name);
+                    cur_buf = output_streambuf(cur_name);
+                    cur_header = logger_header(cur_name);
+                    cur_auto_flush = auto_flush(cur_name);
+                    have_cur = true;
+                }
+
+                if (cur_hook.is_set())
+                {
+                    cur_hook(rec.logger_name, rec.level, rec.thread_name, rec.text.c_str());
+                }
+                else if (cur_buf != 0)
+                {
+                    out.rdbuf(cur_buf);
+                    header_time_override = &rec.timestamp;
+                    cur_header(out, rec.logger_name, rec.level, rec.thread_name);
+                    header_time_override = 0;
+                    out.write(rec.text.data(), rec.text.size());
+                    out << "\n";
+                    if (cur_auto_flush && std::find(to_flush.begin(), to_flush.end(), cur_buf) == to_flush.end())
+                        to_flush.push_back(cur_buf);
+                }
+            } while (++num < max_batch_size && st.queue.dequeue_or_timeout(rec, 0));
+
+            const uint64 dropped = st.dropped;
+            if (dropped != st.reported_dropped)
+            {
+                // This thread always logs synchronously so this doesn't go through the
+                // queue.
+                dlog << LWARN << dropped - st.reported_dropped 
+                     << " log messages were dropped because the async logging queue was full";
+                st.reported_dropped = dropped;
+            }
+
+            for (auto buf : to_flush)
+                buf->pubsync();
+            to_flush.clear();
+
+            if (flush_id != 0)
+            {
+                std::lock_guard<std::mutex> lock(st.flush_m);
+                st.flushed_through = flush_id;
+                st.flush_cv.notify_all();
+            }
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void flush_async_logging (
+    )
+    {
+        logger::global_data& gd = logger::get_global_data();
+        auto_mutex M(gd.async_config_m);
+        if (!gd.async)
+            return;
+
+        logger_helper_stuff::async_log_record marker;
+        marker.kind = logger_helper_stuff::async_log_record::flush_marker;
+        marker.flush_id = ++gd.async->next_flush_id;
+        const uint64 id = marker.flush_id;
+        gd.async->queue.enqueue(marker);
+
+        std::unique_lock<std::mutex> lock(gd.async->flush_m);
+        gd.async->flush_cv.wait(lock, [&]() { return gd.async->flushed_through >= id; });
+    }
+
 // ----------------------------------------------------------------------------------------
 // ----------------------------------------------------------------------------------------
 //               logger_stream stuff
@@ -396,7 +807,19 @@ namespace dlib
     {
         if (!been_used)
         {
+            if (log.gd.async_enabled.load(std::memory_order_relaxed) &&
+                (msg_out = log.gd.begin_async_message()) != 0)
+            {
+                // The writer thread prints the header, so all we do here is format the
+                // message into this thread's buffer.
+                is_async = true;
+                been_used = true;
+                return;
+            }
+
+            msg_out = &log.out;
             log.gd.m.lock();
+            ++logger_helper_stuff::sync_message_depth;
 
             // Check if the output hook is setup.  If it isn't then we print the logger
             // header like normal.  Otherwise we need to remember to clear out the output
@@ -421,7 +844,18 @@ namespace dlib
     print_end_of_line (
     )
     {
+        if (is_async)
+        {
+            log.gd.end_async_message(log.name(), l);
+            return;
+        }
+
         auto_unlock M(log.gd.m);
+        // The hook below runs user code, so only leave the message once it's done.
+        struct depth_guard
+        {
+            ~depth_guard() { --logger_helper_stuff::sync_message_depth; }
+        } guard;
 
         if (log.hook.is_set() == false)
         {
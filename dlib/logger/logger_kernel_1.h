@@ -3,6 +3,7 @@
 #ifndef DLIB_LOGGER_KERNEl_1_
 #define DLIB_LOGGER_KERNEl_1_
 
+#include <atomic>
 #include <limits>
 #include <memory>
 #include <cstring>
@@ -82,6 +83,21 @@ namespace dlib
         const print_header_type& new_header
     );
 
+    enum class log_queue_overflow
+    {
+        block,
+        drop
+    };
+
+    void set_all_logging_async (
+        bool enabled,
+        unsigned long max_queued_messages = 10000,
+        log_queue_overflow overflow = log_queue_overflow::block
+    );
+
+    void flush_async_logging (
+    );
+
 // ----------------------------------------------------------------------------------------
 
     void print_default_logger_header (
@@ -155,9 +171,15 @@ namespace dlib
                 CONVENTION
                     - enabled == is_enabled()
                     - if (been_used) then
-                        - logger::gd::m is locked
                         - someone has used the << operator to write something to the
                           output stream.
+                        - *msg_out is the stream the message is being written to.
+                        - if (is_async) then
+                            - *msg_out is the calling thread's async message buffer
+                              (see global_data::begin_async_message())
+                        - else
+                            - logger::gd::m is locked
+                            - msg_out == &log.out
             !*/
         public:
             logger_stream (
@@ -167,6 +189,8 @@ namespace dlib
                 l(l_),
                 log(log_),
                 been_used(false),
+                is_async(false),
+                msg_out(0),
                 enabled (l.priority >= log.cur_level.priority)
             {}
 
@@ -198,7 +222,7 @@ namespace dlib
                 else
                 {
                     print_header_and_stuff();
-                    log.out << item;
+                    *msg_out << item;
                     return *this;
                 }
             }
@@ -210,8 +234,11 @@ namespace dlib
             /*!
                 ensures
                     - if (!been_used) then
-                        - prints the logger header 
-                        - locks log.gd.m
+                        - if asynchronous logging is on then
+                            - points msg_out at this thread's async message buffer
+                        - else
+                            - prints the logger header 
+                            - locks log.gd.m
                         - #been_used == true
             !*/
 
@@ -219,13 +246,18 @@ namespace dlib
             );
             /*!
                 ensures
-                    - prints a newline to log.out
-                    - unlocks log.gd.m
+                    - if (is_async) then
+                        - hands the finished message to the async writer thread
+                    - else
+                        - prints a newline to log.out
+                        - unlocks log.gd.m
             !*/
 
             const log_level& l;
             logger& log;
             bool been_used;
+            bool is_async;
+            std::ostream* msg_out;
             const bool enabled;
         }; // end of class logger_stream
 
@@ -418,6 +450,73 @@ namespace dlib
 
             hook_streambuf hookbuf;
 
+            // The asynchronous logging state.  async_state is defined in
+            // logger_kernel_1.cpp.
+            struct async_state;
+            mutex async_config_m;
+            std::unique_ptr<async_state> async;
+            std::atomic<bool> async_enabled;
+            std::atomic<long> async_in_flight;
+
+            std::ostream* begin_async_message (
+            );
+            /*!
+                ensures
+                    - if (async_enabled and the calling thread isn't already in the middle
+                      of writing an async message) then
+                        - increments async_in_flight, so async won't be torn down until
+                          the matching end_async_message() call.
+                        - stamps the calling thread's message record with the current time
+                          and returns a stream that writes into it.
+                    - else
+                        - returns 0
+            !*/
+
+            void end_async_message (
+                const std::string& logger_name,
+                const log_level& l
+            );
+            /*!
+                requires
+                    - begin_async_message() was called by this thread and returned non-0
+                ensures
+                    - pushes the message onto async->queue.  If the queue is full then
+                      depending on async->overflow we either block or drop the message.
+                    - decrements async_in_flight
+            !*/
+
+            void start_async (
+                unsigned long max_queued_messages,
+                log_queue_overflow overflow
+            );
+            /*!
+                requires
+                    - async_config_m is locked
+                    - async == 0
+                ensures
+                    - starts the writer thread and turns on async_enabled
+            !*/
+
+            void stop_async (
+            );
+            /*!
+                requires
+                    - async_config_m is locked
+                    - m is not locked by the calling thread
+                ensures
+                    - turns off async_enabled, waits for all queued messages to be written,
+                      stops the writer thread, and sets async to 0.
+            !*/
+
+            void async_writer_loop (
+                async_state& st
+            );
+            /*!
+                ensures
+                    - pulls messages off st.queue and writes them out, in batches, until it
+                      finds a stop marker.
+            !*/
+
             global_data (
             );
 
@@ -615,6 +714,15 @@ namespace dlib
             std::ostream& out
         );
 
+        friend void set_all_logging_async (
+            bool enabled,
+            unsigned long max_queued_messages,
+            log_queue_overflow overflow
+        );
+
+        friend void flush_async_logging (
+        );
+
         template <
             typename T
             >
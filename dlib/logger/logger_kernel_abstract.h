@@ -145,6 +145,71 @@ namespace dlib
             - std::bad_alloc
     !*/
 
+// ----------------------------------------------------------------------------------------
+
+    enum class log_queue_overflow
+    {
+        block,
+        drop
+    };
+
+    void set_all_logging_async (
+        bool enabled,
+        unsigned long max_queued_messages = 10000,
+        log_queue_overflow overflow = log_queue_overflow::block
+    );
+    /*!
+        requires
+            - max_queued_messages > 0
+            - is not called from inside an output hook or logger header function.
+        ensures
+            - Any messages still waiting from a previous call to set_all_logging_async()
+              are written out first.
+            - if (enabled) then
+                - Switches all loggers to asynchronous mode.  In this mode, the thread
+                  that logs a message formats the message text into a private buffer,
+                  without taking any locks shared with other logging threads, and then
+                  puts the message on a bounded queue.  A background thread takes
+                  messages off that queue and does the actual writing.  So threads that
+                  log a lot don't wait on each other or on the output stream.
+                - Each message keeps its level, logger name, thread id, and the time it
+                  was logged.  The writer thread looks up the logger's output stream,
+                  output hook, header function, and auto flush setting when it writes
+                  the message, so all the usual settings (including the ones from
+                  logger_config_file.h) still apply.  print_default_logger_header() shows
+                  the time the message was logged, not the time it was written.
+                - Messages are written in the order they were queued.  Streams whose
+                  loggers have auto_flush() == true are flushed after each batch of
+                  messages rather than after every single message.
+                - At most max_queued_messages messages wait in the queue.  When it is full:
+                    - if (overflow == log_queue_overflow::block) then
+                        - the logging thread waits until there is room.
+                    - if (overflow == log_queue_overflow::drop) then
+                        - the message is thrown away.  The writer thread reports how many
+                          messages were lost with an LWARN message from the logger named
+                          "dlib.logger".
+                - Any messages still in the queue are written out when the program
+                  terminates normally.
+                - A message logged while formatting another message, or from inside an
+                  output hook or header function, is written synchronously.
+            - else
+                - Switches all loggers back to the normal synchronous mode.
+        throws
+            - std::bad_alloc
+            - std::system_error
+    !*/
+
+    void flush_async_logging (
+    );
+    /*!
+        ensures
+            - if (asynchronous logging is on) then
+                - blocks until every message queued before this call has been written
+                  and the auto flush streams have been flushed.
+            - else
+                - returns immediately.
+    !*/
+
 // ----------------------------------------------------------------------------------------
 // ----------------------------------------------------------------------------------------
 // ----------------------------------------------------------------------------------------
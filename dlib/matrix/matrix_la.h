@@ -25,6 +25,7 @@
 #include "../threads.h"
 
 #include <iostream>
+#include <deque>
 
 namespace dlib
 {
@@ -833,6 +834,160 @@ convergence:
         simpl::svd_fast(false, A,u,w,v,l,q);
     }
 
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename linear_operator_type
+        >
+    void find_largest_eigenvectors (
+        const linear_operator_type& A,
+        const long n,
+        const long num_eigs,
+        matrix<double,0,1>& eigenvalues,
+        matrix<double>& eigenvectors,
+        const double eps = 1e-8,
+        const unsigned long max_restarts = 1000
+    )
+    {
+        // make sure requires clause is not broken
+        DLIB_ASSERT(0 < num_eigs && num_eigs <= n && eps > 0,
+            "\t void find_largest_eigenvectors()"
+            << "\n\t Invalid inputs were given to this function."
+            << "\n\t n:        " << n
+            << "\n\t num_eigs: " << num_eigs
+            << "\n\t eps:      " << eps
+            );
+
+        /*
+            This is a block version of the thick restart Lanczos method from the paper:
+                Thick-Restart Lanczos Method for Large Symmetric Eigenvalue Problems by
+                Kesheng Wu and Horst Simon
+
+            We grow an orthonormal Krylov basis V, keeping A*V alongside it, until it has m
+            vectors.  Then the Rayleigh-Ritz procedure gives approximate eigenpairs.  If
+            they aren't accurate enough we shrink the basis down to the num_eigs best Ritz
+            vectors and keep growing it from where the Krylov sequence left off.  The basis
+            is reorthogonalized at every step, which costs a little more time but avoids
+            the loss of orthogonality that plain Lanczos suffers from.
+
+            The Krylov sequence is started from num_eigs random vectors rather than one.
+            A single starting vector only ever finds one eigenvector for each distinct
+            eigenvalue, which is no good for things like the affinity matrix of a graph
+            with several connected components.
+        */
+
+        const long k = num_eigs;
+        const long m = std::min(n, std::max(2*k+1, k+20));
+
+        std::vector<matrix<double,0,1> > V, AV;
+        V.reserve(m);
+        AV.reserve(m);
+        // The next vectors to add to the basis.  They are orthonormal and orthogonal to
+        // everything in V.
+        std::deque<matrix<double,0,1> > next;
+
+        // Makes x orthogonal to V and next.  Doing it twice is enough to keep the basis
+        // orthogonal to working precision.
+        auto orthogonalize_against_basis = [&](matrix<double,0,1>& x)
+        {
+            for (int pass = 0; pass < 2; ++pass)
+            {
+                for (auto& b : V)
+                    x -= dot(b,x)*b;
+                for (auto& b : next)
+                    x -= dot(b,x)*b;
+            }
+        };
+
+        long seed = 0;
+        auto random_unit_vector = [&]()
+        {
+            matrix<double,0,1> x;
+            double len = 0;
+            while (len == 0)
+            {
+                x = gaussian_randm(n,1,seed++);
+                orthogonalize_against_basis(x);
+                len = length(x);
+            }
+            return matrix<double,0,1>(x/len);
+        };
+
+        for (long i = 0; i < k; ++i)
+            next.push_back(random_unit_vector());
+
+        matrix<double> H;
+        matrix<double,0,1> Av, v;
+        for (unsigned long iter = 0; ; ++iter)
+        {
+            // Grow the Krylov basis.
+            while ((long)V.size() < m && next.size() != 0)
+            {
+                V.push_back(next.front());
+                next.pop_front();
+                A(V.back(), Av);
+                AV.push_back(Av);
+
+                // Once V and next span the whole space there is nothing left to add.
+                if ((long)(V.size() + next.size()) >= n)
+                    continue;
+
+                v = Av;
+                orthogonalize_against_basis(v);
+                const double len = length(v);
+                // If the Krylov sequence hits an invariant subspace then just pick a new
+                // random direction.
+                if (len <= 1e-10*length(Av) || len == 0)
+                    next.push_back(random_unit_vector());
+                else
+                    next.push_back(v/len);
+            }
+
+            // Now do the Rayleigh-Ritz step.
+            const long cur = V.size();
+            H.set_size(cur,cur);
+            for (long r = 0; r < cur; ++r)
+                for (long c = r; c < cur; ++c)
+                    H(r,c) = H(c,r) = 0.5*(dot(V[r],AV[c]) + dot(V[c],AV[r]));
+
+            eigenvalue_decomposition<matrix<double> > eig(make_symmetric(H));
+            matrix<double,0,1> evals = eig.get_real_eigenvalues();
+            matrix<double> S = eig.get_pseudo_v();
+            rsort_columns(S, evals);
+
+            // Form the top k Ritz vectors and their images under A.
+            std::vector<matrix<double,0,1> > Y(k), AY(k);
+            double max_residual = 0;
+            for (long i = 0; i < k; ++i)
+            {
+                Y[i] = zeros_matrix<double>(n,1);
+                AY[i] = zeros_matrix<double>(n,1);
+                for (long j = 0; j < cur; ++j)
+                {
+                    Y[i] += S(j,i)*V[j];
+                    AY[i] += S(j,i)*AV[j];
+                }
+                max_residual = std::max(max_residual, length(AY[i] - evals(i)*Y[i]));
+            }
+
+            const double scale = std::max(1.0, max(abs(rowm(evals,range(0,k-1)))));
+            if (max_residual <= eps*scale || iter+1 >= max_restarts || cur == n)
+            {
+                eigenvalues = rowm(evals, range(0,k-1));
+                eigenvectors.set_size(n,k);
+                for (long i = 0; i < k; ++i)
+                    set_colm(eigenvectors,i) = Y[i];
+                return;
+            }
+
+            // Restart the basis from the Ritz vectors.  The vectors in next are orthogonal
+            // to all of the old basis and therefore also to the Ritz vectors, so they are
+            // still the right vectors to add next.
+            V.swap(Y);
+            AV.swap(AY);
+        }
+    }
+
 // ----------------------------------------------------------------------------------------
 // ----------------------------------------------------------------------------------------
 
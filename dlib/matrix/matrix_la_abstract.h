@@ -264,6 +264,47 @@ namespace dlib
         This function is identical to the above svd_fast() except it doesn't compute u.
     !*/
 
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename linear_operator_type
+        >
+    void find_largest_eigenvectors (
+        const linear_operator_type& A,
+        const long n,
+        const long num_eigs,
+        matrix<double,0,1>& eigenvalues,
+        matrix<double>& eigenvectors,
+        const double eps = 1e-8,
+        const unsigned long max_restarts = 1000
+    );
+    /*!
+        requires
+            - 0 < num_eigs <= n
+            - eps > 0
+            - A represents a symmetric n by n matrix.  It must be a function object with
+              the signature:
+                void A(const matrix<double,0,1>& x, matrix<double,0,1>& y)
+              which sets y to the n element vector M*x, where M is the matrix A
+              represents.
+        ensures
+            - Finds the num_eigs largest eigenvalues of M, along with their eigenvectors,
+              using only products of M with vectors.  So M never needs to be stored
+              explicitly.  This makes this function appropriate for very large sparse
+              matrices, e.g. the adjacency matrix of a graph with millions of nodes.
+            - #eigenvalues.size() == num_eigs
+            - #eigenvalues is sorted in descending order.
+            - #eigenvectors.nr() == n
+            - #eigenvectors.nc() == num_eigs
+            - trans(#eigenvectors)*#eigenvectors == identity matrix
+            - colm(#eigenvectors,i) is an eigenvector of M with eigenvalue #eigenvalues(i).
+            - This function implements the thick restart Lanczos method with full
+              reorthogonalization.  It stops when the residual length(M*v - lambda*v) of
+              every output eigenvector is <= eps*max(1, max(abs(#eigenvalues))) or after
+              max_restarts restarts, whichever comes first.  It keeps a basis of about
+              max(2*num_eigs+1, num_eigs+20) vectors of length n in memory.
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
     template <
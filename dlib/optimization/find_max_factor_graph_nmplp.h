@@ -6,8 +6,11 @@
 #include "find_max_factor_graph_nmplp_abstract.h"
 #include <vector>
 #include <map>
+#include <mutex>
 #include "../matrix.h"
 #include "../hash.h"
+#include "../threads/thread_pool_extension.h"
+#include "../threads/parallel_for_extension.h"
 
 
 namespace dlib
@@ -120,161 +123,157 @@ namespace dlib
             std::vector<bucket> data;
             const unsigned int scan_dist;
         };
-    }
-
-// ----------------------------------------------------------------------------------------
-
-    template <
-        typename map_problem
-        >
-    void find_max_factor_graph_nmplp (
-        const map_problem& prob,
-        std::vector<unsigned long>& map_assignment,
-        unsigned long max_iter,
-        double eps
-    )
-    {
-        // make sure requires clause is not broken
-        DLIB_ASSERT( eps > 0,
-                     "\t void find_max_factor_graph_nmplp()"
-                     << "\n\t eps must be greater than zero"
-                     << "\n\t eps:  " << eps 
-                );
-
-        /*
-            This function is an implementation of the NMPLP algorithm introduced in the 
-            following papers:
-                Fixing Max-Product: Convergent Message Passing Algorithms for MAP LP-Relaxations (2008)
-                by Amir Globerson and Tommi Jaakkola
-
-                Introduction to dual decomposition for inference (2011)
-                by David Sontag, Amir Globerson, and Tommi Jaakkola 
-
-            In particular, this function implements the star MPLP update equations shown as
-            equation 1.20 from the paper Introduction to dual decomposition for inference
-            (the method was called NMPLP in the first paper).  It should also be noted that
-            the original description of the NMPLP in the first paper had an error in the
-            equations and the second paper contains corrected equations, which is what this 
-            function uses.
-        */
-
-        typedef typename map_problem::node_iterator node_iterator;
-        typedef typename map_problem::neighbor_iterator neighbor_iterator;
-
-        map_assignment.resize(prob.number_of_nodes());
-
 
-        if (prob.number_of_nodes() == 0)
-            return;
-
-
-        std::vector<double> delta_elements;
-        delta_elements.reserve(prob.number_of_nodes()*prob.num_states(prob.begin())*3);
-
-        impl::simple_hash_map delta_idx;
+    // ------------------------------------------------------------------------------------
 
-
-
-        // Initialize delta to zero and fill up the hash table with the appropriate values
-        // so we can index into delta later on.
-        for (node_iterator i = prob.begin(); i != prob.end(); ++i)
+        template <typename map_problem>
+        class nmplp_messages
         {
-            const unsigned long id_i = prob.node_id(i);
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    This object holds the messages of the NMPLP algorithm in one flat array
+                    along with a flat (CSR style) copy of the graph structure so that the
+                    main loop never has to look anything up in a hash table.  It also
+                    knows how to do the star update around one node.
+
+                CONVENTION
+                    - nodes[id] == the node_iterator for the node with node_id() == id.
+                    - The neighbors of node id are the edges e in the range
+                      [edge_begin[id], edge_begin[id+1]).  For such an edge:
+                        - edge_nbr[e] == the neighbor_iterator for the neighbor.
+                        - edge_node[e] == the node_id() of the neighbor.
+                        - delta[edge_out[e]] is the start of the message from id to the
+                          neighbor and delta[edge_in[e]] the start of the message from the
+                          neighbor to id.
+            !*/
+        public:
+            typedef typename map_problem::node_iterator node_iterator;
+            typedef typename map_problem::neighbor_iterator neighbor_iterator;
 
-            for (neighbor_iterator j = prob.begin(i); j != prob.end(i); ++j)
+            struct scratch
             {
-                const unsigned long id_j = prob.node_id(j);
-                delta_idx.insert(id_i, id_j, delta_elements.size());
+                std::vector<double> gamma_i;
+                std::vector<std::vector<double> > gamma_ji;
+                std::vector<std::vector<double> > delta_to_j_no_i;
+            };
 
-                const unsigned long num_states_xj = prob.num_states(j);
-                for (unsigned long xj = 0; xj < num_states_xj; ++xj)
-                    delta_elements.push_back(0);
+            nmplp_messages (
+                const map_problem& prob_
+            ) : prob(prob_)
+            {
+                const unsigned long n = prob.number_of_nodes();
+                nodes.resize(n);
+                edge_begin.assign(n+1, 0);
+                for (node_iterator i = prob.begin(); i != prob.end(); ++i)
+                {
+                    const unsigned long id_i = prob.node_id(i);
+                    nodes[id_i] = i;
+                    order.push_back(id_i);
+                    for (neighbor_iterator j = prob.begin(i); j != prob.end(i); ++j)
+                        ++edge_begin[id_i+1];
+                }
+                for (unsigned long i = 0; i < n; ++i)
+                    edge_begin[i+1] += edge_begin[i];
+
+                edge_nbr.resize(edge_begin[n]);
+                edge_node.resize(edge_begin[n]);
+                edge_out.resize(edge_begin[n]);
+                edge_in.resize(edge_begin[n]);
+
+                // Initialize delta to zero and fill up a hash table so we can find the
+                // message going the other way along each edge.
+                simple_hash_map delta_idx;
+                for (unsigned long id_i = 0; id_i < n; ++id_i)
+                {
+                    unsigned long e = edge_begin[id_i];
+                    for (neighbor_iterator j = prob.begin(nodes[id_i]); j != prob.end(nodes[id_i]); ++j, ++e)
+                    {
+                        const unsigned long id_j = prob.node_id(j);
+                        edge_nbr[e] = j;
+                        edge_node[e] = id_j;
+                        edge_out[e] = delta.size();
+                        delta_idx.insert(id_i, id_j, delta.size());
+                        delta.resize(delta.size() + prob.num_states(j), 0);
+                    }
+                }
+                for (unsigned long id_i = 0; id_i < n; ++id_i)
+                {
+                    for (unsigned long e = edge_begin[id_i]; e < edge_begin[id_i+1]; ++e)
+                        edge_in[e] = delta_idx(edge_node[e], id_i);
+                }
             }
-        }
-
-
-        std::vector<double> gamma_i;
-        std::vector<std::vector<double> > gamma_ji;
-        std::vector<std::vector<double> > delta_to_j_no_i;
-        // These arrays will end up with a length equal to the maximum number of neighbors
-        // of any node in the graph.  So reserve a bigish number of slots so that we are
-        // very unlikely to need to preform an expensive reallocation during the
-        // optimization.
-        gamma_ji.reserve(10000);
-        delta_to_j_no_i.reserve(10000);
-
-
-        double max_change = eps + 1; 
-        // Now do the main body of the optimization. 
-        unsigned long iter;
-        for (iter = 0; iter < max_iter && max_change > eps; ++iter)
-        {
-            max_change = -std::numeric_limits<double>::infinity();
 
-            for (node_iterator i = prob.begin(); i != prob.end(); ++i)
+            double update_node (
+                const unsigned long id_i,
+                scratch& s
+            )
+            /*!
+                ensures
+                    - performs the star update around node id_i.
+                    - returns the largest change made to any message.
+            !*/
             {
-                const unsigned long id_i = prob.node_id(i);
+                const node_iterator& i = nodes[id_i];
                 const unsigned long num_states_xi = prob.num_states(i);
-                gamma_i.assign(num_states_xi, 0);
+                s.gamma_i.assign(num_states_xi, 0);
 
-                double num_neighbors = 0;
+                const unsigned long eb = edge_begin[id_i];
+                const unsigned long ee = edge_begin[id_i+1];
+                const double num_neighbors = ee - eb;
 
-                unsigned int jcnt = 0;
-                // first we fill in the gamma vectors
-                for (neighbor_iterator j = prob.begin(i); j != prob.end(i); ++j)
+                // Make sure these arrays are big enough to hold all the neighbor
+                // information.
+                if (s.gamma_ji.size() < ee-eb)
                 {
-                    // Make sure these arrays are big enough to hold all the neighbor
-                    // information.
-                    if (jcnt >= gamma_ji.size())
-                    {
-                        gamma_ji.resize(gamma_ji.size()+1);
-                        delta_to_j_no_i.resize(delta_to_j_no_i.size()+1);
-                    }
+                    s.gamma_ji.resize(ee-eb);
+                    s.delta_to_j_no_i.resize(ee-eb);
+                }
 
-                    ++num_neighbors;
-                    const unsigned long id_j = prob.node_id(j);
+                // first we fill in the gamma vectors
+                for (unsigned long e = eb; e < ee; ++e)
+                {
+                    const unsigned long jcnt = e-eb;
+                    const neighbor_iterator& j = edge_nbr[e];
+                    const unsigned long id_j = edge_node[e];
                     const unsigned long num_states_xj = prob.num_states(j);
 
-                    gamma_ji[jcnt].assign(num_states_xi, -std::numeric_limits<double>::infinity());
-                    delta_to_j_no_i[jcnt].assign(num_states_xj, 0);
+                    std::vector<double>& gamma_ji = s.gamma_ji[jcnt];
+                    std::vector<double>& delta_to_j_no_i = s.delta_to_j_no_i[jcnt];
+                    gamma_ji.assign(num_states_xi, -std::numeric_limits<double>::infinity());
+                    delta_to_j_no_i.assign(num_states_xj, 0);
 
-                    // compute delta_j^{-i} and store it in delta_to_j_no_i[jcnt]  
-                    for (neighbor_iterator k = prob.begin(j); k != prob.end(j); ++k)
+                    // compute delta_j^{-i} and store it in delta_to_j_no_i
+                    for (unsigned long k = edge_begin[id_j]; k < edge_begin[id_j+1]; ++k)
                     {
-                        const unsigned long id_k = prob.node_id(k);
-                        if (id_k==id_i)
+                        if (edge_node[k] == id_i)
                             continue;
-                        const double* const delta_kj = &delta_elements[delta_idx(id_k,id_j)];
+                        const double* const delta_kj = &delta[edge_in[k]];
                         for (unsigned long xj = 0; xj < num_states_xj; ++xj)
-                        {
-                            delta_to_j_no_i[jcnt][xj] += delta_kj[xj];
-                        }
+                            delta_to_j_no_i[xj] += delta_kj[xj];
                     }
 
                     // now compute gamma values
                     for (unsigned long xi = 0; xi < num_states_xi; ++xi)
                     {
                         for (unsigned long xj = 0; xj < num_states_xj; ++xj)
-                        {
-                            gamma_ji[jcnt][xi] = std::max(gamma_ji[jcnt][xi], prob.factor_value(i,j,xi,xj) + delta_to_j_no_i[jcnt][xj]);
-                        }
-                        gamma_i[xi] += gamma_ji[jcnt][xi];
+                            gamma_ji[xi] = std::max(gamma_ji[xi], prob.factor_value(i,j,xi,xj) + delta_to_j_no_i[xj]);
+                        s.gamma_i[xi] += gamma_ji[xi];
                     }
-                    ++jcnt;
                 }
 
                 // now update the delta values
-                jcnt = 0;
-                for (neighbor_iterator j = prob.begin(i); j != prob.end(i); ++j)
+                double max_change = -std::numeric_limits<double>::infinity();
+                for (unsigned long e = eb; e < ee; ++e)
                 {
-                    const unsigned long id_j = prob.node_id(j);
+                    const unsigned long jcnt = e-eb;
+                    const neighbor_iterator& j = edge_nbr[e];
                     const unsigned long num_states_xj = prob.num_states(j);
 
                     // messages from j to i
-                    double* const delta_ji = &delta_elements[delta_idx(id_j,id_i)];
+                    double* const delta_ji = &delta[edge_in[e]];
 
                     // messages from i to j
-                    double* const delta_ij = &delta_elements[delta_idx(id_i,id_j)];
+                    double* const delta_ij = &delta[edge_out[e]];
 
                     for (unsigned long xj = 0; xj < num_states_xj; ++xj)
                     {
@@ -282,11 +281,11 @@ namespace dlib
 
                         for (unsigned long xi = 0; xi < num_states_xi; ++xi)
                         {
-                            double val = prob.factor_value(i,j,xi,xj) + 2/(num_neighbors+1)*gamma_i[xi] -gamma_ji[jcnt][xi];
+                            double val = prob.factor_value(i,j,xi,xj) + 2/(num_neighbors+1)*s.gamma_i[xi] - s.gamma_ji[jcnt][xi];
                             if (val > best_val)
                                 best_val = val;
                         }
-                        best_val = -0.5*delta_to_j_no_i[jcnt][xj] + 0.5*best_val;
+                        best_val = -0.5*s.delta_to_j_no_i[jcnt][xj] + 0.5*best_val;
 
                         if (std::abs(delta_ij[xj] - best_val) > max_change)
                             max_change = std::abs(delta_ij[xj] - best_val);
@@ -296,37 +295,191 @@ namespace dlib
 
                     for (unsigned long xi = 0; xi < num_states_xi; ++xi)
                     {
-                        double new_val = -1/(num_neighbors+1)*gamma_i[xi] + gamma_ji[jcnt][xi];
+                        double new_val = -1/(num_neighbors+1)*s.gamma_i[xi] + s.gamma_ji[jcnt][xi];
                         if (std::abs(delta_ji[xi] - new_val) > max_change)
                             max_change = std::abs(delta_ji[xi] - new_val);
                         delta_ji[xi] = new_val;
                     }
-                    ++jcnt;
                 }
+                return max_change;
             }
-        }
 
+            std::vector<std::vector<unsigned long> > color_nodes (
+            ) const
+            /*!
+                ensures
+                    - Greedily colors the graph so that nodes within distance 2 of each
+                      other never share a color and returns the nodes of each color.
+                      Since the star update at a node only touches messages on its own
+                      edges and reads messages going into its neighbors, all the nodes
+                      with the same color can be updated at the same time.
+            !*/
+            {
+                const unsigned long n = nodes.size();
+                std::vector<unsigned long> color(n, 0);
+                std::vector<unsigned long> used_by;
+                std::vector<std::vector<unsigned long> > colors;
+                for (unsigned long t = 0; t < order.size(); ++t)
+                {
+                    const unsigned long id_i = order[t];
+                    // used_by[c] == id_i+1 means color c is taken by a nearby node.
+                    for (unsigned long e = edge_begin[id_i]; e < edge_begin[id_i+1]; ++e)
+                    {
+                        const unsigned long id_j = edge_node[e];
+                        for (unsigned long k = edge_begin[id_j]; k < edge_begin[id_j+1]; ++k)
+                        {
+                            const unsigned long id_k = edge_node[k];
+                            if (color[id_k] != 0)
+                                mark_color(used_by, color[id_k]-1, id_i);
+                        }
+                        if (color[id_j] != 0)
+                            mark_color(used_by, color[id_j]-1, id_i);
+                    }
+                    unsigned long c = 0;
+                    while (c < used_by.size() && used_by[c] == id_i+1)
+                        ++c;
+                    if (c == colors.size())
+                        colors.resize(c+1);
+                    colors[c].push_back(id_i);
+                    color[id_i] = c+1;
+                }
+                return colors;
+            }
 
-        // now decode the "beliefs"
-        std::vector<double> b;
-        for (node_iterator i = prob.begin(); i != prob.end(); ++i)
-        {
-            const unsigned long id_i = prob.node_id(i);
-            b.assign(prob.num_states(i), 0);
+            void decode (
+                std::vector<unsigned long>& map_assignment
+            ) const
+            {
+                // now decode the "beliefs"
+                std::vector<double> b;
+                for (unsigned long id_i = 0; id_i < nodes.size(); ++id_i)
+                {
+                    b.assign(prob.num_states(nodes[id_i]), 0);
+                    for (unsigned long e = edge_begin[id_i]; e < edge_begin[id_i+1]; ++e)
+                    {
+                        const double* const delta_ki = &delta[edge_in[e]];
+                        for (unsigned long xi = 0; xi < b.size(); ++xi)
+                            b[xi] += delta_ki[xi];
+                    }
+
+                    map_assignment[id_i] = index_of_max(mat(b));
+                }
+            }
+
+            std::vector<unsigned long> order;
 
-            for (neighbor_iterator k = prob.begin(i); k != prob.end(i); ++k)
+        private:
+
+            static void mark_color (
+                std::vector<unsigned long>& used_by,
+                unsigned long c,
+                unsigned long id_i
+            )
             {
-                const unsigned long id_k = prob.node_id(k);
+                if (c >= used_by.size())
+                    used_by.resize(c+1, 0);
+                used_by[c] = id_i+1;
+            }
+
+            const map_problem& prob;
+            std::vector<node_iterator> nodes;
+            std::vector<unsigned long> edge_begin;
+            std::vector<neighbor_iterator> edge_nbr;
+            std::vector<unsigned long> edge_node;
+            std::vector<unsigned long> edge_out;
+            std::vector<unsigned long> edge_in;
+            std::vector<double> delta;
+        };
+    }
+
+// ----------------------------------------------------------------------------------------
 
-                for (unsigned long xi = 0; xi < b.size(); ++xi)
+    template <
+        typename map_problem
+        >
+    void find_max_factor_graph_nmplp (
+        const map_problem& prob,
+        std::vector<unsigned long>& map_assignment,
+        unsigned long max_iter,
+        double eps,
+        unsigned long num_threads = 1
+    )
+    {
+        // make sure requires clause is not broken
+        DLIB_ASSERT( eps > 0,
+                     "\t void find_max_factor_graph_nmplp()"
+                     << "\n\t eps must be greater than zero"
+                     << "\n\t eps:  " << eps 
+                );
+
+        /*
+            This function is an implementation of the NMPLP algorithm introduced in the 
+            following papers:
+                Fixing Max-Product: Convergent Message Passing Algorithms for MAP LP-Relaxations (2008)
+                by Amir Globerson and Tommi Jaakkola
+
+                Introduction to dual decomposition for inference (2011)
+                by David Sontag, Amir Globerson, and Tommi Jaakkola 
+
+            In particular, this function implements the star MPLP update equations shown as
+            equation 1.20 from the paper Introduction to dual decomposition for inference
+            (the method was called NMPLP in the first paper).  It should also be noted that
+            the original description of the NMPLP in the first paper had an error in the
+            equations and the second paper contains corrected equations, which is what this 
+            function uses.
+        */
+
+        map_assignment.resize(prob.number_of_nodes());
+
+
+        if (prob.number_of_nodes() == 0)
+            return;
+
+        impl::nmplp_messages<map_problem> msgs(prob);
+
+        if (num_threads <= 1)
+        {
+            typename impl::nmplp_messages<map_problem>::scratch s;
+            double max_change = eps + 1; 
+            // Now do the main body of the optimization. 
+            for (unsigned long iter = 0; iter < max_iter && max_change > eps; ++iter)
+            {
+                max_change = -std::numeric_limits<double>::infinity();
+                for (unsigned long t = 0; t < msgs.order.size(); ++t)
+                    max_change = std::max(max_change, msgs.update_node(msgs.order[t], s));
+            }
+        }
+        else
+        {
+            // Sweep over the nodes one color at a time.  The nodes in a color don't
+            // interact, so they are updated in parallel and the results don't depend
+            // on num_threads.
+            const std::vector<std::vector<unsigned long> > colors = msgs.color_nodes();
+            thread_pool tp(num_threads);
+            std::mutex m;
+
+            double max_change = eps + 1; 
+            for (unsigned long iter = 0; iter < max_iter && max_change > eps; ++iter)
+            {
+                max_change = -std::numeric_limits<double>::infinity();
+                for (unsigned long c = 0; c < colors.size(); ++c)
                 {
-                    const double* const delta_ki = &delta_elements[delta_idx(id_k,id_i)];
-                    b[xi] += delta_ki[xi];
+                    const std::vector<unsigned long>& nodes = colors[c];
+                    parallel_for_blocked(tp, 0, nodes.size(), [&](long begin, long end)
+                    {
+                        typename impl::nmplp_messages<map_problem>::scratch local;
+                        double local_change = -std::numeric_limits<double>::infinity();
+                        for (long t = begin; t < end; ++t)
+                            local_change = std::max(local_change, msgs.update_node(nodes[t], local));
+
+                        std::lock_guard<std::mutex> lock(m);
+                        max_change = std::max(max_change, local_change);
+                    });
                 }
             }
-
-            map_assignment[id_i] = index_of_max(mat(b));
         }
+
+        msgs.decode(map_assignment);
     }
 
 // ----------------------------------------------------------------------------------------
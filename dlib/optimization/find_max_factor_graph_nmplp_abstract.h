@@ -317,7 +317,8 @@ namespace dlib
         const map_problem& prob,
         std::vector<unsigned long>& map_assignment,
         unsigned long max_iter,
-        double eps
+        double eps,
+        unsigned long num_threads = 1
     );
     /*!
         requires
@@ -325,6 +326,9 @@ namespace dlib
             - map_problem == an object with an interface compatible with the map_problem
               object defined at the top of this file.
             - eps > 0
+            - if (num_threads > 1) then
+                - It must be safe to call the const member functions of prob from 
+                  multiple threads at the same time.
         ensures
             - This function is a tool for approximately solving the given MAP problem in a graphical 
               model or factor graph with pairwise potential functions.  That is, it attempts 
@@ -345,6 +349,14 @@ namespace dlib
               the setting of eps.
             - If the graph is tree-structured then this routine always gives the exact solution 
               to the MAP problem.  However, for graphs with cycles, the solution may be approximate.
+            - if (num_threads > 1) then
+                - The nodes are colored so that nodes within two hops of each other get
+                  different colors.  Each iteration then updates one color at a time,
+                  with the nodes of a color split across num_threads threads.  This visits
+                  the nodes in a different order than the single threaded version so the
+                  messages, and on graphs with cycles possibly the returned assignment,
+                  can differ slightly from the num_threads == 1 output.  However, the
+                  output doesn't depend on the number of threads used.
               
 
             - This function is an implementation of the NMPLP algorithm introduced in the
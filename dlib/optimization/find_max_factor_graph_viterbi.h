@@ -5,6 +5,8 @@
 
 #include "find_max_factor_graph_viterbi_abstract.h"
 #include <vector>
+#include <algorithm>
+#include <unordered_map>
 #include "../matrix.h"
 #include "../array2d.h"
 
@@ -115,6 +117,14 @@ namespace dlib
         array2d<impl::viterbi_data> trellis;
         trellis.set_size(prob.number_of_nodes(), trellis_size);
 
+        // buffers used by the order 1 case
+        std::vector<double> prev_vals, scores;
+        if (order == 1)
+        {
+            prev_vals.resize(num_states);
+            scores.resize(num_states);
+        }
+
 
         for (unsigned long node = 0; node < prob.number_of_nodes(); ++node)
         {
@@ -148,6 +158,46 @@ namespace dlib
                 }
             }
             else if (order == 1)
+            {
+                // Order 1 chains are by far the most common, so they get their own loop.
+                // For each state of this node we first gather the scores of coming from
+                // each previous state into a contiguous buffer and then do the max-plus
+                // step on it in a separate loop, which the compiler can vectorize.
+                for (unsigned long s = 0; s < num_states; ++s)
+                    prev_vals[s] = trellis[node-1][s].val;
+
+                matrix<unsigned long,1,2> node_states;
+                for (unsigned long i = 0; i < num_states; ++i)
+                {
+                    node_states(0) = i;
+                    for (unsigned long s = 0; s < num_states; ++s)
+                    {
+                        node_states(1) = s;
+                        scores[s] = prob.factor_value(node,node_states);
+                    }
+
+                    double best_score = -std::numeric_limits<double>::infinity();
+                    for (unsigned long s = 0; s < num_states; ++s)
+                    {
+                        scores[s] += prev_vals[s];
+                        best_score = std::max(best_score, scores[s]);
+                    }
+                    // Pick the first state that attains the max, just like the general
+                    // code below.
+                    unsigned long back_index = 0;
+                    for (unsigned long s = 0; s < num_states; ++s)
+                    {
+                        if (scores[s] == best_score)
+                        {
+                            back_index = s;
+                            break;
+                        }
+                    }
+                    trellis[node][i].val = best_score;
+                    trellis[node][i].back_index = back_index;
+                }
+            }
+            else if (order == 2)
             {
                 /*
                     WHAT'S THE DEAL WITH THIS PREPROCESSOR MACRO?
@@ -178,11 +228,6 @@ namespace dlib
                     trellis[node][i].back_index = back_index;                                                               \
                 }
 
-                matrix<unsigned long,1,2> node_states;
-                DLIB_FMFGV_WORK
-            }
-            else if (order == 2)
-            {
                 matrix<unsigned long,1,3> node_states;
                 DLIB_FMFGV_WORK
             }
@@ -225,8 +270,185 @@ namespace dlib
 
 // ----------------------------------------------------------------------------------------
 
-}
+    namespace impl
+    {
+        struct viterbi_beam_entry
+        {
+            double val;
+            // The states of the last min(node+1,order) nodes, written as a number in
+            // base num_states with the most recent node as the most significant digit.
+            unsigned long hist;
+            // index of the entry in the previous beam this one came from.
+            unsigned long back;
+        };
 
-#endif // DLIB_FIND_MAX_FACTOR_GRAPH_VITERBi_Hh_
+        inline bool operator< (
+            const viterbi_beam_entry& a,
+            const viterbi_beam_entry& b
+        )
+        {
+            // Order entries from best to worst and break ties in favor of smaller
+            // state numbers so the output doesn't depend on hash table ordering.
+            if (a.val != b.val)
+                return a.val > b.val;
+            return a.hist < b.hist;
+        }
+
+        template <
+            typename map_problem
+            >
+        void find_max_factor_graph_viterbi_beam (
+            const map_problem& prob,
+            std::vector<unsigned long>& map_assignment,
+            const unsigned long beam_width
+        )
+        {
+            const unsigned long order = prob.order();
+            const unsigned long num_states = prob.num_states();
+            const unsigned long num_nodes = prob.number_of_nodes();
+
+            // powers[k] == num_states^k
+            std::vector<unsigned long> powers(order+1, 1);
+            for (unsigned long k = 1; k <= order; ++k)
+                powers[k] = powers[k-1]*num_states;
+
+            std::vector<std::vector<viterbi_beam_entry> > beams(num_nodes);
+            std::vector<viterbi_beam_entry> candidates;
+            // When order == 1 the candidates are indexed by state directly, otherwise
+            // we find them through a hash table.
+            std::vector<long> slot;
+            std::unordered_map<unsigned long,unsigned long> slot_map;
+            matrix<unsigned long,1,0> node_states;
+
+            for (unsigned long node = 0; node < num_nodes; ++node)
+            {
+                // number of previous nodes the factor at this node looks at
+                const unsigned long m = std::min(node, order);
+                node_states.set_size(m+1);
+                candidates.clear();
+                if (order == 1)
+                    slot.assign(num_states, -1);
+                else
+                    slot_map.clear();
+
+                const unsigned long num_prev = (node == 0) ? 1 : beams[node-1].size();
+                for (unsigned long b = 0; b < num_prev; ++b)
+                {
+                    double prev_val = 0;
+                    unsigned long prev_hist = 0;
+                    if (node != 0)
+                    {
+                        prev_val = beams[node-1][b].val;
+                        prev_hist = beams[node-1][b].hist;
+                        for (unsigned long j = 0; j < m; ++j)
+                            node_states(1+j) = (prev_hist/powers[m-1-j])%num_states;
+                    }
 
+                    for (unsigned long s = 0; s < num_states; ++s)
+                    {
+                        node_states(0) = s;
+                        viterbi_beam_entry e;
+                        e.val = prev_val + prob.factor_value(node, node_states);
+                        e.back = b;
+                        if (m == order)
+                            e.hist = s*powers[order-1] + prev_hist/num_states;
+                        else
+                            e.hist = s*powers[m] + prev_hist;
+
+                        // keep only the best way of reaching each history
+                        long idx;
+                        if (order == 1)
+                        {
+                            idx = slot[e.hist];
+                            if (idx == -1)
+                                slot[e.hist] = candidates.size();
+                        }
+                        else
+                        {
+                            std::unordered_map<unsigned long,unsigned long>::iterator i = slot_map.find(e.hist);
+                            if (i == slot_map.end())
+                            {
+                                idx = -1;
+                                slot_map[e.hist] = candidates.size();
+                            }
+                            else
+                            {
+                                idx = i->second;
+                            }
+                        }
+
+                        if (idx == -1)
+                            candidates.push_back(e);
+                        else if (e.val > candidates[idx].val)
+                            candidates[idx] = e;
+                    }
+                }
+
+                // Now keep only the beam_width best candidates.
+                if (candidates.size() > beam_width)
+                {
+                    std::partial_sort(candidates.begin(), candidates.begin()+beam_width, candidates.end());
+                    candidates.resize(beam_width);
+                }
+                beams[node] = candidates;
+            }
+
+            // Find the best entry in the last beam and follow the back links.
+            const std::vector<viterbi_beam_entry>& last = beams[num_nodes-1];
+            unsigned long best = 0;
+            for (unsigned long b = 1; b < last.size(); ++b)
+            {
+                if (last[b] < last[best])
+                    best = b;
+            }
 
+            map_assignment.resize(num_nodes);
+            for (long node = num_nodes-1; node >= 0; --node)
+            {
+                const viterbi_beam_entry& e = beams[node][best];
+                const unsigned long len = std::min<unsigned long>(node+1, order);
+                map_assignment[node] = e.hist/powers[len-1];
+                best = e.back;
+            }
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename map_problem
+        >
+    void find_max_factor_graph_viterbi (
+        const map_problem& prob,
+        std::vector<unsigned long>& map_assignment,
+        unsigned long beam_width
+    )
+    {
+        DLIB_ASSERT(prob.num_states() > 0,
+            "\t void find_max_factor_graph_viterbi()"
+            << "\n\t The nodes in a factor graph have to be able to take on more than 0 states."
+            );
+        DLIB_ASSERT(std::pow(prob.num_states(),(double)prob.order()) < std::numeric_limits<unsigned long>::max(),
+            "\t void find_max_factor_graph_viterbi()"
+            << "\n\t The order is way too large for this algorithm to handle."
+            << "\n\t order:      " << prob.order()
+            << "\n\t num_states: " << prob.num_states()
+            );
+
+        // A beam holding all the trellis states gives the exact answer, so we may as
+        // well run the exact code in that case.
+        if (beam_width == 0 || prob.order() == 0 || prob.number_of_nodes() == 0 ||
+            std::pow(prob.num_states(),(double)prob.order()) <= beam_width)
+        {
+            find_max_factor_graph_viterbi(prob, map_assignment);
+            return;
+        }
+
+        impl::find_max_factor_graph_viterbi_beam(prob, map_assignment, beam_width);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_FIND_MAX_FACTOR_GRAPH_VITERBi_Hh_
@@ -121,6 +121,39 @@ namespace dlib
                 - #map_assignment[i] == The MAP assignment for node/variable i.
     !*/
 
+    template <
+        typename map_problem
+        >
+    void find_max_factor_graph_viterbi (
+        const map_problem& prob,
+        std::vector<unsigned long>& map_assignment,
+        unsigned long beam_width
+    );
+    /*!
+        requires
+            - prob.num_states() > 0
+            - std::pow(prob.num_states(), prob.order()) < std::numeric_limits<unsigned long>::max()
+            - map_problem == an object with an interface compatible with the map_problem
+              object defined at the top of this file.
+        ensures
+            - This function is identical to find_max_factor_graph_viterbi(prob,map_assignment)
+              except that it can use beam search to approximately solve the MAP problem.
+              This is useful when prob.num_states() is large since the exact Viterbi
+              algorithm takes time proportional to std::pow(prob.num_states(), prob.order()+1)
+              per node while the beam search takes time proportional to
+              beam_width*prob.num_states() per node.
+            - if (beam_width == 0 || std::pow(prob.num_states(), prob.order()) <= beam_width) then
+                - The MAP problem is solved exactly, i.e. this function just calls
+                  find_max_factor_graph_viterbi(prob,map_assignment).
+            - else
+                - At each node, only the beam_width best partial assignments to the
+                  preceding nodes are kept around.  Therefore, #map_assignment is a good
+                  assignment but it may not be the MAP assignment.
+            - #map_assignment.size() == prob.number_of_nodes()
+            - for all valid i:
+                - #map_assignment[i] < prob.num_states()
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
 }
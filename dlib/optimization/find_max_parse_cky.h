@@ -7,8 +7,13 @@
 #include <vector>
 #include <string>
 #include <sstream>
+#include <map>
+#include <algorithm>
+#include <functional>
 #include "../serialize.h" 
 #include "../array2d.h"
+#include "../threads/thread_pool_extension.h"
+#include "../threads/parallel_for_extension.h"
 
 namespace dlib
 {
@@ -96,31 +101,172 @@ namespace dlib
 
     namespace impl
     {
+        template <typename T>
+        class cky_chart
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    This is the CKY chart.  Cell (r,c) holds the best parse_tree_element
+                    for each tag that can cover the words [r, c], sorted by tag.  The
+                    cells are kept in one flat vector ordered by span length, so the cells
+                    filled in one pass (which all have the same span length) are next to
+                    each other, as are the cells they read.
+            !*/
+        public:
+            typedef std::vector<parse_tree_element<T> > cell_type;
+
+            explicit cky_chart (
+                unsigned long n_
+            ) : n(n_), cells(n_*(n_+1)/2) {}
+
+            cell_type& operator() (
+                unsigned long r,
+                unsigned long c
+            ) { return cells[index(r,c)]; }
+
+            const cell_type& operator() (
+                unsigned long r,
+                unsigned long c
+            ) const { return cells[index(r,c)]; }
+
+        private:
+            unsigned long index (
+                unsigned long r,
+                unsigned long c
+            ) const 
+            { 
+                const unsigned long len = c-r;
+                return len*n - len*(len-1)/2 + r;
+            }
+
+            unsigned long n;
+            std::vector<cell_type> cells;
+        };
+
+        template <typename T>
+        struct cky_tag_less
+        {
+            bool operator() (
+                const parse_tree_element<T>& a,
+                const parse_tree_element<T>& b
+            ) const { return std::less<T>()(a.tag, b.tag); }
+        };
+
+        template <typename T>
+        struct cky_score_greater
+        {
+            bool operator() (
+                const parse_tree_element<T>& a,
+                const parse_tree_element<T>& b
+            ) const { return a.score > b.score; }
+        };
+
+        template <typename T>
+        const parse_tree_element<T>& find_in_cell (
+            const std::vector<parse_tree_element<T> >& cell,
+            const T& tag
+        )
+        /*!
+            requires
+                - cell is sorted by tag and contains an element with the given tag
+        !*/
+        {
+            parse_tree_element<T> key;
+            key.tag = tag;
+            return *std::lower_bound(cell.begin(), cell.end(), key, cky_tag_less<T>());
+        }
+
+        template <typename T, typename production_rule_function>
+        void fill_cky_cell (
+            const std::vector<T>& sequence,
+            const production_rule_function& production_rules,
+            cky_chart<T>& chart,
+            const unsigned long r,
+            const unsigned long c,
+            const unsigned long beam_width,
+            std::map<T,parse_tree_element<T> >& best,
+            std::vector<std::pair<T,double> >& possible_tags
+        )
+        {
+            typedef typename std::vector<parse_tree_element<T> >::const_iterator itr;
+            typedef typename std::map<T,parse_tree_element<T> >::iterator itr_b;
+
+            best.clear();
+            for (unsigned long k = r; k < c; ++k)
+            {
+                const std::vector<parse_tree_element<T> >& left = chart(r,k);
+                const std::vector<parse_tree_element<T> >& right = chart(k+1,c);
+                for (itr i = right.begin(); i != right.end(); ++i)
+                {
+                    for (itr j = left.begin(); j != left.end(); ++j)
+                    {
+                        constituent<T> con;
+                        con.begin = r;
+                        con.end = c+1;
+                        con.k = k+1;
+                        con.left_tag = j->tag;
+                        con.right_tag = i->tag;
+                        possible_tags.clear();
+                        production_rules(sequence, con, possible_tags);
+                        for (unsigned long m = 0; m < possible_tags.size(); ++m)
+                        {
+                            const double score = possible_tags[m].second + i->score + j->score;
+                            itr_b match = best.find(possible_tags[m].first);
+                            if (match == best.end() || score > match->second.score)
+                            {
+                                parse_tree_element<T>& item = best[possible_tags[m].first];
+                                item.c = con;
+                                item.score = score;
+                                item.tag = possible_tags[m].first;
+                                item.left = END_OF_TREE;
+                                item.right = END_OF_TREE;
+                            }
+                        }
+                    }
+                }
+            }
+
+            std::vector<parse_tree_element<T> >& cell = chart(r,c);
+            cell.clear();
+            cell.reserve(best.size());
+            for (itr_b i = best.begin(); i != best.end(); ++i)
+                cell.push_back(i->second);
+
+            // Prune the cell down to its beam_width highest scoring tags.  The stable sort
+            // breaks ties in favor of the tags that come first in tag order.
+            if (beam_width != 0 && cell.size() > beam_width)
+            {
+                std::stable_sort(cell.begin(), cell.end(), cky_score_greater<T>());
+                cell.resize(beam_width);
+                std::sort(cell.begin(), cell.end(), cky_tag_less<T>());
+            }
+        }
+
         template <typename T>
         unsigned long fill_parse_tree(
             std::vector<parse_tree_element<T> >& parse_tree, 
             const T& tag,
-            const array2d<std::map<T, parse_tree_element<T> > >& back, 
+            const cky_chart<T>& chart, 
             long r, long c
         )
         /*!
             requires
-                - back[r][c].size() == 0 || back[r][c].count(tag) != 0
+                - r == c || chart(r,c) contains an element with the given tag
         !*/
         {
             // base case of the recursion 
-            if (back[r][c].size() == 0)
+            if (r == c)
             {
                 return END_OF_TREE;
             }
 
             const unsigned long idx = parse_tree.size();
-            const parse_tree_element<T>& item = back[r][c].find(tag)->second;
+            const parse_tree_element<T>& item = find_in_cell(chart(r,c), tag);
             parse_tree.push_back(item);
 
             const long k = item.c.k;
-            const unsigned long idx_left  = fill_parse_tree(parse_tree, item.c.left_tag, back, r, k-1); 
-            const unsigned long idx_right = fill_parse_tree(parse_tree, item.c.right_tag, back, k, c); 
+            const unsigned long idx_left  = fill_parse_tree(parse_tree, item.c.left_tag, chart, r, k-1); 
+            const unsigned long idx_right = fill_parse_tree(parse_tree, item.c.right_tag, chart, k, c); 
             parse_tree[idx].left = idx_left;
             parse_tree[idx].right = idx_right;
             return idx;
@@ -131,82 +277,69 @@ namespace dlib
     void find_max_parse_cky (
         const std::vector<T>& sequence,
         const production_rule_function& production_rules,
-        std::vector<parse_tree_element<T> >& parse_tree
+        std::vector<parse_tree_element<T> >& parse_tree,
+        unsigned long beam_width = 0,
+        unsigned long num_threads = 1
     )
     {
         parse_tree.clear();
-        if (sequence.size() == 0)
+        // A single word can't be covered by any production rule.
+        if (sequence.size() <= 1)
             return;
 
-        array2d<std::map<T,double> > table(sequence.size(), sequence.size());
-        array2d<std::map<T,parse_tree_element<T> > > back(sequence.size(), sequence.size());
-        typedef typename std::map<T,double>::iterator itr;
-        typedef typename std::map<T,parse_tree_element<T> >::iterator itr_b;
-
-        for (long r = 0; r < table.nr(); ++r)
-            table[r][r][sequence[r]] = 0;
+        const unsigned long n = sequence.size();
+        impl::cky_chart<T> chart(n);
 
-        std::vector<std::pair<T,double> > possible_tags;
+        for (unsigned long r = 0; r < n; ++r)
+        {
+            parse_tree_element<T> item;
+            item.tag = sequence[r];
+            item.score = 0;
+            chart(r,r).push_back(item);
+        }
 
-        for (long r = table.nr()-2; r >= 0; --r)
+        // Fill the chart one span length at a time.  The cells with the same span length
+        // only read shorter spans, so they can be filled in any order, or in parallel.
+        if (num_threads <= 1)
         {
-            for (long c = r+1; c < table.nc(); ++c)
+            std::map<T,parse_tree_element<T> > best;
+            std::vector<std::pair<T,double> > possible_tags;
+            for (unsigned long len = 1; len < n; ++len)
             {
-                for (long k = r; k < c; ++k)
+                for (unsigned long r = 0; r+len < n; ++r)
+                    impl::fill_cky_cell(sequence, production_rules, chart, r, r+len, beam_width, best, possible_tags);
+            }
+        }
+        else
+        {
+            thread_pool tp(num_threads);
+            for (unsigned long len = 1; len < n; ++len)
+            {
+                parallel_for_blocked(tp, 0, n-len, [&](long begin, long end)
                 {
-                    for (itr i = table[k+1][c].begin(); i != table[k+1][c].end(); ++i)
-                    {
-                        for (itr j = table[r][k].begin(); j != table[r][k].end(); ++j)
-                        {
-                            constituent<T> con;
-                            con.begin = r;
-                            con.end = c+1;
-                            con.k = k+1;
-                            con.left_tag = j->first;
-                            con.right_tag = i->first;
-                            possible_tags.clear();
-                            production_rules(sequence, con, possible_tags);
-                            for (unsigned long m = 0; m < possible_tags.size(); ++m)
-                            {
-                                const double score = possible_tags[m].second + i->second + j->second;
-                                itr match = table[r][c].find(possible_tags[m].first);
-                                if (match == table[r][c].end() || score > match->second)
-                                {
-                                    table[r][c][possible_tags[m].first] = score;
-                                    parse_tree_element<T> item;
-                                    item.c = con;
-                                    item.score = score;
-                                    item.tag = possible_tags[m].first;
-                                    item.left = END_OF_TREE;
-                                    item.right = END_OF_TREE;
-                                    back[r][c][possible_tags[m].first] = item;
-                                }
-                            }
-                        }
-                    }
-                }
+                    std::map<T,parse_tree_element<T> > best;
+                    std::vector<std::pair<T,double> > possible_tags;
+                    for (long r = begin; r < end; ++r)
+                        impl::fill_cky_cell(sequence, production_rules, chart, r, r+len, beam_width, best, possible_tags);
+                });
             }
         }
 
 
         // now use back pointers to build the parse trees
-        const long r = 0;
-        const long c = back.nc()-1;
-        if (back[r][c].size() != 0)
+        const std::vector<parse_tree_element<T> >& root = chart(0,n-1);
+        if (root.size() != 0)
         {
-
-            // find the max scoring element in back[r][c]
-            itr_b max_i = back[r][c].begin();
-            itr_b i = max_i;
-            ++i;
-            for (; i != back[r][c].end(); ++i)
+            // find the max scoring element in the root cell
+            unsigned long max_i = 0;
+            for (unsigned long i = 1; i < root.size(); ++i)
             {
-                if (i->second.score > max_i->second.score)
+                if (root[i].score > root[max_i].score)
                     max_i = i;
             }
 
-            parse_tree.reserve(c);
-            impl::fill_parse_tree(parse_tree, max_i->second.tag, back, r, c);
+            parse_tree.reserve(n-1);
+            impl::fill_parse_tree(parse_tree, root[max_i].tag, chart, 0, n-1);
         }
     }
 
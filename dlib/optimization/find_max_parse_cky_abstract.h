@@ -175,13 +175,18 @@ namespace dlib
     void find_max_parse_cky (
         const std::vector<T>& words,
         const production_rule_function& production_rules,
-        std::vector<parse_tree_element<T> >& parse_tree
+        std::vector<parse_tree_element<T> >& parse_tree,
+        unsigned long beam_width = 0,
+        unsigned long num_threads = 1
     );
     /*!
         requires
             - production_rule_function == a function or function object with the same
               interface as example_production_rule_function defined above.
             - It must be possible to store T objects in a std::map.
+            - if (num_threads > 1) then
+                - production_rules() must be safe to call from multiple threads at the
+                  same time.
         ensures
             - Uses the CKY algorithm to find the most probable/highest scoring binary parse
               tree of the given vector of words.  
@@ -199,6 +204,15 @@ namespace dlib
             - This function uses production_rules() to find out what the allowed production
               rules are.  That is, production_rules() defines all properties of the grammar
               used by find_max_parse_cky(). 
+            - if (beam_width != 0) then
+                - Each cell of the CKY chart, i.e. each span of words, only keeps the
+                  beam_width highest scoring tags.  This makes parsing with large grammars
+                  much faster, but #parse_tree might not be the highest scoring parse tree
+                  and, if the pruning removed all ways of covering words, it may be empty
+                  even though a parse tree exists.
+            - The cells of the CKY chart covering spans of the same length are filled in
+              parallel using num_threads threads.  The output does not depend on
+              num_threads.
     !*/
 
 // -----------------------------------------------------------------------------------------
@@ -7,6 +7,9 @@
 #include "../matrix.h"
 #include <vector>
 #include <deque>
+#include <queue>
+#include <limits>
+#include <algorithm>
 
 namespace dlib
 {
@@ -281,8 +284,151 @@ namespace dlib
 
 // ----------------------------------------------------------------------------------------
 
-}
+    template <typename sparse_vector_type>
+    std::vector<long> sparse_max_cost_assignment (
+        const std::vector<sparse_vector_type>& cost
+    )
+    {
+        typedef typename sparse_vector_type::value_type::second_type type;
+        // Just like max_cost_assignment(), this algorithm needs exact comparisons
+        // between costs so they must be integers.  They must also be signed since the
+        // algorithm works with the negated costs.
+        COMPILE_TIME_ASSERT(std::numeric_limits<type>::is_integer);
+        COMPILE_TIME_ASSERT(std::numeric_limits<type>::is_signed);
 
-#endif // DLIB_MAX_COST_ASSIgNMENT_Hh_
+        /*
+            This is the shortest augmenting path algorithm used by LAPJV (see A Shortest
+            Augmenting Path Algorithm for Dense and Sparse Linear Assignment Problems by
+            Jonker and Volgenant) except that it only ever looks at the edges which are
+            present in cost.  Each row is added to the matching by running Dijkstra's
+            algorithm over the reduced costs until a free column is found.
+
+            We minimize the negated cost.  To let rows go unassigned each row x also
+            gets a private column num_cols+x with a cost of 0.  Assigning x to it is
+            how we represent leaving x unassigned.
+        */
+
+        const long num_rows = cost.size();
+        long num_cols = 0;
+        for (long x = 0; x < num_rows; ++x)
+        {
+            for (typename sparse_vector_type::const_iterator i = cost[x].begin(); i != cost[x].end(); ++i)
+                num_cols = std::max<long>(num_cols, i->first+1);
+        }
+        const long total_cols = num_cols + num_rows;
+
+        const type infinity = std::numeric_limits<type>::max();
+
+        // column potentials 
+        std::vector<type> v(total_cols, 0);
+        std::vector<long> xy(num_rows, -1);
+        std::vector<long> yx(total_cols, -1);
+        // matched_cost[x] == the negated cost of the edge from x to xy[x]
+        std::vector<type> matched_cost(num_rows, 0);
+
+        // Dijkstra state.  Only the columns listed in touched are ever changed so we
+        // can reset them cheaply.
+        std::vector<type> dist(total_cols, infinity);
+        std::vector<long> pred(total_cols, -1);
+        std::vector<type> pred_cost(total_cols, 0);
+        std::vector<char> done(total_cols, false);
+        std::vector<long> touched, scanned;
+        typedef std::pair<type,long> heap_item;
+        std::priority_queue<heap_item, std::vector<heap_item>, std::greater<heap_item> > heap;
+
+        for (long s = 0; s < num_rows; ++s)
+        {
+            // Relax all the edges leaving row x.  base is the distance to x minus
+            // x's dual variable.
+            auto relax = [&](long x, type base)
+            {
+                for (typename sparse_vector_type::const_iterator i = cost[x].begin(); i != cost[x].end(); ++i)
+                {
+                    const long y = i->first;
+                    const type nd = base - i->second - v[y];
+                    if (!done[y] && nd < dist[y])
+                    {
+                        if (dist[y] == infinity)
+                            touched.push_back(y);
+                        dist[y] = nd;
+                        pred[y] = x;
+                        pred_cost[y] = -i->second;
+                        heap.push(heap_item(nd,y));
+                    }
+                }
+                const long y = num_cols + x;
+                const type nd = base - v[y];
+                if (!done[y] && nd < dist[y])
+                {
+                    if (dist[y] == infinity)
+                        touched.push_back(y);
+                    dist[y] = nd;
+                    pred[y] = x;
+                    pred_cost[y] = 0;
+                    heap.push(heap_item(nd,y));
+                }
+            };
 
+            relax(s, 0);
 
+            long end_col = -1;
+            type mu = 0;
+            while (heap.size() != 0)
+            {
+                const heap_item item = heap.top();
+                heap.pop();
+                const long y = item.second;
+                if (done[y] || item.first != dist[y])
+                    continue;
+
+                done[y] = true;
+                scanned.push_back(y);
+                if (yx[y] == -1)
+                {
+                    end_col = y;
+                    mu = item.first;
+                    break;
+                }
+
+                const long x = yx[y];
+                relax(x, item.first - (matched_cost[x] - v[y]));
+            }
+
+            // Update the potentials so the reduced costs stay non-negative.
+            for (unsigned long i = 0; i < scanned.size(); ++i)
+                v[scanned[i]] += dist[scanned[i]] - mu;
+
+            // Flip the edges along the augmenting path.
+            for (long y = end_col; y != -1; )
+            {
+                const long x = pred[y];
+                const long next = xy[x];
+                yx[y] = x;
+                xy[x] = y;
+                matched_cost[x] = pred_cost[y];
+                y = (x == s) ? -1 : next;
+            }
+
+            for (unsigned long i = 0; i < touched.size(); ++i)
+            {
+                dist[touched[i]] = infinity;
+                done[touched[i]] = false;
+            }
+            touched.clear();
+            scanned.clear();
+            heap = std::priority_queue<heap_item, std::vector<heap_item>, std::greater<heap_item> >();
+        }
+
+        for (long x = 0; x < num_rows; ++x)
+        {
+            if (xy[x] >= num_cols)
+                xy[x] = -1;
+        }
+        return xy;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_MAX_COST_ASSIgNMENT_Hh_
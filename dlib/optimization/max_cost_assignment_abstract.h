@@ -55,9 +55,49 @@ namespace dlib
               where N is the number of rows in the cost matrix.
     !*/
 
+// ----------------------------------------------------------------------------------------
+
+    template <typename sparse_vector_type>
+    std::vector<long> sparse_max_cost_assignment (
+        const std::vector<sparse_vector_type>& cost
+    );
+    /*!
+        requires
+            - sparse_vector_type == a container of std::pair objects, for example, a
+              std::map<unsigned long,int> or std::vector<std::pair<unsigned long,int> >.
+              That is, each element of cost is a sparse vector as defined in
+              dlib/svm/sparse_vector_abstract.h.
+            - sparse_vector_type::value_type::second_type == some signed integer type 
+              (e.g. int or dlib::int64)
+            - The sum of the absolute values of all the costs fits in the cost type
+              without overflowing.
+        ensures
+            - Interprets cost as a sparse cost assignment matrix.  That is, if the
+              pair (j,c) appears in cost[i] then assigning row i to column j gains c.
+              Any pair which doesn't appear in cost can't be assigned.
+            - Finds and returns the solution to the following optimization problem:
+
+                Maximize: f(A) == sum over all i where A[i] != -1: the cost of 
+                                  assigning i to A[i]
+                Subject to the following constraints:
+                    - A.size() == cost.size()
+                    - A[i] == -1 or the pair (A[i],c) appears in cost[i] for some c.
+                      A value of -1 means i isn't assigned to anything.
+                    - The elements of A which aren't -1 are unique.  
+
+            - Leaving a row unassigned contributes 0 to f(A).  So this is the same
+              problem max_cost_assignment() solves on a square matrix where every
+              missing pair has a cost of 0 and every row also has its own "unassigned"
+              column of cost 0.  This is the problem solved inside dlib's
+              assignment_function when it doesn't force assignments.
+            - This function uses the shortest augmenting path method from the LAPJV
+              algorithm, except that only the pairs present in cost are ever
+              examined.  So it is much faster than max_cost_assignment() when most
+              of the possible assignments are disallowed.
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
 }
 
 #endif // DLIB_MAX_COST_ASSIgNMENT_ABSTRACT_Hh_
-
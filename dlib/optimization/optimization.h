@@ -5,10 +5,13 @@
 
 #include <cmath>
 #include <limits>
+#include <vector>
 #include "optimization_abstract.h"
 #include "optimization_search_strategies.h"
 #include "optimization_stop_strategies.h"
 #include "optimization_line_search.h"
+#include "../threads/thread_pool_extension.h"
+#include "../threads/parallel_for_extension.h"
 
 namespace dlib
 {
@@ -102,6 +105,152 @@ namespace dlib
         return central_differences<funct>(f,eps); 
     }
 
+// ----------------------------------------------------------------------------------------
+
+    template <typename funct>
+    class parallel_central_differences
+    {
+    public:
+        parallel_central_differences(thread_pool& tp_, const funct& f_, double eps_ = 1e-7) : tp(tp_), f(f_), eps(eps_){}
+
+        template <typename T>
+        typename T::matrix_type operator()(const T& x) const
+        {
+            // T must be some sort of dlib matrix 
+            COMPILE_TIME_ASSERT(is_matrix<T>::value);
+
+            const typename T::matrix_type x0(x);
+            return eval(x0, [this](const typename T::matrix_type& e) { return f(e); });
+        }
+
+        template <typename T, typename U>
+        typename U::matrix_type operator()(const T& item, const U& x) const
+        {
+            // U must be some sort of dlib matrix 
+            COMPILE_TIME_ASSERT(is_matrix<U>::value);
+
+            const typename U::matrix_type x0(x);
+            return eval(x0, [this,&item](const typename U::matrix_type& e) { return f(item,e); });
+        }
+
+        double operator()(const double& x) const
+        {
+            double vals[2];
+            parallel_for(tp, 0, 2, [&](long i) { vals[i] = f(i==0 ? x+eps : x-eps); }, 1);
+            return (vals[0]-vals[1])/((x+eps)-(x-eps));
+        }
+
+    private:
+
+        template <typename M, typename F>
+        M eval(const M& x, const F& call_f) const
+        {
+            // Each of the 2*x.size() function evaluations is a separate unit of work, so
+            // even a gradient with fewer elements than tp has threads keeps them all busy.
+            // Element 2*i of vals is f(x + eps*e_i) and 2*i+1 is f(x - eps*e_i).
+            std::vector<double> vals(2*x.size());
+            parallel_for_blocked(tp, 0, vals.size(), [&](long begin, long end)
+            {
+                M e(x);
+                for (long j = begin; j < end; ++j)
+                {
+                    const long i = j/2;
+                    const double old_val = e(i);
+                    e(i) = (j%2 == 0) ? old_val + eps : old_val - eps;
+                    vals[j] = call_f(e);
+                    e(i) = old_val;
+                }
+            }, 1);
+
+            M der(x.size());
+            for (long i = 0; i < x.size(); ++i)
+                der(i) = (vals[2*i] - vals[2*i+1])/((x(i)+eps)-(x(i)-eps));
+            return der;
+        }
+
+        thread_pool& tp;
+        const funct& f;
+        const double eps;
+    };
+
+    template <typename funct>
+    const parallel_central_differences<funct> derivative(
+        thread_pool& tp, 
+        const funct& f, 
+        double eps = 1e-7
+    ) 
+    { 
+        DLIB_ASSERT (
+            eps > 0,
+            "\tparallel_central_differences derivative(tp,f,eps)"
+            << "\n\tYou must give an epsilon > 0"
+            << "\n\teps:     " << eps 
+        );
+        return parallel_central_differences<funct>(tp,f,eps); 
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <typename funct>
+    class batched_central_differences
+    {
+    public:
+        batched_central_differences(const funct& f_, double eps_ = 1e-7) : f(f_), eps(eps_){}
+
+        template <typename T>
+        typename T::matrix_type operator()(const T& x) const
+        {
+            // T must be some sort of dlib matrix 
+            COMPILE_TIME_ASSERT(is_matrix<T>::value);
+
+            typedef typename T::matrix_type matrix_type;
+            std::vector<matrix_type> points;
+            points.reserve(2*x.size());
+            matrix_type e(x);
+            for (long i = 0; i < x.size(); ++i)
+            {
+                const double old_val = e(i);
+                e(i) = old_val + eps;
+                points.push_back(e);
+                e(i) = old_val - eps;
+                points.push_back(e);
+                e(i) = old_val;
+            }
+
+            const auto vals = f(points);
+            DLIB_CASSERT(mat(vals).size() == (long)points.size(),
+                "\t batched_central_differences::operator()"
+                << "\n\t The batched function must return one value for each point it is given."
+                << "\n\t points.size():    " << points.size()
+                << "\n\t mat(vals).size(): " << mat(vals).size()
+            );
+
+            matrix_type der(x.size());
+            for (long i = 0; i < x.size(); ++i)
+                der(i) = (mat(vals)(2*i) - mat(vals)(2*i+1))/((x(i)+eps)-(x(i)-eps)); 
+            return der;
+        }
+
+    private:
+        const funct& f;
+        const double eps;
+    };
+
+    template <typename funct>
+    const batched_central_differences<funct> batched_derivative(
+        const funct& f, 
+        double eps = 1e-7
+    ) 
+    { 
+        DLIB_ASSERT (
+            eps > 0,
+            "\tbatched_central_differences batched_derivative(f,eps)"
+            << "\n\tYou must give an epsilon > 0"
+            << "\n\teps:     " << eps 
+        );
+        return batched_central_differences<funct>(f,eps); 
+    }
+
 // ----------------------------------------------------------------------------------------
 
     template <typename funct, typename EXP1, typename EXP2>
@@ -279,6 +428,69 @@ namespace dlib
 
 // ----------------------------------------------------------------------------------------
 
+    namespace impl
+    {
+        template <
+            typename search_strategy_type,
+            typename stop_strategy_type,
+            typename funct,
+            typename funct_der,
+            typename T
+            >
+        double find_min_using_approximate_derivatives (
+            search_strategy_type& search_strategy,
+            stop_strategy_type& stop_strategy,
+            const funct& f,
+            const funct_der& der,
+            T& x,
+            double min_f,
+            double derivative_eps
+        )
+        /*!
+            ensures
+                - This is find_min_using_approximate_derivatives() except that the gradient
+                  of f is computed by der.
+        !*/
+        {
+            T g, s;
+
+            double f_value = f(x);
+            g = der(x);
+
+            if (!is_finite(f_value))
+                throw error("The objective function generated non-finite outputs");
+            if (!is_finite(g))
+                throw error("The objective function generated non-finite outputs");
+
+            while(stop_strategy.should_continue_search(x, f_value, g) && f_value > min_f)
+            {
+                s = search_strategy.get_next_direction(x, f_value, g);
+
+                double alpha = line_search(
+                            make_line_search_function(f,x,s,f_value),
+                            f_value,
+                            derivative(make_line_search_function(f,x,s),derivative_eps),
+                            dot(g,s),  // Sometimes the following line is a better way of determining the initial gradient. 
+                            //derivative(make_line_search_function(f,x,s),derivative_eps)(0),
+                            search_strategy.get_wolfe_rho(), search_strategy.get_wolfe_sigma(), min_f,
+                            search_strategy.get_max_line_search_iterations()
+                            );
+
+                // Take the search step indicated by the above line search
+                x += alpha*s;
+
+                g = der(x);
+
+                if (!is_finite(f_value))
+                    throw error("The objective function generated non-finite outputs");
+                if (!is_finite(g))
+                    throw error("The objective function generated non-finite outputs");
+            }
+
+            return f_value;
+        }
+    }
+
     template <
         typename search_strategy_type,
         typename stop_strategy_type,
@@ -306,46 +518,82 @@ namespace dlib
             << "\n\tderivative_eps: " << derivative_eps 
         );
 
-        T g, s;
-
-        double f_value = f(x);
-        g = derivative(f,derivative_eps)(x);
+        return impl::find_min_using_approximate_derivatives(search_strategy, stop_strategy,
+            f, derivative(f,derivative_eps), x, min_f, derivative_eps);
+    }
 
-        if (!is_finite(f_value))
-            throw error("The objective function generated non-finite outputs");
-        if (!is_finite(g))
-            throw error("The objective function generated non-finite outputs");
+    template <
+        typename search_strategy_type,
+        typename stop_strategy_type,
+        typename funct,
+        typename T
+        >
+    double find_min_using_approximate_derivatives (
+        thread_pool& tp,
+        search_strategy_type search_strategy,
+        stop_strategy_type stop_strategy,
+        const funct& f,
+        T& x,
+        double min_f,
+        double derivative_eps = 1e-7
+    )
+    {
+        COMPILE_TIME_ASSERT(is_matrix<T>::value);
+        // The starting point (i.e. x) must be a column vector.  
+        COMPILE_TIME_ASSERT(T::NC <= 1);
 
-        while(stop_strategy.should_continue_search(x, f_value, g) && f_value > min_f)
-        {
-            s = search_strategy.get_next_direction(x, f_value, g);
+        DLIB_CASSERT (
+            is_col_vector(x) && derivative_eps > 0,
+            "\tdouble find_min_using_approximate_derivatives()"
+            << "\n\tYou have to supply column vectors to this function"
+            << "\n\tx.nc():         " << x.nc()
+            << "\n\tderivative_eps: " << derivative_eps 
+        );
 
-            double alpha = line_search(
-                        make_line_search_function(f,x,s,f_value),
-                        f_value,
-                        derivative(make_line_search_function(f,x,s),derivative_eps),
-                        dot(g,s),  // Sometimes the following line is a better way of determining the initial gradient. 
-                        //derivative(make_line_search_function(f,x,s),derivative_eps)(0),
-                        search_strategy.get_wolfe_rho(), search_strategy.get_wolfe_sigma(), min_f,
-                        search_strategy.get_max_line_search_iterations()
-                        );
+        return impl::find_min_using_approximate_derivatives(search_strategy, stop_strategy,
+            f, derivative(tp,f,derivative_eps), x, min_f, derivative_eps);
+    }
 
-            // Take the search step indicated by the above line search
-            x += alpha*s;
+// ----------------------------------------------------------------------------------------
 
-            g = derivative(f,derivative_eps)(x);
+    template <
+        typename search_strategy_type,
+        typename stop_strategy_type,
+        typename funct,
+        typename T
+        >
+    double find_max_using_approximate_derivatives (
+        search_strategy_type search_strategy,
+        stop_strategy_type stop_strategy,
+        const funct& f,
+        T& x,
+        double max_f,
+        double derivative_eps = 1e-7
+    )
+    {
+        COMPILE_TIME_ASSERT(is_matrix<T>::value);
+        // The starting point (i.e. x) must be a column vector.  
+        COMPILE_TIME_ASSERT(T::NC <= 1);
 
-            if (!is_finite(f_value))
-                throw error("The objective function generated non-finite outputs");
-            if (!is_finite(g))
-                throw error("The objective function generated non-finite outputs");
-        }
+        DLIB_CASSERT (
+            is_col_vector(x) && derivative_eps > 0,
+            "\tdouble find_max_using_approximate_derivatives()"
+            << "\n\tYou have to supply column vectors to this function"
+            << "\n\tx.nc():         " << x.nc()
+            << "\n\tderivative_eps: " << derivative_eps 
+        );
 
-        return f_value;
+        // Just negate the necessary things and call the find_min version of this function.
+        return -find_min_using_approximate_derivatives(
+            search_strategy, 
+            stop_strategy, 
+            negate_function(f),
+            x,
+            -max_f,
+            derivative_eps
+        );
     }
 
-// ----------------------------------------------------------------------------------------
-
     template <
         typename search_strategy_type,
         typename stop_strategy_type,
@@ -353,6 +601,7 @@ namespace dlib
         typename T
         >
     double find_max_using_approximate_derivatives (
+        thread_pool& tp,
         search_strategy_type search_strategy,
         stop_strategy_type stop_strategy,
         const funct& f,
@@ -375,6 +624,7 @@ namespace dlib
 
         // Just negate the necessary things and call the find_min version of this function.
         return -find_min_using_approximate_derivatives(
+            tp,
             search_strategy, 
             stop_strategy, 
             negate_function(f),
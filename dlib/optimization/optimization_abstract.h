@@ -68,6 +68,76 @@ namespace dlib
             - returns derivative(f, 1e-7)
     !*/
 
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename funct
+        >
+    class parallel_central_differences;
+    /*!
+        This is a function object that represents the derivative of some other function,
+        just like central_differences.  The only difference is that the function
+        evaluations needed to approximate a gradient are run in parallel on a thread_pool.
+    !*/
+
+    template <
+        typename funct
+        >
+    const parallel_central_differences<funct> derivative(
+        thread_pool& tp,
+        const funct& f, 
+        double eps = 1e-7
+    );
+    /*!
+        requires
+            - f meets the requirements of derivative(f,eps) defined above.
+            - It must be safe to call f concurrently from multiple threads.
+            - eps > 0
+        ensures
+            - returns a function that computes exactly the same thing as derivative(f,eps)
+              except that the 2*x.size() evaluations of f needed to compute the derivative
+              at x are spread over the threads in tp.  This is useful when evaluating f is
+              expensive.  
+            - The returned object holds references to tp and f, so they must outlive it.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename funct
+        >
+    class batched_central_differences;
+    /*!
+        This is a function object that represents the gradient of some other function.
+        Unlike central_differences, it gets all the function values it needs from a
+        single call to a batched version of that function.
+    !*/
+
+    template <
+        typename funct
+        >
+    const batched_central_differences<funct> batched_derivative(
+        const funct& f, 
+        double eps = 1e-7
+    );
+    /*!
+        requires
+            - f must have the form:
+                R f(const std::vector<M>& points) 
+              where M is a dlib::matrix column vector and R is either a std::vector<double>
+              or a dlib::matrix<double,0,1>.  It must return the value of the function
+              being differentiated at each of the given points.  That is, f(points)[i] is
+              the value of the function at points[i].
+            - eps > 0
+        ensures
+            - returns a function that represents the gradient of the function f computes.
+              When evaluated at a column vector x it calls f once, with 2*x.size() points,
+              and computes the same thing as derivative(g,eps)(x), where g is the
+              single point version of the function.  This lets f evaluate all the
+              perturbed points at once, e.g. using vectorized code or a GPU.
+            - The returned object holds a reference to f, so f must outlive it.
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
     template <
@@ -218,6 +288,34 @@ namespace dlib
               information.
     !*/
 
+
+    template <
+        typename search_strategy_type,
+        typename stop_strategy_type,
+        typename funct,
+        typename T
+        >
+    double find_min_using_approximate_derivatives (
+        thread_pool& tp,
+        search_strategy_type search_strategy,
+        stop_strategy_type stop_strategy,
+        const funct& f,
+        T& x,
+        double min_f,
+        double derivative_eps = 1e-7
+    );
+    /*!
+        requires
+            - The requirements of find_min_using_approximate_derivatives(search_strategy,
+              stop_strategy, f, x, min_f, derivative_eps) are satisfied.
+            - It must be safe to call f concurrently from multiple threads.
+        ensures
+            - This function is identical to the find_min_using_approximate_derivatives()
+              routine defined above except that it uses dlib::derivative(tp,f,derivative_eps)
+              to compute gradient information.  That is, the function evaluations needed
+              for each gradient are done in parallel by tp.
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
     template <
@@ -260,6 +358,33 @@ namespace dlib
               value.
     !*/
 
+    template <
+        typename search_strategy_type,
+        typename stop_strategy_type,
+        typename funct,
+        typename T
+        >
+    double find_max_using_approximate_derivatives (
+        thread_pool& tp,
+        search_strategy_type search_strategy,
+        stop_strategy_type stop_strategy,
+        const funct& f,
+        T& x,
+        double max_f,
+        double derivative_eps = 1e-7
+    );
+    /*!
+        requires
+            - The requirements of find_max_using_approximate_derivatives(search_strategy,
+              stop_strategy, f, x, max_f, derivative_eps) are satisfied.
+            - It must be safe to call f concurrently from multiple threads.
+        ensures
+            - This function is identical to the find_max_using_approximate_derivatives()
+              routine defined above except that it uses dlib::derivative(tp,f,derivative_eps)
+              to compute gradient information.  That is, the function evaluations needed
+              for each gradient are done in parallel by tp.
+    !*/
+
 // ----------------------------------------------------------------------------------------
 // ----------------------------------------------------------------------------------------
 //                  Functions that perform box constrained optimization 
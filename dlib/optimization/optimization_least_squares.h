@@ -4,7 +4,14 @@
 #define DLIB_OPTIMIZATION_LEAST_SQuARES_H_h_
 
 #include "../matrix.h"
+#include "../threads/thread_pool_extension.h"
+#include "../threads/parallel_for_extension.h"
 #include "optimization_trust_region.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
 #include "optimization_least_squares_abstract.h"
 
 namespace dlib
@@ -336,6 +343,341 @@ namespace dlib
                                      radius);
     }
 
+// ----------------------------------------------------------------------------------------
+// ----------------------------------------------------------------------------------------
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        template <typename type>
+        struct sparse_jacobian
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    This is a sparse Jacobian matrix J stored both row by row (i.e. the
+                    gradient of each residual) and column by column, so that J*v and
+                    trans(J)*v can each be computed in parallel without any locking.
+            !*/
+
+            long num_cols = 0;
+            std::vector<long> row_start, col_start;
+            std::vector<std::pair<long,type>> rows, cols;
+
+            template <typename vect_type>
+            void multiply (
+                thread_pool& tp,
+                const vect_type& v,
+                matrix<type,0,1>& out
+            ) const
+            /*!
+                ensures
+                    - #out == J*v
+            !*/
+            {
+                out.set_size(row_start.size()-1);
+                parallel_for_blocked(tp, 0, out.size(), [&](long begin, long end)
+                {
+                    for (long r = begin; r < end; ++r)
+                    {
+                        type temp = 0;
+                        for (long k = row_start[r]; k < row_start[r+1]; ++k)
+                            temp += rows[k].second*v(rows[k].first);
+                        out(r) = temp;
+                    }
+                }, 1);
+            }
+
+            template <typename vect_type, typename out_type>
+            void multiply_transpose (
+                thread_pool& tp,
+                const vect_type& v,
+                out_type& out
+            ) const
+            /*!
+                ensures
+                    - #out == trans(J)*v
+            !*/
+            {
+                out.set_size(num_cols);
+                parallel_for_blocked(tp, 0, out.size(), [&](long begin, long end)
+                {
+                    for (long c = begin; c < end; ++c)
+                    {
+                        type temp = 0;
+                        for (long k = col_start[c]; k < col_start[c+1]; ++k)
+                            temp += cols[k].second*v(cols[k].first);
+                        out(c) = temp;
+                    }
+                }, 1);
+            }
+        };
+
+        template <
+            typename type,
+            typename funct_type,
+            typename vector_type,
+            typename T
+            >
+        type compute_residuals (
+            thread_pool& tp,
+            const funct_type& f,
+            const vector_type& list,
+            const T& x,
+            matrix<type,0,1>& r
+        )
+        /*!
+            ensures
+                - #r(i) == f(list(i), x)
+                - returns 0.5*sum(squared(#r)), i.e. the least squares objective.
+        !*/
+        {
+            r.set_size(list.size());
+            parallel_for_blocked(tp, 0, list.size(), [&](long begin, long end)
+            {
+                for (long i = begin; i < end; ++i)
+                    r(i) = f(list(i), x);
+            });
+            return 0.5*dot(r,r);
+        }
+
+        template <
+            typename type,
+            typename funct_der_type,
+            typename vector_type,
+            typename T
+            >
+        void compute_sparse_jacobian (
+            thread_pool& tp,
+            const funct_der_type& der,
+            const vector_type& list,
+            const T& x,
+            sparse_jacobian<type>& J
+        )
+        {
+            const long num_rows = list.size();
+            J.num_cols = x.size();
+
+            // Ask for the gradient of each residual in parallel.  We don't know how many
+            // non-zero elements each one has ahead of time so put them into per row
+            // buffers first.
+            std::vector<std::vector<std::pair<long,type>>> row_bufs(num_rows);
+            parallel_for_blocked(tp, 0, num_rows, [&](long begin, long end)
+            {
+                for (long i = begin; i < end; ++i)
+                {
+                    const auto g = der(list(i), x);
+                    for (auto& v : g)
+                    {
+                        DLIB_ASSERT(0 <= (long)v.first && (long)v.first < x.size(),
+                            "\t double solve_sparse_least_squares_lm()"
+                            << "\n\t The derivative function returned an invalid index."
+                            << "\n\t i:          " << i
+                            << "\n\t v.first:    " << v.first
+                            << "\n\t x.size():   " << x.size()
+                        );
+                        row_bufs[i].push_back(std::make_pair((long)v.first, (type)v.second));
+                    }
+                }
+            });
+
+            J.row_start.assign(num_rows+1, 0);
+            for (long i = 0; i < num_rows; ++i)
+                J.row_start[i+1] = J.row_start[i] + row_bufs[i].size();
+            J.rows.resize(J.row_start[num_rows]);
+            for (long i = 0; i < num_rows; ++i)
+                std::copy(row_bufs[i].begin(), row_bufs[i].end(), J.rows.begin()+J.row_start[i]);
+
+            // now make the transposed copy
+            J.col_start.assign(J.num_cols+1, 0);
+            for (auto& v : J.rows)
+                ++J.col_start[v.first+1];
+            for (long c = 0; c < J.num_cols; ++c)
+                J.col_start[c+1] += J.col_start[c];
+            J.cols.resize(J.rows.size());
+            std::vector<long> next(J.col_start.begin(), J.col_start.end()-1);
+            for (long i = 0; i < num_rows; ++i)
+            {
+                for (long k = J.row_start[i]; k < J.row_start[i+1]; ++k)
+                    J.cols[next[J.rows[k].first]++] = std::make_pair(i, J.rows[k].second);
+            }
+        }
+
+        template <typename type, typename EXP>
+        void solve_damped_normal_equations (
+            thread_pool& tp,
+            const sparse_jacobian<type>& J,
+            const matrix<type,0,1>& D,
+            const type lambda,
+            const matrix_exp<EXP>& g,
+            matrix<type,0,1>& delta
+        )
+        /*!
+            requires
+                - D == the diagonal of trans(J)*J
+                - lambda > 0
+            ensures
+                - Let DF be D with every element smaller than a small fraction of max(D)
+                  raised to that fraction, or with all elements set to 1 if D is all
+                  zeros.  Then this function uses Jacobi preconditioned conjugate gradient
+                  to find #delta such that:
+                    (trans(J)*J + lambda*diagm(DF))*#delta == -g
+                  We never form trans(J)*J since it can be much denser than J.  Instead,
+                  each product with it is done as trans(J)*(J*v).
+        !*/
+        {
+            const long n = g.size();
+
+            // Parameters that don't affect any residual give zero, or nearly zero,
+            // elements of D.  Floor them so the damped system stays positive definite
+            // and the preconditioner stays finite.
+            const type max_D = (n != 0) ? max(D) : 0;
+            const type floor_D = (max_D > 0) ? max_D*std::numeric_limits<type>::epsilon() : 1;
+            matrix<type,0,1> DF(n), precond(n);
+            for (long i = 0; i < n; ++i)
+            {
+                DF(i) = std::max(D(i), floor_D);
+                // The diagonal of the system matrix is D(i) + lambda*DF(i).
+                precond(i) = 1/(D(i) + lambda*DF(i));
+            }
+
+            delta.set_size(n);
+            delta = 0;
+            matrix<type,0,1> res = -g;
+            matrix<type,0,1> z = pointwise_multiply(precond, res);
+            matrix<type,0,1> p = z;
+            matrix<type,0,1> Jp, Ap;
+            type rz = dot(res,z);
+            const type stop_norm = 1e-10*length(g);
+            for (long iter = 0; iter < n && length(res) > stop_norm; ++iter)
+            {
+                J.multiply(tp, p, Jp);
+                J.multiply_transpose(tp, Jp, Ap);
+                Ap += lambda*pointwise_multiply(DF, p);
+
+                const type pAp = dot(p,Ap);
+                if (!(pAp > 0))
+                    break;
+                const type alpha = rz/pAp;
+                delta += alpha*p;
+                res -= alpha*Ap;
+
+                z = pointwise_multiply(precond, res);
+                const type rz_new = dot(res,z);
+                p = z + (rz_new/rz)*p;
+                rz = rz_new;
+            }
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename stop_strategy_type,
+        typename funct_type,
+        typename funct_der_type,
+        typename vector_type,
+        typename T
+        >
+    double solve_sparse_least_squares_lm (
+        stop_strategy_type stop_strategy,
+        const funct_type& f,
+        const funct_der_type& der,
+        const vector_type& list,
+        T& x, 
+        unsigned long num_threads = 1
+    )
+    {
+        // The starting point (i.e. x) must be a column vector.  
+        COMPILE_TIME_ASSERT(T::NC <= 1);
+
+        // make sure requires clause is not broken
+        DLIB_ASSERT(is_vector(mat(list)) && list.size() > 0 && 
+                    is_col_vector(x) && num_threads > 0,
+            "\t double solve_sparse_least_squares_lm()"
+            << "\n\t invalid arguments were given to this function"
+            << "\n\t is_vector(list):  " << is_vector(mat(list)) 
+            << "\n\t list.size():      " << list.size() 
+            << "\n\t is_col_vector(x): " << is_col_vector(x) 
+            << "\n\t num_threads:      " << num_threads
+            );
+
+        typedef typename T::type type;
+        thread_pool tp(num_threads > 1 ? num_threads : 0);
+        const auto& samples = mat(list);
+
+        matrix<type,0,1> r, r_new, D, delta, Jdelta;
+        T g;
+        impl::sparse_jacobian<type> J;
+
+        type f_value = impl::compute_residuals(tp, f, samples, x, r);
+        if (!is_finite(f_value))
+            throw error("The objective function generated non-finite outputs");
+
+        auto update_derivatives = [&]()
+        {
+            impl::compute_sparse_jacobian(tp, der, samples, x, J);
+            J.multiply_transpose(tp, r, g);
+            if (!is_finite(g))
+                throw error("The objective function generated non-finite outputs");
+
+            // Marquardt's scaling.  solve_damped_normal_equations() takes care of
+            // parameters that don't affect any residual and so have D(c) == 0.
+            D.set_size(x.size());
+            for (long c = 0; c < J.num_cols; ++c)
+            {
+                type temp = 0;
+                for (long k = J.col_start[c]; k < J.col_start[c+1]; ++k)
+                    temp += J.cols[k].second*J.cols[k].second;
+                D(c) = temp;
+            }
+        };
+        update_derivatives();
+
+        // The damping schedule is the one from Nielsen's "Damping Parameter in
+        // Marquardt's Method", which is what most modern LM codes use.
+        type lambda = 1e-3;
+        type nu = 2;
+        T x_new;
+        while (stop_strategy.should_continue_search(x, f_value, g))
+        {
+            bool took_step = false;
+            while (lambda < 1e30)
+            {
+                impl::solve_damped_normal_equations(tp, J, D, lambda, g, delta);
+                x_new = x + delta;
+                const type f_new = impl::compute_residuals(tp, f, samples, x_new, r_new);
+
+                // The decrease in the objective predicted by the linear model of r().
+                J.multiply(tp, delta, Jdelta);
+                const type predicted = -dot(g,delta) - 0.5*dot(Jdelta,Jdelta);
+
+                if (is_finite(f_new) && f_new < f_value && predicted > 0)
+                {
+                    const type rho = (f_value - f_new)/predicted;
+                    lambda *= std::max<type>(1.0/3, 1 - std::pow(2*rho-1, 3));
+                    nu = 2;
+                    x.swap(x_new);
+                    r.swap(r_new);
+                    f_value = f_new;
+                    took_step = true;
+                    break;
+                }
+
+                lambda *= nu;
+                nu *= 2;
+            }
+
+            // If no amount of damping makes the objective go down then we are at a
+            // minimum, to within the precision of the computations.
+            if (!took_step)
+                break;
+
+            update_derivatives();
+        }
+
+        return f_value;
+    }
+
 // ----------------------------------------------------------------------------------------
 
 }
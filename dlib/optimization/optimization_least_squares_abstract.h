@@ -103,6 +103,64 @@ namespace dlib
             - returns g(#x). 
     !*/
 
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename stop_strategy_type,
+        typename funct_type,
+        typename funct_der_type,
+        typename vector_type,
+        typename T
+        >
+    double solve_sparse_least_squares_lm (
+        stop_strategy_type stop_strategy,
+        const funct_type& f,
+        const funct_der_type& der,
+        const vector_type& list,
+        T& x, 
+        unsigned long num_threads = 1
+    );
+    /*!
+        requires
+            - stop_strategy == an object that defines a stop strategy such as one of 
+              the objects from dlib/optimization/optimization_stop_strategies_abstract.h
+            - list == a matrix or something convertible to a matrix via mat()
+              such as a std::vector.
+            - is_vector(list) == true
+            - list.size() > 0
+            - is_col_vector(x) == true
+            - num_threads > 0
+            - for all valid i:
+                - f(list(i),x) must be a valid expression that evaluates to a floating point value.
+                - der(list(i),x) must be a valid expression that evaluates to the derivative of f(list(i),x) 
+                  with respect to x.  This derivative must take the form of a sparse vector,
+                  as defined in dlib/svm/sparse_vector_abstract.h (e.g. a
+                  std::vector<std::pair<unsigned long,double>>), whose indices are all < x.size().
+            - It must be safe to call f() and der() concurrently from multiple threads.
+        ensures
+            - This function performs an unconstrained minimization of the least squares
+              function g(x) defined by:
+                - g(x) = sum over all i: 0.5*pow( f(list(i),x), 2 )
+            - This is a Levenberg-Marquardt method intended for large problems where each
+              residual depends on only a few of the variables, such as bundle adjustment.
+              It never creates a dense Jacobian or a dense approximation to the hessian
+              of g().  Instead, the Jacobian is stored as a sparse matrix and each
+              damped Gauss-Newton step is found by Jacobi preconditioned conjugate
+              gradient, which only needs products with the Jacobian and its transpose.
+              So the memory and time needed per iteration are roughly proportional to
+              the number of non-zero entries in the Jacobian.
+            - Like solve_least_squares_lm(), it is most appropriate for small residual
+              problems (i.e. problems where f() goes to 0 at the solution).
+            - The residuals and Jacobian rows, as well as the sparse matrix products,
+              are computed using num_threads threads.  The result does not depend on
+              num_threads.
+            - The function is optimized until stop_strategy decides that an acceptable 
+              point has been found or no amount of damping produces a step that
+              reduces g().
+            - #x == the value of x that was found to minimize g()
+            - returns g(#x). 
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
 }
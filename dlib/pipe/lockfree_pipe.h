@@ -0,0 +1,678 @@
+// Copyright (C) 2018  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_LOCKFREE_PIPe_Hh_
+#define DLIB_LOCKFREE_PIPe_Hh_
+
+#include "lockfree_pipe_abstract.h"
+#include "../algs.h"
+#include "../assert.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        const unsigned long lockfree_pipe_cache_line = 64;
+        const unsigned long lockfree_pipe_spin_count = 64;
+
+        inline void lockfree_pipe_pause (
+            unsigned long iteration
+        )
+        {
+            // Busy wait for the first few rounds since the other side usually shows up
+            // within a few hundred cycles.  After that give the core away, which also
+            // keeps things moving when there are more threads than cores.
+            if (iteration < 32)
+            {
+#if defined(__x86_64__) || defined(_M_X64)
+                _mm_pause();
+#endif
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+
+    // ------------------------------------------------------------------------------------
+
+        template <typename T>
+        class spsc_ring
+        {
+            /*!
+                CONVENTION
+                    - head and tail count the total number of dequeues and enqueues ever
+                      done.  Only the consumer writes head and only the producer writes
+                      tail.  The item at position i lives in data[i&mask].
+                    - tail_cache is the consumer's last look at tail and head_cache is the
+                      producer's last look at head, so the hot paths only touch the other
+                      side's cache line when the ring looks empty or full.
+            !*/
+        public:
+            typedef T type;
+
+            explicit spsc_ring (
+                unsigned long maximum_size
+            ) : cap(maximum_size), mask(ring_size(maximum_size)-1), data(new T[mask+1]),
+                head(0), tail_cache(0), tail(0), head_cache(0)
+            {}
+
+            bool try_push (
+                T& item
+            )
+            {
+                const std::size_t t = tail.load(std::memory_order_relaxed);
+                if (t - head_cache == cap)
+                {
+                    head_cache = head.load(std::memory_order_acquire);
+                    if (t - head_cache == cap)
+                        return false;
+                }
+                exchange(item, data[t&mask]);
+                tail.store(t+1, std::memory_order_release);
+                return true;
+            }
+
+            bool try_pop (
+                T& item
+            )
+            {
+                const std::size_t h = head.load(std::memory_order_relaxed);
+                if (h == tail_cache)
+                {
+                    tail_cache = tail.load(std::memory_order_acquire);
+                    if (h == tail_cache)
+                        return false;
+                }
+                exchange(item, data[h&mask]);
+                head.store(h+1, std::memory_order_release);
+                return true;
+            }
+
+            unsigned long size (
+            ) const
+            {
+                const std::size_t h = head.load(std::memory_order_acquire);
+                const std::size_t t = tail.load(std::memory_order_acquire);
+                return static_cast<unsigned long>(std::min<std::size_t>(t-h, cap));
+            }
+
+            unsigned long capacity (
+            ) const { return cap; }
+
+        private:
+            static std::size_t ring_size (
+                unsigned long n
+            )
+            {
+                std::size_t s = 1;
+                while (s < n)
+                    s <<= 1;
+                return s;
+            }
+
+            const std::size_t cap;
+            const std::size_t mask;
+            const std::unique_ptr<T[]> data;
+
+            char pad0[lockfree_pipe_cache_line];
+            std::atomic<std::size_t> head;
+            std::size_t tail_cache;
+            char pad1[lockfree_pipe_cache_line];
+            std::atomic<std::size_t> tail;
+            std::size_t head_cache;
+            char pad2[lockfree_pipe_cache_line];
+        };
+
+    // ------------------------------------------------------------------------------------
+
+        template <typename T>
+        class mpmc_ring
+        {
+            /*!
+                CONVENTION
+                    - This is the bounded queue from Dmitry Vyukov's "Bounded MPMC queue".
+                      head and tail count the dequeue and enqueue positions handed out so
+                      far and the item at position i lives in cells[i%cap].
+                    - cells[i%cap].seq == 2*i means the cell is free for the enqueue at
+                      position i, seq == 2*i+1 means it holds the item for the dequeue at
+                      position i, and the dequeue then sets it to 2*(i+cap) to hand the
+                      cell to the next lap's enqueue.  (Vyukov uses i, i+1, and i+cap,
+                      but with cap == 1 "full at i" and "free at i+1" would then be the
+                      same value.)
+            !*/
+        public:
+            typedef T type;
+
+            explicit mpmc_ring (
+                unsigned long maximum_size
+            ) : cap(maximum_size), cells(new cell[maximum_size]), head(0), tail(0)
+            {
+                for (std::size_t i = 0; i < cap; ++i)
+                    cells[i].seq.store(2*i, std::memory_order_relaxed);
+            }
+
+            bool try_push (
+                T& item
+            )
+            {
+                std::size_t pos = tail.load(std::memory_order_relaxed);
+                cell* c;
+                while (true)
+                {
+                    c = &cells[pos%cap];
+                    const std::size_t seq = c->seq.load(std::memory_order_acquire);
+                    const std::ptrdiff_t dif = static_cast<std::ptrdiff_t>(seq - 2*pos);
+                    if (dif == 0)
+                    {
+                        if (tail.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed))
+                            break;
+                    }
+                    else if (dif < 0)
+                    {
+                        return false;
+                    }
+                    else
+                    {
+                        pos = tail.load(std::memory_order_relaxed);
+                    }
+                }
+                exchange(item, c->data);
+                c->seq.store(2*pos+1, std::memory_order_release);
+                return true;
+            }
+
+            bool try_pop (
+                T& item
+            )
+            {
+                std::size_t pos = head.load(std::memory_order_relaxed);
+                cell* c;
+                while (true)
+                {
+                    c = &cells[pos%cap];
+                    const std::size_t seq = c->seq.load(std::memory_order_acquire);
+                    const std::ptrdiff_t dif = static_cast<std::ptrdiff_t>(seq - (2*pos+1));
+                    if (dif == 0)
+                    {
+                        if (head.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed))
+                            break;
+                    }
+                    else if (dif < 0)
+                    {
+                        return false;
+                    }
+                    else
+                    {
+                        pos = head.load(std::memory_order_relaxed);
+                    }
+                }
+                exchange(item, c->data);
+                c->seq.store(2*(pos+cap), std::memory_order_release);
+                return true;
+            }
+
+            unsigned long size (
+            ) const
+            {
+                const std::size_t h = head.load(std::memory_order_acquire);
+                const std::size_t t = tail.load(std::memory_order_acquire);
+                if (t <= h)
+                    return 0;
+                return static_cast<unsigned long>(std::min<std::size_t>(t-h, cap));
+            }
+
+            unsigned long capacity (
+            ) const { return cap; }
+
+        private:
+            struct cell
+            {
+                std::atomic<std::size_t> seq;
+                T data;
+            };
+
+            const std::size_t cap;
+            const std::unique_ptr<cell[]> cells;
+
+            char pad0[lockfree_pipe_cache_line];
+            std::atomic<std::size_t> head;
+            char pad1[lockfree_pipe_cache_line];
+            std::atomic<std::size_t> tail;
+            char pad2[lockfree_pipe_cache_line];
+        };
+
+    // ------------------------------------------------------------------------------------
+
+        template <typename ring_type>
+        class lockfree_pipe_base
+        {
+            /*!
+                CONVENTION
+                    - ring holds the items.  Its try_push()/try_pop() never block, so when
+                      the pipe has room (or something in it) enqueue() and dequeue() never
+                      touch m.
+                    - enqueue_blocked/dequeue_blocked == the number of threads that found
+                      the ring full/empty and haven't yet returned from enqueue()/dequeue().
+                      They are only decremented by leave_blocked(), while holding m, as the
+                      last thing such a thread does to *this.  So once the destructor sees
+                      both at zero while holding m no blocked thread will touch *this again.
+                    - enqueue_sleepers/dequeue_sleepers == the number of those threads that
+                      are, or are about to be, waiting on not_full/not_empty.  They
+                      increment the count, issue a full fence and only then recheck the
+                      ring, while the other side pushes/pops, issues a full fence and
+                      then reads the count.  So at least one of them always sees the
+                      other, and since the notify is done while holding m no wake up is
+                      lost.
+                    - watchers == the number of threads in wait_until_empty(),
+                      wait_for_num_blocked_dequeues() and the destructor.  They wait on
+                      state_changed, which is signaled whenever something they look at
+                      may have changed, including watchers itself once the pipe has been
+                      disabled.
+            !*/
+        public:
+            typedef typename ring_type::type type;
+
+            explicit lockfree_pipe_base (
+                unsigned long maximum_size
+            ) :
+                ring(maximum_size),
+                enabled(true),
+                enqueue_enabled(true),
+                dequeue_enabled(true),
+                enqueue_blocked(0),
+                dequeue_blocked(0),
+                enqueue_sleepers(0),
+                dequeue_sleepers(0),
+                watchers(0)
+            {
+                // make sure requires clause is not broken
+                DLIB_ASSERT(maximum_size > 0,
+                    "\t lockfree pipe::pipe(maximum_size)"
+                    << "\n\t A lock free pipe must be able to hold at least one item."
+                    << "\n\t this: " << this
+                    );
+            }
+
+            virtual ~lockfree_pipe_base (
+            )
+            {
+                disable();
+
+                std::unique_lock<std::mutex> lock(m);
+                ++watchers;
+                while (enqueue_blocked.load() > 0 || dequeue_blocked.load() > 0 || watchers.load() > 1)
+                    state_changed.wait(lock);
+                --watchers;
+            }
+
+            void empty (
+            )
+            {
+                type temp = type();
+                while (ring.try_pop(temp))
+                {}
+                after_pop();
+            }
+
+            void wait_until_empty (
+            ) const
+            {
+                std::unique_lock<std::mutex> lock(m);
+                ++watchers;
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                while (ring.size() != 0 && enabled && dequeue_enabled)
+                    state_changed.wait(lock);
+                leave_watchers();
+            }
+
+            void wait_for_num_blocked_dequeues (
+                unsigned long num
+            ) const
+            {
+                std::unique_lock<std::mutex> lock(m);
+                ++watchers;
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                while ((dequeue_blocked.load() < num || ring.size() != 0) && enabled && dequeue_enabled)
+                    state_changed.wait(lock);
+                leave_watchers();
+            }
+
+            void enable (
+            ) { enabled = true; }
+
+            void disable (
+            )
+            {
+                enabled = false;
+                std::lock_guard<std::mutex> lock(m);
+                not_empty.notify_all();
+                not_full.notify_all();
+                state_changed.notify_all();
+            }
+
+            bool is_enabled (
+            ) const { return enabled; }
+
+            bool is_enqueue_enabled (
+            ) const { return enqueue_enabled; }
+
+            void disable_enqueue (
+            )
+            {
+                enqueue_enabled = false;
+                std::lock_guard<std::mutex> lock(m);
+                not_full.notify_all();
+            }
+
+            void enable_enqueue (
+            ) { enqueue_enabled = true; }
+
+            bool is_dequeue_enabled (
+            ) const { return dequeue_enabled; }
+
+            void disable_dequeue (
+            )
+            {
+                dequeue_enabled = false;
+                std::lock_guard<std::mutex> lock(m);
+                not_empty.notify_all();
+                state_changed.notify_all();
+            }
+
+            void enable_dequeue (
+            ) { dequeue_enabled = true; }
+
+            unsigned long max_size (
+            ) const { return ring.capacity(); }
+
+            unsigned long size (
+            ) const { return ring.size(); }
+
+            bool enqueue (
+                type& item
+            ) { return enqueue_impl(item, false, 0); }
+
+            bool enqueue (
+                type&& item
+            ) { return enqueue(item); }
+
+            bool enqueue_or_timeout (
+                type& item,
+                unsigned long timeout
+            ) { return enqueue_impl(item, true, timeout); }
+
+            bool enqueue_or_timeout (
+                type&& item,
+                unsigned long timeout
+            ) { return enqueue_or_timeout(item,timeout); }
+
+            bool dequeue (
+                type& item
+            ) { return dequeue_impl(item, false, 0); }
+
+            bool dequeue_or_timeout (
+                type& item,
+                unsigned long timeout
+            ) { return dequeue_impl(item, true, timeout); }
+
+        private:
+
+            bool enqueue_impl (
+                type& item,
+                bool use_timeout,
+                unsigned long timeout
+            )
+            {
+                if (!(enabled && enqueue_enabled))
+                    return false;
+
+                if (ring.try_push(item))
+                {
+                    after_push();
+                    return true;
+                }
+                if (use_timeout && timeout == 0)
+                    return false;
+
+                const bool result = wait_for_op([&]() { return ring.try_push(item); }, enqueue_enabled,
+                                                enqueue_blocked, enqueue_sleepers, not_full, false,
+                                                use_timeout, timeout);
+                if (result)
+                    after_push();
+                leave_blocked(enqueue_blocked);
+                return result;
+            }
+
+            bool dequeue_impl (
+                type& item,
+                bool use_timeout,
+                unsigned long timeout
+            )
+            {
+                if (!(enabled && dequeue_enabled))
+                    return false;
+
+                if (ring.try_pop(item))
+                {
+                    after_pop();
+                    return true;
+                }
+                if (use_timeout && timeout == 0)
+                    return false;
+
+                const bool result = wait_for_op([&]() { return ring.try_pop(item); }, dequeue_enabled,
+                                                dequeue_blocked, dequeue_sleepers, not_empty, true,
+                                                use_timeout, timeout);
+                if (result)
+                    after_pop();
+                leave_blocked(dequeue_blocked);
+                return result;
+            }
+
+            template <typename op_type>
+            bool wait_for_op (
+                const op_type& op,
+                const std::atomic<bool>& side_enabled,
+                std::atomic<unsigned long>& blocked,
+                std::atomic<unsigned long>& sleepers,
+                std::condition_variable& cv,
+                bool is_dequeue,
+                bool use_timeout,
+                unsigned long timeout
+            )
+            /*!
+                ensures
+                    - increments blocked, then spins and sleeps until op() returns true,
+                      this side of the pipe is disabled, or the timeout expires.  Returns
+                      true if op() succeeded.
+                    - the caller must call leave_blocked(blocked) once it is done with
+                      *this.
+            !*/
+            {
+                const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+                ++blocked;
+                if (is_dequeue)
+                    notify_watchers();
+
+                bool result = false;
+                for (unsigned long i = 0; i < lockfree_pipe_spin_count; ++i)
+                {
+                    if (!(enabled && side_enabled))
+                        break;
+                    lockfree_pipe_pause(i);
+                    if (op())
+                    {
+                        result = true;
+                        break;
+                    }
+                }
+
+                if (!result)
+                {
+                    std::unique_lock<std::mutex> lock(m);
+                    while (enabled && side_enabled)
+                    {
+                        ++sleepers;
+                        std::atomic_thread_fence(std::memory_order_seq_cst);
+                        if (op())
+                        {
+                            --sleepers;
+                            result = true;
+                            break;
+                        }
+
+                        // Someone may have emptied the pipe without us noticing, which is
+                        // what wait_for_num_blocked_dequeues() is looking for.
+                        if (is_dequeue && watchers.load() > 0)
+                            state_changed.notify_all();
+
+                        if (use_timeout)
+                        {
+                            if (cv.wait_until(lock, deadline) == std::cv_status::timeout)
+                            {
+                                --sleepers;
+                                result = enabled && side_enabled && op();
+                                break;
+                            }
+                        }
+                        else
+                        {
+                            cv.wait(lock);
+                        }
+                        --sleepers;
+                    }
+                }
+
+                return result;
+            }
+
+            void leave_blocked (
+                std::atomic<unsigned long>& blocked
+            )
+            {
+                // The destructor may be waiting for blocked to reach zero.  Doing the
+                // decrement and the notify while holding m means it can't wake up and
+                // destroy *this until we have let go of m, which is the last member we
+                // touch.
+                std::lock_guard<std::mutex> lock(m);
+                --blocked;
+                state_changed.notify_all();
+            }
+
+            void leave_watchers (
+            ) const
+            /*!
+                requires
+                    - m is locked by the calling thread
+            !*/
+            {
+                --watchers;
+                if (!enabled)
+                    state_changed.notify_all();
+            }
+
+            void after_push (
+            )
+            {
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (dequeue_sleepers.load(std::memory_order_relaxed) > 0)
+                {
+                    std::lock_guard<std::mutex> lock(m);
+                    not_empty.notify_one();
+                }
+            }
+
+            void after_pop (
+            )
+            {
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (enqueue_sleepers.load(std::memory_order_relaxed) > 0 ||
+                    watchers.load(std::memory_order_relaxed) > 0)
+                {
+                    std::lock_guard<std::mutex> lock(m);
+                    not_full.notify_one();
+                    state_changed.notify_all();
+                }
+            }
+
+            void notify_watchers (
+            ) const
+            {
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (watchers.load(std::memory_order_relaxed) > 0)
+                {
+                    std::lock_guard<std::mutex> lock(m);
+                    state_changed.notify_all();
+                }
+            }
+
+            ring_type ring;
+
+            std::atomic<bool> enabled;
+            std::atomic<bool> enqueue_enabled;
+            std::atomic<bool> dequeue_enabled;
+
+            std::atomic<unsigned long> enqueue_blocked;
+            std::atomic<unsigned long> dequeue_blocked;
+            std::atomic<unsigned long> enqueue_sleepers;
+            std::atomic<unsigned long> dequeue_sleepers;
+            mutable std::atomic<unsigned long> watchers;
+
+            mutable std::mutex m;
+            std::condition_variable not_empty;
+            std::condition_variable not_full;
+            mutable std::condition_variable state_changed;
+
+            // restricted functions
+            lockfree_pipe_base(const lockfree_pipe_base&);        // copy constructor
+            lockfree_pipe_base& operator=(const lockfree_pipe_base&);    // assignment operator
+        };
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename T
+        >
+    class spsc_pipe : public impl::lockfree_pipe_base<impl::spsc_ring<T> >
+    {
+    public:
+        explicit spsc_pipe (
+            unsigned long maximum_size
+        ) : impl::lockfree_pipe_base<impl::spsc_ring<T> >(maximum_size) {}
+    };
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename T
+        >
+    class mpmc_pipe : public impl::lockfree_pipe_base<impl::mpmc_ring<T> >
+    {
+    public:
+        explicit mpmc_pipe (
+            unsigned long maximum_size
+        ) : impl::lockfree_pipe_base<impl::mpmc_ring<T> >(maximum_size) {}
+    };
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_LOCKFREE_PIPe_Hh_
+
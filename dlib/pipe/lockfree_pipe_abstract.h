@@ -0,0 +1,163 @@
+// Copyright (C) 2018  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#undef DLIB_LOCKFREE_PIPe_ABSTRACT_Hh_
+#ifdef DLIB_LOCKFREE_PIPe_ABSTRACT_Hh_
+
+#include "pipe_kernel_abstract.h"
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename T
+        >
+    class mpmc_pipe 
+    {
+        /*!
+            REQUIREMENTS ON T
+                T must be swappable by a global swap() 
+                T must have a default constructor
+
+            INITIAL VALUE
+                size() == 0
+                is_enabled() == true
+                is_enqueue_enabled() == true
+                is_dequeue_enabled() == true
+
+            WHAT THIS OBJECT REPRESENTS
+                This object is a drop in replacement for dlib::pipe (see
+                pipe_kernel_abstract.h) for when the pipe is a throughput bottleneck.  It
+                has the same interface and the same blocking, timeout, and enable/disable
+                semantics as pipe, with the following differences:
+                    - max_size() must be greater than 0.  That is, there is no zero length
+                      "hand the item directly to the reader" mode.
+                    - The items live in a fixed size ring buffer and enqueue() and
+                      dequeue() don't lock any mutex as long as the pipe isn't full or
+                      empty respectively.
+                    - A call that can't proceed first spins for a short while and only
+                      then goes to sleep on a condition variable.  So hand offs between
+                      threads that keep up with each other never pay for a context switch.
+                    - size() is only a snapshot.  While other threads are enqueuing or
+                      dequeuing it may be off by the number of calls in progress.
+
+            THREAD SAFETY
+                All methods of this class are thread safe.  You may call them from any
+                thread and any number of threads may call them at once.
+        !*/
+
+    public:
+
+        typedef T type;
+
+        explicit mpmc_pipe (  
+            unsigned long maximum_size
+        );
+        /*!
+            requires
+                - maximum_size > 0
+            ensures                
+                - #*this is properly initialized
+                - #max_size() == maximum_size
+            throws
+                - std::bad_alloc
+        !*/
+
+        virtual ~mpmc_pipe (
+        );
+        /*!
+            ensures
+                - any resources associated with *this have been released
+                - disables (i.e. sets is_enabled() == false) this object so that 
+                  all calls currently blocking on it will return immediately. 
+        !*/
+
+        // All the remaining member functions, i.e. enable(), disable(), is_enabled(),
+        // empty(), wait_until_empty(), wait_for_num_blocked_dequeues(),
+        // is_enqueue_enabled(), disable_enqueue(), enable_enqueue(),
+        // is_dequeue_enabled(), disable_dequeue(), enable_dequeue(), max_size(), size(),
+        // enqueue(), enqueue_or_timeout(), dequeue(), and dequeue_or_timeout(), have
+        // exactly the same specification as the corresponding member of dlib::pipe.
+
+    private:
+
+        // restricted functions
+        mpmc_pipe(const mpmc_pipe&);        // copy constructor
+        mpmc_pipe& operator=(const mpmc_pipe&);    // assignment operator
+    };
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename T
+        >
+    class spsc_pipe 
+    {
+        /*!
+            REQUIREMENTS ON T
+                T must be swappable by a global swap() 
+                T must have a default constructor
+
+            INITIAL VALUE
+                size() == 0
+                is_enabled() == true
+                is_enqueue_enabled() == true
+                is_dequeue_enabled() == true
+
+            WHAT THIS OBJECT REPRESENTS
+                This object is identical to mpmc_pipe except that it is only for a single
+                producer and a single consumer.  In exchange, enqueue() and dequeue() are
+                cheaper still since they don't need any atomic read-modify-write
+                operations.
+
+            THREAD SAFETY
+                At most one thread may be calling enqueue() or enqueue_or_timeout() at
+                any given time and at most one thread may be calling dequeue(),
+                dequeue_or_timeout(), or empty() at any given time.  It does not have to
+                be the same thread each time.  All the other member functions may be
+                called by any number of threads at once.
+        !*/
+
+    public:
+
+        typedef T type;
+
+        explicit spsc_pipe (  
+            unsigned long maximum_size
+        );
+        /*!
+            requires
+                - maximum_size > 0
+            ensures                
+                - #*this is properly initialized
+                - #max_size() == maximum_size
+            throws
+                - std::bad_alloc
+        !*/
+
+        virtual ~spsc_pipe (
+        );
+        /*!
+            ensures
+                - any resources associated with *this have been released
+                - disables (i.e. sets is_enabled() == false) this object so that 
+                  all calls currently blocking on it will return immediately. 
+        !*/
+
+        // All the remaining member functions have exactly the same specification as the
+        // corresponding member of dlib::pipe.
+
+    private:
+
+        // restricted functions
+        spsc_pipe(const spsc_pipe&);        // copy constructor
+        spsc_pipe& operator=(const spsc_pipe&);    // assignment operator
+    };
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_LOCKFREE_PIPe_ABSTRACT_Hh_
+
@@ -287,7 +287,8 @@ namespace dlib
         /*!
             requires
                 - on_request() is called when there is an HTTP GET or POST request to be serviced 
-                - on_request() is run in its own thread 
+                - on_request() is run in its own thread, or on one of the server's worker threads
+                  if is_using_event_loop()
                 - is_running() == true 
                 - the number of current on_request() functions running < get_max_connection() 
                 - in incoming: 
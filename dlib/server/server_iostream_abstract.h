@@ -62,7 +62,8 @@ namespace dlib
                 - foreign_port == the foreign port number for this connection 
                 - local_ip == the IP of the local interface this connection is using
                 - local_port == the local port number for this connection
-                - on_connect() is run in its own thread 
+                - on_connect() is run in its own thread, or on one of the server's worker threads
+                  if is_using_event_loop()
                 - is_running() == true 
                 - the number of current connections < get_max_connection() 
                 - connection_id == an integer that uniquely identifies this connection. 
@@ -6,9 +6,529 @@
 #include "server_kernel.h"
 #include "../string.h"
 
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <map>
+#include <vector>
+#endif
+
 namespace dlib
 {
 
+// ----------------------------------------------------------------------------------------
+// ----------------------------------------------------------------------------------------
+    // event_loop object
+// ----------------------------------------------------------------------------------------
+// ----------------------------------------------------------------------------------------
+
+#if defined(__linux__)
+
+    class server::event_loop
+    {
+        /*!
+            CONVENTION
+                - epfd == an epoll instance.  Connections waiting for their first data
+                  and connections being closed are registered with it, using their
+                  con_state as the event data, and con_state::registered is set.  While
+                  a worker is running on_connect() for a connection it is either not
+                  registered yet or its registration is disarmed (it was added with
+                  EPOLLONESHOT).
+                - wait_for_data == true if on_connect() is only called once the foreign
+                  host has sent something, false if it is called right away.
+                - wake_fd == an eventfd registered with epfd using null event data.  It is
+                  used to wake the loop thread when closing or stop_loop changes.
+                - closing == a linked list, through con_state::next, of the connections 
+                  whose on_connect() has returned and which are waiting for the loop thread
+                  to start closing them.  
+                - m == the mutex protecting closing and stop_loop.
+                - deadlines == the connections being gracefully closed, keyed by the time
+                  at which they get closed even if the foreign host hasn't closed its end
+                  yet.  Only the loop thread touches it.
+                - for each connection owned by this object the_server.thread_count has
+                  been incremented once, and it is decremented again by
+                  close_connection().
+        !*/
+
+    public:
+
+        event_loop (
+            server& the_server_,
+            unsigned long num_worker_threads,
+            bool wait_for_data_
+        );
+
+        ~event_loop (
+        );
+        /*!
+            requires
+                - this object doesn't own any connections
+        !*/
+
+        void add_connection (
+            connection* con
+        );
+        /*!
+            requires
+                - con is in the_server.cons and the_server.thread_count has been 
+                  incremented for it
+            ensures
+                - this object takes ownership of con.  One of the worker threads calls
+                  on_connect() on con, right away or, if wait_for_data, once the foreign
+                  host has sent something.  After that con is gracefully closed.
+        !*/
+
+    private:
+
+        struct con_state;
+        typedef std::chrono::steady_clock clock_type;
+        typedef std::multimap<clock_type::time_point,con_state*> deadline_map;
+
+        struct con_state
+        {
+            explicit con_state (
+                connection* con_
+            ) : con(con_), registered(false), is_closing(false), has_deadline(false), next(0) {}
+
+            connection* con;
+            bool registered;
+            bool is_closing;
+            bool has_deadline;
+            deadline_map::iterator deadline;
+            con_state* next;
+        };
+
+        void loop (
+        );
+
+        void dispatch (
+            con_state* c
+        );
+        /*!
+            ensures
+                - hands c to one of the worker threads, which calls
+                  service_connection(c)
+        !*/
+
+        void service_connection (
+            con_state* c
+        );
+        /*!
+            ensures
+                - runs on_connect() for c and then hands c back to the loop thread
+        !*/
+
+        void begin_closing (
+            con_state* c
+        );
+
+        void drain (
+            con_state* c
+        );
+        /*!
+            requires
+                - c->is_closing == true
+            ensures
+                - reads and discards whatever the foreign host sent and calls finish(c)
+                  once it has closed its end of the connection
+        !*/
+
+        void finish (
+            con_state* c
+        );
+        /*!
+            ensures
+                - closes and deletes c->con and c
+        !*/
+
+        void close_connection (
+            connection* con
+        );
+        /*!
+            ensures
+                - removes con from the_server.cons, deletes it, and decrements 
+                  the_server.thread_count
+        !*/
+
+        void wake (
+        );
+
+        server& the_server;
+        const bool wait_for_data;
+        int epfd;
+        int wake_fd;
+        mutex m;
+        con_state* closing;
+        bool stop_loop;
+        deadline_map deadlines;
+        thread_pool workers;
+        std::unique_ptr<thread_function> loop_thread;
+
+        // restricted functions
+        event_loop(event_loop&);
+        event_loop& operator=(event_loop&);
+    };
+
+// ----------------------------------------------------------------------------------------
+
+    server::event_loop::
+    event_loop (
+        server& the_server_,
+        unsigned long num_worker_threads,
+        bool wait_for_data_
+    ) :
+        the_server(the_server_),
+        wait_for_data(wait_for_data_),
+        epfd(-1),
+        wake_fd(-1),
+        closing(0),
+        stop_loop(false),
+        workers(num_worker_threads)
+    {
+        epfd = epoll_create1(EPOLL_CLOEXEC);
+        wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+        epoll_event ev = epoll_event();
+        ev.events = EPOLLIN;
+        ev.data.ptr = 0;
+        if (epfd == -1 || wake_fd == -1 || epoll_ctl(epfd, EPOLL_CTL_ADD, wake_fd, &ev) == -1)
+        {
+            if (epfd != -1)
+                ::close(epfd);
+            if (wake_fd != -1)
+                ::close(wake_fd);
+            throw dlib::socket_error(
+                "error occurred in server::start()\nunable to create the event loop"
+            );
+        }
+
+        try
+        {
+            loop_thread.reset(new thread_function(make_mfp(*this,&event_loop::loop)));
+        }
+        catch (...)
+        {
+            ::close(epfd);
+            ::close(wake_fd);
+            throw;
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    server::event_loop::
+    ~event_loop (
+    )
+    {
+        m.lock();
+        stop_loop = true;
+        m.unlock();
+        wake();
+
+        loop_thread.reset();
+        ::close(epfd);
+        ::close(wake_fd);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void server::event_loop::
+    wake (
+    )
+    {
+        const uint64 one = 1;
+        if (::write(wake_fd, &one, sizeof(one)) != sizeof(one))
+            sdlog << LERROR << "unable to wake the server event loop";
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void server::event_loop::
+    add_connection (
+        connection* con
+    )
+    {
+        con_state* c = 0;
+        try
+        {
+            c = new con_state(con);
+        }
+        catch (std::bad_alloc&)
+        {
+            sdlog << LERROR << "We ran out of memory in server::event_loop::add_connection()";
+            close_connection(con);
+            return;
+        }
+
+        if (!wait_for_data)
+        {
+            dispatch(c);
+            return;
+        }
+
+        epoll_event ev = epoll_event();
+        ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+        ev.data.ptr = c;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, con->get_socket_descriptor(), &ev) == -1)
+        {
+            sdlog << LERROR << "unable to add a connection to the server event loop";
+            finish(c);
+            return;
+        }
+        c->registered = true;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void server::event_loop::
+    dispatch (
+        con_state* c
+    )
+    {
+        try
+        {
+            workers.add_task_by_value([this,c](){ service_connection(c); });
+        }
+        catch (std::exception& e)
+        {
+            sdlog << LERROR << "unable to start servicing a connection: " << e.what();
+            finish(c);
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void server::event_loop::
+    loop (
+    )
+    {
+        std::vector<epoll_event> events(128);
+        bool done = false;
+        while (!done)
+        {
+            int timeout = -1;
+            if (!deadlines.empty())
+            {
+                using namespace std::chrono;
+                const long long wait = duration_cast<milliseconds>(
+                    deadlines.begin()->first - clock_type::now()).count();
+                // Round up so we don't spin waiting for a deadline that is less than a
+                // millisecond away.
+                timeout = static_cast<int>(std::min<long long>(std::max<long long>(wait+1,0), 1000));
+            }
+
+            const int num = epoll_wait(epfd, &events[0], events.size(), timeout);
+            if (num == -1 && errno != EINTR)
+                sdlog << LERROR << "epoll_wait() failed in the server event loop, errno: " << errno;
+
+            for (int i = 0; i < num; ++i)
+            {
+                con_state* c = static_cast<con_state*>(events[i].data.ptr);
+                if (c == 0)
+                {
+                    uint64 junk;
+                    while (::read(wake_fd, &junk, sizeof(junk)) > 0) {}
+
+                    m.lock();
+                    c = closing;
+                    closing = 0;
+                    done = stop_loop;
+                    m.unlock();
+
+                    while (c != 0)
+                    {
+                        con_state* next = c->next;
+                        begin_closing(c);
+                        c = next;
+                    }
+                }
+                else if (c->is_closing)
+                {
+                    drain(c);
+                }
+                else
+                {
+                    // The foreign host either sent us something or closed the connection.
+                    // Peek at the socket to find out which without consuming anything
+                    // on_connect() will want to read.
+                    char ch;
+                    const long status = ::recv(c->con->get_socket_descriptor(), &ch, 1, MSG_PEEK | MSG_DONTWAIT);
+                    if (status > 0)
+                    {
+                        dispatch(c);
+                    }
+                    else if (status == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+                    {
+                        epoll_event ev = epoll_event();
+                        ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+                        ev.data.ptr = c;
+                        if (epoll_ctl(epfd, EPOLL_CTL_MOD, c->con->get_socket_descriptor(), &ev) == -1)
+                            finish(c);
+                    }
+                    else
+                    {
+                        finish(c);
+                    }
+                }
+            }
+
+            // close the connections that have had long enough to close gracefully
+            const clock_type::time_point now = clock_type::now();
+            while (!deadlines.empty() && deadlines.begin()->first <= now)
+                finish(deadlines.begin()->second);
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void server::event_loop::
+    service_connection (
+        con_state* c
+    )
+    {
+        // Since this is a worker thread there is nowhere for an exception to go, so log it
+        // rather than letting it take down the thread pool.
+        try
+        {
+            the_server.on_connect(*c->con);
+        }
+        catch (std::exception& e)
+        {
+            sdlog << LERROR << "on_connect() threw an exception: " << e.what();
+        }
+        catch (...)
+        {
+            sdlog << LERROR << "on_connect() threw an exception";
+        }
+
+        // remove this connection from cons 
+        the_server.cons_mutex.lock();
+        connection* temp;
+        if (the_server.cons.is_member(c->con))
+            the_server.cons.remove(c->con,temp);
+        the_server.cons_mutex.unlock();
+
+        m.lock();
+        c->next = closing;
+        closing = c;
+        m.unlock();
+        wake();
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void server::event_loop::
+    begin_closing (
+        con_state* c
+    )
+    {
+        c->is_closing = true;
+
+        // This is what close_gracefully() does, except that rather than blocking a
+        // thread while we wait for the foreign host to close its end we let epoll tell us
+        // when it happens.
+        const unsigned long timeout = the_server.get_graceful_close_timeout();
+        if (timeout == 0 || c->con->shutdown_outgoing())
+        {
+            finish(c);
+            return;
+        }
+
+        epoll_event ev = epoll_event();
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.ptr = c;
+        const int op = c->registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+        if (epoll_ctl(epfd, op, c->con->get_socket_descriptor(), &ev) == -1)
+        {
+            finish(c);
+            return;
+        }
+        c->registered = true;
+
+        c->deadline = deadlines.insert(std::make_pair(
+                clock_type::now() + std::chrono::milliseconds(timeout), c));
+        c->has_deadline = true;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void server::event_loop::
+    drain (
+        con_state* c
+    )
+    {
+        char junk[1024];
+        long status;
+        while ((status = ::recv(c->con->get_socket_descriptor(), junk, sizeof(junk), MSG_DONTWAIT)) > 0) {}
+
+        if (status == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+            finish(c);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void server::event_loop::
+    finish (
+        con_state* c
+    )
+    {
+        if (c->has_deadline)
+            deadlines.erase(c->deadline);
+
+        // closing the socket also removes it from epfd
+        close_connection(c->con);
+        delete c;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void server::event_loop::
+    close_connection (
+        connection* con
+    )
+    {
+        // remove this connection from cons and close it
+        the_server.cons_mutex.lock();
+        connection* temp;
+        if (the_server.cons.is_member(con))
+            the_server.cons.remove(con,temp);
+        the_server.cons_mutex.unlock();
+
+        delete con;
+
+        // decrement the thread count and signal if it is now zero
+        the_server.thread_count_mutex.lock();
+        --the_server.thread_count;
+        the_server.thread_count_signaler.broadcast();
+        if (the_server.thread_count == 0)
+            the_server.thread_count_zero.broadcast();
+        the_server.thread_count_mutex.unlock();
+    }
+
+#else
+
+    class server::event_loop
+    {
+        /*!
+            epoll is only available on Linux, so on other platforms start() never creates
+            an event_loop and each connection gets its own thread.
+        !*/
+    public:
+        void add_connection (
+            connection* 
+        ) {}
+    };
+
+#endif
+
+// ----------------------------------------------------------------------------------------
+// ----------------------------------------------------------------------------------------
+    // server object
+// ----------------------------------------------------------------------------------------
 // ----------------------------------------------------------------------------------------
 
     server::
@@ -22,7 +542,9 @@ namespace dlib
         thread_count_signaler(thread_count_mutex),
         max_connections(1000),
         thread_count_zero(thread_count_mutex),
-        graceful_close_timeout(500)
+        graceful_close_timeout(500),
+        num_worker_threads(0),
+        wait_for_client_data(false)
     {
     }
 
@@ -89,6 +611,78 @@ namespace dlib
         max_connections_mutex.unlock();
     }
 
+// ----------------------------------------------------------------------------------------
+
+    void server::
+    use_event_loop (
+        unsigned long num_worker_threads_,
+        bool wait_for_client_data_
+    )
+    {
+        // make sure requires clause is not broken
+        DLIB_CASSERT( 
+            ( num_worker_threads_ > 0 &&
+              this->is_running() == false ),
+            "\tvoid server::use_event_loop"
+            << "\n\tnum_worker_threads: " << num_worker_threads_
+            << "\n\tis_running():       " << this->is_running() 
+            << "\n\tthis: " << this
+            );
+
+        auto_mutex lock(max_connections_mutex);
+        num_worker_threads = num_worker_threads_;
+        wait_for_client_data = wait_for_client_data_;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void server::
+    use_thread_per_connection (
+    )
+    {
+        // make sure requires clause is not broken
+        DLIB_CASSERT( 
+            this->is_running() == false,
+            "\tvoid server::use_thread_per_connection"
+            << "\n\tis_running(): " << this->is_running() 
+            << "\n\tthis: " << this
+            );
+
+        auto_mutex lock(max_connections_mutex);
+        num_worker_threads = 0;
+        wait_for_client_data = false;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    bool server::
+    is_using_event_loop (
+    ) const
+    {
+        auto_mutex lock(max_connections_mutex);
+        return num_worker_threads != 0;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    unsigned long server::
+    get_num_worker_threads (
+    ) const
+    {
+        auto_mutex lock(max_connections_mutex);
+        return num_worker_threads;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    bool server::
+    waits_for_client_data (
+    ) const
+    {
+        auto_mutex lock(max_connections_mutex);
+        return wait_for_client_data;
+    }
+
 // ----------------------------------------------------------------------------------------
 
     void server::
@@ -109,6 +703,8 @@ namespace dlib
         listening_port = 0;
         max_connections = 1000;
         graceful_close_timeout = 500;
+        num_worker_threads = 0;
+        wait_for_client_data = false;
         listening_port_mutex.unlock();
         listening_ip_mutex.unlock();
         max_connections_mutex.unlock();
@@ -145,6 +741,28 @@ namespace dlib
         running_mutex.unlock();
 
 
+        // Connections accepted while we were waiting above were handed to the event loop
+        // as well, so shut those down too before getting rid of it.
+        if (events)
+        {
+            cons_mutex.lock();
+            while (cons.size() > 0)
+            {
+                cons.remove_any(temp);
+                temp->shutdown();
+            }
+            cons_mutex.unlock();
+
+            thread_count_mutex.lock();
+            while (thread_count > 0)
+            {
+                thread_count_zero.wait();
+            }
+            thread_count_mutex.unlock();
+
+            events.reset();
+        }
+
 
         // signal that the shutdown is complete
         shutting_down_mutex.lock();
@@ -208,6 +826,8 @@ namespace dlib
                 listening_port = 0;
                 max_connections = 1000;
                 graceful_close_timeout = 500;
+                num_worker_threads = 0;
+                wait_for_client_data = false;
                 listening_port_mutex.unlock();
                 listening_ip_mutex.unlock();
                 max_connections_mutex.unlock();
@@ -231,6 +851,22 @@ namespace dlib
             }
         }
 
+#if defined(__linux__)
+        const unsigned long num_workers = get_num_worker_threads();
+        if (num_workers != 0 && !events)
+        {
+            try
+            {
+                events.reset(new event_loop(*this, num_workers, waits_for_client_data()));
+            }
+            catch (...)
+            {
+                sock.reset();
+                throw;
+            }
+        }
+#endif
+
         running_mutex.lock();
         running = true;
         running_mutex.unlock();
@@ -344,69 +980,82 @@ namespace dlib
             cons_mutex.unlock();
 
 
-            // make a param structure
-            param* temp = 0;
-            try{
-            temp = new param (
-                            *this,
-                            *client,
-                            get_graceful_close_timeout() 
-                            );
-            } catch (...) 
+            if (events)
             {
-                sock.reset();
-                delete client;
-                running_mutex.lock();
-                running = false;
-                running_signaler.broadcast();
-                running_mutex.unlock();
-                clear(); 
-                throw;
-            }
-
+                // the event loop takes ownership of client and decrements thread_count
+                // once it is done with it
+                thread_count_mutex.lock();
+                ++thread_count;
+                thread_count_mutex.unlock();
 
-            // if create_new_thread failed
-            if (!create_new_thread(service_connection,temp))
+                events->add_connection(client);
+            }
+            else
             {
-                delete temp;
-                // close the listening socket
-                sock.reset();
-
-                // close the new connection and remove it from cons
-                cons_mutex.lock();
-                connection* ctemp;
-                if (cons.is_member(client))
+                // make a param structure
+                param* temp = 0;
+                try{
+                temp = new param (
+                                *this,
+                                *client,
+                                get_graceful_close_timeout() 
+                                );
+                } catch (...) 
                 {
-                    cons.remove(client,ctemp);
+                    sock.reset();
+                    delete client;
+                    running_mutex.lock();
+                    running = false;
+                    running_signaler.broadcast();
+                    running_mutex.unlock();
+                    clear(); 
+                    throw;
                 }
-                delete client;
-                cons_mutex.unlock();
 
 
-                // signal that the listener has closed
-                running_mutex.lock();
-                running = false;
-                running_signaler.broadcast();
-                running_mutex.unlock();
+                // if create_new_thread failed
+                if (!create_new_thread(service_connection,temp))
+                {
+                    delete temp;
+                    // close the listening socket
+                    sock.reset();
+
+                    // close the new connection and remove it from cons
+                    cons_mutex.lock();
+                    connection* ctemp;
+                    if (cons.is_member(client))
+                    {
+                        cons.remove(client,ctemp);
+                    }
+                    delete client;
+                    cons_mutex.unlock();
 
-                // make sure the object is cleared
-                clear();
 
-                // throw the exception
-                throw dlib::thread_error(
-                    ECREATE_THREAD,
-                    "error occurred in server::start()\nunable to start thread"
-                    );    
-            }
-            // if we made the new thread then update thread_count
-            else
-            {
-                // increment the thread count
-                thread_count_mutex.lock();
-                ++thread_count;
-                if (thread_count == 0)
-                    thread_count_zero.broadcast();
-                thread_count_mutex.unlock();
+                    // signal that the listener has closed
+                    running_mutex.lock();
+                    running = false;
+                    running_signaler.broadcast();
+                    running_mutex.unlock();
+
+                    // make sure the object is cleared
+                    clear();
+
+                    // throw the exception
+                    throw dlib::thread_error(
+                        ECREATE_THREAD,
+                        "error occurred in server::start()\nunable to start thread"
+                        );    
+                }
+                // if we made the new thread then update thread_count
+                else
+                {
+                    // increment the thread count
+                    thread_count_mutex.lock();
+                    ++thread_count;
+                    if (thread_count == 0)
+                        thread_count_zero.broadcast();
+                    thread_count_mutex.unlock();
+                }
             }
 
 
@@ -46,8 +46,12 @@ namespace dlib
                 thread_count_signaler   == a signaler associated with thread_count_mutex
                 thread_count_zero       == a signaler associated with thread_count_mutex
                 max_connections         == 1000 
-                max_connections_mutex   == a mutex for max_connections and graceful_close_timeout
+                max_connections_mutex   == a mutex for max_connections, graceful_close_timeout,
+                                           num_worker_threads and wait_for_client_data
                 graceful_close_timeout  == 500 
+                num_worker_threads      == 0
+                wait_for_client_data    == false
+                events                  == a null pointer
              
             CONVENTION
                 listening_port          == get_listening_port()
@@ -65,7 +69,9 @@ namespace dlib
                                            used to signal when running is false
                 shutting_down_mutex     == a mutex for shutting_down
                 cons_mutex              == a mutex for cons
-                thread_count            == the number of threads currently running
+                thread_count            == the number of threads currently running.  If
+                                           events is non-null then this is instead the 
+                                           number of connections owned by *events.
                 thread_count_mutex      == a mutex for thread_count
                 thread_count_signaler   == a signaler for thread_count and
                                            is associated with thread_count_mutex.  it
@@ -77,6 +83,11 @@ namespace dlib
                                            zero
                 max_connections         == get_max_connections()
                 max_connections_mutex   == a mutex for max_connections
+                num_worker_threads      == get_num_worker_threads()
+                wait_for_client_data    == waits_for_client_data()
+                events                  == the event loop servicing connections while
+                                           start() is running in event loop mode, null 
+                                           otherwise
         !*/
         
 
@@ -158,8 +169,27 @@ namespace dlib
             unsigned long get_graceful_close_timeout (
             ) const;
 
+            void use_event_loop (
+                unsigned long num_worker_threads,
+                bool wait_for_client_data = false
+            );
+
+            void use_thread_per_connection (
+            );
+
+            bool is_using_event_loop (
+            ) const;
+
+            unsigned long get_num_worker_threads (
+            ) const;
+
+            bool waits_for_client_data (
+            ) const;
+
         private:
 
+            class event_loop;
+
             void start_async_helper (
             );
 
@@ -213,6 +243,9 @@ namespace dlib
             std::unique_ptr<thread_function> async_start_thread;
             std::unique_ptr<listener> sock;
             unsigned long graceful_close_timeout;
+            unsigned long num_worker_threads;
+            bool wait_for_client_data;
+            std::unique_ptr<event_loop> events;
 
 
             // restricted functions
@@ -20,6 +20,8 @@ namespace dlib
                 is_running()                 == false
                 get_max_connections()        == 1000
                 get_graceful_close_timeout() == 500 
+                is_using_event_loop()        == false
+                waits_for_client_data()      == false
 
 
             CALLBACK FUNCTIONS
@@ -29,7 +31,7 @@ namespace dlib
                 connection.  Note that the connection object passed to on_connect() should
                 NOT be closed, just let the function end and it will be gracefully closed 
                 for you.  Also note that each call to on_connect() is run in its own 
-                thread.  Also note that on_connect() should NOT throw any exceptions, 
+                thread, or on one of the worker threads if is_using_event_loop().  Also note that on_connect() should NOT throw any exceptions, 
                 all exceptions must be dealt with inside on_connect() and cannot be 
                 allowed to leave.
 
@@ -46,6 +48,23 @@ namespace dlib
                 This object represents a server that listens on a port and spawns new
                 threads to handle each new connection.            
 
+                Alternatively, after a call to use_event_loop(), connections are
+                handled by a fixed number of worker threads and an epoll based event
+                loop.  on_connect() is called on one of the workers as soon as a
+                connection is accepted, and once it returns the graceful close is
+                carried out by the event loop rather than a worker.  While on_connect()
+                runs it occupies its worker, so on_connect() shouldn't block for long
+                periods waiting on the remote host.
+
+                If, in addition, waits_for_client_data() == true then a new connection
+                is parked in the event loop, without using any thread, until the remote
+                host sends something, and only then is on_connect() called.
+                Connections that are closed before sending anything never reach
+                on_connect() at all.  So any number of idle connections can be held
+                open.  This only suits protocols where the client speaks first, such
+                as HTTP.  A server that sends a greeting before reading anything would
+                never get to send it.
+
                 Note that the clear() function does not return until all calls to 
                 on_connect() have finished and the start() function has been shutdown.
                 Also note that when clear() is called all open connection objects 
@@ -265,6 +284,71 @@ namespace dlib
                       connection.  This is the timeout value given to close_gracefully().
             !*/
 
+            void use_event_loop (
+                unsigned long num_worker_threads,
+                bool wait_for_client_data = false
+            );
+            /*!
+                requires
+                    - num_worker_threads > 0
+                    - is_running() == false
+                ensures
+                    - #is_using_event_loop() == true
+                    - #get_num_worker_threads() == num_worker_threads
+                    - #waits_for_client_data() == wait_for_client_data
+                    - When the server is started, connections are serviced by an event
+                      loop and num_worker_threads worker threads, as described in the
+                      WHAT THIS OBJECT REPRESENTS section, rather than by one thread per
+                      connection.  In this mode get_max_connections() limits the number
+                      of open connections, not the number of threads, so it usually makes
+                      sense to raise it. 
+                    - The event loop is built on epoll and is therefore only available on
+                      Linux.  On other platforms this setting has no effect and each
+                      connection still gets its own thread.
+            !*/
+
+            void use_thread_per_connection (
+            );
+            /*!
+                requires
+                    - is_running() == false
+                ensures
+                    - #is_using_event_loop() == false
+                    - #get_num_worker_threads() == 0
+                    - #waits_for_client_data() == false
+                    - When the server is started, each connection will be serviced by
+                      its own thread.
+            !*/
+
+            bool is_using_event_loop (
+            ) const;
+            /*!
+                ensures
+                    - returns true if use_event_loop() has been called, and the setting
+                      hasn't since been undone by use_thread_per_connection() or clear().
+            !*/
+
+            unsigned long get_num_worker_threads (
+            ) const;
+            /*!
+                ensures
+                    - if (is_using_event_loop()) then
+                        - returns the number of threads that will run on_connect()
+                    - else
+                        - returns 0
+            !*/
+
+            bool waits_for_client_data (
+            ) const;
+            /*!
+                ensures
+                    - returns true if, in event loop mode, on_connect() is only called
+                      once the remote host has sent something on the new connection.
+                      See the WHAT THIS OBJECT REPRESENTS section above.
+                    - returns false if on_connect() is called as soon as a connection is
+                      accepted.
+            !*/
+
         private:
 
             virtual void on_connect (
@@ -272,7 +356,8 @@ namespace dlib
             )=0;
             /*!
                 requires
-                    - on_connect() is run in its own thread 
+                    - on_connect() is run in its own thread, or on one of the 
+                      get_num_worker_threads() worker threads if is_using_event_loop()
                     - is_running() == true 
                     - the number of current connections < get_max_connection() 
                     - new_connection == the new connection to the server which is
@@ -25,6 +25,8 @@
 #include "svm/null_trainer.h"
 #include "svm/roc_trainer.h"
 #include "svm/kernel_matrix.h"
+#include "svm/kernel_cache.h"
+#include "svm/batch_evaluate.h"
 #include "svm/empirical_kernel_map.h"
 #include "svm/svm_c_linear_trainer.h"
 #include "svm/svm_c_linear_dcd_trainer.h"
@@ -117,49 +117,82 @@ namespace dlib
         {
             assignment.clear();
 
-            matrix<double> cost;
-            unsigned long size;
+            typedef typename feature_extractor::feature_vector_type feature_vector_type;
+            feature_vector_type feats;
+
             if (force_assignment)
             {
-                size = std::max(lhs.size(), rhs.size());
-            }
-            else
-            {
-                size = rhs.size() + lhs.size();
-            }
-            cost.set_size(size, size);
+                matrix<double> cost;
+                const unsigned long size = std::max(lhs.size(), rhs.size());
+                cost.set_size(size, size);
 
-            typedef typename feature_extractor::feature_vector_type feature_vector_type;
-            feature_vector_type feats;
+                // now fill out the cost assignment matrix
+                for (long r = 0; r < cost.nr(); ++r)
+                {
+                    for (long c = 0; c < cost.nc(); ++c)
+                    {
+                        if (r < (long)lhs.size() && c < (long)rhs.size())
+                        {
+                            fe.get_features(lhs[r], rhs[c], feats);
+                            cost(r,c) = dot(weights, feats) + bias;
+                        }
+                        else
+                        {
+                            cost(r,c) = 0;
+                        }
+                    }
+                }
 
-            // now fill out the cost assignment matrix
-            for (long r = 0; r < cost.nr(); ++r)
+
+                if (cost.size() != 0)
+                {
+                    // max_cost_assignment() only works with integer matrices, so convert from
+                    // double to integer.
+                    const double scale = (std::numeric_limits<dlib::int64>::max()/1000)/max(abs(cost));
+                    matrix<dlib::int64> int_cost = matrix_cast<dlib::int64>(round(cost*scale));
+                    assignment = max_cost_assignment(int_cost);
+                    assignment.resize(lhs.size());
+                }
+            }
+            else
             {
-                for (long c = 0; c < cost.nc(); ++c)
+                // Leaving an element of lhs unassigned scores 0.  So only the pairs with
+                // a positive score can be part of the best assignment and we can hand
+                // just those to the sparse solver rather than building the full
+                // (lhs.size()+rhs.size()) by (lhs.size()+rhs.size()) cost matrix.
+                std::vector<std::vector<std::pair<unsigned long,double> > > scores(lhs.size());
+                double max_score = 0;
+                for (unsigned long r = 0; r < lhs.size(); ++r)
                 {
-                    if (r < (long)lhs.size() && c < (long)rhs.size())
+                    for (unsigned long c = 0; c < rhs.size(); ++c)
                     {
                         fe.get_features(lhs[r], rhs[c], feats);
-                        cost(r,c) = dot(weights, feats) + bias;
+                        const double score = dot(weights, feats) + bias;
+                        if (score > 0)
+                        {
+                            scores[r].push_back(std::make_pair(c, score));
+                            max_score = std::max(max_score, score);
+                        }
                     }
-                    else
+                }
+
+                assignment.assign(lhs.size(), -1);
+                if (max_score > 0)
+                {
+                    // sparse_max_cost_assignment() only works with integers, so convert
+                    // from double to integer.  Scale things so that even the sum of all
+                    // the scores can't overflow.
+                    const double scale = (std::numeric_limits<dlib::int64>::max()/1000)/(max_score*(lhs.size()+1));
+                    std::vector<std::vector<std::pair<unsigned long,dlib::int64> > > int_cost(lhs.size());
+                    for (unsigned long r = 0; r < scores.size(); ++r)
                     {
-                        cost(r,c) = 0;
+                        for (unsigned long i = 0; i < scores[r].size(); ++i)
+                            int_cost[r].push_back(std::make_pair(scores[r][i].first, (dlib::int64)std::floor(scores[r][i].second*scale + 0.5)));
                     }
+                    assignment = sparse_max_cost_assignment(int_cost);
                 }
             }
 
-
-            if (cost.size() != 0)
-            {
-                // max_cost_assignment() only works with integer matrices, so convert from
-                // double to integer.
-                const double scale = (std::numeric_limits<dlib::int64>::max()/1000)/max(abs(cost));
-                matrix<dlib::int64> int_cost = matrix_cast<dlib::int64>(round(cost*scale));
-                assignment = max_cost_assignment(int_cost);
-                assignment.resize(lhs.size());
-            }
-
             // adjust assignment so that non-assignments have a value of -1
             for (unsigned long i = 0; i < assignment.size(); ++i)
             {
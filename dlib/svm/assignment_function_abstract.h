@@ -261,6 +261,11 @@ namespace dlib
                   it is possible for this object to indicate that there are anywhere between 
                   0 to 10 matches between LHS and RHS.  However, in forced assignment mode 
                   it will always indicate exactly 10 matches.   
+                - In the default mode only the pairs with a positive match_score() are
+                  given to the assignment solver (sparse_max_cost_assignment()).  So when
+                  most pairs score below 0, as in track association, this is much faster
+                  than forced assignment mode, which solves a dense 
+                  max(LHS size, RHS size) by max(LHS size, RHS size) problem.
         !*/
 
         result_type operator()(
@@ -0,0 +1,343 @@
+// Copyright (C) 2018  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_SVm_BATCH_EVALUATE_Hh_
+#define DLIB_SVm_BATCH_EVALUATE_Hh_
+
+#include "batch_evaluate_abstract.h"
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "../matrix.h"
+#include "../algs.h"
+#include "../threads.h"
+#include "function.h"
+#include "kernel.h"
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        // The number of samples each GEMM call works on.  This bounds the size of the
+        // temporary samples-by-basis-vectors matrix to block_size*basis_vectors.size().
+        const long batch_evaluate_block_size = 256;
+
+        template <typename funct_type>
+        void for_each_sample_block (
+            long num_samples,
+            unsigned long num_threads,
+            const funct_type& funct
+        )
+        {
+            const long num_blocks = (num_samples + batch_evaluate_block_size - 1)/batch_evaluate_block_size;
+            auto block = [&](long i)
+            {
+                const long begin = i*batch_evaluate_block_size;
+                const long end = std::min(begin + batch_evaluate_block_size, num_samples);
+                funct(begin, end);
+            };
+
+            if (num_threads > 1 && num_blocks > 1)
+            {
+                thread_pool tp(std::min<unsigned long>(num_threads, num_blocks));
+                parallel_for(tp, 0, num_blocks, block, 1);
+            }
+            else
+            {
+                for (long i = 0; i < num_blocks; ++i)
+                    block(i);
+            }
+        }
+
+        template <typename T, typename EXP>
+        void load_sample_rows (
+            matrix<typename T::type,0,0,typename T::mem_manager_type>& dest,
+            const matrix_exp<EXP>& samples,
+            long begin,
+            long end,
+            long dims
+        )
+        /*!
+            ensures
+                - #dest == a matrix where the ith row is trans(samples(begin+i)), for all
+                  sample indices in the range [begin, end).
+        !*/
+        {
+            dest.set_size(end-begin, dims);
+            for (long r = begin; r < end; ++r)
+            {
+                const T& s = samples(r);
+                DLIB_ASSERT(s.size() == dims,
+                    "\t batch_evaluate(df, samples)"
+                    << "\n\t All samples must have the same dimensionality as the basis vectors."
+                    << "\n\t r:         " << r
+                    << "\n\t s.size():  " << s.size()
+                    << "\n\t dims:      " << dims
+                );
+                set_rowm(dest, r-begin) = trans(s);
+            }
+        }
+
+        template <
+            typename K,
+            typename EXP,
+            typename transform_type
+            >
+        matrix<typename K::scalar_type,0,1> batch_evaluate_dense_kernel (
+            const decision_function<K>& df,
+            const matrix_exp<EXP>& samples,
+            unsigned long num_threads,
+            bool need_norms,
+            const transform_type& transform
+        )
+        /*!
+            requires
+                - K is a kernel on dense column vectors that depends on its two arguments
+                  only through their dot product and squared norms.
+                - transform(D, xnorms, snorms) turns D, a matrix of dot products between
+                  samples (rows) and basis vectors (columns), into kernel values.  xnorms
+                  and snorms hold the squared norms of the samples and basis vectors and
+                  are only populated if need_norms == true.
+            ensures
+                - returns a vector whose ith element is df(samples(i)).
+        !*/
+        {
+            typedef typename K::scalar_type scalar_type;
+            typedef typename K::sample_type sample_type;
+            typedef typename K::mem_manager_type mem_manager_type;
+            typedef matrix<scalar_type,0,0,mem_manager_type> mat_type;
+            typedef matrix<scalar_type,0,1,mem_manager_type> col_type;
+
+            matrix<scalar_type,0,1> out(samples.size());
+            if (df.basis_vectors.size() == 0)
+            {
+                out = -df.b;
+                return out;
+            }
+
+            const long dims = df.basis_vectors(0).size();
+            mat_type S;
+            load_sample_rows<sample_type>(S, mat(df.basis_vectors), 0, df.basis_vectors.size(), dims);
+            col_type snorms;
+            if (need_norms)
+                snorms = sum_cols(dlib::squared(S));
+
+            for_each_sample_block(samples.size(), num_threads, [&](long begin, long end)
+            {
+                mat_type X, D;
+                col_type xnorms;
+                load_sample_rows<sample_type>(X, samples, begin, end, dims);
+                if (need_norms)
+                    xnorms = sum_cols(dlib::squared(X));
+
+                D = X*trans(S);
+                transform(D, xnorms, snorms);
+                set_subm(out, begin, 0, end-begin, 1) = D*df.alpha - df.b;
+            });
+
+            return out;
+        }
+
+    // ------------------------------------------------------------------------------------
+
+        template <typename function_type>
+        struct batch_evaluator
+        {
+            template <typename EXP>
+            static matrix<typename function_type::result_type,0,1> eval (
+                const function_type& f,
+                const matrix_exp<EXP>& samples,
+                unsigned long num_threads
+            )
+            {
+                matrix<typename function_type::result_type,0,1> out(samples.size());
+                for_each_sample_block(samples.size(), num_threads, [&](long begin, long end)
+                {
+                    // Use a private copy of f since function objects aren't required to
+                    // be safe to share between threads.
+                    const function_type lf(f);
+                    for (long i = begin; i < end; ++i)
+                        out(i) = lf(samples(i));
+                });
+                return out;
+            }
+        };
+
+        template <typename T>
+        struct batch_evaluator<decision_function<radial_basis_kernel<T> > >
+        {
+            template <typename EXP>
+            static matrix<typename T::type,0,1> eval (
+                const decision_function<radial_basis_kernel<T> >& df,
+                const matrix_exp<EXP>& samples,
+                unsigned long num_threads
+            )
+            {
+                typedef typename T::type scalar_type;
+                const scalar_type gamma = df.kernel_function.gamma;
+                return batch_evaluate_dense_kernel(df, samples, num_threads, true,
+                    [gamma](matrix<scalar_type,0,0,typename T::mem_manager_type>& D,
+                            const matrix<scalar_type,0,1,typename T::mem_manager_type>& xnorms,
+                            const matrix<scalar_type,0,1,typename T::mem_manager_type>& snorms)
+                    {
+                        const long nc = D.nc();
+                        const scalar_type* sn = &snorms(0);
+                        for (long r = 0; r < D.nr(); ++r)
+                        {
+                            // ||x-s||^2 == ||x||^2 + ||s||^2 - 2*dot(x,s).  Rounding can
+                            // make this slightly negative when x == s so clamp it at 0.
+                            scalar_type* d = &D(r,0);
+                            const scalar_type xn = xnorms(r);
+                            for (long c = 0; c < nc; ++c)
+                                d[c] = std::max<scalar_type>(0, xn + sn[c] - 2*d[c]);
+                            for (long c = 0; c < nc; ++c)
+                                d[c] = std::exp(-gamma*d[c]);
+                        }
+                    });
+            }
+        };
+
+        template <typename T>
+        struct batch_evaluator<decision_function<polynomial_kernel<T> > >
+        {
+            template <typename EXP>
+            static matrix<typename T::type,0,1> eval (
+                const decision_function<polynomial_kernel<T> >& df,
+                const matrix_exp<EXP>& samples,
+                unsigned long num_threads
+            )
+            {
+                typedef typename T::type scalar_type;
+                const scalar_type gamma = df.kernel_function.gamma;
+                const scalar_type coef = df.kernel_function.coef;
+                const scalar_type degree = df.kernel_function.degree;
+                return batch_evaluate_dense_kernel(df, samples, num_threads, false,
+                    [gamma,coef,degree](matrix<scalar_type,0,0,typename T::mem_manager_type>& D,
+                            const matrix<scalar_type,0,1,typename T::mem_manager_type>& ,
+                            const matrix<scalar_type,0,1,typename T::mem_manager_type>& )
+                    {
+                        scalar_type* d = &D(0,0);
+                        const long n = D.size();
+                        for (long i = 0; i < n; ++i)
+                            d[i] = std::pow(gamma*d[i] + coef, degree);
+                    });
+            }
+        };
+
+        template <typename T>
+        struct batch_evaluator<decision_function<sigmoid_kernel<T> > >
+        {
+            template <typename EXP>
+            static matrix<typename T::type,0,1> eval (
+                const decision_function<sigmoid_kernel<T> >& df,
+                const matrix_exp<EXP>& samples,
+                unsigned long num_threads
+            )
+            {
+                typedef typename T::type scalar_type;
+                const scalar_type gamma = df.kernel_function.gamma;
+                const scalar_type coef = df.kernel_function.coef;
+                return batch_evaluate_dense_kernel(df, samples, num_threads, false,
+                    [gamma,coef](matrix<scalar_type,0,0,typename T::mem_manager_type>& D,
+                            const matrix<scalar_type,0,1,typename T::mem_manager_type>& ,
+                            const matrix<scalar_type,0,1,typename T::mem_manager_type>& )
+                    {
+                        scalar_type* d = &D(0,0);
+                        const long n = D.size();
+                        for (long i = 0; i < n; ++i)
+                            d[i] = std::tanh(gamma*d[i] + coef);
+                    });
+            }
+        };
+
+        template <typename T>
+        struct batch_evaluator<decision_function<linear_kernel<T> > >
+        {
+            template <typename EXP>
+            static matrix<typename T::type,0,1> eval (
+                const decision_function<linear_kernel<T> >& df,
+                const matrix_exp<EXP>& samples,
+                unsigned long num_threads
+            )
+            {
+                typedef typename T::type scalar_type;
+                typedef typename T::mem_manager_type mem_manager_type;
+                typedef matrix<scalar_type,0,0,mem_manager_type> mat_type;
+
+                matrix<scalar_type,0,1> out(samples.size());
+                if (df.basis_vectors.size() == 0)
+                {
+                    out = -df.b;
+                    return out;
+                }
+
+                // A linear decision function is just dot(w,x)-b, so collapse the basis
+                // vectors into w once and then each block of samples needs only a single
+                // matrix-vector product.
+                const long dims = df.basis_vectors(0).size();
+                mat_type S;
+                load_sample_rows<T>(S, mat(df.basis_vectors), 0, df.basis_vectors.size(), dims);
+                const matrix<scalar_type,0,1,mem_manager_type> w = trans(S)*df.alpha;
+
+                for_each_sample_block(samples.size(), num_threads, [&](long begin, long end)
+                {
+                    mat_type X;
+                    load_sample_rows<T>(X, samples, begin, end, dims);
+                    set_subm(out, begin, 0, end-begin, 1) = X*w - df.b;
+                });
+                return out;
+            }
+        };
+
+        template <typename function_type, typename normalizer_type>
+        struct batch_evaluator<normalized_function<function_type,normalizer_type> >
+        {
+            template <typename EXP>
+            static matrix<typename function_type::result_type,0,1> eval (
+                const normalized_function<function_type,normalizer_type>& f,
+                const matrix_exp<EXP>& samples,
+                unsigned long num_threads
+            )
+            {
+                // The normalizer isn't threadsafe, so normalize everything up front and
+                // then hand the normalized samples to the underlying function.
+                normalizer_type normalizer(f.normalizer);
+                std::vector<typename function_type::sample_type> temp(samples.size());
+                for (long i = 0; i < samples.size(); ++i)
+                    temp[i] = normalizer(samples(i));
+                return batch_evaluator<function_type>::eval(f.function, mat(temp), num_threads);
+            }
+        };
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename function_type,
+        typename in_sample_vector_type
+        >
+    matrix<typename function_type::result_type,0,1> batch_evaluate (
+        const function_type& f,
+        const in_sample_vector_type& samples,
+        unsigned long num_threads = 1
+    )
+    {
+        // make sure requires clause is not broken
+        DLIB_ASSERT(num_threads > 0 && is_vector(mat(samples)),
+            "\t matrix batch_evaluate(f, samples, num_threads)"
+            << "\n\t Invalid inputs were given to this function."
+            << "\n\t num_threads:             " << num_threads
+            << "\n\t is_vector(mat(samples)): " << is_vector(mat(samples))
+        );
+
+        return impl::batch_evaluator<function_type>::eval(f, mat(samples), num_threads);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_SVm_BATCH_EVALUATE_Hh_
+
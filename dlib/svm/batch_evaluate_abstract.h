@@ -0,0 +1,59 @@
+// Copyright (C) 2018  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#undef DLIB_SVm_BATCH_EVALUATE_ABSTRACT_Hh_
+#ifdef DLIB_SVm_BATCH_EVALUATE_ABSTRACT_Hh_
+
+#include "../matrix.h"
+#include "function_abstract.h"
+#include "kernel_abstract.h"
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename function_type,
+        typename in_sample_vector_type
+        >
+    matrix<typename function_type::result_type,0,1> batch_evaluate (
+        const function_type& f,
+        const in_sample_vector_type& samples,
+        unsigned long num_threads = 1
+    );
+    /*!
+        requires
+            - function_type == a function object that takes a function_type::sample_type
+              and returns a function_type::result_type.  E.g. decision_function or
+              normalized_function.
+            - in_sample_vector_type == a type usable with mat() that contains
+              function_type::sample_type objects.  E.g. std::vector or dlib::matrix.
+            - is_vector(mat(samples)) == true
+            - num_threads > 0
+        ensures
+            - returns a column vector R such that:
+                - R.size() == mat(samples).size()
+                - for all valid i: R(i) == f(mat(samples)(i))
+                  (up to floating point rounding differences)
+            - The samples are split into blocks which are evaluated in parallel using
+              num_threads threads.  If num_threads == 1 then all the work is done in the
+              calling thread.
+            - If f is a decision_function using the radial_basis_kernel,
+              polynomial_kernel, sigmoid_kernel, or linear_kernel then each block of
+              samples is evaluated against all the basis vectors with a single matrix
+              multiply rather than one kernel call per sample and basis vector pair.
+              This is much faster than calling f() on each sample, especially if dlib is
+              linked to an optimized BLAS library.  For the linear_kernel the basis
+              vectors are first collapsed into a single weight vector.  If f is a
+              normalized_function then the samples are normalized and the underlying
+              function is evaluated in the same way.
+            - For all other function types this function simply calls a copy of f on
+              each sample.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_SVm_BATCH_EVALUATE_ABSTRACT_Hh_
+
@@ -11,6 +11,7 @@
 #include "../image_processing/full_object_detection.h"
 #include "../image_processing/box_overlap_testing.h"
 #include "../statistics.h"
+#include "../threads.h"
 
 namespace dlib
 {
@@ -283,34 +284,45 @@ namespace dlib
         const std::vector<std::vector<rectangle> >& ignore,
         const long folds,
         const test_box_overlap& overlap_tester = test_box_overlap(),
-        const double adjust_threshold = 0
+        const double adjust_threshold = 0,
+        const unsigned long num_threads = 1
     )
     {
         // make sure requires clause is not broken
         DLIB_CASSERT( is_learning_problem(images,truth_dets) == true &&
                      ignore.size() == images.size() &&
-                     1 < folds && folds <= static_cast<long>(images.size()),
+                     1 < folds && folds <= static_cast<long>(images.size()) &&
+                     num_threads > 0,
                     "\t matrix cross_validate_object_detection_trainer()"
                     << "\n\t invalid inputs were given to this function"
                     << "\n\t is_learning_problem(images,truth_dets): " << is_learning_problem(images,truth_dets)
                     << "\n\t folds: "<< folds
+                    << "\n\t num_threads: "<< num_threads
                     << "\n\t ignore.size(): " << ignore.size() 
                     << "\n\t images.size(): " << images.size() 
                     );
 
-        double correct_hits = 0;
-        double total_true_targets = 0;
-
         const long test_size = images.size()/folds;
 
-        std::vector<std::pair<double,bool> > all_dets;
-        unsigned long missing_detections = 0;
-        unsigned long test_idx = 0;
-        for (long iter = 0; iter < folds; ++iter)
+        // The results from each fold.  We combine them in fold order at the end so the
+        // results are the same no matter how many threads are used.
+        struct fold_result
         {
+            fold_result() : correct_hits(0), total_true_targets(0), missing_detections(0) {}
+            double correct_hits;
+            double total_true_targets;
+            std::vector<std::pair<double,bool> > all_dets;
+            unsigned long missing_detections;
+        };
+        std::vector<fold_result> fold_results(folds);
+
+        auto run_fold = [&](long iter)
+        {
+            fold_result& fr = fold_results[iter];
             std::vector<unsigned long> train_idx_set;
             std::vector<unsigned long> test_idx_set;
 
+            unsigned long test_idx = iter*test_size;
             for (long i = 0; i < test_size; ++i)
                 test_idx_set.push_back(test_idx++);
 
@@ -333,10 +345,25 @@ namespace dlib
                 std::vector<std::pair<double,rectangle> > hits; 
                 detector(images[test_idx_set[i]], hits, adjust_threshold);
 
-                correct_hits += impl::number_of_truth_hits(truth_dets[test_idx_set[i]], ignore[i], hits, overlap_tester, all_dets, missing_detections);
-                total_true_targets += truth_dets[test_idx_set[i]].size();
+                fr.correct_hits += impl::number_of_truth_hits(truth_dets[test_idx_set[i]], ignore[test_idx_set[i]], hits, overlap_tester, fr.all_dets, fr.missing_detections);
+                fr.total_true_targets += truth_dets[test_idx_set[i]].size();
             }
+        };
 
+        // A pool with 0 threads just runs everything in the calling thread.
+        thread_pool tp(num_threads > 1 ? std::min<unsigned long>(num_threads, folds) : 0);
+        parallel_for(tp, 0, folds, run_fold);
+
+        double correct_hits = 0;
+        double total_true_targets = 0;
+        std::vector<std::pair<double,bool> > all_dets;
+        unsigned long missing_detections = 0;
+        for (long iter = 0; iter < folds; ++iter)
+        {
+            correct_hits += fold_results[iter].correct_hits;
+            total_true_targets += fold_results[iter].total_true_targets;
+            all_dets.insert(all_dets.end(), fold_results[iter].all_dets.begin(), fold_results[iter].all_dets.end());
+            missing_detections += fold_results[iter].missing_detections;
         }
 
         std::sort(all_dets.rbegin(), all_dets.rend());
@@ -372,7 +399,8 @@ namespace dlib
         const std::vector<std::vector<rectangle> >& ignore,
         const long folds,
         const test_box_overlap& overlap_tester = test_box_overlap(),
-        const double adjust_threshold = 0
+        const double adjust_threshold = 0,
+        const unsigned long num_threads = 1
     )
     {
         // convert into a list of regular rectangles.
@@ -385,7 +413,7 @@ namespace dlib
             }
         }
 
-        return cross_validate_object_detection_trainer(trainer, images, dets, ignore, folds, overlap_tester, adjust_threshold);
+        return cross_validate_object_detection_trainer(trainer, images, dets, ignore, folds, overlap_tester, adjust_threshold, num_threads);
     }
 
     template <
@@ -398,11 +426,12 @@ namespace dlib
         const std::vector<std::vector<rectangle> >& truth_dets,
         const long folds,
         const test_box_overlap& overlap_tester = test_box_overlap(),
-        const double adjust_threshold = 0
+        const double adjust_threshold = 0,
+        const unsigned long num_threads = 1
     )
     {
         const std::vector<std::vector<rectangle> > ignore(images.size());
-        return cross_validate_object_detection_trainer(trainer,images,truth_dets,ignore,folds,overlap_tester,adjust_threshold);
+        return cross_validate_object_detection_trainer(trainer,images,truth_dets,ignore,folds,overlap_tester,adjust_threshold,num_threads);
     }
 
     template <
@@ -415,11 +444,12 @@ namespace dlib
         const std::vector<std::vector<full_object_detection> >& truth_dets,
         const long folds,
         const test_box_overlap& overlap_tester = test_box_overlap(),
-        const double adjust_threshold = 0
+        const double adjust_threshold = 0,
+        const unsigned long num_threads = 1
     )
     {
         const std::vector<std::vector<rectangle> > ignore(images.size());
-        return cross_validate_object_detection_trainer(trainer,images,truth_dets,ignore,folds,overlap_tester,adjust_threshold);
+        return cross_validate_object_detection_trainer(trainer,images,truth_dets,ignore,folds,overlap_tester,adjust_threshold,num_threads);
     }
 
 // ----------------------------------------------------------------------------------------
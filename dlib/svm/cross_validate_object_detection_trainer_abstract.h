@@ -205,13 +205,15 @@ namespace dlib
         const std::vector<std::vector<rectangle> >& ignore,
         const long folds,
         const test_box_overlap& overlap_tester = test_box_overlap(),
-        const double adjust_threshold = 0
+        const double adjust_threshold = 0,
+        const unsigned long num_threads = 1
     );
     /*!
         requires
             - is_learning_problem(images,truth_dets)
             - images.size() == ignore.size()
             - 1 < folds <= images.size()
+            - num_threads > 0
             - trainer_type == some kind of object detection trainer (e.g structural_object_detection_trainer)
             - image_array_type must be an implementation of dlib/array/array_kernel_abstract.h 
               and it must contain objects which can be accepted by detector().
@@ -223,6 +225,15 @@ namespace dlib
               returned.  The matrix contains the precision, recall, and average
               precision of the trained detectors and is defined identically to the
               test_object_detection_function() routine defined at the top of this file.
+            - The folds are trained and tested in parallel using num_threads threads.  The
+              results are identical to the single threaded case.  Note that if num_threads
+              > 1 then trainer.train() will be called from several threads at once.  This
+              is fine for dlib's object detection trainers since their train() methods
+              don't modify the trainer.  At most num_threads folds run at once.  Since
+              training is usually what takes the most memory, you should pick num_threads
+              so that num_threads simultaneous calls to trainer.train() fit in RAM.  This
+              also means that if trainer is itself multithreaded you will usually want to
+              reduce its thread count accordingly.
     !*/
 
     template <
@@ -236,7 +247,8 @@ namespace dlib
         const std::vector<std::vector<rectangle> >& ignore,
         const long folds,
         const test_box_overlap& overlap_tester = test_box_overlap(),
-        const double adjust_threshold = 0
+        const double adjust_threshold = 0,
+        const unsigned long num_threads = 1
     );
     /*!
         requires
@@ -258,7 +270,8 @@ namespace dlib
         const std::vector<std::vector<rectangle> >& truth_dets,
         const long folds,
         const test_box_overlap& overlap_tester = test_box_overlap(),
-        const double adjust_threshold = 0
+        const double adjust_threshold = 0,
+        const unsigned long num_threads = 1
     );
     /*!
         requires
@@ -278,7 +291,8 @@ namespace dlib
         const std::vector<std::vector<full_object_detection> >& truth_dets,
         const long folds,
         const test_box_overlap& overlap_tester = test_box_overlap(),
-        const double adjust_threshold = 0
+        const double adjust_threshold = 0,
+        const unsigned long num_threads = 1
     );
     /*!
         requires
@@ -6,6 +6,7 @@
 #include <vector>
 #include "../matrix.h"
 #include "../statistics.h"
+#include "../threads.h"
 #include "cross_validate_regression_trainer_abstract.h"
 
 namespace dlib
@@ -64,17 +65,20 @@ namespace dlib
         const trainer_type& trainer,
         const std::vector<sample_type>& x,
         const std::vector<label_type>& y,
-        const long folds
+        const long folds,
+        const unsigned long num_threads = 1
     )
     {
 
         // make sure requires clause is not broken
         DLIB_ASSERT(is_learning_problem(x,y) == true &&
-                    1 < folds && folds <= static_cast<long>(x.size()),
+                    1 < folds && folds <= static_cast<long>(x.size()) &&
+                    num_threads > 0,
             "\tmatrix cross_validate_regression_trainer()"
             << "\n\t invalid inputs were given to this function"
             << "\n\t x.size(): " << x.size() 
             << "\n\t folds:  " << folds 
+            << "\n\t num_threads:  " << num_threads 
             << "\n\t is_learning_problem(x,y): " << is_learning_problem(x,y)
             );
 
@@ -83,33 +87,24 @@ namespace dlib
         const long num_in_test = x.size()/folds;
         const long num_in_train = x.size() - num_in_test;
 
-        running_stats<double> rs, rs_mae;
-        running_scalar_covariance<double> rc;
-
-        std::vector<sample_type> x_test, x_train;
-        std::vector<label_type> y_test, y_train;
-
-
-        long next_test_idx = 0;
+        // outputs[i] holds the outputs of the function learned in fold i on that fold's
+        // testing samples.  It's empty if the fold was skipped.  We accumulate the error
+        // statistics from these in fold order at the end so the results are the same no
+        // matter how many threads are used.
+        std::vector<std::vector<double> > outputs(folds);
 
-
-        for (long i = 0; i < folds; ++i)
+        auto run_fold = [&](long i)
         {
-            x_test.clear();
-            y_test.clear();
-            x_train.clear();
-            y_train.clear();
-
-            // load up the test samples
-            for (long cnt = 0; cnt < num_in_test; ++cnt)
-            {
-                x_test.push_back(x[next_test_idx]);
-                y_test.push_back(y[next_test_idx]);
-                next_test_idx = (next_test_idx + 1)%x.size();
-            }
+            // Only build the training set once this fold actually runs, so at most
+            // num_threads copies of it exist at a time.
+            const long first_test_idx = (i*num_in_test)%x.size();
+            std::vector<sample_type> x_train;
+            std::vector<label_type> y_train;
+            x_train.reserve(num_in_train);
+            y_train.reserve(num_in_train);
 
             // load up the training samples
-            long next = next_test_idx;
+            long next = (first_test_idx + num_in_test)%x.size();
             for (long cnt = 0; cnt < num_in_train; ++cnt)
             {
                 x_train.push_back(x[next]);
@@ -117,29 +112,44 @@ namespace dlib
                 next = (next + 1)%x.size();
             }
 
-
             try
             {
-                const typename trainer_type::trained_function_type& df = trainer.train(x_train,y_train);
-
-                // do the training and testing
-                for (unsigned long j = 0; j < x_test.size(); ++j)
-                {
-                    // compute error
-                    const double output = df(x_test[j]);
-                    const double temp = output - y_test[j];
-
-                    rs_mae.add(std::abs(temp));
-                    rs.add(temp*temp);
-                    rc.add(output, y_test[j]);
-                }
+                const trainer_type local_trainer(trainer);
+                const typename trainer_type::trained_function_type& df = local_trainer.train(x_train,y_train);
+
+                // do the testing
+                outputs[i].resize(num_in_test);
+                for (long j = 0; j < num_in_test; ++j)
+                    outputs[i][j] = df(x[(first_test_idx + j)%x.size()]);
             }
             catch (invalid_nu_error&)
             {
                 // just ignore cases which result in an invalid nu
+                outputs[i].clear();
             }
+        };
+
+        // A pool with 0 threads just runs everything in the calling thread.
+        thread_pool tp(num_threads > 1 ? std::min<unsigned long>(num_threads, folds) : 0);
+        parallel_for(tp, 0, folds, run_fold);
 
-        } // for (long i = 0; i < folds; ++i)
+        running_stats<double> rs, rs_mae;
+        running_scalar_covariance<double> rc;
+        for (long i = 0; i < folds; ++i)
+        {
+            const long first_test_idx = (i*num_in_test)%x.size();
+            for (unsigned long j = 0; j < outputs[i].size(); ++j)
+            {
+                // compute error
+                const double output = outputs[i][j];
+                const double target = y[(first_test_idx + j)%x.size()];
+                const double temp = output - target;
+
+                rs_mae.add(std::abs(temp));
+                rs.add(temp*temp);
+                rc.add(output, target);
+            }
+        }
 
         matrix<double,1,4> result;
         result = rs.mean(), rc.correlation(), rs_mae.mean(), rs_mae.stddev();
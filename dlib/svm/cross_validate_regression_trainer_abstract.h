@@ -37,6 +37,11 @@ namespace dlib
                 - M(2) == the mean absolute error.  
                   This is given by: sum over i: abs(reg_funct(x_test[i]) - y_test[i])
                 - M(3) == the standard deviation of the absolute error.
+            - The folds are trained and tested in parallel using num_threads threads, with
+              each thread using its own copy of trainer.  The results are identical to
+              the single threaded case.  At most num_threads folds run at once, and each
+              one makes its own copy of its training samples.  So memory usage grows with
+              num_threads.
     !*/
 
 // ----------------------------------------------------------------------------------------
@@ -51,12 +56,14 @@ namespace dlib
         const trainer_type& trainer,
         const std::vector<sample_type>& x,
         const std::vector<label_type>& y,
-        const long folds
+        const long folds,
+        const unsigned long num_threads = 1
     );
     /*!
         requires
             - is_learning_problem(x,y)
             - 1 < folds <= x.size()
+            - num_threads > 0
             - trainer_type == some kind of regression trainer object (e.g. svr_trainer)
         ensures
             - Performs k-fold cross validation by using the given trainer to solve a 
@@ -70,6 +77,11 @@ namespace dlib
                 - M(2) == the mean absolute error.  
                   This is given by: sum over i: abs(reg_funct(x_test[i]) - y_test[i])
                 - M(3) == the standard deviation of the absolute error.
+            - The folds are trained and tested in parallel using num_threads threads, with
+              each thread using its own copy of trainer.  The results are identical to
+              the single threaded case.  At most num_threads folds run at once, and each
+              one makes its own copy of its training samples.  So memory usage grows with
+              num_threads.
     !*/
 
 }
@@ -0,0 +1,412 @@
+// Copyright (C) 2018  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_KERNEL_CaCHE_Hh_
+#define DLIB_KERNEL_CaCHE_Hh_
+
+#include "kernel_cache_abstract.h"
+#include <vector>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <algorithm>
+#include "../matrix.h"
+#include "../algs.h"
+#include "../threads.h"
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename kern_type
+        >
+    class kernel_cache : noncopyable
+    {
+    public:
+        typedef kern_type kernel_type;
+        typedef typename kernel_type::sample_type sample_type;
+        typedef typename kernel_type::scalar_type scalar_type;
+        typedef matrix<float,0,1> column_type;
+
+        kernel_cache (
+            const kernel_type& kernel_,
+            const std::vector<sample_type>& samples_,
+            size_t max_bytes_
+        ) :
+            kernel(kernel_),
+            samples(samples_),
+            max_bytes(max_bytes_)
+        {
+            init(std::vector<unsigned long>(samples.size(), 0));
+        }
+
+        kernel_cache (
+            const kernel_type& kernel_,
+            const std::vector<sample_type>& samples_,
+            const std::vector<unsigned long>& groups_,
+            size_t max_bytes_
+        ) :
+            kernel(kernel_),
+            samples(samples_),
+            max_bytes(max_bytes_)
+        {
+            // make sure requires clause is not broken
+            DLIB_ASSERT(groups_.size() == samples_.size(),
+                "\t kernel_cache::kernel_cache(kernel, samples, groups, max_bytes)"
+                << "\n\t Every sample must be assigned a group."
+                << "\n\t groups.size():  " << groups_.size()
+                << "\n\t samples.size(): " << samples_.size()
+                << "\n\t this: " << this
+                );
+
+            init(groups_);
+        }
+
+        const kernel_type& get_kernel (
+        ) const { return kernel; }
+
+        const std::vector<sample_type>& get_samples (
+        ) const { return samples; }
+
+        long size (
+        ) const { return samples.size(); }
+
+        unsigned long num_groups (
+        ) const { return group_members.size(); }
+
+        unsigned long get_group (
+            long r
+        ) const 
+        { 
+            // make sure requires clause is not broken
+            DLIB_ASSERT(0 <= r && r < size(),
+                "\t unsigned long kernel_cache::get_group(r)"
+                << "\n\t invalid index given to this function"
+                << "\n\t r:      " << r
+                << "\n\t size(): " << size()
+                << "\n\t this:   " << this
+                );
+            return groups[r]; 
+        }
+
+        long get_position_in_group (
+            long r
+        ) const 
+        { 
+            // make sure requires clause is not broken
+            DLIB_ASSERT(0 <= r && r < size(),
+                "\t long kernel_cache::get_position_in_group(r)"
+                << "\n\t invalid index given to this function"
+                << "\n\t r:      " << r
+                << "\n\t size(): " << size()
+                << "\n\t this:   " << this
+                );
+            return position_in_group[r]; 
+        }
+
+        size_t get_max_bytes (
+        ) const { return max_bytes; }
+
+        size_t get_bytes_used (
+        ) const
+        {
+            auto_mutex lock(m);
+            return bytes_used;
+        }
+
+        unsigned long get_num_column_evaluations (
+        ) const
+        {
+            auto_mutex lock(m);
+            return num_evals;
+        }
+
+        unsigned long get_num_kernel_evaluations (
+        ) const
+        {
+            auto_mutex lock(m);
+            return num_kernel_evals;
+        }
+
+        float diag (
+            long i
+        ) const
+        {
+            // make sure requires clause is not broken
+            DLIB_ASSERT(0 <= i && i < size(),
+                "\t float kernel_cache::diag(i)"
+                << "\n\t invalid index given to this function"
+                << "\n\t i:      " << i
+                << "\n\t size(): " << size()
+                << "\n\t this:   " << this
+                );
+
+            return diag_cache(i);
+        }
+
+        std::shared_ptr<const column_type> get_column_block (
+            long c,
+            unsigned long g
+        ) const
+        {
+            // make sure requires clause is not broken
+            DLIB_ASSERT(0 <= c && c < size() && g < num_groups(),
+                "\t std::shared_ptr<const column_type> kernel_cache::get_column_block(c,g)"
+                << "\n\t invalid arguments given to this function"
+                << "\n\t c:            " << c
+                << "\n\t size():       " << size()
+                << "\n\t g:            " << g
+                << "\n\t num_groups(): " << num_groups()
+                << "\n\t this:         " << this
+                );
+
+            const unsigned long key = c*num_groups() + g;
+            {
+                auto_mutex lock(m);
+                const typename block_map::iterator i = blocks.find(key);
+                if (i != blocks.end())
+                {
+                    // move this block to the front of the LRU list
+                    lru.splice(lru.begin(), lru, i->second.lru_pos);
+                    return i->second.block;
+                }
+            }
+
+            // Compute the block without holding the lock so other threads can keep
+            // using the cache in the meantime.
+            const std::vector<long>& rows = group_members[g];
+            std::shared_ptr<column_type> col(new column_type(rows.size()));
+            for (long r = 0; r < col->size(); ++r)
+                (*col)(r) = kernel(samples[rows[r]], samples[c]);
+
+            auto_mutex lock(m);
+            ++num_evals;
+            num_kernel_evals += rows.size();
+            // Another thread might have computed the same block while we were working.
+            // If so then just use that one.
+            typename block_map::iterator i = blocks.find(key);
+            if (i != blocks.end())
+            {
+                lru.splice(lru.begin(), lru, i->second.lru_pos);
+                return i->second.block;
+            }
+
+            const size_t col_bytes = rows.size()*sizeof(float);
+            // Evict the least recently used blocks until the new one fits.  We always
+            // keep at least one block in the cache no matter how small max_bytes is.
+            while (lru.size() != 0 && bytes_used + col_bytes > max_bytes)
+            {
+                const typename block_map::iterator j = blocks.find(lru.back());
+                bytes_used -= j->second.block->size()*sizeof(float);
+                blocks.erase(j);
+                lru.pop_back();
+            }
+
+            lru.push_front(key);
+            cached_block& b = blocks[key];
+            b.block = col;
+            b.lru_pos = lru.begin();
+            bytes_used += col_bytes;
+            return b.block;
+        }
+
+        std::shared_ptr<const column_type> get_column (
+            long i
+        ) const
+        {
+            // make sure requires clause is not broken
+            DLIB_ASSERT(0 <= i && i < size(),
+                "\t std::shared_ptr<const column_type> kernel_cache::get_column(i)"
+                << "\n\t invalid index given to this function"
+                << "\n\t i:      " << i
+                << "\n\t size(): " << size()
+                << "\n\t this:   " << this
+                );
+
+            if (num_groups() == 1)
+                return get_column_block(i, 0);
+
+            std::shared_ptr<column_type> col(new column_type(samples.size()));
+            for (unsigned long g = 0; g < num_groups(); ++g)
+            {
+                const std::shared_ptr<const column_type> block = get_column_block(i, g);
+                for (unsigned long k = 0; k < group_members[g].size(); ++k)
+                    (*col)(group_members[g][k]) = (*block)(k);
+            }
+            return col;
+        }
+
+        float operator() (
+            long r,
+            long c
+        ) const
+        {
+            if (r == c)
+                return diag(r);
+            return (*get_column_block(c, groups[r]))(position_in_group[r]);
+        }
+
+    private:
+
+        void init (
+            const std::vector<unsigned long>& groups_
+        )
+        {
+            bytes_used = 0;
+            num_evals = 0;
+            num_kernel_evals = 0;
+
+            diag_cache.set_size(samples.size());
+            for (long i = 0; i < diag_cache.size(); ++i)
+                diag_cache(i) = kernel(samples[i], samples[i]);
+
+            groups = groups_;
+            position_in_group.resize(samples.size());
+            unsigned long num = samples.size() == 0 ? 1 : 0;
+            for (unsigned long i = 0; i < groups.size(); ++i)
+                num = std::max(num, groups[i]+1);
+            group_members.assign(num, std::vector<long>());
+            for (unsigned long i = 0; i < groups.size(); ++i)
+            {
+                position_in_group[i] = group_members[groups[i]].size();
+                group_members[groups[i]].push_back(i);
+            }
+        }
+
+        /*!
+            CONVENTION
+                - diag_cache(i) == kernel(samples[i], samples[i])
+                - groups[r] == get_group(r)
+                - group_members[g] == the indices of the samples in group g, in
+                  increasing order.  So group_members[groups[r]][position_in_group[r]] == r.
+                - blocks[c*num_groups()+g], if present, holds the block of column c over
+                  the rows in group g, i.e. its kth element is K(group_members[g][k], c).
+                  Its lru_pos points at its key in lru.
+                - lru lists the keys of the cached blocks, most recently used first.
+                - bytes_used == the number of bytes taken up by the cached blocks.
+                - m protects blocks, lru, bytes_used, num_evals, and num_kernel_evals.
+        !*/
+
+        struct cached_block
+        {
+            std::shared_ptr<const column_type> block;
+            std::list<unsigned long>::iterator lru_pos;
+        };
+        typedef std::unordered_map<unsigned long, cached_block> block_map;
+
+        const kernel_type kernel;
+        const std::vector<sample_type>& samples;
+        const size_t max_bytes;
+        matrix<float,0,1> diag_cache;
+        std::vector<unsigned long> groups;
+        std::vector<long> position_in_group;
+        std::vector<std::vector<long> > group_members;
+
+        mutable mutex m;
+        mutable block_map blocks;
+        mutable std::list<unsigned long> lru;
+        mutable size_t bytes_used;
+        mutable unsigned long num_evals;
+        mutable unsigned long num_kernel_evals;
+    };
+
+// ----------------------------------------------------------------------------------------
+
+    template <typename kernel_type>
+    struct op_kernel_cache_subset
+    {
+        op_kernel_cache_subset(
+            const kernel_cache<kernel_type>& cache_,
+            const std::vector<unsigned long>& idx_
+        ) :
+            cache(cache_),
+            idx(idx_),
+            last_c(-1)
+        {}
+
+        op_kernel_cache_subset(
+            const op_kernel_cache_subset& item
+        ) :
+            cache(item.cache),
+            idx(item.idx),
+            last_c(-1)
+        {}
+
+        const kernel_cache<kernel_type>& cache;
+        const std::vector<unsigned long>& idx;
+
+        // Columns of the output matrix are usually read one at a time, top to bottom, so
+        // we remember the blocks of the last column we looked up to avoid hitting the
+        // cache's mutex on every element access.  Only the blocks for the groups idx
+        // actually touches are ever fetched, so rows outside the subset are never
+        // computed unless they share a group with rows inside it.
+        mutable long last_c;
+        mutable std::vector<std::shared_ptr<const typename kernel_cache<kernel_type>::column_type> > last_blocks;
+
+        typedef typename kernel_type::scalar_type type;
+
+        const static long cost = 3;
+        const static long NR = 0;
+        const static long NC = 0;
+
+        typedef const type const_ret_type;
+        typedef typename kernel_type::mem_manager_type mem_manager_type;
+        typedef row_major_layout layout_type;
+
+        const_ret_type apply (long r, long c ) const
+        {
+            const long gc = idx[c];
+            const long gr = idx[r];
+            if (r == c)
+                return cache.diag(gc);
+
+            if (gc != last_c)
+            {
+                last_blocks.assign(cache.num_groups(), nullptr);
+                last_c = gc;
+            }
+            const unsigned long g = cache.get_group(gr);
+            if (!last_blocks[g])
+                last_blocks[g] = cache.get_column_block(gc, g);
+            return static_cast<type>((*last_blocks[g])(cache.get_position_in_group(gr)));
+        }
+
+        long nr () const { return idx.size(); }
+        long nc () const { return idx.size(); }
+
+        template <typename U> bool aliases               ( const matrix_exp<U>& ) const { return false; }
+        template <typename U> bool destructively_aliases ( const matrix_exp<U>& ) const { return false; }
+    };
+
+    template <
+        typename kernel_type
+        >
+    const matrix_op<op_kernel_cache_subset<kernel_type> > cached_kernel_matrix (
+        const kernel_cache<kernel_type>& cache,
+        const std::vector<unsigned long>& idx
+    )
+    {
+#ifdef ENABLE_ASSERTS
+        for (unsigned long i = 0; i < idx.size(); ++i)
+        {
+            DLIB_ASSERT(idx[i] < (unsigned long)cache.size(),
+                "\t const matrix_exp cached_kernel_matrix(cache, idx)"
+                << "\n\t invalid inputs were given to this function"
+                << "\n\t i:            " << i
+                << "\n\t idx[i]:       " << idx[i]
+                << "\n\t cache.size(): " << cache.size()
+                );
+        }
+#endif
+
+        typedef op_kernel_cache_subset<kernel_type> op;
+        return matrix_op<op>(op(cache,idx));
+    }
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_KERNEL_CaCHE_Hh_
+
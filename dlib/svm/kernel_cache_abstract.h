@@ -0,0 +1,271 @@
+// Copyright (C) 2018  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#undef DLIB_KERNEL_CaCHE_ABSTRACT_Hh_
+#ifdef DLIB_KERNEL_CaCHE_ABSTRACT_Hh_
+
+#include <vector>
+#include <memory>
+#include "../matrix.h"
+#include "kernel_abstract.h"
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename kern_type
+        >
+    class kernel_cache : noncopyable
+    {
+        /*!
+            REQUIREMENTS ON kern_type
+                must be a kernel function object as defined in dlib/svm/kernel_abstract.h
+
+            WHAT THIS OBJECT REPRESENTS
+                This object is a thread safe, lazily evaluated cache of the kernel matrix
+                over a fixed set of samples.  That is, it represents the matrix K where
+                K(r,c) == get_kernel()(get_samples()[r], get_samples()[c]).
+
+                The samples are partitioned into groups, and the unit of caching is a
+                column block: the part of a column of K that lies in the rows of one
+                group.  Blocks are computed the first time they are requested and kept in
+                memory, up to a budget of get_max_bytes() bytes.  When the budget is
+                exceeded the least recently used blocks are discarded.  This way, a user
+                who only needs the rows of a few groups never pays for the rest of the
+                column.
+
+                The point of this object is to let several SVM sub-problems over the same
+                samples share kernel evaluations.  For instance, the one_vs_one_trainer
+                uses it, with one group per class label, so that all the binary
+                problems in a multiclass problem draw from one cache rather than each
+                recomputing the same kernel values, while each binary problem only
+                computes the rows belonging to its own two classes.
+
+            THREAD SAFETY
+                All the const member functions of this object may be called concurrently
+                from multiple threads.
+        !*/
+    public:
+        typedef kern_type kernel_type;
+        typedef typename kernel_type::sample_type sample_type;
+        typedef typename kernel_type::scalar_type scalar_type;
+        typedef matrix<float,0,1> column_type;
+
+        kernel_cache (
+            const kernel_type& kernel,
+            const std::vector<sample_type>& samples,
+            size_t max_bytes
+        );
+        /*!
+            ensures
+                - #get_kernel() == kernel
+                - #get_samples() == samples
+                - #get_max_bytes() == max_bytes
+                - #get_bytes_used() == 0
+                - #get_num_column_evaluations() == 0
+                - #get_num_kernel_evaluations() == 0
+                - #num_groups() == 1
+                  (i.e. all the samples are in group 0, so column blocks are whole
+                  columns)
+                - The diagonal of the kernel matrix is computed by this constructor.
+                - This object keeps a reference to samples.  Therefore, samples must not
+                  be modified or destroyed while this object is in use.
+        !*/
+
+        kernel_cache (
+            const kernel_type& kernel,
+            const std::vector<sample_type>& samples,
+            const std::vector<unsigned long>& groups,
+            size_t max_bytes
+        );
+        /*!
+            requires
+                - groups.size() == samples.size()
+            ensures
+                - #get_kernel() == kernel
+                - #get_samples() == samples
+                - #get_max_bytes() == max_bytes
+                - #get_bytes_used() == 0
+                - #get_num_column_evaluations() == 0
+                - #get_num_kernel_evaluations() == 0
+                - for all valid i: #get_group(i) == groups[i]
+                - #num_groups() == max(groups)+1, or 1 if samples is empty.
+                - The diagonal of the kernel matrix is computed by this constructor.
+                - This object keeps a reference to samples.  Therefore, samples must not
+                  be modified or destroyed while this object is in use.
+        !*/
+
+        const kernel_type& get_kernel (
+        ) const;
+        /*!
+            ensures
+                - returns the kernel used to compute the entries of the kernel matrix.
+        !*/
+
+        const std::vector<sample_type>& get_samples (
+        ) const;
+        /*!
+            ensures
+                - returns the samples over which the kernel matrix is defined.
+        !*/
+
+        long size (
+        ) const;
+        /*!
+            ensures
+                - returns get_samples().size()
+        !*/
+
+        unsigned long num_groups (
+        ) const;
+        /*!
+            ensures
+                - returns the number of groups the samples are partitioned into.  Note
+                  that some of them may be empty.
+        !*/
+
+        unsigned long get_group (
+            long r
+        ) const;
+        /*!
+            requires
+                - 0 <= r < size()
+            ensures
+                - returns the group sample r belongs to.
+                - get_group(r) < num_groups()
+        !*/
+
+        long get_position_in_group (
+            long r
+        ) const;
+        /*!
+            requires
+                - 0 <= r < size()
+            ensures
+                - returns the number of samples with an index less than r that are in the
+                  same group as r.  That is, returns the position of K(r,c) within the
+                  block returned by get_column_block(c, get_group(r)).
+        !*/
+
+        size_t get_max_bytes (
+        ) const;
+        /*!
+            ensures
+                - returns the number of bytes of cached column blocks this object is
+                  allowed to keep.  Note that a block is always kept if it is the only one
+                  in the cache, regardless of the budget.  Also, blocks evicted from the
+                  cache stay alive until the last shared_ptr returned by
+                  get_column_block() or get_column() that refers to them is released.
+        !*/
+
+        size_t get_bytes_used (
+        ) const;
+        /*!
+            ensures
+                - returns the number of bytes currently taken up by cached column blocks.
+        !*/
+
+        unsigned long get_num_column_evaluations (
+        ) const;
+        /*!
+            ensures
+                - returns the number of times this object has computed a column block of
+                  the kernel matrix.  When num_groups() == 1 this is the number of whole
+                  columns computed.
+        !*/
+
+        unsigned long get_num_kernel_evaluations (
+        ) const;
+        /*!
+            ensures
+                - returns the number of kernel evaluations this object has performed while
+                  computing column blocks.  This does not include the evaluations done by
+                  the constructor to fill in the diagonal.
+        !*/
+
+        float diag (
+            long i
+        ) const;
+        /*!
+            requires
+                - 0 <= i < size()
+            ensures
+                - returns K(i,i)
+        !*/
+
+        std::shared_ptr<const column_type> get_column_block (
+            long c,
+            unsigned long g
+        ) const;
+        /*!
+            requires
+                - 0 <= c < size()
+                - g < num_groups()
+            ensures
+                - returns a pointer to the part of the cth column of K that lies in the
+                  rows of group g.  That is, returns B such that:
+                    - B->size() == the number of samples in group g
+                    - for all valid r such that get_group(r) == g:
+                        - (*B)(get_position_in_group(r)) == K(r,c)
+                - The block is computed if it isn't already in the cache.  Only the
+                  kernel values for the rows in group g are evaluated.
+        !*/
+
+        std::shared_ptr<const column_type> get_column (
+            long i
+        ) const;
+        /*!
+            requires
+                - 0 <= i < size()
+            ensures
+                - returns a pointer to the ith column of K.  That is, returns C such that:
+                    - C->size() == size()
+                    - for all valid r: (*C)(r) == K(r,i)
+                - This is assembled from get_column_block(i,g) for every group g, so all
+                  the blocks of column i end up in the cache.  When num_groups() == 1 the
+                  returned object is the cached block itself.
+        !*/
+
+        float operator() (
+            long r,
+            long c
+        ) const;
+        /*!
+            requires
+                - 0 <= r < size()
+                - 0 <= c < size()
+            ensures
+                - returns K(r,c)
+        !*/
+    };
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename kernel_type
+        >
+    const matrix_exp cached_kernel_matrix (
+        const kernel_cache<kernel_type>& cache,
+        const std::vector<unsigned long>& idx
+    );
+    /*!
+        requires
+            - for all valid i: idx[i] < cache.size()
+        ensures
+            - returns a matrix expression M of kernel_type::scalar_type values such that:
+                - M.nr() == M.nc() == idx.size()
+                - M(r,c) == cache(idx[r], idx[c])
+            - That is, this function returns the kernel matrix over the subset of
+              cache.get_samples() selected by idx.  The entries are pulled from the
+              cache rather than recomputed.  Only the column blocks for the groups of the
+              samples in idx are ever requested from the cache.
+            - The returned expression keeps references to cache and idx.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_KERNEL_CaCHE_ABSTRACT_Hh_
+
@@ -14,6 +14,10 @@
 #include "kcentroid.h"
 #include "kkmeans_abstract.h"
 #include "../noncopyable.h"
+#include "../threads.h"
+#include "../rand.h"
+#include <algorithm>
+#include <limits>
 
 namespace dlib
 {
@@ -354,8 +358,9 @@ namespace dlib
             scores_sorted = scores;
 
             // now find the winning center and add it to centers.  It is the one that is 
-            // far away from all the other centers.
-            sort(scores_sorted.begin(), scores_sorted.end());
+            // far away from all the other centers.  We only need the element at best_idx
+            // to be in its sorted position, so there is no need to sort everything.
+            std::nth_element(scores_sorted.begin(), scores_sorted.begin()+best_idx, scores_sorted.end());
             centers.push_back(samples[scores_sorted[best_idx].idx]);
         }
         
@@ -379,6 +384,110 @@ namespace dlib
         pick_initial_centers(num_centers, centers, samples, kern, percentile);
     }
 
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename vector_type1, 
+        typename vector_type2
+        >
+    void pick_initial_centers_kmeans_plus_plus (
+        long num_centers, 
+        vector_type1& centers, 
+        const vector_type2& samples, 
+        dlib::rand& rnd,
+        unsigned long num_threads = 1
+    )
+    {
+        // make sure requires clause is not broken
+        DLIB_ASSERT(num_centers > 0 && samples.size() > 0 && num_threads > 0,
+            "\tvoid pick_initial_centers_kmeans_plus_plus()"
+            << "\n\tYou passed invalid arguments to this function"
+            << "\n\tnum_centers:    " << num_centers 
+            << "\n\tsamples.size(): " << samples.size() 
+            << "\n\tnum_threads:    " << num_threads 
+            );
+
+        /*
+            This is the kmeans++ algorithm described in the paper:
+                kmeans++: The Advantages of Careful Seeding by Arthur and Vassilvitskii
+
+            Each new center is sampled with probability proportional to the squared
+            distance between a sample and its nearest already chosen center.  The
+            distance updates are done in parallel.  The samples are split into fixed size
+            blocks whose weights are summed in block order, so the centers picked depend
+            only on rnd and not on the number of threads.
+        */
+
+        const long num_samples = samples.size();
+        const long block_size = 1024;
+        const long num_blocks = (num_samples + block_size - 1)/block_size;
+
+        thread_pool tp(num_threads > 1 ? num_threads : 0);
+
+        std::vector<double> dist(num_samples, std::numeric_limits<double>::infinity());
+        std::vector<double> block_sums(num_blocks);
+
+        centers.clear();
+        long next = rnd.get_random_64bit_number()%num_samples;
+        for (long c = 0; c < num_centers; ++c)
+        {
+            centers.push_back(samples[next]);
+            if (c+1 == num_centers)
+                break;
+
+            // update the distance from each sample to its nearest center
+            const long newest = centers.size()-1;
+            parallel_for(tp, 0, num_blocks, [&](long b)
+            {
+                const long end = std::min(num_samples, (b+1)*block_size);
+                double sum = 0;
+                for (long i = b*block_size; i < end; ++i)
+                {
+                    dist[i] = std::min<double>(dist[i], length_squared(samples[i] - centers[newest]));
+                    sum += dist[i];
+                }
+                block_sums[b] = sum;
+            }, 1);
+
+            double total = 0;
+            for (long b = 0; b < num_blocks; ++b)
+                total += block_sums[b];
+
+            // If all the samples are on top of existing centers then any choice is as
+            // good as any other.
+            if (!(total > 0))
+            {
+                next = rnd.get_random_64bit_number()%num_samples;
+                continue;
+            }
+
+            // Draw a sample with probability proportional to dist.  First find the block
+            // and then the sample within the block.
+            double r = rnd.get_random_double()*total;
+            long b = 0;
+            while (b+1 < num_blocks && r >= block_sums[b])
+            {
+                r -= block_sums[b];
+                ++b;
+            }
+            const long end = std::min(num_samples, (b+1)*block_size);
+            next = end-1;
+            for (long i = b*block_size; i < end; ++i)
+            {
+                if (r < dist[i])
+                {
+                    next = i;
+                    break;
+                }
+                r -= dist[i];
+            }
+            // Rounding might make us run off the end of the block onto a sample with 0
+            // weight.  So back up to one that could actually be picked.
+            while (dist[next] == 0 && next > b*block_size)
+                --next;
+        }
+    }
+
 // ----------------------------------------------------------------------------------------
 
     template <
@@ -389,15 +498,17 @@ namespace dlib
     void find_clusters_using_kmeans (
         const array_type& samples,
         std::vector<sample_type, alloc>& centers,
-        unsigned long max_iter = 1000
+        unsigned long max_iter = 1000,
+        unsigned long num_threads = 1
     )
     {
         // make sure requires clause is not broken
-        DLIB_ASSERT(samples.size() > 0 && centers.size() > 0,
+        DLIB_ASSERT(samples.size() > 0 && centers.size() > 0 && num_threads > 0,
             "\tvoid find_clusters_using_kmeans()"
             << "\n\tYou passed invalid arguments to this function"
             << "\n\t samples.size(): " << samples.size() 
             << "\n\t centers.size(): " << centers.size() 
+            << "\n\t num_threads:    " << num_threads 
             );
 
 #ifdef ENABLE_ASSERTS
@@ -420,64 +531,162 @@ namespace dlib
         }
 #endif
 
-        typedef typename sample_type::type scalar_type;
+        /*
+            This is Lloyd's algorithm, but with the triangle inequality based pruning from
+            the paper:
+                Making k-means even faster by Greg Hamerly
+
+            For each sample we keep an upper bound on the distance to its assigned center
+            and a lower bound on the distance to every other center.  Whenever the upper
+            bound is below both the lower bound and half the distance from the assigned
+            center to its nearest neighboring center the sample can't change clusters and
+            we skip it.  Otherwise we fall back to checking all the centers.  Therefore,
+            the output is the same as the plain algorithm but most distance computations
+            are avoided once the centers begin to settle down.
+        */
 
         sample_type zero(centers[0]);
         set_all_elements(zero, 0);
 
-        std::vector<unsigned long> center_element_count;
+        const unsigned long num_samples = samples.size();
+        const unsigned long num_centers = centers.size();
+        const double inf = std::numeric_limits<double>::infinity();
 
-        // tells which center a sample belongs to
-        std::vector<unsigned long> assignments(samples.size(), samples.size());
+        // A pool with 0 threads just runs everything in the calling thread.
+        thread_pool tp(num_threads > 1 ? num_threads : 0);
 
+        // tells which center a sample belongs to.  num_centers means unassigned.
+        std::vector<unsigned long> assignments(num_samples, num_centers);
+        std::vector<double> upper(num_samples), lower(num_samples);
+        // half the distance from each center to the nearest other center
+        std::vector<double> half_gap(num_centers);
+        std::vector<double> movement(num_centers);
+        std::vector<sample_type, alloc> old_centers;
+        std::vector<unsigned long> center_element_count, members, member_start;
 
         unsigned long iter = 0;
         bool centers_changed = true;
+        mutex m;
         while (centers_changed && iter < max_iter)
         {
             ++iter;
             centers_changed = false;
-            center_element_count.assign(centers.size(), 0);
+
+            parallel_for(tp, 0, num_centers, [&](long j)
+            {
+                double best = inf;
+                for (unsigned long k = 0; k < num_centers; ++k)
+                {
+                    if (k != (unsigned long)j)
+                        best = std::min<double>(best, length(centers[j] - centers[k]));
+                }
+                half_gap[j] = best/2;
+            });
 
             // loop over each sample and see which center it is closest to
-            for (unsigned long i = 0; i < samples.size(); ++i)
+            parallel_for_blocked(tp, 0, num_samples, [&](long begin, long end)
             {
-                // find the best center for sample[i]
-                scalar_type best_dist = std::numeric_limits<scalar_type>::max();
-                unsigned long best_center = 0;
-                for (unsigned long j = 0; j < centers.size(); ++j)
+                bool changed = false;
+                for (long i = begin; i < end; ++i)
                 {
-                    scalar_type dist = length(centers[j] - samples[i]);
-                    if (dist < best_dist)
+                    const unsigned long cur = assignments[i];
+                    if (cur != num_centers)
                     {
-                        best_dist = dist;
-                        best_center = j;
+                        const double bound = std::max(half_gap[cur], lower[i]);
+                        if (upper[i] <= bound)
+                            continue;
+                        upper[i] = length(centers[cur] - samples[i]);
+                        if (upper[i] <= bound)
+                            continue;
+                    }
+
+                    // find the best center for sample[i] as well as the distance to the
+                    // second best center.
+                    double best_dist = inf;
+                    double second_dist = inf;
+                    unsigned long best_center = 0;
+                    for (unsigned long j = 0; j < num_centers; ++j)
+                    {
+                        const double dist = length(centers[j] - samples[i]);
+                        if (dist < best_dist)
+                        {
+                            second_dist = best_dist;
+                            best_dist = dist;
+                            best_center = j;
+                        }
+                        else if (dist < second_dist)
+                        {
+                            second_dist = dist;
+                        }
+                    }
+                    upper[i] = best_dist;
+                    lower[i] = second_dist;
+
+                    if (cur != best_center)
+                    {
+                        changed = true;
+                        assignments[i] = best_center;
                     }
                 }
 
-                if (assignments[i] != best_center)
+                if (changed)
                 {
+                    auto_mutex lock(m);
                     centers_changed = true;
-                    assignments[i] = best_center;
                 }
-
-                center_element_count[best_center] += 1;
+            });
+
+            // Group the samples by center so each center can be summed up independently.
+            // The samples in each group stay in their original order so the sums come out
+            // the same regardless of the number of threads.
+            center_element_count.assign(num_centers, 0);
+            for (unsigned long i = 0; i < num_samples; ++i)
+                center_element_count[assignments[i]] += 1;
+            member_start.assign(num_centers+1, 0);
+            for (unsigned long j = 0; j < num_centers; ++j)
+                member_start[j+1] = member_start[j] + center_element_count[j];
+            members.resize(num_samples);
+            {
+                std::vector<unsigned long> pos(member_start.begin(), member_start.end()-1);
+                for (unsigned long i = 0; i < num_samples; ++i)
+                    members[pos[assignments[i]]++] = i;
             }
 
             // now update all the centers
-            centers.assign(centers.size(), zero);
-            for (unsigned long i = 0; i < samples.size(); ++i)
+            old_centers = centers;
+            parallel_for(tp, 0, num_centers, [&](long j)
             {
-                centers[assignments[i]] += samples[i];
+                centers[j] = zero;
+                for (unsigned long k = member_start[j]; k < member_start[j+1]; ++k)
+                    centers[j] += samples[members[k]];
+                if (center_element_count[j] != 0)
+                    centers[j] /= center_element_count[j];
+                movement[j] = length(centers[j] - old_centers[j]);
+            });
+
+            // Finally, loosen the bounds to account for how far the centers moved.
+            unsigned long most_moved = 0;
+            for (unsigned long j = 1; j < num_centers; ++j)
+            {
+                if (movement[j] > movement[most_moved])
+                    most_moved = j;
             }
-            for (unsigned long i = 0; i < centers.size(); ++i)
+            double second_most_movement = 0;
+            for (unsigned long j = 0; j < num_centers; ++j)
             {
-                if (center_element_count[i] != 0)
-                    centers[i] /= center_element_count[i];
+                if (j != most_moved)
+                    second_most_movement = std::max(second_most_movement, movement[j]);
             }
+            parallel_for_blocked(tp, 0, num_samples, [&](long begin, long end)
+            {
+                for (long i = begin; i < end; ++i)
+                {
+                    const unsigned long a = assignments[i];
+                    upper[i] += movement[a];
+                    lower[i] -= (a == most_moved) ? second_most_movement : movement[most_moved];
+                }
+            });
         }
-
-
     }
 
 // ----------------------------------------------------------------------------------------
@@ -645,6 +854,160 @@ namespace dlib
         return best_idx;
     }
 
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename sample_type_
+        >
+    class minibatch_kmeans
+    {
+        /*
+            This object implements the algorithm from the paper:
+                Web-Scale K-Means Clustering by D. Sculley
+        */
+    public:
+        typedef sample_type_ sample_type;
+        typedef typename sample_type::type scalar_type;
+
+        minibatch_kmeans (
+        ) : num_threads(1) {}
+
+        explicit minibatch_kmeans (
+            const std::vector<sample_type>& initial_centers
+        ) : num_threads(1)
+        {
+            set_centers(initial_centers);
+        }
+
+        void set_centers (
+            const std::vector<sample_type>& new_centers
+        )
+        {
+            centers = new_centers;
+            counts.assign(centers.size(), 0);
+        }
+
+        const std::vector<sample_type>& get_centers (
+        ) const { return centers; }
+
+        const std::vector<unsigned long>& get_center_counts (
+        ) const { return counts; }
+
+        unsigned long number_of_centers (
+        ) const { return centers.size(); }
+
+        void set_num_threads (
+            unsigned long num
+        )
+        {
+            // make sure requires clause is not broken
+            DLIB_ASSERT(num > 0,
+                "\t void minibatch_kmeans::set_num_threads()"
+                << "\n\t num must be greater than 0"
+                << "\n\t num:  " << num 
+                << "\n\t this: " << this
+                );
+
+            num_threads = num;
+        }
+
+        unsigned long get_num_threads (
+        ) const { return num_threads; }
+
+        template <typename array_type>
+        void train (
+            const array_type& batch
+        )
+        {
+            // make sure requires clause is not broken
+            DLIB_ASSERT(number_of_centers() > 0,
+                "\t void minibatch_kmeans::train()"
+                << "\n\t You must give this object some initial centers before calling train()."
+                << "\n\t this: " << this
+                );
+
+            // First find the nearest center for each sample in the batch.  This is the
+            // expensive part so we do it in parallel.
+            assignments.resize(batch.size());
+            thread_pool tp(num_threads > 1 ? num_threads : 0);
+            parallel_for_blocked(tp, 0, batch.size(), [&](long begin, long end)
+            {
+                for (long i = begin; i < end; ++i)
+                    assignments[i] = nearest_center(centers, batch[i]);
+            });
+
+            // Then move each center towards the samples assigned to it.  The step size
+            // is 1/(number of samples the center has seen), so each center is the running
+            // mean of all the samples ever assigned to it.
+            for (unsigned long i = 0; i < batch.size(); ++i)
+            {
+                const unsigned long c = assignments[i];
+                counts[c] += 1;
+                const scalar_type eta = static_cast<scalar_type>(1.0/counts[c]);
+                centers[c] += eta*(batch[i] - centers[c]);
+            }
+        }
+
+        template <typename EXP>
+        unsigned long operator() (
+            const matrix_exp<EXP>& sample
+        ) const
+        {
+            // make sure requires clause is not broken
+            DLIB_ASSERT(number_of_centers() > 0,
+                "\t unsigned long minibatch_kmeans::operator()"
+                << "\n\t You must give this object some centers before calling this function."
+                << "\n\t this: " << this
+                );
+
+            return nearest_center(centers, sample);
+        }
+
+        void swap (
+            minibatch_kmeans& item
+        )
+        {
+            centers.swap(item.centers);
+            counts.swap(item.counts);
+            std::swap(num_threads, item.num_threads);
+        }
+
+        friend void serialize(const minibatch_kmeans& item, std::ostream& out)
+        {
+            int version = 1;
+            serialize(version, out);
+            serialize(item.centers, out);
+            serialize(item.counts, out);
+            serialize(item.num_threads, out);
+        }
+
+        friend void deserialize(minibatch_kmeans& item, std::istream& in)
+        {
+            int version = 0;
+            deserialize(version, in);
+            if (version != 1)
+                throw serialization_error("Unexpected version found while deserializing dlib::minibatch_kmeans.");
+            deserialize(item.centers, in);
+            deserialize(item.counts, in);
+            deserialize(item.num_threads, in);
+        }
+
+    private:
+
+        std::vector<sample_type> centers;
+        std::vector<unsigned long> counts;
+        unsigned long num_threads;
+
+        // This is here just so we don't have to reallocate it every time train() is called.
+        std::vector<unsigned long> assignments;
+    };
+
+    template <typename sample_type>
+    void swap (
+        minibatch_kmeans<sample_type>& a,
+        minibatch_kmeans<sample_type>& b
+    ) { a.swap(b); }
+
 // ----------------------------------------------------------------------------------------
 
 }
@@ -263,6 +263,43 @@ namespace dlib
               (i.e. this function is simply an overload that uses the linear kernel.
     !*/
 
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename vector_type1, 
+        typename vector_type2
+        >
+    void pick_initial_centers_kmeans_plus_plus (
+        long num_centers, 
+        vector_type1& centers, 
+        const vector_type2& samples, 
+        dlib::rand& rnd,
+        unsigned long num_threads = 1
+    );
+    /*!
+        requires
+            - num_centers > 0
+            - samples.size() > 0
+            - num_threads > 0
+            - vector_type1 == something with an interface compatible with std::vector
+            - vector_type2 == something with an interface compatible with std::vector
+            - Both centers and samples must be able to contain dlib::matrix based row or
+              column vectors.
+        ensures
+            - Picks num_centers initial cluster centers from samples using the randomized
+              kmeans++ algorithm from the paper:
+                kmeans++: The Advantages of Careful Seeding by Arthur and Vassilvitskii
+              That is, the first center is picked uniformly at random and each following
+              center is picked with probability proportional to its squared distance to
+              the nearest center picked so far.
+            - #centers.size() == num_centers
+            - #centers == a vector containing the centers found.  Each is a copy of some
+              element of samples.
+            - rnd is used to make the random choices.  The work is split across
+              num_threads threads, but the output only depends on the state of rnd and
+              not on num_threads.
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
     template <
@@ -273,7 +310,8 @@ namespace dlib
     void find_clusters_using_kmeans (
         const array_type& samples,
         std::vector<sample_type, alloc>& centers,
-        unsigned long max_iter = 1000
+        unsigned long max_iter = 1000,
+        unsigned long num_threads = 1
     );
     /*!
         requires
@@ -285,12 +323,18 @@ namespace dlib
               and it must contain row or column vectors capable of being stored in 
               sample_type objects.
             - sample_type == a dlib::matrix capable of representing vectors
+            - num_threads > 0
         ensures
             - performs regular old linear kmeans clustering on the samples.  The clustering
               begins with the initial set of centers given as an argument to this function.
               When it finishes #centers will contain the resulting centers.
             - no more than max_iter iterations will be performed before this function
               terminates.
+            - Uses the triangle inequality to avoid most of the sample to center distance
+              computations (see Making k-means even faster by Greg Hamerly).  This does
+              not change the results, it only makes things faster.
+            - The work is split across num_threads threads.  The output does not depend
+              on num_threads.
     !*/
 
 // ----------------------------------------------------------------------------------------
@@ -357,6 +401,170 @@ namespace dlib
               of centers that minimizes length(centers[IDX]-sample).
     !*/
 
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename sample_type_
+        >
+    class minibatch_kmeans
+    {
+        /*!
+            REQUIREMENTS ON sample_type_
+                must be a dlib::matrix capable of representing a row or column vector.
+
+            INITIAL VALUE
+                - number_of_centers() == 0
+                - get_num_threads() == 1
+
+            WHAT THIS OBJECT REPRESENTS
+                This object is a tool for running linear kmeans clustering on a stream of
+                data that is too big to hold in memory all at once.  It implements the mini
+                batch kmeans algorithm from the paper:
+                    Web-Scale K-Means Clustering by D. Sculley
+
+                You give it some initial centers (e.g. from pick_initial_centers()) and
+                then repeatedly call train() with small batches of samples.  Each call
+                moves the centers towards the samples assigned to them.  In particular,
+                each center is kept equal to the mean of all the samples that were
+                assigned to it when train() saw them.
+        !*/
+    public:
+        typedef sample_type_ sample_type;
+        typedef typename sample_type::type scalar_type;
+
+        minibatch_kmeans (
+        );
+        /*!
+            ensures
+                - this object is properly initialized
+        !*/
+
+        explicit minibatch_kmeans (
+            const std::vector<sample_type>& initial_centers
+        );
+        /*!
+            ensures
+                - #get_centers() == initial_centers
+                - #get_num_threads() == 1
+        !*/
+
+        void set_centers (
+            const std::vector<sample_type>& new_centers
+        );
+        /*!
+            ensures
+                - #get_centers() == new_centers
+                - #get_center_counts().size() == new_centers.size()
+                - all elements of #get_center_counts() are 0
+        !*/
+
+        const std::vector<sample_type>& get_centers (
+        ) const;
+        /*!
+            ensures
+                - returns the current cluster centers
+        !*/
+
+        const std::vector<unsigned long>& get_center_counts (
+        ) const;
+        /*!
+            ensures
+                - returns a vector C such that:
+                    - C.size() == number_of_centers()
+                    - C[i] == the number of samples given to train() that were assigned
+                      to the ith center.
+        !*/
+
+        unsigned long number_of_centers (
+        ) const;
+        /*!
+            ensures
+                - returns get_centers().size()
+        !*/
+
+        void set_num_threads (
+            unsigned long num
+        );
+        /*!
+            requires
+                - num > 0
+            ensures
+                - #get_num_threads() == num
+        !*/
+
+        unsigned long get_num_threads (
+        ) const;
+        /*!
+            ensures
+                - returns the number of threads train() uses to find the nearest center
+                  for each sample in a batch.  The results of train() do not depend on
+                  this value.
+        !*/
+
+        template <typename array_type>
+        void train (
+            const array_type& batch
+        );
+        /*!
+            requires
+                - number_of_centers() > 0
+                - array_type == something with an interface compatible with std::vector
+                  and it must contain vectors of the same dimensionality as the centers.
+            ensures
+                - Assigns each sample in batch to its nearest center.  Then, going over
+                  the batch in order, moves each sample's center towards it by a step of
+                  1/(updated count for that center).
+                - for all valid i: #get_center_counts()[i] == get_center_counts()[i] +
+                  the number of samples in batch assigned to center i.
+        !*/
+
+        template <typename EXP>
+        unsigned long operator() (
+            const matrix_exp<EXP>& sample
+        ) const;
+        /*!
+            requires
+                - number_of_centers() > 0
+            ensures
+                - returns nearest_center(get_centers(), sample)
+        !*/
+
+        void swap (
+            minibatch_kmeans& item
+        );
+        /*!
+            ensures
+                - swaps *this and item
+        !*/
+    };
+
+    template <typename sample_type>
+    void swap (
+        minibatch_kmeans<sample_type>& a,
+        minibatch_kmeans<sample_type>& b
+    ) { a.swap(b); }
+    /*!
+        provides a global swap function
+    !*/
+
+    template <typename sample_type>
+    void serialize (
+        const minibatch_kmeans<sample_type>& item,
+        std::ostream& out
+    );
+    /*!
+        provides serialization support
+    !*/
+
+    template <typename sample_type>
+    void deserialize (
+        minibatch_kmeans<sample_type>& item,
+        std::istream& in 
+    );
+    /*!
+        provides deserialization support
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
 }
@@ -17,7 +17,12 @@
 #include "../any.h"
 #include <map>
 #include <set>
+#include <memory>
+#include <algorithm>
 #include "../threads.h"
+#include "kernel_cache.h"
+#include "svm_c_trainer.h"
+#include "svm_nu_trainer.h"
 
 namespace dlib
 {
@@ -87,6 +92,29 @@ namespace dlib
             return num_threads;
         }
 
+        template <
+            typename kernel_type
+            >
+        void set_shared_kernel_cache (
+            const kernel_type& kernel,
+            size_t max_bytes
+        )
+        {
+            cache_maker.reset(new kernel_cache_maker<kernel_type>(kernel, max_bytes));
+        }
+
+        bool uses_shared_kernel_cache (
+        ) const
+        {
+            return cache_maker.get() != 0;
+        }
+
+        void disable_shared_kernel_cache (
+        )
+        {
+            cache_maker.reset();
+        }
+
         struct invalid_label : public dlib::error 
         { 
             invalid_label(const std::string& msg, const label_type& l1_, const label_type& l2_
@@ -136,8 +164,23 @@ namespace dlib
 
 
 
+            std::unique_ptr<shared_kernel_cache_base> cache;
+            if (cache_maker)
+            {
+                // Put each class in its own group of the kernel cache.  That way each
+                // binary problem only computes kernel values for the rows of its two
+                // classes, and those are reused by every other pair involving them.
+                std::vector<unsigned long> groups(all_labels.size());
+                for (unsigned long i = 0; i < all_labels.size(); ++i)
+                {
+                    groups[i] = std::lower_bound(distinct_labels.begin(), distinct_labels.end(),
+                                                 all_labels[i]) - distinct_labels.begin();
+                }
+                cache = cache_maker->make_cache(all_samples, groups);
+            }
+
             // Now train on all the label pairs.  
-            parallel_for_helper helper(all_samples,all_labels,default_trainer,trainers,verbose,pairs);
+            parallel_for_helper helper(all_samples,all_labels,default_trainer,trainers,verbose,pairs,cache.get());
             parallel_for(num_threads, 0, pairs.size(), helper, 500);
 
             if (helper.error_message.size() != 0)
@@ -150,6 +193,97 @@ namespace dlib
     private:
 
         typedef std::map<unordered_pair<label_type>, any_trainer> binary_function_table;
+        typedef typename any_trainer::trained_function_type binary_function_type;
+
+        struct shared_kernel_cache_base
+        {
+            virtual ~shared_kernel_cache_base() {}
+
+            virtual bool train (
+                const any_trainer& trainer,
+                const std::vector<unsigned long>& idx,
+                const std::vector<scalar_type>& labels,
+                binary_function_type& df
+            ) const = 0;
+            /*!
+                ensures
+                    - if (trainer is a svm_c_trainer or svm_nu_trainer that can use the
+                      kernel cache inside this object) then
+                        - #df == the result of training trainer on the samples selected
+                          by idx, using the cached kernel values.
+                        - returns true
+                    - else
+                        - returns false
+            !*/
+        };
+
+        template <typename kernel_type>
+        struct shared_kernel_cache : public shared_kernel_cache_base
+        {
+            shared_kernel_cache(
+                const kernel_type& kernel,
+                const std::vector<sample_type>& samples,
+                const std::vector<unsigned long>& groups,
+                size_t max_bytes
+            ) : cache(kernel, samples, groups, max_bytes) {}
+
+            virtual bool train (
+                const any_trainer& trainer,
+                const std::vector<unsigned long>& idx,
+                const std::vector<scalar_type>& labels,
+                binary_function_type& df
+            ) const
+            {
+                typedef svm_c_trainer<kernel_type> c_trainer;
+                typedef svm_nu_trainer<kernel_type> nu_trainer;
+                if (trainer.template contains<c_trainer>() && 
+                    trainer.template cast_to<c_trainer>().get_kernel() == cache.get_kernel())
+                {
+                    df = trainer.template cast_to<c_trainer>().train(cache, idx, labels);
+                    return true;
+                }
+                else if (trainer.template contains<nu_trainer>() && 
+                    trainer.template cast_to<nu_trainer>().get_kernel() == cache.get_kernel())
+                {
+                    df = trainer.template cast_to<nu_trainer>().train(cache, idx, labels);
+                    return true;
+                }
+                return false;
+            }
+
+            kernel_cache<kernel_type> cache;
+        };
+
+        struct kernel_cache_maker_base
+        {
+            virtual ~kernel_cache_maker_base() {}
+
+            virtual std::unique_ptr<shared_kernel_cache_base> make_cache (
+                const std::vector<sample_type>& samples,
+                const std::vector<unsigned long>& groups
+            ) const = 0;
+        };
+
+        template <typename kernel_type>
+        struct kernel_cache_maker : public kernel_cache_maker_base
+        {
+            kernel_cache_maker(
+                const kernel_type& kernel_,
+                size_t max_bytes_
+            ) : kernel(kernel_), max_bytes(max_bytes_) {}
+
+            virtual std::unique_ptr<shared_kernel_cache_base> make_cache (
+                const std::vector<sample_type>& samples,
+                const std::vector<unsigned long>& groups
+            ) const
+            {
+                return std::unique_ptr<shared_kernel_cache_base>(
+                    new shared_kernel_cache<kernel_type>(kernel, samples, groups, max_bytes));
+            }
+
+            kernel_type kernel;
+            size_t max_bytes;
+        };
 
         struct parallel_for_helper
         {
@@ -159,21 +293,23 @@ namespace dlib
                 const any_trainer& default_trainer_,
                 const binary_function_table& trainers_,
                 const bool verbose_,
-                const std::vector<unordered_pair<label_type> >& pairs_
+                const std::vector<unordered_pair<label_type> >& pairs_,
+                const shared_kernel_cache_base* cache_
             ) : 
                 all_samples(all_samples_),
                 all_labels(all_labels_),
                 default_trainer(default_trainer_),
                 trainers(trainers_), 
                 verbose(verbose_),
-                pairs(pairs_)
+                pairs(pairs_),
+                cache(cache_)
             {}
 
             void operator()(long i) const 
             {
                 try
                 {
-                    std::vector<sample_type> samples;
+                    std::vector<unsigned long> idx;
                     std::vector<scalar_type> labels;
 
                     const unordered_pair<label_type> p = pairs[i];
@@ -183,12 +319,12 @@ namespace dlib
                     {
                         if (all_labels[k] == p.first)
                         {
-                            samples.push_back(all_samples[k]);
+                            idx.push_back(k);
                             labels.push_back(+1);
                         }
                         else if (all_labels[k] == p.second)
                         {
-                            samples.push_back(all_samples[k]);
+                            idx.push_back(k);
                             labels.push_back(-1);
                         }
                     }
@@ -209,7 +345,15 @@ namespace dlib
                         trainer = default_trainer;
                     }
 
-                    any_decision_function<sample_type,scalar_type> binary_df = trainer.train(samples, labels);
+                    binary_function_type binary_df;
+                    if (!cache || !cache->train(trainer, idx, labels, binary_df))
+                    {
+                        std::vector<sample_type> samples;
+                        samples.reserve(idx.size());
+                        for (unsigned long k = 0; k < idx.size(); ++k)
+                            samples.push_back(all_samples[idx[k]]);
+                        binary_df = trainer.train(samples, labels);
+                    }
 
                     auto_mutex lock(class_mutex);
                     dfs[p] = binary_df;
@@ -231,6 +375,7 @@ namespace dlib
             const binary_function_table& trainers;
             const bool verbose;
             const std::vector<unordered_pair<label_type> >& pairs;
+            const shared_kernel_cache_base* cache;
         };
 
         
@@ -238,6 +383,7 @@ namespace dlib
         binary_function_table trainers;
         bool verbose;
         unsigned long num_threads;
+        std::shared_ptr<kernel_cache_maker_base> cache_maker;
 
     };
 
@@ -60,6 +60,7 @@ namespace dlib
                 - No binary trainers are associated with *this.  I.e. you have to
                   call set_trainer() before calling train().
                 - #get_num_threads() == 4
+                - #uses_shared_kernel_cache() == false
         !*/
 
         void set_trainer (
@@ -117,6 +118,46 @@ namespace dlib
                   machine.
         !*/
 
+        template <
+            typename kernel_type
+            >
+        void set_shared_kernel_cache (
+            const kernel_type& kernel,
+            size_t max_bytes
+        );
+        /*!
+            requires
+                - kernel_type::sample_type == sample_type
+            ensures
+                - #uses_shared_kernel_cache() == true
+                - When train() is called, it will create a kernel_cache (see
+                  dlib/svm/kernel_cache_abstract.h) over all the training samples using
+                  the given kernel and a budget of max_bytes bytes.  Every binary trainer
+                  that is an svm_c_trainer<kernel_type> or svm_nu_trainer<kernel_type> with
+                  a kernel equal to the given kernel will then take its kernel values from
+                  this one cache, which is shared by all the training threads.  The
+                  cache puts each class in its own group, so a binary problem only
+                  computes the kernel values between samples of its two classes, and
+                  each of those is reused by every other binary problem involving the
+                  same classes rather than being recomputed for every pair of classes.
+                - Binary trainers of any other type are trained as usual.
+        !*/
+
+        bool uses_shared_kernel_cache (
+        ) const;
+        /*!
+            ensures
+                - returns true if set_shared_kernel_cache() has been called and
+                  disable_shared_kernel_cache() hasn't been called since.
+        !*/
+
+        void disable_shared_kernel_cache (
+        );
+        /*!
+            ensures
+                - #uses_shared_kernel_cache() == false
+        !*/
+
         struct invalid_label : public dlib::error 
         { 
             /*!
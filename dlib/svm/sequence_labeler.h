@@ -214,7 +214,7 @@ namespace dlib
         };
     public:
 
-        sequence_labeler()
+        sequence_labeler() : beam_width(0)
         {
             weights.set_size(fe.num_features());
             weights = 0;
@@ -223,7 +223,8 @@ namespace dlib
         explicit sequence_labeler(
             const matrix<double,0,1>& weights_
         ) : 
-            weights(weights_)
+            weights(weights_),
+            beam_width(0)
         {
             // make sure requires clause is not broken
             DLIB_ASSERT(fe.num_features() == static_cast<unsigned long>(weights_.size()),
@@ -240,7 +241,8 @@ namespace dlib
             const feature_extractor& fe_
         ) :
             fe(fe_),
-            weights(weights_)
+            weights(weights_),
+            beam_width(0)
         {
             // make sure requires clause is not broken
             DLIB_ASSERT(fe_.num_features() == static_cast<unsigned long>(weights_.size()),
@@ -261,6 +263,13 @@ namespace dlib
         unsigned long num_labels (
         ) const { return fe.num_labels(); }
 
+        void set_beam_width (
+            unsigned long width
+        ) { beam_width = width; }
+
+        unsigned long get_beam_width (
+        ) const { return beam_width; }
+
         labeled_sequence_type operator() (
             const sample_sequence_type& x
         ) const
@@ -273,7 +282,7 @@ namespace dlib
                 );
 
             labeled_sequence_type y;
-            find_max_factor_graph_viterbi(map_prob(x,fe,weights), y);
+            find_max_factor_graph_viterbi(map_prob(x,fe,weights), y, beam_width);
             return y;
         }
 
@@ -289,13 +298,14 @@ namespace dlib
                 << "\n\t this: " << this
                 );
 
-            find_max_factor_graph_viterbi(map_prob(x,fe,weights), y);
+            find_max_factor_graph_viterbi(map_prob(x,fe,weights), y, beam_width);
         }
 
     private:
 
         feature_extractor fe;
         matrix<double,0,1> weights;
+        unsigned long beam_width;
     };
 
 // ----------------------------------------------------------------------------------------
@@ -281,6 +281,7 @@ namespace dlib
                   (i.e. it will have its default value)
                 - #get_weights().size() == #get_feature_extractor().num_features()
                 - #get_weights() == 0
+                - #get_beam_width() == 0
         !*/
 
         explicit sequence_labeler(
@@ -293,6 +294,7 @@ namespace dlib
                 - #get_feature_extractor() == feature_extractor() 
                   (i.e. it will have its default value)
                 - #get_weights() == weights
+                - #get_beam_width() == 0
         !*/
 
         sequence_labeler(
@@ -305,6 +307,7 @@ namespace dlib
             ensures
                 - #get_feature_extractor() == fe
                 - #get_weights() == weights
+                - #get_beam_width() == 0
         !*/
 
         const feature_extractor& get_feature_extractor (
@@ -331,6 +334,28 @@ namespace dlib
                   element of a sequence)
         !*/
 
+        void set_beam_width (
+            unsigned long width
+        );
+        /*!
+            ensures
+                - #get_beam_width() == width
+        !*/
+
+        unsigned long get_beam_width (
+        ) const;
+        /*!
+            ensures
+                - returns the beam width used when labeling sequences.  If it is 0 then
+                  the exact Viterbi algorithm is used.  Otherwise, labeling is done with
+                  find_max_factor_graph_viterbi(prob,y,get_beam_width()), which only
+                  keeps the get_beam_width() best partial labelings at each element of
+                  a sequence.  This is much faster when num_labels() is large but might
+                  not find the best labeling.
+                - The beam width is not saved by serialize(), so a deserialized
+                  sequence_labeler always has a beam width of 0.
+        !*/
+
         labeled_sequence_type operator() (
             const sample_sequence_type& x
         ) const;
@@ -340,6 +365,11 @@ namespace dlib
             ensures
                 - returns a vector Y of label values such that:
                     - Y.size() == x.size()
+                    - if (get_beam_width() == 0) then
+                        - Y == argmax_Y dot(get_weights(), PSI(x,Y))
+                    - else
+                        - Y is found with a beam search over the labelings and may
+                          only approximately maximize dot(get_weights(), PSI(x,Y)).
                     - for all valid i: 
                         - Y[i] == the predicted label for x[i]
                         - 0 <= Y[i] < num_labels()
@@ -58,6 +58,19 @@ namespace dlib
             return num_threads;
         }
 
+        void set_beam_width (
+            unsigned long width
+        )
+        {
+            beam_width = width;
+        }
+
+        unsigned long get_beam_width (
+        ) const
+        {
+            return beam_width;
+        }
+
         void set_epsilon (
             double eps_
         )
@@ -228,12 +241,15 @@ namespace dlib
             prob.set_max_iterations(max_iterations);
             prob.set_c(C);
             prob.set_max_cache_size(max_cache_size);
+            prob.set_beam_width(beam_width);
             for (unsigned long i = 0; i < loss_values.size(); ++i)
                 prob.set_loss(i,loss_values[i]);
 
             solver(prob, weights, num_nonnegative_weights(fe));
 
-            return sequence_labeler<feature_extractor>(weights,fe);
+            sequence_labeler<feature_extractor> labeler(weights,fe);
+            labeler.set_beam_width(beam_width);
+            return labeler;
         }
 
     private:
@@ -244,6 +260,7 @@ namespace dlib
         unsigned long max_iterations;
         bool verbose;
         unsigned long num_threads;
+        unsigned long beam_width;
         unsigned long max_cache_size;
         std::vector<double> loss_values;
 
@@ -254,6 +271,7 @@ namespace dlib
             eps = 0.1;
             max_iterations = 10000;
             num_threads = 2;
+            beam_width = 0;
             max_cache_size = 5;
             loss_values.assign(num_labels(), 1);
         }
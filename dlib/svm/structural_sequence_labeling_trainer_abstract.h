@@ -49,6 +49,7 @@ namespace dlib
                 - #get_epsilon() == 0.1
                 - #get_max_iterations() == 10000
                 - #get_num_threads() == 2
+                - #get_beam_width() == 0
                 - #get_max_cache_size() == 5
                 - #get_feature_extractor() == a default initialized feature_extractor
         !*/
@@ -63,6 +64,7 @@ namespace dlib
                 - #get_epsilon() == 0.1
                 - #get_max_iterations() == 10000
                 - #get_num_threads() == 2
+                - #get_beam_width() == 0
                 - #get_max_cache_size() == 5
                 - #get_feature_extractor() == fe 
         !*/
@@ -100,6 +102,27 @@ namespace dlib
                   machine.
         !*/
 
+        void set_beam_width (
+            unsigned long width
+        );
+        /*!
+            ensures
+                - #get_beam_width() == width
+        !*/
+
+        unsigned long get_beam_width (
+        ) const;
+        /*!
+            ensures
+                - returns the beam width used to find the most violated labelings during
+                  training.  If it is 0 then the exact Viterbi algorithm is used.
+                  Otherwise, a beam search which keeps only the get_beam_width() best
+                  partial labelings is used instead.  This makes training much faster
+                  when num_labels() is large, at the cost of only approximately solving
+                  each separation problem.
+                - The sequence_labeler returned by train() uses this same beam width.
+        !*/
+
         void set_epsilon (
             double eps
         );
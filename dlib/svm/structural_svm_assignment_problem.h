@@ -9,6 +9,7 @@
 #include <vector>
 #include <iterator>
 #include "structural_svm_problem_threaded.h"
+#include "../optimization/max_cost_assignment.h"
 
 // ----------------------------------------------------------------------------------------
 
@@ -189,68 +190,107 @@ namespace dlib
             feature_vector_type& psi
         ) const
         {
-            matrix<double> cost;
-            unsigned long size;
+            typename feature_extractor::feature_vector_type feats;
+            const double bias = current_solution(current_solution.size()-1);
+            std::vector<long> assignment;
+
             if (force_assignment)
             {
+                matrix<double> cost;
                 unsigned long lhs_size = samples[idx].first.size();
                 unsigned long rhs_size = samples[idx].second.size();
-                size = std::max(lhs_size, rhs_size);
-            }
-            else
-            {
-                unsigned long rhs_size = samples[idx].second.size() + samples[idx].first.size();
-                size = rhs_size;
-            }
-            cost.set_size(size, size);
+                const unsigned long size = std::max(lhs_size, rhs_size);
+                cost.set_size(size, size);
 
-            typename feature_extractor::feature_vector_type feats;
-
-            // now fill out the cost assignment matrix
-            for (long r = 0; r < cost.nr(); ++r)
-            {
-                for (long c = 0; c < cost.nc(); ++c)
+                // now fill out the cost assignment matrix
+                for (long r = 0; r < cost.nr(); ++r)
                 {
-                    if (r < (long)samples[idx].first.size())
+                    for (long c = 0; c < cost.nc(); ++c)
                     {
-                        if (c < (long)samples[idx].second.size())
+                        if (r < (long)samples[idx].first.size())
                         {
-                            fe.get_features(samples[idx].first[r], samples[idx].second[c], feats);
-                            const double bias = current_solution(current_solution.size()-1);
-                            cost(r,c) = dot(colm(current_solution,0,current_solution.size()-1), feats) + bias;
-
-                            // add in the loss since this corresponds to an incorrect prediction.
-                            if (c != labels[idx][r])
+                            if (c < (long)samples[idx].second.size())
                             {
-                                cost(r,c) += loss_per_false_association;
+                                fe.get_features(samples[idx].first[r], samples[idx].second[c], feats);
+                                cost(r,c) = dot(colm(current_solution,0,current_solution.size()-1), feats) + bias;
+
+                                // add in the loss since this corresponds to an incorrect prediction.
+                                if (c != labels[idx][r])
+                                {
+                                    cost(r,c) += loss_per_false_association;
+                                }
                             }
+                            else
+                            {
+                                if (labels[idx][r] == -1)
+                                    cost(r,c) = 0;
+                                else
+                                    cost(r,c) = loss_per_missed_association; 
+                            }
+
                         }
                         else
                         {
-                            if (labels[idx][r] == -1)
-                                cost(r,c) = 0;
-                            else
-                                cost(r,c) = loss_per_missed_association; 
+                            cost(r,c) = 0;
                         }
-
-                    }
-                    else
-                    {
-                        cost(r,c) = 0;
                     }
                 }
+
+                if (cost.size() != 0)
+                {
+                    // max_cost_assignment() only works with integer matrices, so convert from
+                    // double to integer.
+                    const double scale = (std::numeric_limits<dlib::int64>::max()/1000)/max(abs(cost));
+                    matrix<dlib::int64> int_cost = matrix_cast<dlib::int64>(round(cost*scale));
+                    assignment = max_cost_assignment(int_cost);
+                    assignment.resize(samples[idx].first.size());
+                }
             }
+            else
+            {
+                // Each lhs element gets unassigned_score for not being assigned.  Measure
+                // the score of every pair relative to that, then only the pairs which
+                // beat it can be part of the best assignment.  So we give just those to
+                // the sparse solver.
+                const unsigned long lhs_size = samples[idx].first.size();
+                std::vector<std::vector<std::pair<unsigned long,double> > > scores(lhs_size);
+                double max_score = 0;
+                for (unsigned long r = 0; r < lhs_size; ++r)
+                {
+                    const double unassigned_score = (labels[idx][r] == -1) ? 0 : loss_per_missed_association;
+                    for (unsigned long c = 0; c < samples[idx].second.size(); ++c)
+                    {
+                        fe.get_features(samples[idx].first[r], samples[idx].second[c], feats);
+                        double score = dot(colm(current_solution,0,current_solution.size()-1), feats) + bias;
 
-            std::vector<long> assignment;
+                        // add in the loss since this corresponds to an incorrect prediction.
+                        if ((long)c != labels[idx][r])
+                            score += loss_per_false_association;
 
-            if (cost.size() != 0)
-            {
-                // max_cost_assignment() only works with integer matrices, so convert from
-                // double to integer.
-                const double scale = (std::numeric_limits<dlib::int64>::max()/1000)/max(abs(cost));
-                matrix<dlib::int64> int_cost = matrix_cast<dlib::int64>(round(cost*scale));
-                assignment = max_cost_assignment(int_cost);
-                assignment.resize(samples[idx].first.size());
+                        score -= unassigned_score;
+                        if (score > 0)
+                        {
+                            scores[r].push_back(std::make_pair(c, score));
+                            max_score = std::max(max_score, score);
+                        }
+                    }
+                }
+
+                assignment.assign(lhs_size, -1);
+                if (max_score > 0)
+                {
+                    // sparse_max_cost_assignment() only works with integers, so convert
+                    // from double to integer.  Scale things so that even the sum of all
+                    // the scores can't overflow.
+                    const double scale = (std::numeric_limits<dlib::int64>::max()/1000)/(max_score*(lhs_size+1));
+                    std::vector<std::vector<std::pair<unsigned long,dlib::int64> > > int_cost(lhs_size);
+                    for (unsigned long r = 0; r < scores.size(); ++r)
+                    {
+                        for (unsigned long i = 0; i < scores[r].size(); ++i)
+                            int_cost[r].push_back(std::make_pair(scores[r][i].first, (dlib::int64)std::floor(scores[r][i].second*scale + 0.5)));
+                    }
+                    assignment = sparse_max_cost_assignment(int_cost);
+                }
             }
 
             loss = 0;
@@ -82,7 +82,8 @@ namespace dlib
             structural_svm_problem_threaded<matrix_type,feature_vector_type>(num_threads),
             samples(samples_),
             labels(labels_),
-            fe(fe_)
+            fe(fe_),
+            beam_width(0)
         {
             // make sure requires clause is not broken
             DLIB_ASSERT(is_sequence_labeling_problem(samples,labels) == true &&
@@ -155,6 +156,13 @@ namespace dlib
             loss_values[label] = value;
         }
 
+        void set_beam_width (
+            unsigned long width
+        ) { beam_width = width; }
+
+        unsigned long get_beam_width (
+        ) const { return beam_width; }
+
     private:
         virtual long get_num_dimensions (
         ) const 
@@ -255,7 +263,7 @@ namespace dlib
         ) const
         {
             std::vector<unsigned long> y;
-            find_max_factor_graph_viterbi(map_prob(samples[idx],labels[idx],fe,current_solution,loss_values), y);
+            find_max_factor_graph_viterbi(map_prob(samples[idx],labels[idx],fe,current_solution,loss_values), y, beam_width);
 
             loss = 0;
             for (unsigned long i = 0; i < y.size(); ++i)
@@ -271,6 +279,7 @@ namespace dlib
         const std::vector<std::vector<unsigned long> >& labels;
         const feature_extractor& fe;
         std::vector<double> loss_values;
+        unsigned long beam_width;
     };
 
 // ----------------------------------------------------------------------------------------
@@ -66,6 +66,7 @@ namespace dlib
                   available processing cores on your machine.
                 - #num_labels() == fe.num_labels()
                 - for all valid i: #get_loss(i) == 1
+                - #get_beam_width() == 0
         !*/
 
         unsigned long num_labels (
@@ -99,6 +100,24 @@ namespace dlib
             ensures
                 - #get_loss(label) == value
         !*/
+
+        void set_beam_width (
+            unsigned long width
+        );
+        /*!
+            ensures
+                - #get_beam_width() == width
+        !*/
+
+        unsigned long get_beam_width (
+        ) const;
+        /*!
+            ensures
+                - returns the beam width given to find_max_factor_graph_viterbi() by the
+                  separation oracle.  If it is 0 then the separation oracle is solved
+                  exactly.  Otherwise, it is solved approximately with a beam search,
+                  which is much faster when num_labels() is large.
+        !*/
     };
 
 // ----------------------------------------------------------------------------------------
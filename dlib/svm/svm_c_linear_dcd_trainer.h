@@ -9,6 +9,7 @@
 #include "../matrix.h"
 #include "../algs.h"
 #include "../rand.h"
+#include "../threads.h"
 #include "svm.h"
 
 #include "function.h"
@@ -49,7 +50,8 @@ namespace dlib
             have_bias(true),
             last_weight_1(false),
             do_shrinking(true),
-            do_svm_l2(false)
+            do_svm_l2(false),
+            num_threads(1)
         {
         }
 
@@ -64,7 +66,8 @@ namespace dlib
             have_bias(true),
             last_weight_1(false),
             do_shrinking(true),
-            do_svm_l2(false)
+            do_svm_l2(false),
+            num_threads(1)
         {
             // make sure requires clause is not broken
             DLIB_ASSERT(0 < C_,
@@ -114,6 +117,26 @@ namespace dlib
             bool enabled
         ) { do_svm_l2 = enabled; }
 
+        void set_num_threads (
+            unsigned long num
+        )
+        {
+            // make sure requires clause is not broken
+            DLIB_ASSERT(num > 0,
+                "\t void svm_c_linear_dcd_trainer::set_num_threads()"
+                << "\n\t num must be greater than 0"
+                << "\n\t num:  " << num 
+                << "\n\t this: " << this
+                );
+            num_threads = num;
+        }
+
+        unsigned long get_num_threads (
+        ) const
+        {
+            return num_threads;
+        }
+
         void be_verbose (
         )
         {
@@ -226,6 +249,10 @@ namespace dlib
         public:
             optimizer_state() : did_init(false) {}
 
+            explicit optimizer_state(
+                const std::vector<scalar_type>& initial_alpha
+            ) : did_init(false), alpha(initial_alpha) {}
+
         private:
 
             template <
@@ -321,12 +348,19 @@ namespace dlib
                 }
                 else
                 {
+                    DLIB_CASSERT( x.size() >= static_cast<long>(alpha.size()),
+                                "\t decision_function svm_c_linear_dcd_trainer::train(x,y,state)"
+                                << "\n\t The given state object is invalid because it has more initial alphas than there are samples."
+                                << "\n\t x.size():     " << x.size() 
+                                << "\n\t alpha.size(): " << alpha.size() 
+                        );
+
                     did_init = true;
                     have_bias = have_bias_;
                     last_weight_1 = last_weight_1_;
                     dims = new_dims;
 
-                    alpha.resize(x.size());
+                    alpha.resize(x.size(),0);
 
                     index.reserve(x.size());
                     Q.reserve(x.size());
@@ -337,6 +371,20 @@ namespace dlib
                         w.set_size(dims);
 
                     w = 0;
+
+                    // If we were given initial alphas then start from the w they imply.
+                    // With the usual hinge loss alpha can't be larger than C, so clip it.
+                    for (long i = 0; i < x.size(); ++i)
+                    {
+                        if (!do_svm_l2_)
+                            alpha[i] = std::min(alpha[i], (y(i) > 0) ? Cpos : Cneg);
+                        if (alpha[i] != 0)
+                        {
+                            add_to(w, x(i), alpha[i]*y(i));
+                            if (have_bias && !last_weight_1)
+                                w(w.size()-1) -= alpha[i]*y(i);
+                        }
+                    }
                 }
 
                 for (long i = new_idx; i < x.size(); ++i)
@@ -518,6 +566,12 @@ namespace dlib
 
             state.init(x,y,have_bias,last_weight_1,do_svm_l2,Cpos,Cneg);
 
+            if (num_threads > 1)
+            {
+                do_train_parallel(x,y,state);
+                return make_decision_function(state);
+            }
+
             std::vector<scalar_type>& alpha = state.alpha;
             scalar_vector_type& w = state.w;
             std::vector<long>& index = state.index;
@@ -651,8 +705,14 @@ namespace dlib
 
             } // end of main optimization loop
 
+            return make_decision_function(state);
+        }
 
-
+        const decision_function<kernel_type> make_decision_function (
+            const optimizer_state& state
+        ) const
+        {
+            const scalar_vector_type& w = state.w;
 
             // put the solution into a decision function and then return it
             decision_function<kernel_type> df;
@@ -665,13 +725,220 @@ namespace dlib
             // Copy the plane normal into the output basis vector.  The output vector might
             // be a sparse vector container so we need to use this special kind of copy to
             // handle that case.  
-            assign(df.basis_vectors(0), colm(w, 0, dims));
+            assign(df.basis_vectors(0), colm(w, 0, state.dims));
             df.alpha.set_size(1);
             df.alpha(0) = 1;
 
             return df;
         }
 
+    // ------------------------------------------------------------------------------------
+
+        struct dcd_block
+        {
+            scalar_vector_type dw;
+            std::vector<long> shrunk;
+            unsigned long begin;
+            unsigned long end;
+            unsigned long num_kept;
+            scalar_type PG_max;
+            scalar_type PG_min;
+        };
+
+        template <
+            typename in_sample_vector_type,
+            typename in_scalar_vector_type
+            >
+        void do_train_parallel (
+            const in_sample_vector_type& x,
+            const in_scalar_vector_type& y,
+            optimizer_state& state 
+        ) const
+        {
+            /*
+                This is the block-partitioned version of the solver.  Each outer iteration
+                splits the active samples into num_threads disjoint blocks and runs one
+                pass of coordinate descent over each block in parallel.  Every block sees
+                the shared w from the start of the iteration plus its own pending changes
+                and the changes from all the blocks are summed into w at the end of the
+                iteration.  To make that sum safe each block solves its local dual
+                sub-problem with the quadratic term scaled by the number of blocks, which
+                is the CoCoA+ scheme from "Adding vs. Averaging in Distributed
+                Primal-Dual Optimization" by Ma, Smith, Jaggi, et al.  The result does not
+                depend on thread timing and converges to the same solution as the serial
+                solver.
+            */
+            std::vector<scalar_type>& alpha = state.alpha;
+            scalar_vector_type& w = state.w;
+            std::vector<long>& index = state.index;
+            const long dims = state.dims;
+
+            unsigned long active_size = index.size();
+
+            scalar_type PG_max_prev = std::numeric_limits<scalar_type>::infinity();
+            scalar_type PG_min_prev = -std::numeric_limits<scalar_type>::infinity();
+
+            const scalar_type Dii_pos = 1/(2*Cpos);
+            const scalar_type Dii_neg = 1/(2*Cneg);
+
+            thread_pool tp(num_threads);
+            std::vector<dcd_block> blocks(num_threads);
+            std::vector<long> new_index;
+
+            // main loop
+            for (unsigned long iter = 0; iter < max_iterations; ++iter)
+            {
+                // randomly shuffle the indices
+                for (unsigned long i = 0; i < active_size; ++i)
+                {
+                    // pick a random index >= i
+                    const long j = i + state.rnd.get_random_32bit_number()%(active_size-i);
+                    std::swap(index[i], index[j]);
+                }
+
+                const unsigned long num_blocks = std::max<unsigned long>(1, std::min<unsigned long>(num_threads, active_size));
+                const scalar_type sigma = num_blocks;
+                for (unsigned long b = 0; b < num_blocks; ++b)
+                {
+                    blocks[b].begin = active_size*b/num_blocks;
+                    blocks[b].end = active_size*(b+1)/num_blocks;
+                }
+
+                parallel_for(tp, 0, num_blocks, [&](long b)
+                {
+                    dcd_block& blk = blocks[b];
+                    blk.dw.set_size(w.size());
+                    blk.dw = 0;
+                    blk.shrunk.clear();
+                    blk.num_kept = 0;
+                    blk.PG_max = -std::numeric_limits<scalar_type>::infinity();
+                    blk.PG_min = std::numeric_limits<scalar_type>::infinity();
+
+                    for (unsigned long ii = blk.begin; ii < blk.end; ++ii)
+                    {
+                        const long i = index[ii];
+
+                        scalar_type G = y(i)*(dot(w, x(i)) + sigma*dot(blk.dw, x(i))) - 1;
+                        scalar_type Dii = 0;
+                        if (do_svm_l2)
+                        {
+                            Dii = (y(i) > 0) ? Dii_pos : Dii_neg;
+                            G += Dii*alpha[i];
+                        }
+                        const scalar_type C = (y(i) > 0) ? Cpos : Cneg;
+                        const scalar_type U = do_svm_l2 ? std::numeric_limits<scalar_type>::infinity() : C;
+
+                        scalar_type PG = 0;
+                        if (alpha[i] == 0)
+                        {
+                            if (G > PG_max_prev)
+                            {
+                                // shrink the active set of training examples
+                                blk.shrunk.push_back(i);
+                                continue;
+                            }
+
+                            if (G < 0)
+                                PG = G;
+                        }
+                        else if (alpha[i] == U)
+                        {
+                            if (G < PG_min_prev)
+                            {
+                                // shrink the active set of training examples
+                                blk.shrunk.push_back(i);
+                                continue;
+                            }
+
+                            if (G > 0)
+                                PG = G;
+                        }
+                        else
+                        {
+                            PG = G;
+                        }
+
+                        index[blk.begin + blk.num_kept++] = i;
+
+                        if (PG > blk.PG_max) 
+                            blk.PG_max = PG;
+                        if (PG < blk.PG_min) 
+                            blk.PG_min = PG;
+
+                        // if PG != 0
+                        if (std::abs(PG) > 1e-12)
+                        {
+                            const scalar_type Qii = sigma*(state.Q[i]-Dii) + Dii;
+                            const scalar_type alpha_old = alpha[i];
+                            alpha[i] = std::min(std::max(alpha[i] - G/Qii, (scalar_type)0.0), U);
+                            const scalar_type delta = (alpha[i]-alpha_old)*y(i);
+                            add_to(blk.dw, x(i), delta);
+                            if (have_bias && !last_weight_1)
+                                blk.dw(blk.dw.size()-1) -= delta;
+
+                            if (last_weight_1)
+                                blk.dw(dims-1) = 0;
+                        }
+                    }
+                }, 1);
+
+                // Merge the results from each block.  The samples each block kept active
+                // go to the front of index and the ones it shrunk go right after them.
+                scalar_type PG_max = -std::numeric_limits<scalar_type>::infinity();
+                scalar_type PG_min = std::numeric_limits<scalar_type>::infinity();
+                new_index.clear();
+                for (unsigned long b = 0; b < num_blocks; ++b)
+                {
+                    w += blocks[b].dw;
+                    PG_max = std::max(PG_max, blocks[b].PG_max);
+                    PG_min = std::min(PG_min, blocks[b].PG_min);
+                    new_index.insert(new_index.end(), index.begin()+blocks[b].begin, 
+                                     index.begin()+blocks[b].begin+blocks[b].num_kept);
+                }
+                const unsigned long new_active_size = new_index.size();
+                for (unsigned long b = 0; b < num_blocks; ++b)
+                    new_index.insert(new_index.end(), blocks[b].shrunk.begin(), blocks[b].shrunk.end());
+                std::copy(new_index.begin(), new_index.end(), index.begin());
+                active_size = new_active_size;
+
+                if (last_weight_1)
+                    w(dims-1) = 1;
+
+                if (verbose)
+                {
+                    using namespace std;
+                    cout << "gap:         " << PG_max - PG_min << endl;
+                    cout << "active_size: " << active_size << endl;
+                    cout << "iter:        " << iter << endl;
+                    cout << endl;
+                }
+
+                if (PG_max - PG_min <= eps)
+                {
+                    // stop if we are within eps tolerance and the last iteration
+                    // was over all the samples
+                    if (active_size == index.size())
+                        break;
+
+                    // Turn off shrinking on the next iteration.  We will stop if the
+                    // tolerance is still <= eps when shrinking is off.
+                    active_size = index.size();
+                    PG_max_prev = std::numeric_limits<scalar_type>::infinity();
+                    PG_min_prev = -std::numeric_limits<scalar_type>::infinity();
+                }
+                else if (do_shrinking)
+                {
+                    PG_max_prev = PG_max;
+                    PG_min_prev = PG_min;
+                    if (PG_max_prev <= 0)
+                        PG_max_prev = std::numeric_limits<scalar_type>::infinity();
+                    if (PG_min_prev >= 0)
+                        PG_min_prev = -std::numeric_limits<scalar_type>::infinity();
+                }
+
+            } // end of main optimization loop
+        }
+
         scalar_type dot (
             const scalar_vector_type& w,
             const sample_type& sample
@@ -699,6 +966,7 @@ namespace dlib
         bool last_weight_1;
         bool do_shrinking;
         bool do_svm_l2;
+        unsigned long num_threads;
 
     }; // end of class svm_c_linear_dcd_trainer
 
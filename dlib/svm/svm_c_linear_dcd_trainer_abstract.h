@@ -68,6 +68,7 @@ namespace dlib
                 - #includes_bias() == true
                 - #shrinking_enabled() == true
                 - #solving_svm_l2_problem() == false
+                - #get_num_threads() == 1
         !*/
 
         explicit svm_c_linear_dcd_trainer (
@@ -88,6 +89,7 @@ namespace dlib
                 - #includes_bias() == true
                 - #shrinking_enabled() == true
                 - #solving_svm_l2_problem() == false
+                - #get_num_threads() == 1
         !*/
 
         bool includes_bias (
@@ -159,6 +161,33 @@ namespace dlib
                 - #solving_svm_l2_problem() == enabled
         !*/
 
+        void set_num_threads (
+            unsigned long num
+        );
+        /*!
+            requires
+                - num > 0
+            ensures
+                - #get_num_threads() == num
+        !*/
+
+        unsigned long get_num_threads (
+        ) const;
+        /*!
+            ensures
+                - returns the number of threads used during training.  When this is 1 the
+                  solver runs the serial dual coordinate descent algorithm from the Hsieh
+                  paper.  Otherwise, each pass over the data is split into
+                  get_num_threads() disjoint blocks of samples which are optimized in
+                  parallel and then merged using the CoCoA+ scheme described in the paper:
+                    Adding vs. Averaging in Distributed Primal-Dual Optimization
+                    by Chenxin Ma, Virginia Smith, Martin Jaggi, et al.
+                  This converges to the same solution as the serial solver, and the
+                  result does not depend on how the threads happen to be scheduled.
+                  However, each pass makes less progress than a serial pass, so the
+                  multithreaded mode only pays off on large datasets.
+        !*/
+
         void be_verbose (
         );
         /*!
@@ -311,6 +340,32 @@ namespace dlib
         class optimizer_state
         {
         public:
+            optimizer_state (
+            );
+            /*!
+                ensures
+                    - this object is a default initialized optimizer_state.  So the
+                      optimizer will start from alpha == 0 the first time it is used.
+            !*/
+
+            explicit optimizer_state (
+                const std::vector<scalar_type>& initial_alpha
+            );
+            /*!
+                requires
+                    - for all valid i: initial_alpha[i] >= 0
+                ensures
+                    - #get_alpha() == initial_alpha
+                    - This object counts as a default initialized optimizer_state, except
+                      that the first call to train() with it starts the optimizer from
+                      the dual variables in initial_alpha rather than from all zeros.
+                      Values missing at the end of initial_alpha are taken to be 0.
+                      Values larger than the C for their sample are clipped to C.
+                    - This lets you warm start the optimizer from the solution to a
+                      related problem.  For instance, the alphas of a problem whose
+                      samples have changed slightly since it was last solved.
+            !*/
+
             const std::vector<scalar_type>& get_alpha (
             ) const; 
         };
@@ -329,7 +384,9 @@ namespace dlib
                 - is_learning_problem(x,y) == true
                   (Note that it is ok for x.size() == 1)
                 - All elements of y must be equal to +1 or -1
-                - state must be either a default initialized optimizer_state object or all the
+                - state must be either a default initialized optimizer_state object, an
+                  optimizer_state constructed from initial_alpha values that hasn't been
+                  used yet and with initial_alpha.size() <= x.size(), or all the
                   following conditions must be satisfied:
                     - Let LAST denote the previous trainer used with the state object, then
                       we must have: 
@@ -11,11 +11,59 @@
 #include "kernel.h"
 #include <iostream>
 #include <vector>
+#include <memory>
 #include "sparse_vector.h"
+#include "../threads.h"
 
 namespace dlib
 {
 
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        inline unsigned long oca_num_blocks (
+            const thread_pool* tp
+        )
+        /*!
+            ensures
+                - returns the number of blocks oca_for_each_block(tp, ...) splits its
+                  range into.  That is, one per thread in *tp, or 1 if tp == 0.
+        !*/
+        {
+            if (tp)
+                return tp->num_threads_in_pool();
+            else
+                return 1;
+        }
+
+        template <typename T>
+        void oca_for_each_block (
+            thread_pool* tp,
+            long num,
+            const T& funct
+        )
+        /*!
+            ensures
+                - splits [0, num) into oca_num_blocks(tp) contiguous blocks and calls
+                  funct(block_index, block_begin, block_end) for each of them.  The calls
+                  are made in parallel when tp != 0.
+        !*/
+        {
+            const long num_blocks = oca_num_blocks(tp);
+            if (num_blocks == 1)
+            {
+                funct(0, 0, num);
+                return;
+            }
+
+            parallel_for(*tp, 0, num_blocks, [&](long b)
+            {
+                funct(b, num*b/num_blocks, num*(b+1)/num_blocks);
+            }, 1);
+        }
+    }
+
 // ----------------------------------------------------------------------------------------
 
     template <
@@ -45,7 +93,8 @@ namespace dlib
             const bool be_verbose_,
             const scalar_type eps_,
             const unsigned long max_iter,
-            const unsigned long dims_
+            const unsigned long dims_,
+            const unsigned long num_threads = 1
         ) :
             samples(samples_),
             labels(labels_),
@@ -59,6 +108,8 @@ namespace dlib
         {
             dot_prods.resize(samples.size());
             is_first_call = true;
+            if (num_threads > 1)
+                tp.reset(new thread_pool(num_threads));
         }
 
         virtual scalar_type get_c (
@@ -120,37 +171,56 @@ namespace dlib
         {
             line_search(w);
 
-            subgradient.set_size(w.size(),1);
-            subgradient = 0;
-            risk = 0;
-
+            const unsigned long num_blocks = get_num_blocks();
+            risk_buffers.assign(num_blocks, 0);
+            subgradient_buffers.resize(num_blocks);
 
-            // loop over all the samples and compute the risk and its subgradient at the current solution point w
-            for (long i = 0; i < samples.size(); ++i)
+            // loop over all the samples and compute the risk and its subgradient at the
+            // current solution point w.  Each block of samples accumulates into its own
+            // buffer so the blocks can be processed in parallel.
+            for_each_block(samples.size(), [&](unsigned long b, long begin, long end)
             {
-                // multiply current SVM output for the ith sample by its label
-                const scalar_type df_val = labels(i)*dot_prods[i];
+                scalar_type& block_risk = risk_buffers[b];
+                matrix_type& block_subgradient = subgradient_buffers[b];
+                block_subgradient.set_size(w.size(),1);
+                block_subgradient = 0;
 
-                if (labels(i) > 0)
-                    risk += Cpos*std::max<scalar_type>(0.0,1 - df_val);
-                else
-                    risk += Cneg*std::max<scalar_type>(0.0,1 - df_val);
-
-                if (df_val < 1)
+                for (long i = begin; i < end; ++i)
                 {
-                    if (labels(i) > 0)
-                    {
-                        subtract_from(subgradient, samples(i), Cpos);
+                    // multiply current SVM output for the ith sample by its label
+                    const scalar_type df_val = labels(i)*dot_prods[i];
 
-                        subgradient(subgradient.size()-1) += Cpos;
-                    }
+                    if (labels(i) > 0)
+                        block_risk += Cpos*std::max<scalar_type>(0.0,1 - df_val);
                     else
+                        block_risk += Cneg*std::max<scalar_type>(0.0,1 - df_val);
+
+                    if (df_val < 1)
                     {
-                        add_to(subgradient, samples(i), Cneg);
+                        if (labels(i) > 0)
+                        {
+                            subtract_from(block_subgradient, samples(i), Cpos);
+
+                            block_subgradient(block_subgradient.size()-1) += Cpos;
+                        }
+                        else
+                        {
+                            add_to(block_subgradient, samples(i), Cneg);
 
-                        subgradient(subgradient.size()-1) -= Cneg;
+                            block_subgradient(block_subgradient.size()-1) -= Cneg;
+                        }
                     }
                 }
+            });
+
+            // Sum the blocks in a fixed order so the result doesn't depend on how the
+            // threads were scheduled.
+            risk = risk_buffers[0];
+            subgradient = subgradient_buffers[0];
+            for (unsigned long b = 1; b < num_blocks; ++b)
+            {
+                risk += risk_buffers[b];
+                subgradient += subgradient_buffers[b];
             }
 
             scalar_type scale = 1.0/samples.size();
@@ -176,8 +246,11 @@ namespace dlib
             // The reason for using w_size_m1 and not just w.size()-1 is because
             // doing it this way avoids an inane warning from gcc that can occur in some cases.
             const long w_size_m1 = w.size()-1;
-            for (long i = 0; i < samples.size(); ++i)
-                dot_prods[i] = dot(colm(w,0,w_size_m1), samples(i)) - w(w_size_m1);
+            for_each_block(samples.size(), [&](unsigned long, long begin, long end)
+            {
+                for (long i = begin; i < end; ++i)
+                    dot_prods[i] = dot(colm(w,0,w_size_m1), samples(i)) - w(w_size_m1);
+            });
 
             if (is_first_call)
             {
@@ -275,6 +348,15 @@ namespace dlib
             }
         }
 
+        unsigned long get_num_blocks (
+        ) const { return impl::oca_num_blocks(tp.get()); }
+
+        template <typename T>
+        void for_each_block (
+            long num,
+            const T& funct
+        ) const { impl::oca_for_each_block(tp.get(), num, funct); }
+
         struct helper
         {
             helper(scalar_type k_, scalar_type B_) : k(k_), B(B_) {}
@@ -292,6 +374,10 @@ namespace dlib
         mutable matrix_type best_so_far;  // best w seen so far
         mutable std::vector<scalar_type> dot_prods_best; // dot products between best_so_far and samples
 
+        std::shared_ptr<thread_pool> tp;
+        mutable std::vector<scalar_type> risk_buffers;
+        mutable std::vector<matrix_type> subgradient_buffers;
+
 
         const in_sample_vector_type& samples;
         const in_scalar_vector_type& labels;
@@ -321,11 +407,12 @@ namespace dlib
         const bool be_verbose,
         const scalar_type eps,
         const unsigned long max_iterations,
-        const unsigned long dims
+        const unsigned long dims,
+        const unsigned long num_threads = 1
     )
     {
         return oca_problem_c_svm<matrix_type, in_sample_vector_type, in_scalar_vector_type>(
-            C_pos, C_neg, samples, labels, be_verbose, eps, max_iterations, dims);
+            C_pos, C_neg, samples, labels, be_verbose, eps, max_iterations, dims, num_threads);
     }
 
 // ----------------------------------------------------------------------------------------
@@ -359,6 +446,7 @@ namespace dlib
             max_iterations = 10000;
             learn_nonnegative_weights = false;
             last_weight_1 = false;
+            num_threads = 1;
         }
 
         explicit svm_c_linear_trainer (
@@ -380,6 +468,7 @@ namespace dlib
             max_iterations = 10000;
             learn_nonnegative_weights = false;
             last_weight_1 = false;
+            num_threads = 1;
         }
 
         void set_epsilon (
@@ -410,6 +499,27 @@ namespace dlib
             max_iterations = max_iter;
         }
 
+        void set_num_threads (
+            unsigned long num
+        )
+        {
+            // make sure requires clause is not broken
+            DLIB_ASSERT(num > 0,
+                "\t void svm_c_linear_trainer::set_num_threads()"
+                << "\n\t num must be greater than 0"
+                << "\n\t num:  " << num 
+                << "\n\t this: " << this
+                );
+
+            num_threads = num;
+        }
+
+        unsigned long get_num_threads (
+        ) const
+        {
+            return num_threads;
+        }
+
         void be_verbose (
         )
         {
@@ -654,14 +764,14 @@ namespace dlib
                                                                          mat(prior_b));
 
                 svm_objective = solver(
-                    make_oca_problem_c_svm<w_type>(Cpos, Cneg, x, y, verbose, eps, max_iterations, dims), 
+                    make_oca_problem_c_svm<w_type>(Cpos, Cneg, x, y, verbose, eps, max_iterations, dims, num_threads), 
                     w,
                     prior_temp);
             }
             else
             {
                 svm_objective = solver(
-                    make_oca_problem_c_svm<w_type>(Cpos, Cneg, x, y, verbose, eps, max_iterations, num_dims), 
+                    make_oca_problem_c_svm<w_type>(Cpos, Cneg, x, y, verbose, eps, max_iterations, num_dims, num_threads), 
                     w,
                     num_nonnegative,
                     force_weight_1_idx);
@@ -691,6 +801,7 @@ namespace dlib
         unsigned long max_iterations;
         bool learn_nonnegative_weights;
         bool last_weight_1;
+        unsigned long num_threads;
         matrix<scalar_type,0,1> prior;
         scalar_type prior_b = 0;
     }; 
@@ -15,6 +15,7 @@
 
 #include "function.h"
 #include "kernel.h"
+#include "kernel_cache.h"
 #include "../optimization/optimization_solve_qp2_using_smo.h"
 
 namespace dlib 
@@ -138,7 +139,26 @@ namespace dlib
             const in_scalar_vector_type& y
         ) const
         {
-            return do_train(mat(x), mat(y));
+            return do_train(mat(x), mat(y), kernel_matrix(kernel_function,mat(x)));
+        }
+
+        template <
+            typename in_scalar_vector_type
+            >
+        const decision_function<kernel_type> train (
+            const kernel_cache<kernel_type>& cache,
+            const std::vector<unsigned long>& idx,
+            const in_scalar_vector_type& y
+        ) const
+        {
+            // make sure requires clause is not broken
+            DLIB_ASSERT(cache.get_kernel() == get_kernel(),
+                "\tdecision_function svm_nu_trainer::train(cache,idx,y)"
+                << "\n\t The kernel_cache must use the same kernel as this trainer."
+                << "\n\t this: " << this
+                );
+
+            return do_train(rowm(mat(cache.get_samples()),mat(idx)), mat(y), cached_kernel_matrix(cache,idx));
         }
 
         void swap (
@@ -157,11 +177,13 @@ namespace dlib
 
         template <
             typename in_sample_vector_type,
-            typename in_scalar_vector_type
+            typename in_scalar_vector_type,
+            typename kernel_matrix_type
             >
         const decision_function<kernel_type> do_train (
             const in_sample_vector_type& x,
-            const in_scalar_vector_type& y
+            const in_scalar_vector_type& y,
+            const kernel_matrix_type& kmat
         ) const
         {
             typedef typename K::scalar_type scalar_type;
@@ -184,7 +206,7 @@ namespace dlib
 
             solve_qp2_using_smo<scalar_vector_type> solver;
 
-            solver(symmetric_matrix_cache<float>((diagm(y)*kernel_matrix(kernel_function,x)*diagm(y)), cache_size), 
+            solver(symmetric_matrix_cache<float>((diagm(y)*kmat*diagm(y)), cache_size), 
             //solver(symmetric_matrix_cache<float>(make_label_kernel_matrix(kernel_matrix(kernel_function,x),y), cache_size), 
                    y, 
                    nu,
@@ -11,6 +11,7 @@
 #include "../serialize.h"
 #include "function_abstract.h"
 #include "kernel_abstract.h"
+#include "kernel_cache_abstract.h"
 #include "../optimization/optimization_solve_qp2_using_smo_abstract.h"
 
 namespace dlib
@@ -182,6 +183,34 @@ namespace dlib
                 - std::bad_alloc
         !*/
 
+        template <
+            typename in_scalar_vector_type
+            >
+        const decision_function<kernel_type> train (
+            const kernel_cache<kernel_type>& cache,
+            const std::vector<unsigned long>& idx,
+            const in_scalar_vector_type& y
+        ) const;
+        /*!
+            requires
+                - cache.get_kernel() == get_kernel()
+                - for all valid i: idx[i] < cache.size()
+                - Let x denote the samples cache.get_samples()[idx[i]] for all valid i.
+                  Then is_binary_classification_problem(x,y) == true.
+                - y == a matrix or something convertible to a matrix via mat().
+                  Also, y should contain scalar_type objects.
+            ensures
+                - This function is identical to train(x,y) except that the kernel values
+                  are taken from cache rather than being recomputed.  This is useful when
+                  you train many SVMs on overlapping subsets of the same samples, since
+                  the kernel evaluations can then be shared among them, even when the
+                  trainings run in parallel threads.
+            throws
+                - invalid_nu_error
+                  This exception is thrown if get_nu() >= maximum_nu(y)
+                - std::bad_alloc
+        !*/
+
         void swap (
             svm_nu_trainer& item
         );
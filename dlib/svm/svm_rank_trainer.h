@@ -11,7 +11,10 @@
 #include "function.h"
 #include "kernel.h"
 #include "sparse_vector.h"
+#include "../threads.h"
+#include "svm_c_linear_trainer.h"
 #include <iostream>
+#include <memory>
 
 namespace dlib
 {
@@ -38,7 +41,8 @@ namespace dlib
             const bool be_verbose_,
             const scalar_type eps_,
             const unsigned long max_iter,
-            const unsigned long dims_
+            const unsigned long dims_,
+            const unsigned long num_threads = 1
         ) :
             samples(samples_),
             C(C_),
@@ -47,6 +51,8 @@ namespace dlib
             max_iterations(max_iter),
             dims(dims_)
         {
+            if (num_threads > 1)
+                tp.reset(new thread_pool(num_threads));
         }
 
         virtual scalar_type get_c (
@@ -105,56 +111,76 @@ namespace dlib
             matrix_type& subgradient
         ) const 
         {
-            subgradient.set_size(w.size(),1);
-            subgradient = 0;
-            risk = 0;
-
             // Note that we want the risk value to be in terms of the fraction of overall
             // rank flips.  So a risk of 0.1 would mean that rank flips happen < 10% of the
             // time.
 
+            const unsigned long num_blocks = get_num_blocks();
+            risk_buffers.assign(num_blocks, 0);
+            pair_counts.assign(num_blocks, 0);
+            subgradient_buffers.resize(num_blocks);
 
-            std::vector<double> rel_scores;
-            std::vector<double> nonrel_scores;
-            std::vector<unsigned long> rel_counts;
-            std::vector<unsigned long> nonrel_counts;
-
-            unsigned long total_pairs = 0;
-
-            // loop over all the samples and compute the risk and its subgradient at the current solution point w
-            for (unsigned long i = 0; i < samples.size(); ++i)
+            // loop over all the samples and compute the risk and its subgradient at the
+            // current solution point w.  Each block of samples accumulates into its own
+            // buffer so the blocks can be processed in parallel.
+            for_each_block(samples.size(), [&](unsigned long b, long begin, long end)
             {
-                rel_scores.resize(samples[i].relevant.size());
-                nonrel_scores.resize(samples[i].nonrelevant.size());
+                scalar_type& block_risk = risk_buffers[b];
+                unsigned long& block_pairs = pair_counts[b];
+                matrix_type& block_subgradient = subgradient_buffers[b];
+                block_subgradient.set_size(w.size(),1);
+                block_subgradient = 0;
+
+                std::vector<double> rel_scores;
+                std::vector<double> nonrel_scores;
+                std::vector<unsigned long> rel_counts;
+                std::vector<unsigned long> nonrel_counts;
+
+                for (long i = begin; i < end; ++i)
+                {
+                    rel_scores.resize(samples[i].relevant.size());
+                    nonrel_scores.resize(samples[i].nonrelevant.size());
 
-                for (unsigned long k = 0; k < rel_scores.size(); ++k)
-                    rel_scores[k] = dot(samples[i].relevant[k], w);
+                    for (unsigned long k = 0; k < rel_scores.size(); ++k)
+                        rel_scores[k] = dot(samples[i].relevant[k], w);
 
-                for (unsigned long k = 0; k < nonrel_scores.size(); ++k)
-                    nonrel_scores[k] = dot(samples[i].nonrelevant[k], w) + 1;
+                    for (unsigned long k = 0; k < nonrel_scores.size(); ++k)
+                        nonrel_scores[k] = dot(samples[i].nonrelevant[k], w) + 1;
 
-                count_ranking_inversions(rel_scores, nonrel_scores, rel_counts, nonrel_counts);
+                    count_ranking_inversions(rel_scores, nonrel_scores, rel_counts, nonrel_counts);
 
-                total_pairs += rel_scores.size()*nonrel_scores.size();
+                    block_pairs += rel_scores.size()*nonrel_scores.size();
 
-                for (unsigned long k = 0; k < rel_counts.size(); ++k)
-                {
-                    if (rel_counts[k] != 0)
+                    for (unsigned long k = 0; k < rel_counts.size(); ++k)
                     {
-                        risk -= rel_counts[k]*rel_scores[k];
-                        subtract_from(subgradient, samples[i].relevant[k], rel_counts[k]); 
+                        if (rel_counts[k] != 0)
+                        {
+                            block_risk -= rel_counts[k]*rel_scores[k];
+                            subtract_from(block_subgradient, samples[i].relevant[k], rel_counts[k]); 
+                        }
                     }
-                }
 
-                for (unsigned long k = 0; k < nonrel_counts.size(); ++k)
-                {
-                    if (nonrel_counts[k] != 0)
+                    for (unsigned long k = 0; k < nonrel_counts.size(); ++k)
                     {
-                        risk += nonrel_counts[k]*nonrel_scores[k];
-                        add_to(subgradient, samples[i].nonrelevant[k], nonrel_counts[k]); 
+                        if (nonrel_counts[k] != 0)
+                        {
+                            block_risk += nonrel_counts[k]*nonrel_scores[k];
+                            add_to(block_subgradient, samples[i].nonrelevant[k], nonrel_counts[k]); 
+                        }
                     }
                 }
-
+            });
+
+            // Sum the blocks in a fixed order so the result doesn't depend on how the
+            // threads were scheduled.
+            risk = risk_buffers[0];
+            subgradient = subgradient_buffers[0];
+            unsigned long total_pairs = pair_counts[0];
+            for (unsigned long b = 1; b < num_blocks; ++b)
+            {
+                risk += risk_buffers[b];
+                subgradient += subgradient_buffers[b];
+                total_pairs += pair_counts[b];
             }
 
             const scalar_type scale = 1.0/total_pairs;
@@ -168,6 +194,19 @@ namespace dlib
     // -----------------------------------------------------
     // -----------------------------------------------------
 
+        unsigned long get_num_blocks (
+        ) const { return impl::oca_num_blocks(tp.get()); }
+
+        template <typename T>
+        void for_each_block (
+            long num,
+            const T& funct
+        ) const { impl::oca_for_each_block(tp.get(), num, funct); }
+
+        std::shared_ptr<thread_pool> tp;
+        mutable std::vector<scalar_type> risk_buffers;
+        mutable std::vector<unsigned long> pair_counts;
+        mutable std::vector<matrix_type> subgradient_buffers;
 
         const std::vector<ranking_pair<sample_type> >& samples;
         const scalar_type C;
@@ -191,11 +230,12 @@ namespace dlib
         const bool be_verbose,
         const scalar_type eps,
         const unsigned long max_iterations,
-        const unsigned long dims
+        const unsigned long dims,
+        const unsigned long num_threads = 1
     )
     {
         return oca_problem_ranking_svm<matrix_type, sample_type>(
-            C, samples, be_verbose, eps, max_iterations, dims);
+            C, samples, be_verbose, eps, max_iterations, dims, num_threads);
     }
 
 // ----------------------------------------------------------------------------------------
@@ -228,6 +268,7 @@ namespace dlib
             max_iterations = 10000;
             learn_nonnegative_weights = false;
             last_weight_1 = false;
+            num_threads = 1;
         }
 
         explicit svm_rank_trainer (
@@ -248,6 +289,7 @@ namespace dlib
             max_iterations = 10000;
             learn_nonnegative_weights = false;
             last_weight_1 = false;
+            num_threads = 1;
         }
 
         void set_epsilon (
@@ -278,6 +320,27 @@ namespace dlib
             max_iterations = max_iter;
         }
 
+        void set_num_threads (
+            unsigned long num
+        )
+        {
+            // make sure requires clause is not broken
+            DLIB_ASSERT(num > 0,
+                "\t void svm_rank_trainer::set_num_threads()"
+                << "\n\t num must be greater than 0"
+                << "\n\t num:  " << num 
+                << "\n\t this: " << this
+                );
+
+            num_threads = num;
+        }
+
+        unsigned long get_num_threads (
+        ) const
+        {
+            return num_threads;
+        }
+
         void be_verbose (
         )
         {
@@ -433,13 +496,13 @@ namespace dlib
                 if ((unsigned long)prior.size() < dims)
                 {
                     matrix<scalar_type,0,1> prior_temp = join_cols(prior, zeros_matrix<scalar_type>(dims-prior.size(),1));
-                    solver( make_oca_problem_ranking_svm<w_type>(C, samples, verbose, eps, max_iterations, dims), 
+                    solver( make_oca_problem_ranking_svm<w_type>(C, samples, verbose, eps, max_iterations, dims, num_threads), 
                         w, 
                         prior_temp);
                 }
                 else
                 {
-                    solver( make_oca_problem_ranking_svm<w_type>(C, samples, verbose, eps, max_iterations, dims), 
+                    solver( make_oca_problem_ranking_svm<w_type>(C, samples, verbose, eps, max_iterations, dims, num_threads), 
                         w, 
                         prior);
                 }
@@ -447,7 +510,7 @@ namespace dlib
             }
             else
             {
-                solver( make_oca_problem_ranking_svm<w_type>(C, samples, verbose, eps, max_iterations, num_dims), 
+                solver( make_oca_problem_ranking_svm<w_type>(C, samples, verbose, eps, max_iterations, num_dims, num_threads), 
                     w, 
                     num_nonnegative,
                     force_weight_1_idx);
@@ -484,6 +547,7 @@ namespace dlib
         unsigned long max_iterations;
         bool learn_nonnegative_weights;
         bool last_weight_1;
+        unsigned long num_threads;
         matrix<scalar_type,0,1> prior;
     }; 
 
@@ -56,6 +56,7 @@ namespace dlib
                 - #get_epsilon() == 0.001
                 - this object will not be verbose unless be_verbose() is called
                 - #get_max_iterations() == 10000
+                - #get_num_threads() == 1
                 - #learns_nonnegative_weights() == false
                 - #forces_last_weight_to_1() == false
                 - #has_prior() == false
@@ -75,6 +76,7 @@ namespace dlib
                 - #get_epsilon() == 0.001
                 - this object will not be verbose unless be_verbose() is called
                 - #get_max_iterations() == 10000
+                - #get_num_threads() == 1
                 - #learns_nonnegative_weights() == false
                 - #forces_last_weight_to_1() == false
                 - #has_prior() == false
@@ -118,6 +120,28 @@ namespace dlib
                 - #get_max_iterations() == max_iter
         !*/
 
+        void set_num_threads (
+            unsigned long num
+        );
+        /*!
+            requires
+                - num > 0
+            ensures
+                - #get_num_threads() == num
+        !*/
+
+        unsigned long get_num_threads (
+        ) const;
+        /*!
+            ensures
+                - returns the number of threads used to evaluate the risk and its
+                  subgradient over the training data.  Each thread works on its own
+                  contiguous block of samples and the per-thread results are summed in a
+                  fixed order, so the learned decision function does not depend on thread
+                  scheduling.  You should usually set this equal to the number of
+                  processing cores on your machine when training on large datasets.
+        !*/
+
         void be_verbose (
         );
         /*!
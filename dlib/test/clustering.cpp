@@ -182,6 +182,138 @@ namespace
         }
     }
 
+    void test_find_largest_eigenvectors(dlib::rand& rnd)
+    {
+        print_spinner();
+        const long n = 60 + rnd.get_random_32bit_number()%100;
+        const long k = 1 + rnd.get_random_32bit_number()%5;
+        matrix<double> B = randm(n,n,rnd);
+        const matrix<double> M = B + trans(B);
+
+        matrix<double,0,1> evals;
+        matrix<double> evecs;
+        find_largest_eigenvectors([&](const matrix<double,0,1>& x, matrix<double,0,1>& y){ y = M*x; },
+                                  n, k, evals, evecs);
+
+        eigenvalue_decomposition<matrix<double> > eig(make_symmetric(M));
+        matrix<double,0,1> truth = eig.get_real_eigenvalues();
+        std::sort(truth.begin(), truth.end(), std::greater<double>());
+
+        DLIB_TEST(evals.size() == k);
+        DLIB_TEST(evecs.nr() == n && evecs.nc() == k);
+        DLIB_TEST(max(abs(evals - rowm(truth,range(0,k-1)))) < 1e-6);
+        DLIB_TEST(max(abs(trans(evecs)*evecs - identity_matrix<double>(k))) < 1e-10);
+        DLIB_TEST(max(abs(M*evecs - evecs*diagm(evals))) < 1e-5);
+    }
+
+    void test_sparse_spectral_cluster(dlib::rand& rnd)
+    {
+        print_spinner();
+        std::vector<sample_pair> edges;
+        std::vector<unsigned long> labels;
+
+        make_test_graph(rnd, edges, labels, 5, 30, 3, 0.10);
+        if (rnd.get_random_double() < 0.5)
+            remove_duplicate_edges(edges);
+
+        std::vector<unsigned long> labels2 = spectral_cluster(edges, 5);
+        DLIB_TEST(labels.size() == labels2.size());
+
+        for (unsigned long i = 0; i < labels.size(); ++i)
+        {
+            DLIB_TEST(labels2[i] < 5);
+            for (unsigned long j = 0; j < labels.size(); ++j)
+            {
+                if (labels[i] == labels[j])
+                {
+                    DLIB_TEST(labels2[i] == labels2[j]);
+                }
+                else
+                {
+                    DLIB_TEST(labels2[i] != labels2[j]);
+                }
+            }
+        }
+
+        // Now try the k-nearest-neighbor version on some well separated blobs.
+        typedef matrix<double,2,1> sample_type;
+        std::vector<sample_type> samples;
+        labels.clear();
+        for (unsigned long i = 0; i < 200; ++i)
+        {
+            sample_type samp;
+            samp = rnd.get_random_gaussian(), rnd.get_random_gaussian();
+            samp(0) += 20*(i%4);
+            samples.push_back(samp);
+            labels.push_back(i%4);
+        }
+        labels2 = spectral_cluster(radial_basis_kernel<sample_type>(0.1), samples, 4, 10);
+        DLIB_TEST(labels.size() == labels2.size());
+        for (unsigned long i = 0; i < labels.size(); ++i)
+        {
+            for (unsigned long j = 0; j < labels.size(); ++j)
+            {
+                DLIB_TEST((labels[i] == labels[j]) == (labels2[i] == labels2[j]));
+            }
+        }
+    }
+
+    void test_louvain_clustering(dlib::rand& rnd)
+    {
+        print_spinner();
+        std::vector<sample_pair> edges;
+        std::vector<unsigned long> labels;
+
+        make_test_graph(rnd, edges, labels, 5, 30, 3, 0.10);
+        if (rnd.get_random_double() < 0.5)
+            remove_duplicate_edges(edges);
+
+        std::vector<unsigned long> labels2;
+        unsigned long num_clusters = louvain_cluster(edges, labels2, 1 + rnd.get_random_32bit_number()%4);
+        DLIB_TEST(labels.size() == labels2.size());
+        DLIB_TEST(num_clusters == 5);
+
+        for (unsigned long i = 0; i < labels.size(); ++i)
+        {
+            DLIB_TEST(labels2[i] < num_clusters);
+            for (unsigned long j = 0; j < labels.size(); ++j)
+            {
+                if (labels[i] == labels[j])
+                {
+                    DLIB_TEST(labels2[i] == labels2[j]);
+                }
+                else
+                {
+                    DLIB_TEST(labels2[i] != labels2[j]);
+                }
+            }
+        }
+    }
+
+    void test_louvain_clustering_big(dlib::rand& rnd)
+    {
+        print_spinner();
+        std::vector<sample_pair> edges;
+        std::vector<unsigned long> labels, labels1, labels4, labels_newman;
+        make_test_graph(rnd, edges, labels, 40, 50, 20, 0.6);
+
+        // Big enough that the moves are done in parallel batches, which shouldn't change
+        // the output.
+        const unsigned long num1 = louvain_cluster(edges, labels1, 1);
+        const unsigned long num4 = louvain_cluster(edges, labels4, 4);
+        DLIB_TEST(num1 == num4);
+        DLIB_TEST(labels1 == labels4);
+
+        newman_cluster(edges, labels_newman);
+        const double q_louvain = modularity(edges, labels1);
+        const double q_newman = modularity(edges, labels_newman);
+        const double q_truth = modularity(edges, labels);
+        dlog << LINFO << "louvain: " << num1 << " clusters, modularity " << q_louvain;
+        dlog << LINFO << "newman modularity: " << q_newman << "  truth modularity: " << q_truth;
+        DLIB_TEST(q_louvain >= q_newman - 0.01);
+        DLIB_TEST(q_louvain >= q_truth - 0.01);
+    }
+
     void test_chinese_whispers(dlib::rand& rnd)
     {
         print_spinner();
@@ -220,6 +352,142 @@ namespace
         }
     }
 
+    void test_parallel_chinese_whispers(dlib::rand& rnd)
+    {
+        print_spinner();
+        std::vector<sample_pair> edges;
+        std::vector<unsigned long> labels;
+
+        make_test_graph(rnd, edges, labels, 5, 30, 3, 0.10);
+        if (rnd.get_random_double() < 0.5)
+            remove_duplicate_edges(edges);
+
+        std::vector<ordered_sample_pair> oedges;
+        convert_unordered_to_ordered(edges, oedges);
+
+        for (unsigned long num_threads : {1, 4})
+        {
+            std::vector<unsigned long> labels2;
+            unsigned long num_clusters;
+            if (rnd.get_random_double() < 0.5)
+                num_clusters = parallel_chinese_whispers(edges, labels2, num_threads);
+            else
+                num_clusters = parallel_chinese_whispers(oedges, labels2, num_threads, 200, std::chrono::seconds(1000), rnd);
+
+            DLIB_TEST(labels.size() == labels2.size());
+            DLIB_TEST(num_clusters == 5);
+
+            for (unsigned long i = 0; i < labels.size(); ++i)
+            {
+                for (unsigned long j = 0; j < labels.size(); ++j)
+                {
+                    if (labels[i] == labels[j])
+                    {
+                        DLIB_TEST(labels2[i] == labels2[j]);
+                    }
+                    else
+                    {
+                        DLIB_TEST(labels2[i] != labels2[j]);
+                    }
+                }
+            }
+        }
+
+        // With no time to run every node should be left in its own cluster.
+        std::vector<unsigned long> labels3;
+        DLIB_TEST(parallel_chinese_whispers(edges, labels3, 2, 100, std::chrono::nanoseconds(0)) == labels.size());
+        DLIB_TEST(labels3.size() == labels.size());
+    }
+
+    unsigned long naive_complete_linkage (
+        const matrix<double>& dists,
+        std::vector<unsigned long>& labels,
+        unsigned long min_num_clusters,
+        double max_dist
+    )
+    /*!
+        ensures
+            - A brute force version of bottom_up_cluster() for testing.  It repeatedly
+              merges the two closest clusters.
+    !*/
+    {
+        const long n = dists.nr();
+        labels.resize(n);
+        for (long i = 0; i < n; ++i)
+            labels[i] = i;
+        unsigned long num_clusters = n;
+        while (num_clusters > min_num_clusters)
+        {
+            double best = std::numeric_limits<double>::infinity();
+            unsigned long ba = 0, bb = 0;
+            for (long a = 0; a < n; ++a)
+            {
+                for (long b = 0; b < n; ++b)
+                {
+                    if (labels[a] >= labels[b])
+                        continue;
+                    // complete linkage distance between the clusters of a and b
+                    double d = 0;
+                    for (long i = 0; i < n; ++i)
+                        for (long j = 0; j < n; ++j)
+                            if (labels[i] == labels[a] && labels[j] == labels[b])
+                                d = std::max(d, dists(i,j));
+                    if (d < best)
+                    {
+                        best = d;
+                        ba = labels[a];
+                        bb = labels[b];
+                    }
+                }
+            }
+            if (best > max_dist)
+                break;
+            for (long i = 0; i < n; ++i)
+                if (labels[i] == bb)
+                    labels[i] = ba;
+            --num_clusters;
+        }
+
+        // make the labels contiguous
+        std::map<unsigned long,unsigned long> relabel;
+        for (long i = 0; i < n; ++i)
+        {
+            if (relabel.count(labels[i]) == 0)
+            {
+                const unsigned long next = relabel.size();
+                relabel[labels[i]] = next;
+            }
+            labels[i] = relabel[labels[i]];
+        }
+        return relabel.size();
+    }
+
+    void test_bottom_up_clustering_random(dlib::rand& rnd)
+    {
+        print_spinner();
+        std::vector<matrix<double,2,1> > pts;
+        const long n = rnd.get_random_32bit_number()%30 + 2;
+        for (long i = 0; i < n; ++i)
+            pts.push_back(matrix<double,2,1>(randm(2,1,rnd)*10));
+
+        matrix<double> dists(n,n);
+        for (long r = 0; r < n; ++r)
+            for (long c = 0; c < n; ++c)
+                dists(r,c) = length(pts[r]-pts[c]);
+
+        const unsigned long min_num_clusters = rnd.get_random_32bit_number()%5 + 1;
+        const double max_dist = rnd.get_random_double() < 0.5 ? 6 : std::numeric_limits<double>::infinity();
+
+        std::vector<unsigned long> labels, labels2, labels3;
+        const unsigned long num = naive_complete_linkage(dists, labels, min_num_clusters, max_dist);
+        DLIB_TEST(bottom_up_cluster(dists, labels2, min_num_clusters, max_dist) == num);
+        DLIB_TEST(labels == labels2);
+
+        auto dist = [](const matrix<double,2,1>& a, const matrix<double,2,1>& b) { return length(a-b); };
+        DLIB_TEST(bottom_up_cluster(pts, dist, labels3, min_num_clusters, max_dist, 3) == num);
+        DLIB_TEST(labels == labels3);
+    }
+
     void test_bottom_up_clustering()
     {
         std::vector<dpoint> pts;
@@ -357,16 +625,25 @@ namespace
 
             dlib::rand rnd;
 
+            for (int i = 0; i < 30; ++i)
+                test_bottom_up_clustering_random(rnd);
+
             std::vector<sample_pair> edges;
             std::vector<unsigned long> labels;
             DLIB_TEST(newman_cluster(edges, labels) == 0);
             DLIB_TEST(chinese_whispers(edges, labels) == 0);
+            DLIB_TEST(parallel_chinese_whispers(edges, labels, 2) == 0);
+            DLIB_TEST(louvain_cluster(edges, labels) == 0);
 
             edges.push_back(sample_pair(0,1,1));
             DLIB_TEST(newman_cluster(edges, labels) == 1);
             DLIB_TEST(labels.size() == 2);
+            DLIB_TEST(louvain_cluster(edges, labels) == 1);
+            DLIB_TEST(labels.size() == 2);
             DLIB_TEST(chinese_whispers(edges, labels) == 1);
             DLIB_TEST(labels.size() == 2);
+            DLIB_TEST(parallel_chinese_whispers(edges, labels, 2) == 1);
+            DLIB_TEST(labels.size() == 2);
 
             edges.clear();
             edges.push_back(sample_pair(0,0,1));
@@ -379,8 +656,12 @@ namespace
             edges.push_back(sample_pair(1,1,1));
             DLIB_TEST(newman_cluster(edges, labels) == 1);
             DLIB_TEST(labels.size() == 2);
+            DLIB_TEST(louvain_cluster(edges, labels) == 2);
+            DLIB_TEST(labels.size() == 2);
             DLIB_TEST(chinese_whispers(edges, labels) == 2);
             DLIB_TEST(labels.size() == 2);
+            DLIB_TEST(parallel_chinese_whispers(edges, labels, 2) == 2);
+            DLIB_TEST(labels.size() == 2);
 
             edges.push_back(sample_pair(0,0,1));
             DLIB_TEST(newman_cluster(edges, labels) == 2);
@@ -395,9 +676,22 @@ namespace
             for (int i = 0; i < 10; ++i)
                 test_newman_clustering(rnd);
 
+            for (int i = 0; i < 10; ++i)
+                test_louvain_clustering(rnd);
+            test_louvain_clustering_big(rnd);
+
+            for (int i = 0; i < 10; ++i)
+                test_find_largest_eigenvectors(rnd);
+
+            for (int i = 0; i < 10; ++i)
+                test_sparse_spectral_cluster(rnd);
+
             for (int i = 0; i < 10; ++i)
                 test_chinese_whispers(rnd);
 
+            for (int i = 0; i < 10; ++i)
+                test_parallel_chinese_whispers(rnd);
+
 
         }
     } a;
@@ -673,7 +673,7 @@ namespace
 
         double best_score = -std::numeric_limits<double>::infinity();
 
-        for (unsigned long i = 0; i < 255; ++i)
+        for (unsigned long i = 0; i < 256; ++i)
         {
             temp_assignment[0] = (i&0x01)!=0;
             temp_assignment[1] = (i&0x02)!=0;
@@ -697,12 +697,13 @@ namespace
 
     template <typename map_problem>
     void do_test(
+        unsigned long num_threads = 1
     )
     {
         print_spinner();
         std::vector<unsigned long> map_assignment1, map_assignment2;
         map_problem prob;
-        find_max_factor_graph_nmplp(prob, map_assignment1, 1000, 1e-8);
+        find_max_factor_graph_nmplp(prob, map_assignment1, 1000, 1e-8, num_threads);
 
         const double score1 = find_total_score(prob, map_assignment1); 
 
@@ -720,12 +721,13 @@ namespace
 
     template <typename map_problem>
     void do_test2(
+        unsigned long num_threads = 1
     )
     {
         print_spinner();
         std::vector<unsigned long> map_assignment1, map_assignment2;
         map_problem prob;
-        find_max_factor_graph_nmplp(prob, map_assignment1, 10, 1e-8);
+        find_max_factor_graph_nmplp(prob, map_assignment1, 10, 1e-8, num_threads);
 
         const double score1 = find_total_score(prob, map_assignment1); 
 
@@ -777,6 +779,16 @@ namespace
             dlog << LINFO << "test on a tree structured graph";
             for (int i = 0; i < 10; ++i)
                 do_test2<map_problem2>();
+
+            dlog << LINFO << "test the parallel schedule";
+            for (int i = 0; i < 30; ++i)
+                do_test<map_problem_chain>(4);
+            for (int i = 0; i < 30; ++i)
+                do_test<map_problem<false> >(3);
+            for (int i = 0; i < 5; ++i)
+                do_test<map_problem<true> >(2);
+            for (int i = 0; i < 10; ++i)
+                do_test2<map_problem2>(4);
         }
     } a;
 
@@ -158,6 +158,65 @@ namespace
         do_test_<order,num_states,num_nodes,true>();
     }
 
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename map_problem
+        >
+    double score_assignment (
+        const map_problem& prob,
+        const std::vector<unsigned long>& assign
+    )
+    {
+        const int order = prob.order();
+        double score = 0;
+        for (unsigned long i = 0; i < prob.number_of_nodes(); ++i)
+            score += prob.factor_value(i, rowm(mat(assign), range(i, i-std::min<int>(order,i))));
+        return score;
+    }
+
+    template <
+        unsigned long order,
+        unsigned long num_states,
+        unsigned long num_nodes
+        >
+    void do_test_beam()
+    {
+        dlog << LINFO << "beam search, order: "<< order 
+                      << "  num_states:   " << num_states
+                      << "  num_nodes:    " << num_nodes;
+
+        const unsigned long full_width = (unsigned long)std::pow(num_states,(double)order);
+        for (int i = 0; i < 25; ++i)
+        {
+            print_spinner();
+            map_problem<order,num_states,num_nodes,false> prob;
+            std::vector<unsigned long> assign, assign2;
+            find_max_factor_graph_viterbi(prob, assign);
+            const double best_score = score_assignment(prob, assign);
+
+            // A beam wide enough to hold every trellis state must give the exact answer.
+            dlib::impl::find_max_factor_graph_viterbi_beam(prob, assign2, full_width);
+            DLIB_TEST_MSG(mat(assign) == mat(assign2),
+                          trans(mat(assign))
+                          << trans(mat(assign2))
+                          );
+
+            find_max_factor_graph_viterbi(prob, assign2, full_width+1);
+            DLIB_TEST(mat(assign) == mat(assign2));
+
+            // Narrower beams give valid, but possibly worse, assignments.
+            for (unsigned long width = 1; width < full_width; ++width)
+            {
+                find_max_factor_graph_viterbi(prob, assign2, width);
+                DLIB_TEST(assign2.size() == num_nodes);
+                for (unsigned long j = 0; j < assign2.size(); ++j)
+                    DLIB_TEST(assign2[j] < num_states);
+                DLIB_TEST(score_assignment(prob, assign2) <= best_score + 1e-12);
+            }
+        }
+    }
+
 // ----------------------------------------------------------------------------------------
 
     class test_find_max_factor_graph_viterbi : public tester
@@ -207,6 +266,12 @@ namespace
             do_test<2,1,8>();
             do_test<3,1,8>();
             do_test<0,1,8>();
+
+            do_test_beam<1,3,1>();
+            do_test_beam<1,5,8>();
+            do_test_beam<2,3,7>();
+            do_test_beam<3,3,8>();
+            do_test_beam<2,4,1>();
         }
     } a;
 
@@ -9,6 +9,7 @@
 #include <cstdlib>
 #include <ctime>
 #include <vector>
+#include <atomic>
 #include <dlib/rand.h>
 
 #include "tester.h"
@@ -83,6 +84,42 @@ namespace
         }
     }
 
+// ----------------------------------------------------------------------------------------
+
+    void test_upper_bound_function_many_points()
+    {
+        print_spinner();
+
+        // Add enough points one at a time that the upper bound has to search its
+        // kd-tree, as well as the points it hasn't indexed yet, to evaluate U(x).
+        auto f = [](const matrix<double,0,1>& x) { return std::sin(3*x(0)) + 2*std::cos(2*x(1)) - x(2)*x(2); };
+        dlib::rand rnd;
+        auto make_rnd = [&rnd]() { matrix<double,0,1> x(3); x = 4*rnd.get_random_double()-2, 4*rnd.get_random_double()-2, 4*rnd.get_random_double()-2; return x; };
+
+        upper_bound_function ub(0, 1e-6);
+        for (int i = 0; i < 2000; ++i)
+        {
+            auto x = make_rnd();
+            ub.add(function_evaluation(x,f(x)));
+        }
+        DLIB_TEST(ub.num_points() == 2000);
+        print_spinner();
+
+        // With no noise terms U(x) must go through each point, which means every point
+        // has to be found by the search inside operator().
+        double max_err = 0;
+        for (auto& ev : ub.get_points())
+            max_err = std::max(max_err, std::abs(ub(ev.x) - ev.y));
+        dlog << LINFO << "max error at the points: " << max_err;
+        DLIB_TEST_MSG(max_err < 1e-3, max_err);
+
+        for (int i = 0; i < 100; ++i)
+        {
+            auto x = make_rnd();
+            DLIB_TEST_MSG(ub(x) - f(x) > -1e-3, ub(x) - f(x));
+        }
+    }
+
 // ----------------------------------------------------------------------------------------
 
     double complex_holder_table ( double x0, double x1)
@@ -274,6 +311,61 @@ namespace
         DLIB_TEST_MSG(std::abs(result.y  + 21.9210397) < 0.0001, std::abs(result.y  + 21.9210397));
     }
 
+// ----------------------------------------------------------------------------------------
+
+    void test_find_global_parallel(
+    )
+    {
+        print_spinner();
+        thread_pool tp(4);
+
+        std::atomic<long> num_calls(0);
+        auto rosen = [&num_calls](const matrix<double,0,1>& x) 
+        { 
+            ++num_calls;
+            return -1*( 100*std::pow(x(1) - x(0)*x(0),2.0) + std::pow(1 - x(0),2)); 
+        };
+
+        auto result = find_max_global(tp, rosen, {0.1, 0.1}, {2, 2}, max_function_calls(200));
+        matrix<double,0,1> true_x = {1,1};
+        dlog << LINFO << "parallel rosen: " <<  trans(result.x);
+        DLIB_TEST_MSG(min(abs(true_x-result.x)) < 1e-5, min(abs(true_x-result.x)));
+        DLIB_TEST(num_calls == 200);
+        print_spinner();
+
+        result = find_max_global(tp, rosen, {0.1, 0.1}, {2, 2}, std::chrono::seconds(3));
+        dlog << LINFO << "parallel rosen: " <<  trans(result.x);
+        DLIB_TEST_MSG(min(abs(true_x-result.x)) < 1e-5, min(abs(true_x-result.x)));
+        print_spinner();
+
+        result = find_min_global(tp, [](double x){ return std::pow(x-2,2.0); }, -10, 1, max_function_calls(20));
+        dlog << LINFO << "parallel (x-2)^2, bound at 1: " <<  trans(result.x);
+        DLIB_TEST(result.x.size()==1);
+        DLIB_TEST(std::abs(result.x - 1) < 1e-9);
+        print_spinner();
+
+        result = find_min_global(tp, [](double a, double b){ return complex_holder_table(a,b);}, 
+            {-10, -10}, {10, 10}, max_function_calls(600));
+        dlog << LINFO << "parallel complex_holder_table y: "<< result.y;
+        DLIB_TEST_MSG(std::abs(result.y  + 21.9210397) < 0.0001, std::abs(result.y  + 21.9210397));
+        print_spinner();
+
+        // Exceptions thrown by the objective function should come out of find_max_global().
+        num_calls = 0;
+        bool caught = false;
+        try
+        {
+            find_max_global(tp, [&num_calls](double x) -> double { if (++num_calls == 5) throw error("oops"); return x; }, 
+                -1, 1, max_function_calls(100));
+        }
+        catch (error&)
+        {
+            caught = true;
+        }
+        DLIB_TEST(caught);
+        DLIB_TEST(num_calls < 100);
+    }
+
 // ----------------------------------------------------------------------------------------
 
     class global_optimization_tester : public tester
@@ -291,9 +383,11 @@ namespace
             test_upper_bound_function(0.01, 1e-6);
             test_upper_bound_function(0.0, 1e-6);
             test_upper_bound_function(0.0, 1e-1);
+            test_upper_bound_function_many_points();
             test_global_function_search();
             test_find_max_global();
             test_find_min_global();
+            test_find_global_parallel();
         }
     } a;
 
@@ -1132,6 +1132,176 @@ namespace
         DLIB_TEST(labels[5][5] != 0);
     }
 
+    template <typename T>
+    T grid_min_cut_reference_score (
+        const grid_min_cut<T>& gc
+    )
+    /*!
+        ensures
+            - solves gc's graph from scratch with min_cut and returns the cut score.
+    !*/
+    {
+        typedef typename dlib::directed_graph<node_label, T>::kernel_1a_c dgraph_type;
+        dgraph_type g;
+        const unsigned long n = gc.size();
+        const unsigned long source = n, sink = n+1;
+        g.set_number_of_nodes(n+2);
+        const rectangle rect(0,0,gc.nc()-1,gc.nr()-1);
+        for (long r = 0; r < gc.nr(); ++r)
+        {
+            for (long c = 0; c < gc.nc(); ++c)
+            {
+                const point p(c,r);
+                const unsigned long i = r*gc.nc()+c;
+                g.add_edge(source,i);
+                g.add_edge(i,source);
+                g.add_edge(i,sink);
+                g.add_edge(sink,i);
+                edge(g,source,i) = gc.get_source_capacity(p);
+                edge(g,i,source) = 0;
+                edge(g,i,sink) = gc.get_sink_capacity(p);
+                edge(g,sink,i) = 0;
+                for (long dr = -1; dr <= 1; ++dr)
+                {
+                    for (long dc = -1; dc <= 1; ++dc)
+                    {
+                        const point q(c+dc,r+dr);
+                        if (gc.are_neighbors(p,q))
+                        {
+                            const unsigned long j = q.y()*gc.nc()+q.x();
+                            if (!g.has_edge(i,j))
+                            {
+                                g.add_edge(i,j);
+                                g.add_edge(j,i);
+                            }
+                            edge(g,i,j) = gc.get_edge_capacity(p,q);
+                        }
+                    }
+                }
+            }
+        }
+
+        min_cut mc;
+        mc(g, source, sink);
+
+        T score = 0;
+        for (long r = 0; r < gc.nr(); ++r)
+        {
+            for (long c = 0; c < gc.nc(); ++c)
+            {
+                const point p(c,r);
+                const bool in_source = g.node(r*gc.nc()+c).data == SOURCE_CUT;
+                // the labels from gc must give the same score as the ones from min_cut
+                if (!in_source)
+                    score += gc.get_source_capacity(p);
+                else
+                    score += gc.get_sink_capacity(p);
+                for (long dr = -1; dr <= 1; ++dr)
+                {
+                    for (long dc = -1; dc <= 1; ++dc)
+                    {
+                        const point q(c+dc,r+dr);
+                        if (gc.are_neighbors(p,q) && in_source && 
+                            g.node(q.y()*gc.nc()+q.x()).data != SOURCE_CUT)
+                            score += gc.get_edge_capacity(p,q);
+                    }
+                }
+            }
+        }
+        return score;
+    }
+
+    template <typename T>
+    T grid_min_cut_label_score (
+        const grid_min_cut<T>& gc
+    )
+    {
+        T score = 0;
+        for (long r = 0; r < gc.nr(); ++r)
+        {
+            for (long c = 0; c < gc.nc(); ++c)
+            {
+                const point p(c,r);
+                if (gc.get_label(p) == SOURCE_CUT)
+                    score += gc.get_sink_capacity(p);
+                else
+                    score += gc.get_source_capacity(p);
+                for (long dr = -1; dr <= 1; ++dr)
+                {
+                    for (long dc = -1; dc <= 1; ++dc)
+                    {
+                        const point q(c+dc,r+dr);
+                        if (gc.are_neighbors(p,q) && gc.get_label(p) == SOURCE_CUT && 
+                            gc.get_label(q) == SINK_CUT)
+                            score += gc.get_edge_capacity(p,q);
+                    }
+                }
+            }
+        }
+        return score;
+    }
+
+    template <typename T>
+    void test_grid_min_cut (
+        dlib::rand& rnd,
+        int connectivity
+    )
+    {
+        const long nr = rnd.get_random_32bit_number()%6 + 1;
+        const long nc = rnd.get_random_32bit_number()%6 + 1;
+        grid_min_cut<T> gc(nr, nc, connectivity);
+        DLIB_TEST(gc.size() == nr*nc);
+
+        std::vector<std::pair<point,point> > edges;
+        for (long r = 0; r < nr; ++r)
+        {
+            for (long c = 0; c < nc; ++c)
+            {
+                const point p(c,r);
+                gc.set_terminal_capacities(p, static_cast<T>(rnd.get_random_double()*50),
+                                              static_cast<T>(rnd.get_random_double()*50));
+                for (long dr = -1; dr <= 1; ++dr)
+                {
+                    for (long dc = -1; dc <= 1; ++dc)
+                    {
+                        const point q(c+dc,r+dr);
+                        if (gc.are_neighbors(p,q))
+                        {
+                            edges.push_back(std::make_pair(p,q));
+                            gc.set_edge_capacity(p,q, static_cast<T>(rnd.get_random_double()*30));
+                        }
+                    }
+                }
+            }
+        }
+
+        // Solve, then keep changing random capacities and check that the incremental
+        // solutions match what min_cut finds from scratch.
+        for (int round = 0; round < 10; ++round)
+        {
+            const T score = gc.solve();
+            const T label_score = grid_min_cut_label_score(gc);
+            const T ref_score = grid_min_cut_reference_score(gc);
+            DLIB_TEST_MSG(std::abs(score - label_score) <= 1e-10*std::abs(ref_score), score << "  " << label_score);
+            DLIB_TEST_MSG(std::abs(score - ref_score) <= 1e-10*std::abs(ref_score), score << "  " << ref_score);
+
+            const long num_changes = rnd.get_random_32bit_number()%5 + 1;
+            for (long k = 0; k < num_changes; ++k)
+            {
+                const point p(rnd.get_random_32bit_number()%nc, rnd.get_random_32bit_number()%nr);
+                gc.set_terminal_capacities(p, static_cast<T>(rnd.get_random_double()*50),
+                                              static_cast<T>(rnd.get_random_double()*50));
+                if (edges.size() != 0)
+                {
+                    const std::pair<point,point>& e = edges[rnd.get_random_32bit_number()%edges.size()];
+                    // Make it likely that an edge carrying flow loses capacity.
+                    const T cap = (rnd.get_random_double() < 0.5) ? 0 : static_cast<T>(rnd.get_random_double()*30);
+                    gc.set_edge_capacity(e.first, e.second, cap);
+                }
+            }
+        }
+    }
+
 // ----------------------------------------------------------------------------------------
 // ----------------------------------------------------------------------------------------
 // ----------------------------------------------------------------------------------------
@@ -1154,6 +1324,15 @@ namespace
             test_potts_pair_grid();
             test_inf();
 
+            for (int i = 0; i < 300; ++i)
+            {
+                print_spinner();
+                test_grid_min_cut<int>(rnd, 4);
+                test_grid_min_cut<int>(rnd, 8);
+                test_grid_min_cut<double>(rnd, 4);
+                test_grid_min_cut<double>(rnd, 8);
+            }
+
             for (int i = 0; i < 500; ++i)
             {
                 array2d<unsigned char> labels, brute_labels;
@@ -9,6 +9,8 @@
 #include <dlib/iosockstream.h>
 #include <dlib/server.h>
 #include <vector>
+#include <set>
+#include <memory>
 
 #include "tester.h"
 
@@ -157,6 +159,136 @@ namespace
         }
     }
 
+// ----------------------------------------------------------------------------------------
+
+    class serv3 : public server_iostream
+    {
+        virtual void on_connect (
+            std::istream& in,
+            std::ostream& out,
+            const std::string& ,
+            const std::string& ,
+            unsigned short ,
+            unsigned short ,
+            uint64 
+        )
+        {
+            std::string temp;
+            in >> temp;
+            out << temp << " back ";
+
+            auto_mutex lock(data_mutex);
+            ++num_connects;
+            thread_ids.insert(get_thread_id());
+        }
+
+    public:
+        serv3() : num_connects(0) {}
+
+        dlib::mutex data_mutex;
+        int num_connects;
+        std::set<thread_id_type> thread_ids;
+    };
+
+    void test_event_loop()
+    {
+        dlog << LINFO << "in test_event_loop()";
+        serv3 theserv;
+        theserv.set_listening_port(12345);
+        DLIB_TEST(theserv.is_using_event_loop() == false);
+        theserv.use_event_loop(2, true);
+        DLIB_TEST(theserv.is_using_event_loop());
+        DLIB_TEST(theserv.get_num_worker_threads() == 2);
+        DLIB_TEST(theserv.waits_for_client_data());
+        theserv.start_async();
+
+        // wait a little bit to make sure the server has started listening before we try 
+        // to connect to it.
+        dlib::sleep(500);
+
+        // Connections that never send anything shouldn't tie up the worker threads.
+        std::vector<std::unique_ptr<iosockstream> > idle(30);
+        for (unsigned long i = 0; i < idle.size(); ++i)
+            idle[i].reset(new iosockstream("localhost:12345"));
+
+        for (int i = 0; i < 100; ++i)
+        {
+            print_spinner();
+            iosockstream stream("localhost:12345");
+
+            stream << "hello" << i << " ";
+            std::string temp;
+            stream >> temp; DLIB_TEST(temp == "hello" + cast_to_string(i));
+            stream >> temp; DLIB_TEST(temp == "back");
+        }
+
+        // Closing some of the idle connections without sending anything shouldn't result
+        // in calls to on_connect() either.
+        idle.resize(10);
+        dlib::sleep(500);
+        {
+            auto_mutex lock(theserv.data_mutex);
+            DLIB_TEST(theserv.num_connects == 100);
+            DLIB_TEST(theserv.thread_ids.size() <= 2);
+        }
+
+        // clear() has to shut down the idle connections still parked in the event loop.
+        theserv.clear();
+        DLIB_TEST(theserv.is_running() == false);
+        DLIB_TEST(theserv.is_using_event_loop() == false);
+        DLIB_TEST(theserv.waits_for_client_data() == false);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    class serv4 : public server_iostream
+    {
+        virtual void on_connect (
+            std::istream& in,
+            std::ostream& out,
+            const std::string& ,
+            const std::string& ,
+            unsigned short ,
+            unsigned short ,
+            uint64 
+        )
+        {
+            out << "greetings " << std::flush;
+            std::string temp;
+            in >> temp;
+            out << temp << " back ";
+        }
+    };
+
+    void test_event_loop_server_speaks_first()
+    {
+        dlog << LINFO << "in test_event_loop_server_speaks_first()";
+        serv4 theserv;
+        theserv.set_listening_port(12345);
+        theserv.use_event_loop(2);
+        DLIB_TEST(theserv.waits_for_client_data() == false);
+        theserv.start_async();
+
+        // wait a little bit to make sure the server has started listening before we try 
+        // to connect to it.
+        dlib::sleep(500);
+
+        for (int i = 0; i < 50; ++i)
+        {
+            print_spinner();
+            iosockstream stream("localhost:12345");
+            // fail rather than hang if the greeting never comes
+            stream.terminate_connection_after_timeout(10000);
+
+            // The server talks first, so on_connect() has to run before we send anything.
+            std::string temp;
+            stream >> temp; DLIB_TEST(temp == "greetings");
+            stream << "hello" << i << " ";
+            stream >> temp; DLIB_TEST(temp == "hello" + cast_to_string(i));
+            stream >> temp; DLIB_TEST(temp == "back");
+        }
+    }
+
 // ----------------------------------------------------------------------------------------
 
     class test_iosockstream : public tester
@@ -173,6 +305,8 @@ namespace
         {
             test1();
             test2();
+            test_event_loop();
+            test_event_loop_server_speaks_first();
         }
     } a;
 
@@ -102,6 +102,141 @@ namespace
                 DLIB_TEST(hits[i] == 250);
             }
         }
+        {
+            std::vector<sample_type> centers;
+            pick_initial_centers(seed_centers.size(), centers, samples, linear_kernel<sample_type>());
+
+            minibatch_kmeans<sample_type> mbk(centers);
+            mbk.set_num_threads(2);
+            std::vector<sample_type> batch;
+            for (unsigned long i = 0; i < samples.size(); ++i)
+            {
+                batch.push_back(samples[i]);
+                if (batch.size() == 50)
+                {
+                    mbk.train(batch);
+                    batch.clear();
+                }
+            }
+            mbk.train(batch);
+
+            DLIB_TEST(mbk.number_of_centers() == seed_centers.size());
+            DLIB_TEST(sum(mat(mbk.get_center_counts())) == samples.size());
+
+            std::vector<int> hits(mbk.number_of_centers(),0);
+            for (unsigned long i = 0; i < samples.size(); ++i)
+                hits[mbk(samples[i])]++;
+
+            for (unsigned long i = 0; i < hits.size(); ++i)
+            {
+                DLIB_TEST(hits[i] == 250);
+            }
+
+            ostringstream sout;
+            serialize(mbk, sout);
+            istringstream sin(sout.str());
+            minibatch_kmeans<sample_type> mbk2;
+            deserialize(mbk2, sin);
+            DLIB_TEST(mbk2.get_centers().size() == mbk.get_centers().size());
+            for (unsigned long i = 0; i < mbk.number_of_centers(); ++i)
+                DLIB_TEST(mbk2.get_centers()[i] == mbk.get_centers()[i]);
+            DLIB_TEST(mbk2.get_center_counts() == mbk.get_center_counts());
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void lloyd_kmeans (
+        const std::vector<matrix<double,0,1> >& samples,
+        std::vector<matrix<double,0,1> >& centers,
+        unsigned long max_iter
+    )
+    /*!
+        ensures
+            - runs the plain kmeans algorithm, with no pruning, for comparison with
+              find_clusters_using_kmeans().
+    !*/
+    {
+        std::vector<unsigned long> assignments(samples.size(), centers.size());
+        matrix<double,0,1> zero = zeros_matrix(centers[0]);
+        for (unsigned long iter = 0; iter < max_iter; ++iter)
+        {
+            bool changed = false;
+            for (unsigned long i = 0; i < samples.size(); ++i)
+            {
+                double best_dist = std::numeric_limits<double>::infinity();
+                unsigned long best = 0;
+                for (unsigned long j = 0; j < centers.size(); ++j)
+                {
+                    if (length(centers[j] - samples[i]) < best_dist)
+                    {
+                        best_dist = length(centers[j] - samples[i]);
+                        best = j;
+                    }
+                }
+                if (assignments[i] != best)
+                    changed = true;
+                assignments[i] = best;
+            }
+
+            std::vector<unsigned long> counts(centers.size(), 0);
+            centers.assign(centers.size(), zero);
+            for (unsigned long i = 0; i < samples.size(); ++i)
+            {
+                centers[assignments[i]] += samples[i];
+                counts[assignments[i]]++;
+            }
+            for (unsigned long j = 0; j < centers.size(); ++j)
+            {
+                if (counts[j] != 0)
+                    centers[j] /= counts[j];
+            }
+
+            if (!changed)
+                break;
+        }
+    }
+
+    void test_kmeans_pruning_and_threads (
+    )
+    {
+        print_spinner();
+        typedef matrix<double,0,1> sample_type;
+        std::vector<sample_type> samples;
+        for (int i = 0; i < 3000; ++i)
+            samples.push_back(gaussian_randm(5,1,i) + 3*sample_type(randm(5,1,rnd)));
+
+        dlib::rand rnd2(1);
+        std::vector<sample_type> init_centers;
+        pick_initial_centers_kmeans_plus_plus(30, init_centers, samples, rnd2);
+        DLIB_TEST(init_centers.size() == 30);
+
+        // kmeans++ should give the same centers no matter how many threads are used
+        {
+            dlib::rand rnd3(1);
+            std::vector<sample_type> temp;
+            pick_initial_centers_kmeans_plus_plus(30, temp, samples, rnd3, 4);
+            DLIB_TEST(temp.size() == init_centers.size());
+            for (unsigned long i = 0; i < temp.size(); ++i)
+                DLIB_TEST(temp[i] == init_centers[i]);
+        }
+
+        for (unsigned long max_iter : {1, 3, 1000})
+        {
+            std::vector<sample_type> truth = init_centers, centers1 = init_centers, centers4 = init_centers;
+            lloyd_kmeans(samples, truth, max_iter);
+            find_clusters_using_kmeans(samples, centers1, max_iter);
+            find_clusters_using_kmeans(samples, centers4, max_iter, 4);
+
+            double err = 0;
+            for (unsigned long j = 0; j < truth.size(); ++j)
+            {
+                err = std::max(err, max(abs(truth[j]-centers1[j])));
+                DLIB_TEST(centers1[j] == centers4[j]);
+            }
+            dlog << LINFO << "max_iter: " << max_iter << "  kmeans error: " << err;
+            DLIB_TEST(err < 1e-12);
+        }
     }
 
 
@@ -151,7 +286,7 @@ namespace
                 run_test(seed_centers);
             }
 
-
+            test_kmeans_pruning_and_threads();
         }
     } a;
 
@@ -427,6 +427,138 @@ namespace
         }
     }
 
+// ----------------------------------------------------------------------------------------
+
+    void test_sparse_lm()
+    {
+        typedef std::vector<std::pair<unsigned long,double> > sparse_vect;
+        print_spinner();
+        {
+            matrix<double,2,1> ch;
+            ch = rosen_start<double>();
+
+            auto der = [](int i, const matrix<double,2,1>& m)
+            {
+                const matrix<double,2,1> g = rosen_residual_derivative_double(i,m);
+                sparse_vect temp;
+                for (long j = 0; j < g.size(); ++j)
+                {
+                    if (g(j) != 0)
+                        temp.push_back(make_pair(j, g(j)));
+                }
+                return temp;
+            };
+
+            solve_sparse_least_squares_lm(objective_delta_stop_strategy(1e-13, 80),
+                                rosen_residual_double,
+                                der,
+                                range(1,20),
+                                ch);
+
+            dlog << LINFO << "sparse lm rosen obj: " << rosen(ch);
+            dlog << LINFO << "sparse lm rosen error: " << length(ch - rosen_solution<double>());
+
+            DLIB_TEST(length(ch - rosen_solution<double>()) < 1e-5);
+        }
+
+        print_spinner();
+        {
+            // A bigger problem where each residual only depends on 2 of the 500 variables.
+            // The residuals are nonlinear functions of the differences between variables,
+            // plus one residual that pins down x(0).
+            dlib::rand rnd;
+            const long n = 500;
+            matrix<double,0,1> truth(n);
+            for (long i = 0; i < n; ++i)
+                truth(i) = rnd.get_random_gaussian();
+            std::vector<std::pair<long,long> > pairs;
+            for (long i = 0; i < n; ++i)
+            {
+                for (int k = 0; k < 5; ++k)
+                    pairs.push_back(make_pair(i, (i + 1 + rnd.get_random_32bit_number()%20)%n));
+            }
+
+            auto f = [&](long i, const matrix<double,0,1>& x)
+            {
+                if (i == (long)pairs.size())
+                    return x(0) - truth(0);
+                const long a = pairs[i].first, b = pairs[i].second;
+                return std::sinh(x(a)-x(b)) - std::sinh(truth(a)-truth(b));
+            };
+            auto der = [&](long i, const matrix<double,0,1>& x)
+            {
+                sparse_vect temp;
+                if (i == (long)pairs.size())
+                {
+                    temp.push_back(make_pair(0, 1.0));
+                    return temp;
+                }
+                const long a = pairs[i].first, b = pairs[i].second;
+                const double c = std::cosh(x(a)-x(b));
+                temp.push_back(make_pair(a, c));
+                temp.push_back(make_pair(b, -c));
+                return temp;
+            };
+
+            matrix<double,0,1> x1 = zeros_matrix<double>(n,1), x3 = x1;
+            const double obj1 = solve_sparse_least_squares_lm(objective_delta_stop_strategy(1e-14, 100),
+                f, der, range(0,pairs.size()), x1);
+            const double obj3 = solve_sparse_least_squares_lm(objective_delta_stop_strategy(1e-14, 100),
+                f, der, range(0,pairs.size()), x3, 3);
+
+            dlog << LINFO << "sparse lm obj: " << obj1;
+            dlog << LINFO << "sparse lm error: " << max(abs(x1-truth));
+            DLIB_TEST(max(abs(x1-truth)) < 1e-7);
+            DLIB_TEST(obj1 < 1e-14);
+            // The answer shouldn't depend on the number of threads.
+            DLIB_TEST(x1 == x3);
+            DLIB_TEST(obj1 == obj3);
+        }
+
+        print_spinner();
+        {
+            // x(2) doesn't affect any residual, so its column of the Jacobian is all
+            // zeros, and x(3) only barely affects one.  Neither should stop the solver
+            // from finding x(0) and x(1), and x(2) should be left alone.
+            auto f = [](long i, const matrix<double,4,1>& x)
+            {
+                switch (i)
+                {
+                    case 0: return x(0) - 1;
+                    case 1: return 10*(x(1) - x(0)*x(0));
+                    default: return 1e-160*(x(3) - 1);
+                }
+            };
+            auto der = [](long i, const matrix<double,4,1>& x)
+            {
+                sparse_vect temp;
+                switch (i)
+                {
+                    case 0: temp.push_back(make_pair(0, 1.0)); break;
+                    case 1: temp.push_back(make_pair(0, -20*x(0)));
+                            temp.push_back(make_pair(1, 10.0)); 
+                            // an explicit zero in the x(2) column
+                            temp.push_back(make_pair(2, 0.0)); break;
+                    default: temp.push_back(make_pair(3, 1e-160)); break;
+                }
+                return temp;
+            };
+
+            matrix<double,4,1> x;
+            x = -1.2, 1, 5, 0;
+            const double obj = solve_sparse_least_squares_lm(objective_delta_stop_strategy(1e-14, 100),
+                f, der, range(0,2), x);
+
+            dlog << LINFO << "sparse lm zero column x: " << trans(x);
+            DLIB_TEST(is_finite(x));
+            DLIB_TEST(is_finite(obj));
+            DLIB_TEST(std::abs(x(0) - 1) < 1e-6);
+            DLIB_TEST(std::abs(x(1) - 1) < 1e-6);
+            DLIB_TEST(x(2) == 5);
+            DLIB_TEST(obj < 1e-12);
+        }
+    }
+
 // ----------------------------------------------------------------------------------------
 
     class optimization_tester : public tester
@@ -444,6 +576,7 @@ namespace
             test_with_chebyquad();
             test_with_brown();
             test_with_rosen();
+            test_sparse_lm();
         }
     } a;
 
@@ -0,0 +1,213 @@
+// Copyright (C) 2018  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+
+
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <dlib/logger.h>
+
+#include "tester.h"
+
+namespace  
+{
+    using namespace test;
+    using namespace dlib;
+    using namespace std;
+
+    logger dlog("test.logger");
+
+// ----------------------------------------------------------------------------------------
+
+    struct message_collector
+    {
+        std::vector<std::string> names;
+        std::vector<int> priorities;
+        std::vector<std::string> messages;
+
+        void log (
+            const std::string& logger_name,
+            const log_level& l,
+            const uint64 ,
+            const char* message_to_log
+        )
+        {
+            names.push_back(logger_name);
+            priorities.push_back(l.priority);
+            messages.push_back(message_to_log);
+        }
+    };
+
+// ----------------------------------------------------------------------------------------
+
+    void test_async_logging_to_stream (
+    )
+    {
+        print_spinner();
+        ostringstream sout;
+        logger log1("test_async.a");
+        logger log2("test_async.a.b");
+        log1.set_output_stream(sout);
+        log1.set_level(LALL);
+
+        set_all_logging_async(true, 64);
+
+        const int num_threads = 4;
+        const int num_messages = 2000;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; ++t)
+        {
+            threads.emplace_back([&, t]() {
+                for (int i = 0; i < num_messages; ++i)
+                {
+                    if (i%2 == 0)
+                        log1 << LINFO << "thread " << t << " message " << i;
+                    else
+                        log2 << LDEBUG << "thread " << t << " message " << i;
+                }
+            });
+        }
+        for (auto& th : threads)
+            th.join();
+
+        flush_async_logging();
+
+        // Every message shows up exactly once, with the default header, and the
+        // messages from each thread come out in the order that thread logged them.
+        istringstream sin(sout.str());
+        string line;
+        std::vector<int> next(num_threads, 0);
+        int num_lines = 0;
+        while (getline(sin, line))
+        {
+            ++num_lines;
+            const bool from_child = line.find("test_async.a.b: ") != string::npos;
+            DLIB_TEST_MSG(from_child || line.find("test_async.a: ") != string::npos, line);
+            DLIB_TEST_MSG(line.find(from_child ? "DEBUG" : "INFO") != string::npos, line);
+
+            istringstream lin(line.substr(line.find(": ")+2));
+            string word1, word2;
+            int t = -1, i = -1;
+            lin >> word1 >> t >> word2 >> i;
+            DLIB_TEST_MSG(0 <= t && t < num_threads, line);
+            DLIB_TEST_MSG(i == next[t], line);
+            next[t] = i+1;
+        }
+        DLIB_TEST(num_lines == num_threads*num_messages);
+
+        set_all_logging_async(false);
+        log1 << LINFO << "synchronous again";
+        DLIB_TEST(sout.str().find("synchronous again\n") != string::npos);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_async_logging_hooks_and_overflow (
+    )
+    {
+        print_spinner();
+        message_collector mc;
+        logger log1("test_async_hook");
+        log1.set_output_hook(mc, &message_collector::log);
+        log1.set_level(LALL);
+
+        set_all_logging_async(true, 16);
+        for (int i = 0; i < 1000; ++i)
+            log1 << LWARN << "hook message " << i;
+        flush_async_logging();
+
+        DLIB_TEST(mc.messages.size() == 1000);
+        for (unsigned long i = 0; i < mc.messages.size(); ++i)
+        {
+            DLIB_TEST(mc.names[i] == "test_async_hook");
+            DLIB_TEST(mc.priorities[i] == LWARN.priority);
+            DLIB_TEST(mc.messages[i] == "hook message " + cast_to_string(i));
+        }
+
+        // With the drop policy a tiny queue can't keep up, but whatever does get
+        // through is still in order.
+        mc = message_collector();
+        set_all_logging_async(true, 1, log_queue_overflow::drop);
+        for (int i = 0; i < 1000; ++i)
+            log1 << LWARN << i;
+        set_all_logging_async(false);
+
+        DLIB_TEST(mc.messages.size() > 0);
+        DLIB_TEST(mc.messages.size() <= 1000);
+        for (unsigned long i = 1; i < mc.messages.size(); ++i)
+            DLIB_TEST(string_cast<int>(mc.messages[i-1]) < string_cast<int>(mc.messages[i]));
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    struct async_enabling_hook
+    {
+        logger* inner;
+
+        void log (
+            const std::string& ,
+            const log_level& ,
+            const uint64 ,
+            const char* 
+        )
+        {
+            // Have another thread turn on async logging while this synchronous message
+            // still holds the logger's mutex, then log more than the queue can hold.  The
+            // writer thread can't drain the queue until we return, so these must not
+            // block on it.
+            std::thread t([](){ set_all_logging_async(true, 1); });
+            t.join();
+            for (int i = 0; i < 5; ++i)
+                *inner << LINFO << "nested " << i;
+        }
+    };
+
+    void test_async_logging_nested_in_sync_message (
+    )
+    {
+        print_spinner();
+        ostringstream sout;
+        logger outer("test_async_nested.outer");
+        logger inner("test_async_nested.inner");
+        inner.set_output_stream(sout);
+        inner.set_level(LALL);
+        async_enabling_hook hook;
+        hook.inner = &inner;
+        outer.set_output_hook(hook, &async_enabling_hook::log);
+        outer.set_level(LALL);
+
+        outer << LINFO << "outer message";
+        set_all_logging_async(false);
+
+        string::size_type pos = 0;
+        for (int i = 0; i < 5; ++i)
+        {
+            pos = sout.str().find("nested " + cast_to_string(i) + "\n", pos);
+            DLIB_TEST(pos != string::npos);
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    class logger_tester : public tester
+    {
+    public:
+        logger_tester (
+        ) :
+            tester ("test_logger",
+                    "Runs tests on the logger component.")
+        {}
+
+        void perform_test (
+        )
+        {
+            test_async_logging_to_stream();
+            test_async_logging_hooks_and_overflow();
+            test_async_logging_nested_in_sync_message();
+        }
+    } a;
+
+}
+
+
@@ -135,9 +135,67 @@ namespace
             DLIB_TEST(assignment_cost(cost,assign) == true_eval);
         }
 
+        template <typename T>
+        void test_sparse_assignment()
+        {
+            const long num_rows = rnd.get_random_32bit_number()%6;
+            const long num_cols = rnd.get_random_32bit_number()%6;
+            const long range = rnd.get_random_32bit_number()%100 + 1;
+
+            // The equivalent dense problem.  Every row also gets its own column
+            // standing for "unassigned".
+            matrix<T> dense(num_rows+num_cols, num_rows+num_cols);
+            dense = 0;
+            std::vector<std::vector<std::pair<unsigned long,T> > > cost(num_rows);
+            for (long r = 0; r < num_rows; ++r)
+            {
+                for (long c = 0; c < num_cols; ++c)
+                {
+                    if (rnd.get_random_double() < 0.5)
+                    {
+                        const T val = static_cast<T>(rnd.get_random_32bit_number()%range) - range/4;
+                        cost[r].push_back(std::make_pair(c, val));
+                        dense(r,c) = std::max<T>(val,0);
+                    }
+                }
+            }
+
+            std::vector<long> assign = sparse_max_cost_assignment(cost);
+            DLIB_TEST(assign.size() == (unsigned long)num_rows);
+            std::vector<bool> used(num_cols, false);
+            T total = 0;
+            for (long r = 0; r < num_rows; ++r)
+            {
+                if (assign[r] == -1)
+                    continue;
+                DLIB_TEST(0 <= assign[r] && assign[r] < num_cols);
+                DLIB_TEST(!used[assign[r]]);
+                used[assign[r]] = true;
+                bool found = false;
+                for (unsigned long i = 0; i < cost[r].size(); ++i)
+                {
+                    if (cost[r][i].first == (unsigned long)assign[r])
+                    {
+                        total += cost[r][i].second;
+                        found = true;
+                    }
+                }
+                DLIB_TEST(found);
+            }
+
+            const T true_eval = assignment_cost(dense, max_cost_assignment(dense));
+            DLIB_TEST_MSG(total == true_eval, total << "  " << true_eval);
+        }
+
         void perform_test (
         )
         {
+            for (long i = 0; i < 1000; ++i)
+            {
+                test_sparse_assignment<int>();
+                test_sparse_assignment<int64>();
+            }
+
             for (long i = 0; i < 1000; ++i)
             {
                 if ((i%100) == 0)
@@ -316,6 +316,44 @@ namespace
                 //cout << control(0) << "\t" << trans(initial_state);
             }
 
+            {
+                // Now a system with several inputs and lots of active constraints.
+                dlib::rand rnd;
+                matrix<double,3,3> A = identity_matrix<double>(3) + 0.1*(randm(3,3,rnd)-0.5);
+                matrix<double,3,2> B = randm(3,2,rnd)-0.5;
+                matrix<double,3,1> C = 0.01*(randm(3,1,rnd)-0.5);
+                matrix<double,3,1> Q = randm(3,1,rnd);
+                matrix<double,2,1> R = 0.1 + randm(2,1,rnd);
+                matrix<double,2,1> lower, upper;
+                lower = -0.3;
+                upper = 0.3;
+
+                std::vector<matrix<double,2,1> > controls(40);
+                std::vector<matrix<double,3,1> > target(40);
+                for (unsigned long i = 0; i < controls.size(); ++i)
+                {
+                    controls[i] = 0;
+                    target[i] = 0;
+                }
+
+                mpc<3,2,40> solver(A,B,C,Q,R,lower,upper);
+                solver.set_epsilon(0.00000001);
+                matrix<double,3,1> state = 4*(randm(3,1,rnd)-0.5);
+                for (int i = 0; i < 10; ++i)
+                {
+                    print_spinner();
+                    matrix<double,2,1> control = solver(state);
+
+                    for (unsigned long i = 1; i < controls.size(); ++i)
+                        controls[i-1] = controls[i];
+                    solve_linear_mpc(A,B,C,Q,R,lower,upper, target, state, controls);
+                    dlog << LINFO << "ERROR: " << length(control-controls[0]);
+                    DLIB_TEST(length(control-controls[0]) < 1e-6);
+
+                    state = A*state + B*control + C;
+                }
+            }
+
             {
                 // also just generally test our QP solver.
                 matrix<double,20,20> Q = gaussian_randm(20,20,5);
@@ -820,6 +820,7 @@ namespace
         res = cross_validate_object_detection_trainer(trainer, images, object_locations, 3);
         dlog << LINFO << "3-fold cross validation (precision,recall): " << res;
         DLIB_TEST(sum(res) == 3);
+        DLIB_TEST(cross_validate_object_detection_trainer(trainer, images, object_locations, 3, test_box_overlap(), 0, 3) == res);
 
         {
             ostringstream sout;
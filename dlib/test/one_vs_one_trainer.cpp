@@ -6,6 +6,7 @@
 #include <dlib/statistics.h>
 #include <vector>
 #include <sstream>
+#include <algorithm>
 
 namespace  
 {
@@ -194,9 +195,180 @@ namespace
 
         }
 
+        template <typename scalar_type>
+        void test_shared_kernel_cache (
+        )
+        {
+            print_spinner();
+            typedef matrix<scalar_type,2,1> sample_type;
+            typedef radial_basis_kernel<sample_type> rbf_kernel;
+
+            std::vector<sample_type> samples;
+            std::vector<double> labels;
+            generate_data(samples, labels);
+
+            // First check that the cache gives the same values as the kernel itself.
+            {
+                const rbf_kernel kern(0.1);
+                kernel_cache<rbf_kernel> cache(kern, samples, samples.size()*samples.size()*sizeof(float));
+                const matrix<scalar_type> K = kernel_matrix(kern, samples);
+                std::vector<unsigned long> idx;
+                for (unsigned long i = 0; i < samples.size(); i += 3)
+                    idx.push_back(i);
+                const matrix<scalar_type> Ksub = cached_kernel_matrix(cache, idx);
+                DLIB_TEST(Ksub.nr() == (long)idx.size());
+                DLIB_TEST(Ksub.nc() == (long)idx.size());
+                for (long r = 0; r < Ksub.nr(); ++r)
+                {
+                    for (long c = 0; c < Ksub.nc(); ++c)
+                    {
+                        DLIB_TEST(std::abs(Ksub(r,c) - K(idx[r],idx[c])) < 1e-6);
+                    }
+                }
+                // Each needed column should have been computed exactly once.
+                DLIB_TEST_MSG(cache.get_num_column_evaluations() == idx.size(), cache.get_num_column_evaluations() << "  " << idx.size());
+                DLIB_TEST(cache.get_bytes_used() == idx.size()*samples.size()*sizeof(float));
+            }
+
+            // Now check the LRU behavior when the cache can only hold 3 columns.
+            {
+                const rbf_kernel kern(0.1);
+                kernel_cache<rbf_kernel> cache(kern, samples, 3*samples.size()*sizeof(float));
+                for (long i = 0; i < 5; ++i)
+                    cache.get_column(i);
+                DLIB_TEST(cache.get_bytes_used() == 3*samples.size()*sizeof(float));
+                DLIB_TEST(cache.get_num_column_evaluations() == 5);
+                // columns 2, 3, and 4 are still in the cache
+                cache.get_column(2);
+                DLIB_TEST(cache.get_num_column_evaluations() == 5);
+                // which makes 3 the least recently used column, so this evicts it.
+                cache.get_column(0);
+                DLIB_TEST(cache.get_num_column_evaluations() == 6);
+                cache.get_column(4);
+                cache.get_column(2);
+                DLIB_TEST(cache.get_num_column_evaluations() == 6);
+                cache.get_column(3);
+                DLIB_TEST(cache.get_num_column_evaluations() == 7);
+                DLIB_TEST(std::abs(cache(7,3) - kern(samples[7],samples[3])) < 1e-6);
+                DLIB_TEST(std::abs(cache(3,3) - kern(samples[3],samples[3])) < 1e-6);
+            }
+
+            // When the samples are split into groups, a subset that only touches some of
+            // the groups should only cause the rows of those groups to be computed.
+            {
+                const rbf_kernel kern(0.1);
+                const std::vector<double> distinct = select_all_distinct_labels(labels);
+                DLIB_TEST(distinct.size() >= 3);
+                std::vector<unsigned long> groups(labels.size());
+                for (unsigned long i = 0; i < labels.size(); ++i)
+                    groups[i] = std::find(distinct.begin(), distinct.end(), labels[i]) - distinct.begin();
+
+                kernel_cache<rbf_kernel> cache(kern, samples, groups, samples.size()*samples.size()*sizeof(float));
+                DLIB_TEST(cache.num_groups() == distinct.size());
+                const matrix<scalar_type> K = kernel_matrix(kern, samples);
+
+                // the indices of the samples in the first two classes
+                std::vector<unsigned long> idx01, idx02;
+                for (unsigned long i = 0; i < samples.size(); ++i)
+                {
+                    if (groups[i] == 0 || groups[i] == 1)
+                        idx01.push_back(i);
+                    if (groups[i] == 0 || groups[i] == 2)
+                        idx02.push_back(i);
+                }
+
+                const matrix<scalar_type> K01 = cached_kernel_matrix(cache, idx01);
+                for (long r = 0; r < K01.nr(); ++r)
+                {
+                    for (long c = 0; c < K01.nc(); ++c)
+                    {
+                        DLIB_TEST(std::abs(K01(r,c) - K(idx01[r],idx01[c])) < 1e-6);
+                    }
+                }
+                // Each column needs one block for each of the two classes, and only the
+                // rows of those two classes get evaluated.
+                DLIB_TEST(cache.get_num_column_evaluations() == 2*idx01.size());
+                DLIB_TEST(cache.get_num_kernel_evaluations() == idx01.size()*idx01.size());
+                DLIB_TEST(cache.get_bytes_used() == idx01.size()*idx01.size()*sizeof(float));
+
+                // The blocks between samples of class 0 are reused by the next pair.
+                unsigned long num0 = 0;
+                for (unsigned long i = 0; i < groups.size(); ++i)
+                    num0 += (groups[i] == 0);
+                const unsigned long evals = cache.get_num_kernel_evaluations();
+                const matrix<scalar_type> K02 = cached_kernel_matrix(cache, idx02);
+                for (long r = 0; r < K02.nr(); ++r)
+                {
+                    for (long c = 0; c < K02.nc(); ++c)
+                    {
+                        DLIB_TEST(std::abs(K02(r,c) - K(idx02[r],idx02[c])) < 1e-6);
+                    }
+                }
+                DLIB_TEST(cache.get_num_kernel_evaluations() - evals == idx02.size()*idx02.size() - num0*num0);
+
+                // Whole columns can still be pulled out of a grouped cache.
+                const std::shared_ptr<const typename kernel_cache<rbf_kernel>::column_type> col = cache.get_column(5);
+                DLIB_TEST(col->size() == (long)samples.size());
+                for (long r = 0; r < col->size(); ++r)
+                {
+                    DLIB_TEST(std::abs((*col)(r) - K(r,5)) < 1e-6);
+                    DLIB_TEST(std::abs(cache(r,5) - K(r,5)) < 1e-6);
+                    DLIB_TEST((*cache.get_column_block(5, cache.get_group(r)))(cache.get_position_in_group(r)) == (*col)(r));
+                }
+            }
+
+            typedef one_vs_one_trainer<any_trainer<sample_type,scalar_type>,double> ovo_trainer;
+            ovo_trainer trainer;
+            DLIB_TEST(trainer.uses_shared_kernel_cache() == false);
+
+            svm_c_trainer<rbf_kernel> c_trainer;
+            c_trainer.set_kernel(rbf_kernel(0.1));
+            c_trainer.set_c(10);
+            svm_nu_trainer<rbf_kernel> nu_trainer;
+            nu_trainer.set_kernel(rbf_kernel(0.1));
+            trainer.set_trainer(c_trainer);
+            trainer.set_trainer(nu_trainer, 1, 3);
+
+            one_vs_one_decision_function<ovo_trainer> df = trainer.train(samples, labels);
+
+            trainer.set_shared_kernel_cache(rbf_kernel(0.1), 1024*1024);
+            DLIB_TEST(trainer.uses_shared_kernel_cache() == true);
+            one_vs_one_decision_function<ovo_trainer> df_cached = trainer.train(samples, labels);
+
+            // A cache with a kernel that doesn't match the trainers' kernel shouldn't be
+            // used at all, and a tiny cache should still give the right answer.
+            trainer.set_shared_kernel_cache(rbf_kernel(0.5), 1024*1024);
+            one_vs_one_decision_function<ovo_trainer> df_mismatch = trainer.train(samples, labels);
+            trainer.set_shared_kernel_cache(rbf_kernel(0.1), 1);
+            one_vs_one_decision_function<ovo_trainer> df_tiny = trainer.train(samples, labels);
+
+            trainer.disable_shared_kernel_cache();
+            DLIB_TEST(trainer.uses_shared_kernel_cache() == false);
+
+            const matrix<double> res = test_multiclass_decision_function(df, samples, labels);
+            DLIB_TEST(res == test_multiclass_decision_function(df_cached, samples, labels));
+            DLIB_TEST(res == test_multiclass_decision_function(df_mismatch, samples, labels));
+            DLIB_TEST(res == test_multiclass_decision_function(df_tiny, samples, labels));
+            DLIB_TEST_MSG(sum(diag(res)) == samples.size(), res);
+
+            typename ovo_trainer::trained_function_type::binary_function_table dfs = df.get_binary_decision_functions();
+            typename ovo_trainer::trained_function_type::binary_function_table dfs_cached = df_cached.get_binary_decision_functions();
+            for (unsigned long i = 0; i < samples.size(); ++i)
+            {
+                for (auto& item : dfs)
+                {
+                    DLIB_TEST(std::abs(item.second(samples[i]) - dfs_cached[item.first](samples[i])) < 1e-4);
+                }
+            }
+        }
+
         void perform_test (
         )
         {
+            dlog << LINFO << "test_shared_kernel_cache()";
+            test_shared_kernel_cache<double>();
+            test_shared_kernel_cache<float>();
+
             dlog << LINFO << "run_test<double,double>()";
             run_test<double,double>();
 
@@ -1202,6 +1202,53 @@ namespace
 
     }
 
+// ----------------------------------------------------------------------------------------
+
+    void test_parallel_and_batched_derivatives()
+    {
+        print_spinner();
+        thread_pool tp(3);
+
+        auto f = [](const matrix<double,0,1>& x) { return sum(squared(x-2)) + std::sin(x(0))*x(1); };
+        auto f_item = [](double scale, const matrix<double,0,1>& x) { return scale*sum(squared(x)); };
+        auto f_batch = [&f](const std::vector<matrix<double,0,1>>& points) 
+        {
+            std::vector<double> vals;
+            for (auto& p : points)
+                vals.push_back(f(p));
+            return vals;
+        };
+
+        dlib::rand rnd;
+        for (long n : {1, 2, 7, 50})
+        {
+            matrix<double,0,1> x = randm(n,1,rnd);
+            const matrix<double,0,1> g = derivative(f)(x);
+            // Both versions do the same arithmetic as central_differences so should give
+            // bit for bit the same answer.
+            DLIB_TEST(derivative(tp,f)(x) == g);
+            DLIB_TEST(batched_derivative(f_batch)(x) == g);
+            DLIB_TEST(derivative(tp,f_item,1e-5)(3.0,x) == derivative(f_item,1e-5)(3.0,x));
+        }
+
+        auto f1 = [](double x) { return std::sin(x); };
+        DLIB_TEST(derivative(tp,f1)(0.5) == derivative(f1)(0.5));
+
+        matrix<double,2,1> x, opt;
+        x = -1.2, 1;
+        opt = 1, 1;
+        double val = find_min_using_approximate_derivatives(tp, bfgs_search_strategy(),
+            objective_delta_stop_strategy(1e-13), rosen, x, -1, 1e-5);
+        DLIB_TEST_MSG(dlib::equal(x,opt, 1e-4),opt-x);
+        DLIB_TEST(std::abs(val - rosen(x)) < 1e-12);
+
+        x = -1.2, 1;
+        val = find_max_using_approximate_derivatives(tp, bfgs_search_strategy(),
+            objective_delta_stop_strategy(1e-13), neg_rosen, x, 1, 1e-5);
+        DLIB_TEST_MSG(dlib::equal(x,opt, 1e-4),opt-x);
+        DLIB_TEST(std::abs(val - neg_rosen(x)) < 1e-12);
+    }
+
 // ----------------------------------------------------------------------------------------
 
     class optimization_tester : public tester
@@ -1223,6 +1270,7 @@ namespace
             test_poly_min_extract_2nd();
             optimization_test();
             test_solve_trust_region_subproblem_bounded();
+            test_parallel_and_batched_derivatives();
         }
     } a;
 
@@ -5,6 +5,13 @@
 #include <dlib/threads.h>
 #include <vector>
 #include <sstream>
+#include <cmath>
+#include <stdexcept>
+#include <set>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
 
 namespace  
 {
@@ -298,6 +305,86 @@ namespace
         }
     }
 
+    void test_parallel_for_nested()
+    {
+        // Nested loops run inline on whatever worker picked up the outer iteration, so
+        // this must neither deadlock nor skip or repeat any (i,j) pair.
+        const long n = 37, m = 113;
+        std::vector<int> hits(n*m, 0);
+        parallel_for(4, 0, n, [&](long i) {
+            parallel_for(4, 0, m, [&](long j) { hits[i*m+j] += 1; });
+        });
+        for (auto h : hits)
+            DLIB_TEST(h == 1);
+
+        thread_pool tp(3);
+        std::vector<int> hits2(n*m, 0);
+        parallel_for_blocked(tp, 0, n, [&](long b, long e) {
+            for (long i = b; i < e; ++i)
+                parallel_for(tp, 0, m, [&](long j) { hits2[i*m+j] += 1; });
+        });
+        for (auto h : hits2)
+            DLIB_TEST(h == 1);
+
+        // A long cheap loop followed by a short expensive, irregular one.  The chunk
+        // sizes adapt in both cases but the subranges must still exactly cover the range.
+        std::vector<int> big(200000, 0);
+        parallel_for(4, 0, big.size(), [&](long i) { big[i] += 1; }, 1);
+        for (auto v : big)
+            DLIB_TEST(v == 1);
+
+        std::vector<double> irregular(300, 0);
+        parallel_for_blocked(4, 0, irregular.size(), [&](long b, long e) {
+            for (long i = b; i < e; ++i)
+            {
+                double v = 0;
+                for (long k = 0; k < (i%7)*2000; ++k)
+                    v += std::sqrt(k+1.0);
+                irregular[i] = v + 1;
+            }
+        });
+        for (auto v : irregular)
+            DLIB_TEST(v >= 1);
+
+        bool caught = false;
+        try
+        {
+            parallel_for(4, 0, 1000, [&](long i) { if (i == 500) throw std::runtime_error("boom"); });
+        }
+        catch (std::runtime_error& e)
+        {
+            caught = (std::string(e.what()) == "boom");
+        }
+        DLIB_TEST(caught);
+    }
+
+    void test_parallel_for_more_threads_than_pool()
+    {
+        // Ask for more threads than the default pool has.  parallel_for doesn't create
+        // threads, so only the pool's workers plus the calling thread should show up.
+        // Each chunk blocks until that many threads have arrived, so this also checks
+        // that all of them really run at once.  When the pool is empty everything runs
+        // serially in the calling thread.
+        const unsigned long pool_size = default_thread_pool().num_threads_in_pool();
+        const unsigned long num_threads = pool_size + 3;
+        const unsigned long expected = pool_size + 1;
+        std::mutex m;
+        std::condition_variable cv;
+        std::set<std::thread::id> ids;
+        bool all_arrived = true;
+        parallel_for_blocked(num_threads, 0, num_threads, [&](long, long) {
+            std::unique_lock<std::mutex> lock(m);
+            ids.insert(std::this_thread::get_id());
+            cv.notify_all();
+            if (!cv.wait_for(lock, std::chrono::seconds(20), [&]() { return ids.size() >= expected; }))
+                all_arrived = false;
+        }, 1);
+        DLIB_TEST(all_arrived);
+        DLIB_TEST_MSG(ids.size() == expected, ids.size() << "  " << expected);
+    }
+
+// ----------------------------------------------------------------------------------------
+
     class test_parallel_for_routines : public tester
     {
     public:
@@ -322,6 +409,8 @@ namespace
             test_parallel_for2(50);
 
             test_parallel_for_additional();
+            test_parallel_for_nested();
+            test_parallel_for_more_threads_than_pool();
         }
     };
 
@@ -122,6 +122,17 @@ namespace
         find_max_parse_cky(sequence, user_defined_ruleset<true>, parse_tree);
         DLIB_TEST(parse_tree.size() != 0);
 
+        // Filling the chart in parallel or with a beam that never prunes anything
+        // shouldn't change the result.
+        std::vector<parse_tree_element<tags> > parse_tree2;
+        find_max_parse_cky(sequence, user_defined_ruleset<true>, parse_tree2, 0, 3);
+        DLIB_TEST(parse_tree_to_string_tagged(parse_tree2, words) == parse_tree_to_string_tagged(parse_tree, words));
+        find_max_parse_cky(sequence, user_defined_ruleset<true>, parse_tree2, 10, 2);
+        DLIB_TEST(parse_tree_to_string_tagged(parse_tree2, words) == parse_tree_to_string_tagged(parse_tree, words));
+        // A beam of 1 may prune away the best parse but can never find a better one.
+        find_max_parse_cky(sequence, user_defined_ruleset<true>, parse_tree2, 1);
+        DLIB_TEST(parse_tree2.size() == 0 || parse_tree2[0].score <= parse_tree[0].score);
+
         const std::string str1 = "[[[The flight] [includes [a meal]]] [[The flight] [includes [a meal]]]]";
         const std::string str2 = "[7 [5 [3 The flight] [4 includes [3 a meal]]] [5 [3 The flight] [4 includes [3 a meal]]]]";
         dlog << LINFO << parse_tree_to_string(parse_tree, words);
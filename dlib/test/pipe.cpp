@@ -6,6 +6,11 @@
 #include <string>
 #include <cstdlib>
 #include <ctime>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <atomic>
+#include <vector>
 #include <dlib/misc_api.h>
 #include <dlib/pipe.h>
 
@@ -665,6 +670,262 @@ namespace
 
 
 
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename pipe
+        >
+    void lockfree_pipe_test (
+        unsigned long num_consumers
+    )
+    /*!
+        requires
+            - pipe is spsc_pipe<int> or mpmc_pipe<int>
+        ensures
+            - runs tests on pipe for compliance with the specs, using num_consumers
+              threads to dequeue concurrently.
+    !*/
+    {
+        using namespace pipe_kernel_test_helpers;
+        found_error = false;
+
+        print_spinner();
+        pipe test(10), test2(100);
+        DLIB_TEST(test.max_size() == 10);
+        DLIB_TEST(test.size() == 0);
+        DLIB_TEST(test.is_enabled() == true);
+        DLIB_TEST(test.is_enqueue_enabled() == true);
+        DLIB_TEST(test.is_dequeue_enabled() == true);
+
+        int a = 3;
+        DLIB_TEST(test.enqueue(a));
+        a = 5;
+        DLIB_TEST(test.enqueue(a));
+        DLIB_TEST(test.size() == 2);
+        DLIB_TEST(test.dequeue(a) && a == 3);
+        DLIB_TEST(test.dequeue(a) && a == 5);
+        DLIB_TEST(test.size() == 0);
+
+        DLIB_TEST(test.dequeue_or_timeout(a, 0) == false);
+        DLIB_TEST(test.dequeue_or_timeout(a, 10) == false);
+        DLIB_TEST(a == 5);
+        for (int i = 0; i < 10; ++i)
+        {
+            a = i;
+            DLIB_TEST(test.enqueue_or_timeout(a, 0));
+        }
+        a = 42;
+        DLIB_TEST(test.enqueue_or_timeout(a, 10) == false);
+        DLIB_TEST(a == 42);
+        DLIB_TEST(test.size() == 10);
+        test.empty();
+        DLIB_TEST(test.size() == 0);
+        test.wait_until_empty();
+        test.wait_for_num_blocked_dequeues(0);
+
+        pipe test_1(1);
+        for (int i = 0; i < 5; ++i)
+        {
+            a = i;
+            DLIB_TEST(test_1.enqueue(a));
+            a = -1;
+            DLIB_TEST(test_1.enqueue_or_timeout(a, 0) == false);
+            DLIB_TEST(test_1.size() == 1);
+            DLIB_TEST(test_1.dequeue(a) && a == i);
+            DLIB_TEST(test_1.dequeue_or_timeout(a, 0) == false);
+        }
+
+        test.disable();
+        DLIB_TEST(test.enqueue(a) == false);
+        DLIB_TEST(test.dequeue(a) == false);
+        test.enable();
+        test.disable_dequeue();
+        DLIB_TEST(test.dequeue_or_timeout(a, 1000) == false);
+        test.enable_dequeue();
+
+        // In order delivery through a pipe that is much smaller than the stream.
+        create_new_thread(&threadproc1<pipe>,&test);
+        for (unsigned long i = 0; i < proc1_count; ++i)
+        {
+            a = i;
+            DLIB_TEST(test.enqueue(a));
+        }
+        wait_for_threads();
+        test.disable_enqueue();
+        DLIB_TEST(test.enqueue(a) == false);
+
+        print_spinner();
+        for (unsigned long i = 0; i < num_consumers; ++i)
+            create_new_thread(&threadproc2<pipe>,&test2);
+        for (unsigned long i = 0; i < 100000; ++i)
+        {
+            a = i;
+            if (i%2 == 0)
+                DLIB_TEST(test2.enqueue(a));
+            else
+                DLIB_TEST(test2.enqueue_or_timeout(a,100000));
+        }
+        test2.wait_for_num_blocked_dequeues(num_consumers);
+        DLIB_TEST(test2.size() == 0);
+        test2.disable();
+        wait_for_threads();
+
+        // The destructor has to release threads that are blocked in dequeue().
+        test2.enable();
+        pipe* p = new pipe(4);
+        for (unsigned long i = 0; i < num_consumers; ++i)
+            create_new_thread(&threadproc2<pipe>,p);
+        p->wait_for_num_blocked_dequeues(num_consumers);
+        delete p;
+        wait_for_threads();
+
+        DLIB_TEST(found_error == false);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename push_funct,
+        typename pop_funct
+        >
+    void check_many_producers_and_consumers (
+        unsigned long num_producers,
+        unsigned long num_consumers,
+        const push_funct& push,
+        const pop_funct& pop
+    )
+    /*!
+        ensures
+            - Runs num_producers threads that each push items_per_producer distinct
+              values with push(int&) and num_consumers threads that pop them with
+              pop(int&).  Both return false if they gave up waiting, in which case they
+              are called again.  Then checks that every value was delivered exactly once
+              and that each consumer saw the values from any one producer in the order
+              they were pushed.
+            - Everybody gives up after a generous deadline so that a broken pipe makes
+              the test fail rather than hang.
+    !*/
+    {
+        print_spinner();
+        const long items_per_producer = 20000;
+        const long total = items_per_producer*num_producers;
+        std::vector<std::atomic<int> > times_seen(total);
+        for (auto& t : times_seen)
+            t = 0;
+        std::atomic<long> num_popped(0);
+        std::atomic<bool> out_of_order(false);
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::minutes(2);
+        auto timed_out = [&]() { return std::chrono::steady_clock::now() > deadline; };
+
+        std::vector<std::thread> threads;
+        for (unsigned long p = 0; p < num_producers; ++p)
+        {
+            threads.emplace_back([&, p]() {
+                for (long k = 0; k < items_per_producer; ++k)
+                {
+                    int val = p*items_per_producer + k;
+                    while (!push(val))
+                    {
+                        if (timed_out())
+                            return;
+                    }
+                }
+            });
+        }
+        for (unsigned long c = 0; c < num_consumers; ++c)
+        {
+            threads.emplace_back([&]() {
+                std::vector<long> last(num_producers, -1);
+                while (num_popped < total && !timed_out())
+                {
+                    int val;
+                    if (!pop(val))
+                        continue;
+                    ++num_popped;
+                    ++times_seen[val];
+                    const long p = val/items_per_producer;
+                    const long k = val%items_per_producer;
+                    if (k <= last[p])
+                        out_of_order = true;
+                    last[p] = k;
+                }
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+
+        DLIB_TEST(num_popped == total);
+        DLIB_TEST(out_of_order == false);
+        long num_bad = 0;
+        for (auto& t : times_seen)
+        {
+            if (t != 1)
+                ++num_bad;
+        }
+        DLIB_TEST_MSG(num_bad == 0, num_bad);
+    }
+
+    void mpmc_many_producers_test (
+        unsigned long max_size,
+        unsigned long num_producers,
+        unsigned long num_consumers
+    )
+    {
+        // First the ring on its own, so the producers race each other in the
+        // claim/publish path without any blocking to space them out.
+        impl::mpmc_ring<int> ring(max_size);
+        check_many_producers_and_consumers(num_producers, num_consumers,
+            [&](int& val) { if (ring.try_push(val)) return true; std::this_thread::yield(); return false; },
+            [&](int& val) { if (ring.try_pop(val)) return true; std::this_thread::yield(); return false; });
+        DLIB_TEST(ring.size() == 0);
+
+        // Then through the full pipe, where threads also block and wake each other.
+        mpmc_pipe<int> p(max_size);
+        check_many_producers_and_consumers(num_producers, num_consumers,
+            [&](int& val) { return p.enqueue_or_timeout(val, 10); },
+            [&](int& val) { return p.dequeue_or_timeout(val, 10); });
+        DLIB_TEST(p.size() == 0);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename pipe
+        >
+    double items_per_second_through_pipe (
+        unsigned long num_items
+    )
+    {
+        pipe p(256);
+        std::thread consumer([&]() {
+            int val;
+            for (unsigned long i = 0; i < num_items; ++i)
+                p.dequeue(val);
+        });
+
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned long i = 0; i < num_items; ++i)
+        {
+            int val = i;
+            p.enqueue(val);
+        }
+        consumer.join();
+        const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+        return num_items/std::max(secs, 1e-9);
+    }
+
+    void pipe_throughput_benchmark (
+    )
+    {
+        print_spinner();
+        const unsigned long num_items = 300000;
+        dlog << LINFO << "pipe items/sec:      " << items_per_second_through_pipe<dlib::pipe<int> >(num_items);
+        dlog << LINFO << "spsc_pipe items/sec: " << items_per_second_through_pipe<dlib::spsc_pipe<int> >(num_items);
+        dlog << LINFO << "mpmc_pipe items/sec: " << items_per_second_through_pipe<dlib::mpmc_pipe<int> >(num_items);
+    }
+
+// ----------------------------------------------------------------------------------------
+
     class pipe_tester : public tester
     {
     public:
@@ -680,6 +941,15 @@ namespace
             pipe_kernel_test<dlib::pipe<int> >();
 
             do_zero_size_test_with_timeouts();
+
+            lockfree_pipe_test<dlib::spsc_pipe<int> >(1);
+            lockfree_pipe_test<dlib::mpmc_pipe<int> >(1);
+            lockfree_pipe_test<dlib::mpmc_pipe<int> >(3);
+            mpmc_many_producers_test(1, 4, 3);
+            mpmc_many_producers_test(7, 8, 4);
+            mpmc_many_producers_test(64, 3, 5);
+
+            pipe_throughput_benchmark();
         }
     } a;
 
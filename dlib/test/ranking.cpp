@@ -404,6 +404,46 @@ namespace
         DLIB_TEST(std::abs(abs(df.b - df2.b)) < 1e-8);
     }
 
+// ----------------------------------------------------------------------------------------
+
+    void test_svmrank_threaded()
+    {
+        print_spinner();
+        dlog << LINFO << "in test_svmrank_threaded()";
+
+        typedef matrix<double,10,1> sample_type;
+        typedef linear_kernel<sample_type> kernel_type;
+
+        dlib::rand rnd;
+        std::vector<ranking_pair<sample_type> > samples;
+        for (int i = 0; i < 50; ++i)
+        {
+            ranking_pair<sample_type> pair;
+            for (int j = 0; j < 10; ++j)
+            {
+                sample_type samp = gaussian_randm(10,1,rnd.get_random_32bit_number());
+                samp(0) += 1;
+                pair.relevant.push_back(samp);
+                samp = gaussian_randm(10,1,rnd.get_random_32bit_number());
+                pair.nonrelevant.push_back(samp);
+            }
+            samples.push_back(pair);
+        }
+
+        svm_rank_trainer<kernel_type> trainer;
+        trainer.set_epsilon(1e-9);
+        DLIB_TEST(trainer.get_num_threads() == 1);
+        decision_function<kernel_type> df = trainer.train(samples);
+
+        trainer.set_num_threads(4);
+        DLIB_TEST(trainer.get_num_threads() == 4);
+        decision_function<kernel_type> df2 = trainer.train(samples);
+
+        dlog << LINFO << "w error: " << max(abs(df.basis_vectors(0) - df2.basis_vectors(0)));
+        DLIB_TEST(max(abs(df.basis_vectors(0) - df2.basis_vectors(0))) < 1e-6);
+        DLIB_TEST(equal(test_ranking_function(df, samples), test_ranking_function(df2, samples)));
+    }
+
 // ----------------------------------------------------------------------------------------
 
     void test_dnn_ranking_loss()
@@ -472,6 +512,7 @@ namespace
             test_svmrank_weight_force_dense<false>();
             run_prior_test();
             run_prior_sparse_test();
+            test_svmrank_threaded();
             test_dnn_ranking_loss();
 
         }
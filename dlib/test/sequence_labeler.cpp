@@ -318,6 +318,7 @@ namespace
         DLIB_TEST(trainer.get_c() == 4);
         trainer.set_num_threads(4);
         DLIB_TEST(trainer.get_num_threads() == 4);
+        DLIB_TEST(trainer.get_beam_width() == 0);
 
 
 
@@ -358,6 +359,18 @@ namespace
         dlog << LINFO << "label accuracy: "<< accuracy;
         DLIB_TEST(std::abs(accuracy - 0.882) < 0.01);
 
+        // A beam holding every label gives the same answers as the exact Viterbi
+        // search while a narrower beam still gives sensible labelings.
+        DLIB_TEST(labeler_true.get_beam_width() == 0);
+        labeler_true.set_beam_width(num_label_states);
+        DLIB_TEST(labeler_true.get_beam_width() == num_label_states);
+        DLIB_TEST(test_sequence_labeler(labeler_true, samples, labels) == confusion_matrix);
+        labeler_true.set_beam_width(2);
+        confusion_matrix = test_sequence_labeler(labeler_true, samples, labels);
+        accuracy = sum(diag(confusion_matrix))/sum(confusion_matrix);
+        dlog << LINFO << "label accuracy with beam width 2: "<< accuracy;
+        DLIB_TEST(accuracy > 0.8);
+
 
 
         print_spinner();
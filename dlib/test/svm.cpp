@@ -253,6 +253,8 @@ namespace
         cv = cross_validate_regression_trainer(svr_test, samples, labels, 6);
         DLIB_TEST(cv(0) < 1e-4);
         DLIB_TEST(cv(1) > 0.99);
+        // Running the folds in parallel shouldn't change the results at all.
+        DLIB_TEST(cross_validate_regression_trainer(svr_test, samples, labels, 6, 3) == cv);
 
 
 
@@ -633,6 +635,69 @@ namespace
 
     }
 
+// ----------------------------------------------------------------------------------------
+
+    template <typename function_type>
+    void check_batch_evaluate (
+        const function_type& df,
+        const std::vector<typename function_type::sample_type>& samples
+    )
+    {
+        matrix<double,0,1> truth(samples.size());
+        for (unsigned long i = 0; i < samples.size(); ++i)
+            truth(i) = df(samples[i]);
+
+        const matrix<double,0,1> out1 = batch_evaluate(df, samples);
+        const matrix<double,0,1> out4 = batch_evaluate(df, samples, 4);
+        dlog << LINFO << "batch_evaluate error: " << max(abs(out1-truth));
+        DLIB_TEST(out1.size() == truth.size());
+        DLIB_TEST(max(abs(out1-truth)) < 1e-9);
+        DLIB_TEST(out1 == out4);
+    }
+
+    void test_batch_evaluate()
+    {
+        typedef matrix<double,0,1> sample_type;
+        dlib::rand rnd;
+
+        std::vector<sample_type> basis, samples;
+        for (int i = 0; i < 50; ++i)
+            basis.push_back(sample_type(randm(7,1,rnd)));
+        // make a few samples identical to basis vectors to exercise the zero distance
+        // case of the RBF kernel.
+        for (int i = 0; i < 1000; ++i)
+            samples.push_back(i%100 == 0 ? basis[i/100] : sample_type(randm(7,1,rnd)));
+
+        matrix<double,0,1> alpha = randm(basis.size(),1,rnd) - 0.5;
+
+        check_batch_evaluate(decision_function<radial_basis_kernel<sample_type> >(
+                alpha, 0.3, radial_basis_kernel<sample_type>(0.7), mat(basis)), samples);
+        check_batch_evaluate(decision_function<linear_kernel<sample_type> >(
+                alpha, 0.3, linear_kernel<sample_type>(), mat(basis)), samples);
+        check_batch_evaluate(decision_function<polynomial_kernel<sample_type> >(
+                alpha, 0.3, polynomial_kernel<sample_type>(0.5, 1, 3), mat(basis)), samples);
+        check_batch_evaluate(decision_function<sigmoid_kernel<sample_type> >(
+                alpha, 0.3, sigmoid_kernel<sample_type>(0.5, -1), mat(basis)), samples);
+        // a kernel that doesn't have a specialized implementation
+        check_batch_evaluate(decision_function<histogram_intersection_kernel<sample_type> >(
+                alpha, 0.3, histogram_intersection_kernel<sample_type>(), mat(basis)), samples);
+
+        // normalized functions should normalize first and then use the fast path
+        vector_normalizer<sample_type> normalizer;
+        normalizer.train(samples);
+        normalized_function<decision_function<radial_basis_kernel<sample_type> > > nf;
+        nf.normalizer = normalizer;
+        nf.function = decision_function<radial_basis_kernel<sample_type> >(
+                alpha, 0.3, radial_basis_kernel<sample_type>(0.7), mat(basis));
+        check_batch_evaluate(nf, samples);
+
+        // an empty decision function just returns -b
+        decision_function<radial_basis_kernel<sample_type> > empty;
+        empty.b = 2;
+        DLIB_TEST(batch_evaluate(empty, samples) == uniform_matrix<double>(samples.size(),1,-2));
+        DLIB_TEST(batch_evaluate(empty, std::vector<sample_type>()).size() == 0);
+    }
+
 // ----------------------------------------------------------------------------------------
 
     class svm_tester : public tester
@@ -653,6 +718,7 @@ namespace
             test_regression();
             test_anomaly_detection();
             test_svm_trainer2();
+            test_batch_evaluate();
         }
     } a;
 
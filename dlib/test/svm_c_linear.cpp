@@ -276,6 +276,56 @@ namespace
         DLIB_TEST(abs(df(samples[3]) - (1)) < 1e-6);
     }
 
+// ----------------------------------------------------------------------------------------
+
+    void test_threaded (
+    )
+    {
+        print_spinner();
+        dlog << LINFO << "test with multiple threads";
+        std::vector<sample_type> samples;
+        std::vector<double> labels;
+
+        dlib::rand rnd;
+        for (int i = 0; i < 1000; ++i)
+        {
+            const double label = (i%2) ? +1 : -1;
+            samples.push_back(randm(10,1,rnd) + label*0.3);
+            labels.push_back(label);
+        }
+
+        svm_c_linear_trainer<linear_kernel<sample_type> > trainer;
+        trainer.set_c(10);
+        trainer.set_epsilon(1e-9);
+        DLIB_TEST(trainer.get_num_threads() == 1);
+
+        double obj, obj2;
+        decision_function<linear_kernel<sample_type> > df = trainer.train(samples, labels, obj);
+        trainer.set_num_threads(4);
+        DLIB_TEST(trainer.get_num_threads() == 4);
+        decision_function<linear_kernel<sample_type> > df2 = trainer.train(samples, labels, obj2);
+
+        dlog << LDEBUG << "obj:  "<< obj;
+        dlog << LDEBUG << "obj2: "<< obj2;
+        DLIB_TEST_MSG(abs(obj - obj2) < 1e-6*obj, abs(obj - obj2));
+        DLIB_TEST_MSG(max(abs(df.basis_vectors(0) - df2.basis_vectors(0))) < 1e-4, 
+                      max(abs(df.basis_vectors(0) - df2.basis_vectors(0))));
+        DLIB_TEST(abs(df.b - df2.b) < 1e-4);
+
+        // the threaded risk evaluation should also work with sparse vectors
+        std::vector<sparse_sample_type> sparse_samples;
+        sparse_samples.resize(samples.size());
+        for (unsigned long i = 0; i < samples.size(); ++i)
+            assign(sparse_samples[i], samples[i]);
+        svm_c_linear_trainer<sparse_linear_kernel<sparse_sample_type> > sparse_trainer;
+        sparse_trainer.set_c(10);
+        sparse_trainer.set_epsilon(1e-9);
+        sparse_trainer.set_num_threads(3);
+        decision_function<sparse_linear_kernel<sparse_sample_type> > df3 = sparse_trainer.train(sparse_samples, labels, obj2);
+        DLIB_TEST_MSG(abs(obj - obj2) < 1e-6*obj, abs(obj - obj2));
+        DLIB_TEST(abs(df.b - df3.b) < 1e-4);
+    }
+
 // ----------------------------------------------------------------------------------------
 
     class tester_svm_c_linear : public tester
@@ -294,6 +344,7 @@ namespace
             test_sparse();
             run_prior_test();
             run_prior_sparse_test();
+            test_threaded();
 
             // test mixed sparse and dense dot products
             {
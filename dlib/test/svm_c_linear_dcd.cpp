@@ -499,6 +499,135 @@ namespace
         DLIB_TEST(df(sample) < 0);
     }
 
+// ----------------------------------------------------------------------------------------
+
+    template <typename kernel_type>
+    double dcd_objective (
+        const decision_function<kernel_type>& df,
+        const std::vector<typename kernel_type::sample_type>& samples,
+        const std::vector<double>& labels,
+        double C
+    )
+    {
+        double obj = 0.5*(dot(df.basis_vectors(0), df.basis_vectors(0)) + df.b*df.b);
+        for (unsigned long i = 0; i < samples.size(); ++i)
+            obj += C*std::max(0.0, 1 - labels[i]*df(samples[i]));
+        return obj;
+    }
+
+    void test_initial_alpha ()
+    {
+        typedef matrix<double,10,1> sample_type;
+        typedef linear_kernel<sample_type> kernel_type;
+
+        std::vector<sample_type> samples;
+        std::vector<double> labels;
+        dlib::rand rnd;
+        for (int i = 0; i < 200; ++i)
+        {
+            const double label = (i%2 == 0) ? +1 : -1;
+            sample_type samp = matrix_cast<double>(randm(10,1,rnd)) - 0.5;
+            samp(0) += 0.3*label;
+            samples.push_back(samp);
+            labels.push_back(label);
+        }
+
+        svm_c_linear_dcd_trainer<kernel_type> trainer;
+        trainer.set_c(10);
+        trainer.set_epsilon(1e-10);
+        svm_c_linear_dcd_trainer<kernel_type>::optimizer_state state;
+        const decision_function<kernel_type> df = trainer.train(samples, labels, state);
+
+        // Starting from the optimal alphas of the same problem should give the same
+        // solution, and starting from alphas for only some of the samples, or from
+        // alphas that are too big, should still converge to it.
+        std::vector<double> alpha = state.get_alpha();
+        svm_c_linear_dcd_trainer<kernel_type>::optimizer_state state2(alpha);
+        DLIB_TEST(state2.get_alpha() == alpha);
+        decision_function<kernel_type> df2 = trainer.train(samples, labels, state2);
+        DLIB_TEST(max(abs(df.basis_vectors(0) - df2.basis_vectors(0))) < 1e-6);
+        DLIB_TEST(std::abs(df.b - df2.b) < 1e-6);
+
+        alpha.resize(100);
+        for (auto& a : alpha)
+            a += 100;
+        svm_c_linear_dcd_trainer<kernel_type>::optimizer_state state3(alpha);
+        df2 = trainer.train(samples, labels, state3);
+        DLIB_TEST(state3.get_alpha().size() == samples.size());
+        DLIB_TEST(max(abs(df.basis_vectors(0) - df2.basis_vectors(0))) < 1e-6);
+        DLIB_TEST(std::abs(df.b - df2.b) < 1e-6);
+        for (auto& a : state3.get_alpha())
+            DLIB_TEST(0 <= a && a <= 10);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_threaded ()
+    {
+        print_spinner();
+        typedef std::map<unsigned long,double> sample_type;
+        typedef sparse_linear_kernel<sample_type> kernel_type;
+
+        std::vector<sample_type> samples;
+        std::vector<double> labels;
+
+        dlib::rand rnd;
+        sample_type sample;
+        double label = +1;
+        for (int i = 0; i < 2000; ++i)
+        {
+            label *= -1;
+            sample.clear();
+            for (int j = 0; j < 10; ++j)
+            {
+                int idx = rnd.get_random_32bit_number()%100;
+                sample[idx] = label*rnd.get_random_double() + rnd.get_random_gaussian();
+            }
+            samples.push_back(sample);
+            labels.push_back(label);
+        }
+
+        const double C = 0.1;
+        svm_c_linear_dcd_trainer<kernel_type> trainer;
+        trainer.set_c(C);
+        trainer.set_epsilon(1e-6);
+        DLIB_TEST(trainer.get_num_threads() == 1);
+
+        decision_function<kernel_type> df = trainer.train(samples, labels);
+
+        trainer.set_num_threads(4);
+        DLIB_TEST(trainer.get_num_threads() == 4);
+        decision_function<kernel_type> df2 = trainer.train(samples, labels);
+
+        const double obj = dcd_objective(df, samples, labels, C);
+        const double obj2 = dcd_objective(df2, samples, labels, C);
+        dlog << LINFO << "serial objective:   " << obj;
+        dlog << LINFO << "threaded objective: " << obj2;
+        DLIB_TEST_MSG(std::abs(obj - obj2) < 1e-4*obj, obj << " " << obj2);
+        DLIB_TEST(std::abs(df.b - df2.b) < 1e-2);
+
+        // The threaded solver should also be able to warm start from a partial
+        // solution and pick up new samples appended to the training set.
+        print_spinner();
+        svm_c_linear_dcd_trainer<kernel_type>::optimizer_state state;
+        std::vector<sample_type> samples_half(samples.begin(), samples.begin()+1000);
+        std::vector<double> labels_half(labels.begin(), labels.begin()+1000);
+        trainer.train(samples_half, labels_half, state);
+        df2 = trainer.train(samples, labels, state);
+        DLIB_TEST(state.get_alpha().size() == samples.size());
+        const double obj3 = dcd_objective(df2, samples, labels, C);
+        dlog << LINFO << "warm started threaded objective: " << obj3;
+        DLIB_TEST_MSG(std::abs(obj - obj3) < 1e-4*obj, obj << " " << obj3);
+
+        // warm starting the serial solver from the threaded solution shouldn't change
+        // anything.
+        trainer.set_num_threads(1);
+        decision_function<kernel_type> df3 = trainer.train(samples, labels, state);
+        DLIB_TEST(std::abs(dcd_objective(df3, samples, labels, C) - obj3) < 1e-4*obj);
+    }
+
+// ----------------------------------------------------------------------------------------
+
     class tester_svm_c_linear_dcd : public tester
     {
     public:
@@ -535,6 +664,8 @@ namespace
             print_spinner();
 
             test_l2_version();
+            test_initial_alpha();
+            test_threaded();
         }
     } a;
 
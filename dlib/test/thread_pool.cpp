@@ -403,6 +403,45 @@ namespace
                 DLIB_TEST(got_exception);
 
             }
+
+            test_many_tasks();
+        }
+
+        void test_many_tasks (
+        )
+        {
+            print_spinner();
+            for (int num_threads = 0; num_threads < 4; ++num_threads)
+            {
+                thread_pool tp(num_threads);
+
+                // Submit many more tasks than there are threads.
+                std::vector<long> vals(1000, 0);
+                for (unsigned long i = 0; i < vals.size(); ++i)
+                    tp.add_task_by_value([&vals,i](){ vals[i] = i; });
+                tp.wait_for_all_tasks();
+                for (unsigned long i = 0; i < vals.size(); ++i)
+                    DLIB_TEST(vals[i] == (long)i);
+
+                // Tasks which submit tasks of their own and wait on them must not
+                // deadlock the pool.
+                std::vector<long> counts(20, 0);
+                for (unsigned long i = 0; i < counts.size(); ++i)
+                {
+                    tp.add_task_by_value([&tp,&counts,i]() 
+                    {
+                        std::vector<long> sub(10, 0);
+                        for (unsigned long j = 0; j < sub.size(); ++j)
+                            tp.add_task_by_value([&sub,j](){ sub[j] = 1; });
+                        tp.wait_for_all_tasks();
+                        for (unsigned long j = 0; j < sub.size(); ++j)
+                            counts[i] += sub[j];
+                    });
+                }
+                tp.wait_for_all_tasks();
+                for (unsigned long i = 0; i < counts.size(); ++i)
+                    DLIB_TEST(counts[i] == 10);
+            }
         }
 
         long val;
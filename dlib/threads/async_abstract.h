@@ -20,6 +20,12 @@ namespace dlib
               environment variable is set to an integer then the thread pool will contain
               DLIB_NUM_THREADS threads, otherwise it will contain
               std::thread::hardware_concurrency() threads.
+            - The size of this pool is fixed when it is first used.  It is also the pool
+              the parallel_for() family of functions borrows its workers from when given
+              a number of threads rather than a thread_pool.  Those calls never create
+              threads of their own, so they are capped at num_threads_in_pool()+1
+              threads (counting the calling thread) no matter what number of threads
+              they are asked to use.
     !*/
 
 // ----------------------------------------------------------------------------------------
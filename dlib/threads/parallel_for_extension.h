@@ -7,6 +7,13 @@
 #include "thread_pool_extension.h"
 #include "../console_progress_indicator.h"
 #include "async.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
 
 namespace dlib
 {
@@ -69,6 +76,153 @@ namespace dlib
                 funct(begin, end);
             }
         };
+
+    // ------------------------------------------------------------------------------------
+
+        struct parallel_for_state
+        {
+            parallel_for_state (
+                long begin_,
+                long end_,
+                long first_block_,
+                long num_runners_
+            ) : begin(begin_), end(end_), first_block(first_block_), num_runners(num_runners_),
+                next(begin_), done(0), failed(false)
+            {}
+
+            const long begin;
+            const long end;
+            const long first_block;
+            const long num_runners;
+
+            std::atomic<long> next;
+            std::atomic<long> done;
+            std::atomic<bool> failed;
+
+            std::mutex m;
+            std::condition_variable all_done;
+            std::exception_ptr eptr;
+        };
+
+        template <typename F>
+        void run_parallel_for_chunks (
+            parallel_for_state& s,
+            const F& funct
+        )
+        /*!
+            ensures
+                - Repeatedly claims a chunk of [s.begin, s.end) and calls funct on it until
+                  there is nothing left to claim.  The first chunk has s.first_block
+                  elements.  After that the chunk size is picked from how long the previous
+                  chunk took, so that a chunk runs for about target_seconds, but it is never
+                  larger than an even share of what remains.  So cheap loop bodies get big
+                  chunks and little scheduling overhead while expensive or irregular ones
+                  get small chunks and good load balance.
+                - If funct throws then the exception is recorded in s.eptr and the
+                  remaining chunks are skipped.
+                - Every claimed element is counted in s.done and s.all_done is signaled
+                  once all of them are accounted for.
+        !*/
+        {
+            const double target_seconds = 200e-6;
+            const long num = s.end - s.begin;
+            long block = s.first_block;
+            while (true)
+            {
+                const long i = s.next.fetch_add(block);
+                if (i >= s.end)
+                    return;
+                const long j = std::min(i+block, s.end);
+
+                if (!s.failed)
+                {
+                    const auto start = std::chrono::steady_clock::now();
+                    try
+                    {
+                        funct(i, j);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock(s.m);
+                        if (!s.eptr)
+                            s.eptr = std::current_exception();
+                        s.failed = true;
+                    }
+                    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+                    const long remaining = s.end - std::min(s.next.load(), s.end);
+                    const double fair_share = std::max(1L, remaining/(2*s.num_runners));
+                    const double wanted = secs > 0 ? target_seconds/secs*(j-i) : 2.0*block;
+                    block = std::max(1L, static_cast<long>(std::min(wanted, fair_share)));
+                }
+
+                if (s.done.fetch_add(j-i) + (j-i) == num)
+                {
+                    std::lock_guard<std::mutex> lock(s.m);
+                    s.all_done.notify_all();
+                }
+            }
+        }
+
+        template <typename F>
+        void parallel_for_blocked_shared (
+            thread_pool& tp,
+            unsigned long num_helpers,
+            long begin,
+            long end,
+            const F& funct,
+            long chunks_per_thread
+        )
+        /*!
+            requires
+                - begin <= end
+                - chunks_per_thread > 0
+            ensures
+                - Calls funct on disjoint blocks that exactly cover [begin, end), using the
+                  calling thread plus at most min(num_helpers, tp.num_threads_in_pool())
+                  tasks submitted to tp.  No threads are created by this call.
+                - The calling thread never just sits and waits for the helpers.  It claims
+                  chunks along with them and only blocks once every chunk has been claimed.
+                  Helpers that get scheduled after that find nothing to do and exit, so the
+                  call doesn't depend on tp having any free workers.
+                - If funct throws then the first such exception is rethrown here after all
+                  the running chunks have finished.
+        !*/
+        {
+            const long num = end-begin;
+            num_helpers = std::min(num_helpers, tp.num_threads_in_pool());
+            if (tp.is_task_thread() || num_helpers == 0 || num <= 1)
+            {
+                // Either there is nobody to help or we are already running inside one of
+                // tp's workers (i.e. this is a nested parallel loop).  In that case the
+                // other workers are busy with the outer loop, so the cheapest thing is to
+                // just do the work right here.
+                if (num != 0)
+                    funct(begin, end);
+                return;
+            }
+
+            const long num_runners = static_cast<long>(num_helpers) + 1;
+            const long first_block = std::max(1L, num/(num_runners*chunks_per_thread));
+            // Don't bother the pool with helpers that couldn't possibly get a chunk.
+            const long max_helpers = (num+first_block-1)/first_block - 1;
+            num_helpers = std::min<unsigned long>(num_helpers, max_helpers);
+
+            auto s = std::make_shared<parallel_for_state>(begin, end, first_block, num_runners);
+            for (unsigned long h = 0; h < num_helpers; ++h)
+            {
+                // The helpers only touch funct while there are unclaimed chunks, which can
+                // only happen before we return, so holding it by reference is safe.
+                tp.add_task_by_value([s, &funct]() { run_parallel_for_chunks(*s, funct); });
+            }
+
+            run_parallel_for_chunks(*s, funct);
+
+            std::unique_lock<std::mutex> lock(s->m);
+            s->all_done.wait(lock, [&]() { return s->done.load() == num; });
+            if (s->eptr)
+                std::rethrow_exception(s->eptr);
+        }
     }
 
 // ----------------------------------------------------------------------------------------
@@ -93,25 +247,8 @@ namespace dlib
             << "\n\t chunks_per_thread: " << chunks_per_thread
             );
 
-        if (tp.num_threads_in_pool() != 0)
-        {
-            const long num = end-begin;
-            const long num_workers = static_cast<long>(tp.num_threads_in_pool());
-            // How many samples to process in a single task (aim for chunks_per_thread jobs per worker)
-            const long block_size = std::max(1L, num/(num_workers*chunks_per_thread));
-            for (long i = 0; i < num; i+=block_size)
-            {
-                tp.add_task(obj, funct, begin+i, begin+std::min(i+block_size, num));
-            }
-            tp.wait_for_all_tasks();
-        }
-        else
-        {
-            // Since there aren't any threads in the pool we might as well just invoke
-            // the function directly since that's all the thread_pool object would do.
-            // But doing it ourselves skips a mutex lock.
-            (obj.*funct)(begin, end);
-        }
+        impl::parallel_for_blocked_shared(tp, tp.num_threads_in_pool(), begin, end,
+            [&obj, funct](long i, long j) { (obj.*funct)(i, j); }, chunks_per_thread);
     }
 
 // ----------------------------------------------------------------------------------------
@@ -135,8 +272,11 @@ namespace dlib
             << "\n\t chunks_per_thread: " << chunks_per_thread
             );
 
-        thread_pool tp(num_threads);
-        parallel_for_blocked(tp, begin, end, obj, funct, chunks_per_thread);
+        // Borrow workers from the shared default pool rather than spinning up a new
+        // thread_pool on every call.  num_threads only caps how many threads work on
+        // this loop, counting the calling thread, so it can't exceed the pool size + 1.
+        impl::parallel_for_blocked_shared(default_thread_pool(), num_threads > 1 ? num_threads-1 : 0, begin, end,
+            [&obj, funct](long i, long j) { (obj.*funct)(i, j); }, chunks_per_thread);
     }
 
 // ----------------------------------------------------------------------------------------
@@ -183,8 +323,8 @@ namespace dlib
             << "\n\t chunks_per_thread: " << chunks_per_thread
             );
 
-        thread_pool tp(num_threads);
-        parallel_for_blocked(tp, begin, end, funct, chunks_per_thread);
+        impl::helper_parallel_for_funct2<T> helper(funct);
+        parallel_for_blocked(num_threads, begin, end, helper, &impl::helper_parallel_for_funct2<T>::run, chunks_per_thread);
     }
 
     template <typename T>
@@ -245,8 +385,8 @@ namespace dlib
             << "\n\t chunks_per_thread: " << chunks_per_thread
             );
 
-        thread_pool tp(num_threads);
-        parallel_for(tp, begin, end, obj, funct, chunks_per_thread);
+        impl::helper_parallel_for<T> helper(obj, funct);
+        parallel_for_blocked(num_threads, begin, end, helper, &impl::helper_parallel_for<T>::process_block, chunks_per_thread);
     }
 
 // ----------------------------------------------------------------------------------------
@@ -293,8 +433,8 @@ namespace dlib
             << "\n\t chunks_per_thread: " << chunks_per_thread
             );
 
-        thread_pool tp(num_threads);
-        parallel_for(tp, begin, end, funct, chunks_per_thread);
+        impl::helper_parallel_for_funct<T> helper(funct);
+        parallel_for(num_threads, begin, end, helper, &impl::helper_parallel_for_funct<T>::run, chunks_per_thread);
     }
 
 // ----------------------------------------------------------------------------------------
@@ -25,11 +25,24 @@ namespace dlib
             - begin <= end
             - chunks_per_thread > 0
         ensures
-            - This is a convenience function for submitting a block of jobs to a thread_pool.  
+            - This is a convenience function for running a block of jobs on a thread_pool.
               In particular, given the half open range [begin, end), this function will
-              split the range into approximately tp.num_threads_in_pool()*chunks_per_thread
-              blocks, which it will then submit to the thread_pool.  The given thread_pool
-              will then call (obj.*funct)() on each of the subranges.
+              split the range into subranges and call (obj.*funct)() on each of them, using
+              the calling thread together with up to tp.num_threads_in_pool() of tp's
+              worker threads.
+            - The subranges are handed out dynamically.  The first ones hold about
+              (end-begin)/(tp.num_threads_in_pool()*chunks_per_thread) elements.  After
+              that each thread sizes its next subrange based on how long its previous one
+              took, aiming for subranges that take a fraction of a millisecond but are
+              never bigger than an even share of the remaining work.  So chunks_per_thread
+              only sets the starting granularity.
+            - If tp.num_threads_in_pool() == 0 or tp.is_task_thread() == true (e.g. this
+              is a parallel loop nested inside another one running on tp) then this
+              function simply calls (obj.*funct)(begin, end) in the calling thread.  This
+              means nested parallel loops never wait on tp and never oversubscribe it.
+            - If (obj.*funct)() throws then no further subranges are started and the
+              exception is rethrown by this function once the subranges already running
+              have finished.
             - To be precise, suppose we have broken the range [begin, end) into the
               following subranges:
                 - [begin[0], end[0])
@@ -41,8 +54,6 @@ namespace dlib
               processing such that (obj.*funct)(begin[i], end[i]) is invoked for all valid
               values of i.  Moreover, the subranges are non-overlapping and completely
               cover the total range of [begin, end).
-            - This function will not perform any memory allocations or create any system
-              resources such as mutex objects.
     !*/
 
 // ----------------------------------------------------------------------------------------
@@ -61,9 +72,16 @@ namespace dlib
             - begin <= end
             - chunks_per_thread > 0
         ensures
-            - This function is equivalent to the following block of code:
-                thread_pool tp(num_threads);
-                parallel_for_blocked(tp, begin, end, obj, funct, chunks_per_thread);
+            - This function is equivalent to parallel_for_blocked(default_thread_pool(), ...) except
+              that at most num_threads threads, counting the calling thread, work on the
+              loop.  In particular, if num_threads <= 1 then everything runs serially in
+              the calling thread.
+            - No threads are created by this call.  The helpers are borrowed from
+              default_thread_pool(), so num_threads is only an upper bound: at most
+              default_thread_pool().num_threads_in_pool()+1 threads work on the loop.
+              So if the pool is empty (e.g. DLIB_NUM_THREADS is 0) the loop runs
+              serially.  A call made from inside one of default_thread_pool()'s
+              workers (i.e. a nested parallel loop) also runs serially in that worker.
     !*/
 
 // ----------------------------------------------------------------------------------------
@@ -81,11 +99,9 @@ namespace dlib
             - chunks_per_thread > 0
             - begin <= end
         ensures
-            - This is a convenience function for submitting a block of jobs to a
-              thread_pool.  In particular, given the range [begin, end), this function will
-              split the range into approximately tp.num_threads_in_pool()*chunks_per_thread
-              blocks, which it will then submit to the thread_pool.  The given thread_pool
-              will then call funct() on each of the subranges.
+            - This function is equivalent to the version of parallel_for_blocked() defined
+              above that takes an object and member function, except that it calls funct()
+              on each of the subranges.
             - To be precise, suppose we have broken the range [begin, end) into the
               following subranges:
                 - [begin[0], end[0])
@@ -96,8 +112,6 @@ namespace dlib
               Then parallel_for_blocked() submits each of these subranges to tp for
               processing such that funct(begin[i], end[i]) is invoked for all valid values
               of i.
-            - This function will not perform any memory allocations or create any system
-              resources such as mutex objects.
     !*/
 
 // ----------------------------------------------------------------------------------------
@@ -115,9 +129,16 @@ namespace dlib
             - begin <= end
             - chunks_per_thread > 0
         ensures
-            - This function is equivalent to the following block of code:
-                thread_pool tp(num_threads);
-                parallel_for_blocked(tp, begin, end, funct, chunks_per_thread);
+            - This function is equivalent to parallel_for_blocked(default_thread_pool(), ...) except
+              that at most num_threads threads, counting the calling thread, work on the
+              loop.  In particular, if num_threads <= 1 then everything runs serially in
+              the calling thread.
+            - No threads are created by this call.  The helpers are borrowed from
+              default_thread_pool(), so num_threads is only an upper bound: at most
+              default_thread_pool().num_threads_in_pool()+1 threads work on the loop.
+              So if the pool is empty (e.g. DLIB_NUM_THREADS is 0) the loop runs
+              serially.  A call made from inside one of default_thread_pool()'s
+              workers (i.e. a nested parallel loop) also runs serially in that worker.
     !*/
 
 // ----------------------------------------------------------------------------------------
@@ -164,8 +185,6 @@ namespace dlib
             - Therefore, this routine invokes (obj.*funct)(i) for all i in the range
               [begin, end).  However, it does so using tp.num_threads_in_pool() parallel
               threads.
-            - This function will not perform any memory allocations or create any system
-              resources such as mutex objects.
     !*/
 
 // ----------------------------------------------------------------------------------------
@@ -184,9 +203,16 @@ namespace dlib
             - begin <= end
             - chunks_per_thread > 0
         ensures
-            - This function is equivalent to the following block of code:
-                thread_pool tp(num_threads);
-                parallel_for(tp, begin, end, obj, funct, chunks_per_thread);
+            - This function is equivalent to parallel_for(default_thread_pool(), ...) except
+              that at most num_threads threads, counting the calling thread, work on the
+              loop.  In particular, if num_threads <= 1 then everything runs serially in
+              the calling thread.
+            - No threads are created by this call.  The helpers are borrowed from
+              default_thread_pool(), so num_threads is only an upper bound: at most
+              default_thread_pool().num_threads_in_pool()+1 threads work on the loop.
+              So if the pool is empty (e.g. DLIB_NUM_THREADS is 0) the loop runs
+              serially.  A call made from inside one of default_thread_pool()'s
+              workers (i.e. a nested parallel loop) also runs serially in that worker.
     !*/
 
 // ----------------------------------------------------------------------------------------
@@ -212,8 +238,6 @@ namespace dlib
                 }, chunks_per_thread);
             - Therefore, this routine invokes funct(i) for all i in the range [begin, end).
               However, it does so using tp.num_threads_in_pool() parallel threads.
-            - This function will not perform any memory allocations or create any system
-              resources such as mutex objects.
     !*/
 
 // ----------------------------------------------------------------------------------------
@@ -231,9 +255,16 @@ namespace dlib
             - begin <= end
             - chunks_per_thread > 0
         ensures
-            - This function is equivalent to the following block of code:
-                thread_pool tp(num_threads);
-                parallel_for(tp, begin, end, funct, chunks_per_thread);
+            - This function is equivalent to parallel_for(default_thread_pool(), ...) except
+              that at most num_threads threads, counting the calling thread, work on the
+              loop.  In particular, if num_threads <= 1 then everything runs serially in
+              the calling thread.
+            - No threads are created by this call.  The helpers are borrowed from
+              default_thread_pool(), so num_threads is only an upper bound: at most
+              default_thread_pool().num_threads_in_pool()+1 threads work on the loop.
+              So if the pool is empty (e.g. DLIB_NUM_THREADS is 0) the loop runs
+              serially.  A call made from inside one of default_thread_pool()'s
+              workers (i.e. a nested parallel loop) also runs serially in that worker.
     !*/
 
 // ----------------------------------------------------------------------------------------
@@ -5,6 +5,7 @@
 
 #include "thread_pool_extension.h"
 #include <memory>
+#include <algorithm>
 
 namespace dlib
 {
@@ -15,16 +16,34 @@ namespace dlib
     thread_pool_implementation (
         unsigned long num_threads
     ) : 
-        task_done_signaler(m),
-        task_ready_signaler(m),
-        we_are_destructing(false)
+        next_task_id(2),
+        next_queue(0),
+        num_queued(0),
+        num_sleeping(0),
+        num_started(0),
+        we_are_destructing(false),
+        has_exceptions(false)
     {
-        tasks.resize(num_threads);
+        queues.resize(num_threads);
+        for (auto& q : queues)
+            q.reset(new task_queue);
+
+        // Use a few more shards than threads so that the threads submitting and
+        // finishing tasks rarely collide.
+        pending.resize(std::max<unsigned long>(1, 4*num_threads));
+        for (auto& p : pending)
+            p.reset(new pending_shard);
+
+        worker_thread_ids.resize(num_threads);
         threads.resize(num_threads);
         for (unsigned long i = 0; i < num_threads; ++i)
-        {
-            threads[i] = std::thread([&](){this->thread();});
-        }
+            threads[i] = std::thread([this,i](){this->thread(i);});
+
+        // Wait for all the threads to record their ids so that worker_thread_ids
+        // doesn't change after this and can be read without locking.
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        while (num_started != num_threads)
+            task_ready.wait(lock);
     }
 
 // ----------------------------------------------------------------------------------------
@@ -33,42 +52,31 @@ namespace dlib
     shutdown_pool (
     )
     {
+        // first wait for all pending tasks to finish
+        for (auto& p : pending)
         {
-            auto_mutex M(m);
-            
-            // first wait for all pending tasks to finish
-            bool found_task = true;
-            while (found_task)
-            {
-                found_task = false;
-                for (unsigned long i = 0; i < tasks.size(); ++i)
-                {
-                    // If task bucket i has a task that is currently supposed to be processed
-                    if (tasks[i].is_empty() == false)
-                    {
-                        found_task = true;
-                        break;
-                    }
-                }
-
-                if (found_task)
-                    task_done_signaler.wait();
-            }
+            std::unique_lock<std::mutex> lock(p->m);
+            while (p->tasks.size() != 0)
+                p->task_done.wait(lock);
+        }
 
-            // now tell the threads to kill themselves
+        // now tell the threads to kill themselves
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
             we_are_destructing = true;
-            task_ready_signaler.broadcast();
         }
+        task_ready.notify_all();
 
         // wait for all threads to terminate
         for (auto& t : threads)
-            t.join();
-        threads.clear();
+        {
+            if (t.joinable())
+                t.join();
+        }
 
         // Throw any unhandled exceptions.  Since shutdown_pool() is only called in the
         // destructor this will kill the program.
-        for (auto&& task : tasks)
-            task.propagate_exception();
+        propagate_exception();
     }
 
 // ----------------------------------------------------------------------------------------
@@ -85,8 +93,7 @@ namespace dlib
     num_threads_in_pool (
     ) const
     {
-        auto_mutex M(m);
-        return tasks.size();
+        return queues.size();
     }
 
 // ----------------------------------------------------------------------------------------
@@ -96,16 +103,15 @@ namespace dlib
         uint64 task_id
     ) const
     {
-        auto_mutex M(m);
-        if (tasks.size() != 0)
+        if (queues.size() != 0)
         {
-            const unsigned long idx = task_id_to_index(task_id);
-            while (tasks[idx].task_id == task_id)
-                task_done_signaler.wait();
-
-            for (auto&& task : tasks)
-                task.propagate_exception();
+            pending_shard& p = shard_for(task_id);
+            std::unique_lock<std::mutex> lock(p.m);
+            while (p.tasks.count(task_id) != 0)
+                p.task_done.wait(lock);
         }
+
+        propagate_exception();
     }
 
 // ----------------------------------------------------------------------------------------
@@ -116,29 +122,31 @@ namespace dlib
     {
         const thread_id_type thread_id = get_thread_id();
 
-        auto_mutex M(m);
-        bool found_task = true;
-        while (found_task)
+        // Only the calling thread can add tasks tagged with its own id, and it's busy in
+        // here, so once a shard has none of its tasks left it stays that way.
+        for (auto& p : pending)
         {
-            found_task = false;
-            for (unsigned long i = 0; i < tasks.size(); ++i)
+            std::unique_lock<std::mutex> lock(p->m);
+            bool found_task = true;
+            while (found_task)
             {
-                // If task bucket i has a task that is currently supposed to be processed
-                // and it originated from the calling thread
-                if (tasks[i].is_empty() == false && tasks[i].thread_id == thread_id)
+                found_task = false;
+                for (auto& t : p->tasks)
                 {
-                    found_task = true;
-                    break;
+                    if (t.second == thread_id)
+                    {
+                        found_task = true;
+                        break;
+                    }
                 }
-            }
 
-            if (found_task)
-                task_done_signaler.wait();
+                if (found_task)
+                    p->task_done.wait(lock);
+            }
         }
 
         // throw any exceptions generated by the tasks
-        for (auto&& task : tasks)
-            task.propagate_exception();
+        propagate_exception();
     }
 
 // ----------------------------------------------------------------------------------------
@@ -156,40 +164,39 @@ namespace dlib
 
         // if there aren't any threads in the pool then we consider all threads
         // to be worker threads
-        if (tasks.size() == 0)
-            return true;
-        else
-            return false;
+        return queues.size() == 0;
     }
 
 // ----------------------------------------------------------------------------------------
 
     void thread_pool_implementation::
     thread (
+        unsigned long idx
     )
     {
         {
             // save the id of this worker thread into worker_thread_ids
-            auto_mutex M(m);
-            thread_id_type id = get_thread_id();
-            worker_thread_ids.push_back(id);
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            worker_thread_ids[idx] = get_thread_id();
+            ++num_started;
         }
+        task_ready.notify_all();
 
         task_state_type task;
-        while (we_are_destructing == false)
+        while (true)
         {
-            long idx = 0;
-
-            // wait for a task to do 
-            { auto_mutex M(m);
-                while ( (idx = find_ready_task()) == -1 && we_are_destructing == false)
-                    task_ready_signaler.wait();
-
-                if (we_are_destructing)
+            if (!pop_task(idx, task))
+            {
+                // wait for a task to do 
+                std::unique_lock<std::mutex> lock(sleep_mutex);
+                ++num_sleeping;
+                while (num_queued <= 0 && we_are_destructing == false)
+                    task_ready.wait(lock);
+                --num_sleeping;
+
+                if (num_queued <= 0 && we_are_destructing)
                     break;
-
-                tasks[idx].is_being_processed = true;
-                task = tasks[idx];
+                continue;
             }
 
             std::exception_ptr eptr = nullptr;
@@ -210,77 +217,125 @@ namespace dlib
                 eptr = std::current_exception();
             }
 
-            // Now let others know that we finished the task.  We do this
-            // by clearing out the state of this task
-            { auto_mutex M(m);
-                tasks[idx].is_being_processed = false;
-                tasks[idx].task_id = 0;
-                tasks[idx].bfp.clear();
-                tasks[idx].mfp0.clear();
-                tasks[idx].mfp1.clear();
-                tasks[idx].mfp2.clear();
-                tasks[idx].arg1 = 0;
-                tasks[idx].arg2 = 0;
-                tasks[idx].eptr = eptr;
-                task_done_signaler.broadcast();
+            // Release everything the task was holding onto before telling anyone it's
+            // done.
+            const uint64 task_id = task.task_id;
+            task = task_state_type();
+
+            if (eptr)
+            {
+                std::lock_guard<std::mutex> lock(exception_mutex);
+                exceptions.push_back(eptr);
+                has_exceptions = true;
             }
 
+            // Now let others know that we finished the task.
+            pending_shard& p = shard_for(task_id);
+            {
+                std::lock_guard<std::mutex> lock(p.m);
+                p.tasks.erase(task_id);
+            }
+            p.task_done.notify_all();
         }
     }
 
 // ----------------------------------------------------------------------------------------
 
-    long thread_pool_implementation::
-    find_empty_task_slot (
-    ) const
+    bool thread_pool_implementation::
+    pop_task (
+        unsigned long idx,
+        task_state_type& task
+    )
     {
-        for (auto&& task : tasks)
-            task.propagate_exception();
+        if (num_queued <= 0)
+            return false;
 
-        for (unsigned long i = 0; i < tasks.size(); ++i)
+        // Take the oldest task from our own queue if there is one.
         {
-            if (tasks[i].is_empty())
-                return i;
+            task_queue& q = *queues[idx];
+            std::lock_guard<std::mutex> lock(q.m);
+            if (q.tasks.size() != 0)
+            {
+                task = std::move(q.tasks.front());
+                q.tasks.pop_front();
+                --num_queued;
+                return true;
+            }
         }
 
-        return -1;
-    }
-
-// ----------------------------------------------------------------------------------------
-
-    long thread_pool_implementation::
-    find_ready_task (
-    ) const
-    {
-        for (unsigned long i = 0; i < tasks.size(); ++i)
+        // Otherwise steal the newest task from someone else's queue.  Taking from the
+        // other end keeps us out of the owner's way.
+        for (unsigned long i = 1; i < queues.size(); ++i)
         {
-            if (tasks[i].is_ready())
-                return i;
+            task_queue& q = *queues[(idx+i)%queues.size()];
+            std::lock_guard<std::mutex> lock(q.m);
+            if (q.tasks.size() != 0)
+            {
+                task = std::move(q.tasks.back());
+                q.tasks.pop_back();
+                --num_queued;
+                return true;
+            }
         }
 
-        return -1;
+        return false;
     }
 
 // ----------------------------------------------------------------------------------------
 
     uint64 thread_pool_implementation::
-    make_next_task_id (
-        long idx
+    enqueue_task (
+        task_state_type& task
     )
     {
-        uint64 id = tasks[idx].next_task_id * tasks.size() + idx;
-        tasks[idx].next_task_id += 1;
-        return id;
+        task.thread_id = get_thread_id();
+        task.task_id = next_task_id++;
+        const uint64 task_id = task.task_id;
+
+        {
+            pending_shard& p = shard_for(task_id);
+            std::lock_guard<std::mutex> lock(p.m);
+            p.tasks[task_id] = task.thread_id;
+        }
+
+        // Spread the tasks over the worker queues round robin style.
+        {
+            task_queue& q = *queues[(next_queue++)%queues.size()];
+            std::lock_guard<std::mutex> lock(q.m);
+            q.tasks.push_back(std::move(task));
+        }
+        ++num_queued;
+
+        // Only touch the sleep mutex if a worker might actually be asleep.  A worker
+        // increments num_sleeping before checking num_queued, and we increment
+        // num_queued before checking num_sleeping, so a wakeup can't be missed.
+        if (num_sleeping > 0)
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            task_ready.notify_one();
+        }
+
+        return task_id;
     }
 
 // ----------------------------------------------------------------------------------------
 
-    unsigned long thread_pool_implementation::
-    task_id_to_index (
-        uint64 id
+    void thread_pool_implementation::
+    propagate_exception (
     ) const
     {
-        return static_cast<unsigned long>(id%tasks.size());
+        if (has_exceptions)
+        {
+            std::unique_lock<std::mutex> lock(exception_mutex);
+            if (exceptions.size() != 0)
+            {
+                std::exception_ptr eptr = exceptions.front();
+                exceptions.pop_front();
+                has_exceptions = exceptions.size() != 0;
+                lock.unlock();
+                std::rethrow_exception(eptr);
+            }
+        }
     }
 
 // ----------------------------------------------------------------------------------------
@@ -291,18 +346,11 @@ namespace dlib
         std::shared_ptr<function_object_copy>& item
     )
     {
-        auto_mutex M(m);
-        const thread_id_type my_thread_id = get_thread_id();
-
-        // find a thread that isn't doing anything
-        long idx = find_empty_task_slot();
-        if (idx == -1 && is_worker_thread(my_thread_id))
+        propagate_exception();
+        if (is_task_thread())
         {
-            // this function is being called from within a worker thread and there
-            // aren't any other worker threads free so just perform the task right
-            // here
-
-            M.unlock();
+            // This function is being called from within a worker thread, or the pool
+            // has no threads, so just perform the task right here.
             bfp();
 
             // return a task id that is both non-zero and also one
@@ -311,21 +359,10 @@ namespace dlib
             return 1;
         }
 
-        // wait until there is a thread that isn't doing anything
-        while (idx == -1)
-        {
-            task_done_signaler.wait();
-            idx = find_empty_task_slot();
-        }
-
-        tasks[idx].thread_id = my_thread_id;
-        tasks[idx].task_id = make_next_task_id(idx);
-        tasks[idx].bfp = bfp;
-        tasks[idx].function_copy.swap(item);
-
-        task_ready_signaler.signal();
-
-        return tasks[idx].task_id;
+        task_state_type task;
+        task.bfp = bfp;
+        task.function_copy.swap(item);
+        return enqueue_task(task);
     }
 
 // ----------------------------------------------------------------------------------------
@@ -334,7 +371,6 @@ namespace dlib
     is_task_thread (
     ) const
     {
-        auto_mutex M(m);
         return is_worker_thread(get_thread_id());
     }
 
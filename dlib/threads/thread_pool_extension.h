@@ -6,6 +6,12 @@
 #include <exception>
 #include <memory>
 #include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <unordered_map>
 
 #include "thread_pool_extension_abstract.h"
 #include "multithreaded_object_extension.h"
@@ -131,17 +137,34 @@ namespace dlib
     {
         /*!
             CONVENTION
-                - num_threads_in_pool() == tasks.size()
+                - num_threads_in_pool() == threads.size() == queues.size()
                 - if (the destructor has been called) then
                     - we_are_destructing == true
                 - else
                     - we_are_destructing == false
 
                 - is_task_thread() == is_worker_thread(get_thread_id())
-
-                - m == the mutex used to protect everything in this object
                 - worker_thread_ids == an array that contains the thread ids for
-                  all the threads in the thread pool
+                  all the threads in the thread pool.  It is filled in by the
+                  constructor and never changes after that.
+
+                - queues[i] == the tasks waiting to be run which were handed to the i-th
+                  worker thread.  Each worker runs the tasks in its own queue in the
+                  order they were added, and when its queue is empty it steals the most
+                  recently added task from another worker's queue.
+                - num_queued == the total number of tasks in all the queues.
+                - num_sleeping == the number of worker threads waiting on task_ready.
+                - num_started == the number of worker threads which have recorded their
+                  id in worker_thread_ids.
+                - sleep_mutex protects we_are_destructing and num_started.
+
+                - pending[task_id%pending.size()].tasks contains an entry mapping the id
+                  of each task which has been submitted but hasn't finished to the id of
+                  the thread that submitted it.  The table is split into several shards
+                  so that threads submitting and finishing tasks rarely contend for the
+                  same mutex.
+                - exceptions == the exceptions thrown by tasks which haven't yet been
+                  rethrown to the user.  has_exceptions == (exceptions.size() != 0)
         !*/
         typedef bound_function_pointer::kernel_1a_c bfp_type;
 
@@ -173,18 +196,12 @@ namespace dlib
             void (T::*funct)()
         )
         {
-            auto_mutex M(m);
-            const thread_id_type my_thread_id = get_thread_id();
-
-            // find a thread that isn't doing anything
-            long idx = find_empty_task_slot();
-            if (idx == -1 && is_worker_thread(my_thread_id))
+            propagate_exception();
+            if (is_task_thread())
             {
-                // this function is being called from within a worker thread and there
-                // aren't any other worker threads free so just perform the task right
-                // here
-
-                M.unlock();
+                // This function is being called from within a worker thread, or the pool
+                // has no threads, so just perform the task right here.  Waiting for another
+                // worker to pick it up could deadlock if all the workers are doing this.
                 (obj.*funct)();
 
                 // return a task id that is both non-zero and also one
@@ -193,20 +210,9 @@ namespace dlib
                 return 1;
             }
 
-            // wait until there is a thread that isn't doing anything
-            while (idx == -1)
-            {
-                task_done_signaler.wait();
-                idx = find_empty_task_slot();
-            }
-
-            tasks[idx].thread_id = my_thread_id;
-            tasks[idx].task_id = make_next_task_id(idx);
-            tasks[idx].mfp0.set(obj,funct);
-
-            task_ready_signaler.signal();
-
-            return tasks[idx].task_id;
+            task_state_type task;
+            task.mfp0.set(obj,funct);
+            return enqueue_task(task);
         }
 
         template <typename T>
@@ -216,41 +222,17 @@ namespace dlib
             long arg1
         )
         {
-            auto_mutex M(m);
-            const thread_id_type my_thread_id = get_thread_id();
-
-            // find a thread that isn't doing anything
-            long idx = find_empty_task_slot();
-            if (idx == -1 && is_worker_thread(my_thread_id))
+            propagate_exception();
+            if (is_task_thread())
             {
-                // this function is being called from within a worker thread and there
-                // aren't any other worker threads free so just perform the task right
-                // here
-
-                M.unlock();
                 (obj.*funct)(arg1);
-
-                // return a task id that is both non-zero and also one
-                // that is never normally returned.  This way calls
-                // to wait_for_task() will never block given this id.
                 return 1;
             }
 
-            // wait until there is a thread that isn't doing anything
-            while (idx == -1)
-            {
-                task_done_signaler.wait();
-                idx = find_empty_task_slot();
-            }
-
-            tasks[idx].thread_id = my_thread_id;
-            tasks[idx].task_id = make_next_task_id(idx);
-            tasks[idx].mfp1.set(obj,funct);
-            tasks[idx].arg1 = arg1;
-
-            task_ready_signaler.signal();
-
-            return tasks[idx].task_id;
+            task_state_type task;
+            task.mfp1.set(obj,funct);
+            task.arg1 = arg1;
+            return enqueue_task(task);
         }
 
         template <typename T>
@@ -261,42 +243,18 @@ namespace dlib
             long arg2
         )
         {
-            auto_mutex M(m);
-            const thread_id_type my_thread_id = get_thread_id();
-
-            // find a thread that isn't doing anything
-            long idx = find_empty_task_slot();
-            if (idx == -1 && is_worker_thread(my_thread_id))
+            propagate_exception();
+            if (is_task_thread())
             {
-                // this function is being called from within a worker thread and there
-                // aren't any other worker threads free so just perform the task right
-                // here
-
-                M.unlock();
                 (obj.*funct)(arg1, arg2);
-
-                // return a task id that is both non-zero and also one
-                // that is never normally returned.  This way calls
-                // to wait_for_task() will never block given this id.
                 return 1;
             }
 
-            // wait until there is a thread that isn't doing anything
-            while (idx == -1)
-            {
-                task_done_signaler.wait();
-                idx = find_empty_task_slot();
-            }
-
-            tasks[idx].thread_id = my_thread_id;
-            tasks[idx].task_id = make_next_task_id(idx);
-            tasks[idx].mfp2.set(obj,funct);
-            tasks[idx].arg1 = arg1;
-            tasks[idx].arg2 = arg2;
-
-            task_ready_signaler.signal();
-
-            return tasks[idx].task_id;
+            task_state_type task;
+            task.mfp2.set(obj,funct);
+            task.arg1 = arg1;
+            task.arg2 = arg2;
+            return enqueue_task(task);
         }
 
         struct function_object_copy 
@@ -343,12 +301,41 @@ namespace dlib
 
     private:
 
+        struct task_state_type
+        {
+            task_state_type() : task_id(0), arg1(0), arg2(0) {}
+
+            uint64 task_id; // the id of this task
+            thread_id_type thread_id; // the id of the thread that requested this task 
+
+            long arg1;
+            long arg2;
+
+            member_function_pointer<> mfp0;
+            member_function_pointer<long> mfp1;
+            member_function_pointer<long,long> mfp2;
+            bfp_type bfp;
+
+            std::shared_ptr<function_object_copy> function_copy;
+        };
+
+        struct task_queue
+        {
+            std::mutex m;
+            std::deque<task_state_type> tasks;
+        };
+
+        struct pending_shard
+        {
+            std::mutex m;
+            std::condition_variable task_done;
+            std::unordered_map<uint64,thread_id_type> tasks;
+        };
+
         bool is_worker_thread (
             const thread_id_type id
         ) const;
         /*!
-            requires
-                - m is locked
             ensures
                 - if (thread with given id is one of the thread pool's worker threads or num_threads_in_pool() == 0) then
                     - returns true
@@ -357,124 +344,69 @@ namespace dlib
         !*/
 
         void thread (
+            unsigned long idx
         );
         /*!
-            this is the function that executes the threads in the thread pool
+            this is the function that executes the idx-th thread in the thread pool
         !*/
 
-        long find_empty_task_slot (
-        ) const;
+        uint64 enqueue_task (
+            task_state_type& task
+        );
         /*!
             requires
-                - m is locked
+                - num_threads_in_pool() != 0
             ensures
-                - if (there is currently a empty task slot) then
-                    - returns the index of that task slot in tasks
-                    - there is a task slot
-                - else
-                    - returns -1
+                - gives task a new id, records it as pending, and puts it into one of
+                  the worker queues.
+                - returns the id of the task.
         !*/
 
-        long find_ready_task (
-        ) const;
+        bool pop_task (
+            unsigned long idx,
+            task_state_type& task
+        );
         /*!
-            requires
-                - m is locked
             ensures
-                - if (there is currently a task to do) then
-                    - returns the index of that task in tasks
+                - if (there is a task in any of the queues) then
+                    - removes a task from the queues and stores it into #task.  Tasks
+                      are taken from queues[idx] if possible and stolen from the other
+                      queues otherwise.
+                    - returns true
                 - else
-                    - returns -1
+                    - returns false
         !*/
 
-        uint64 make_next_task_id (
-            long idx
-        );
-        /*!
-            requires
-                - m is locked
-                - 0 <= idx < tasks.size()
-            ensures
-                - returns the next index to be used for tasks that are placed in
-                  tasks[idx]
-        !*/
+        pending_shard& shard_for (
+            uint64 task_id
+        ) const { return *pending[task_id%pending.size()]; }
 
-        unsigned long task_id_to_index (
-            uint64 id
+        void propagate_exception (
         ) const;
         /*!
-            requires
-                - m is locked
-                - num_threads_in_pool() != 0
             ensures
-                - returns the index in tasks corresponding to the given id
+                - if (a task threw an exception which hasn't been rethrown yet) then
+                    - rethrows the oldest such exception
         !*/
 
-        struct task_state_type
-        {
-            task_state_type() : is_being_processed(false), task_id(0), next_task_id(2), arg1(0), arg2(0), eptr(nullptr) {}
-
-            bool is_ready () const 
-            /*!
-                ensures
-                    - if (is_empty() == false && no thread is currently processing this task) then
-                        - returns true
-                    - else
-                        - returns false
-            !*/
-            {
-                return !is_being_processed && !is_empty();
-            }
-
-            bool is_empty () const
-            /*!
-                ensures
-                    - if (this task state is empty.  i.e. it doesn't contain a task to be processed) then
-                        - returns true
-                    - else 
-                        - returns false
-            !*/
-            {
-                return task_id == 0;
-            }
-
-            bool is_being_processed;  // true when a thread is working on this task 
-            uint64 task_id; // the id of this task.  0 means this task is empty
-            thread_id_type thread_id; // the id of the thread that requested this task 
-
-            uint64 next_task_id;
-
-            long arg1;
-            long arg2;
-
-            member_function_pointer<> mfp0;
-            member_function_pointer<long> mfp1;
-            member_function_pointer<long,long> mfp2;
-            bfp_type bfp;
-
-            std::shared_ptr<function_object_copy> function_copy;
-            mutable std::exception_ptr eptr; // non-null if the task threw an exception
+        std::vector<std::unique_ptr<task_queue> > queues;
+        std::vector<std::unique_ptr<pending_shard> > pending;
+        std::vector<thread_id_type> worker_thread_ids;
 
-            void propagate_exception() const
-            {
-                if (eptr)
-                {
-                    auto tmp = eptr;
-                    eptr = nullptr;
-                    std::rethrow_exception(tmp);
-                }
-            }
-
-        };
-
-        array<task_state_type> tasks;
-        array<thread_id_type> worker_thread_ids;
+        std::atomic<uint64> next_task_id;
+        std::atomic<unsigned long> next_queue;
+        std::atomic<long> num_queued;
+        std::atomic<long> num_sleeping;
 
-        mutex m;
-        signaler task_done_signaler;
-        signaler task_ready_signaler;
+        std::mutex sleep_mutex;
+        std::condition_variable task_ready;
+        unsigned long num_started;
         bool we_are_destructing;
 
+        mutable std::mutex exception_mutex;
+        mutable std::deque<std::exception_ptr> exceptions;
+        mutable std::atomic<bool> has_exceptions;
+
         std::vector<std::thread> threads;
 
         // restricted functions
@@ -218,11 +218,15 @@ namespace dlib
                 mode any thread that calls add_task() is considered to be
                 a thread_pool thread capable of executing tasks.
 
-                This object is also implemented such that no memory allocations occur 
-                after the thread_pool has been constructed so long as the user doesn't 
-                call any of the add_task_by_value() routines.  The future object also 
-                doesn't perform any memory allocations or contain any system resources 
-                such as mutex objects. 
+                Tasks submitted from outside the pool are spread over per-thread queues
+                and a thread which runs out of work steals tasks from the other threads'
+                queues.  There is no limit on the number of queued tasks, so adding a
+                task never waits for a thread to become free.  Tasks submitted from
+                inside one of the pool's threads are always run right away in that
+                thread.  This means a task can itself submit tasks and wait on them
+                without deadlocking the pool.  The future object doesn't perform any
+                memory allocations or contain any system resources such as mutex
+                objects. 
 
             EXCEPTIONS
                 Note that if an exception is thrown inside a task thread and is not caught
@@ -285,12 +289,12 @@ namespace dlib
                 - function_object() is a valid expression 
             ensures
                 - makes a copy of function_object, call it FCOPY.
-                - if (is_task_thread() == true and there aren't any free threads available) then
+                - if (is_task_thread() == true) then
                     - calls FCOPY() within the calling thread and returns when it finishes
                 - else
-                    - the call to this function blocks until there is a free thread in the pool
-                      to process this new task.  Once a free thread is available the task
-                      is handed off to that thread which then calls FCOPY().
+                    - the task is queued and the call to this function returns without
+                      waiting for it.  One of the threads in the pool later calls
+                      FCOPY().
                 - returns a task id that can be used by this->wait_for_task() to wait
                   for the submitted task to finish.
         !*/
@@ -307,13 +311,13 @@ namespace dlib
                   this function passes obj to the task by reference.  If you want to avoid
                   this restriction then use add_task_by_value())
             ensures
-                - if (is_task_thread() == true and there aren't any free threads available) then
+                - if (is_task_thread() == true) then
                     - calls (obj.*funct)() within the calling thread and returns
                       when it finishes.
                 - else
-                    - the call to this function blocks until there is a free thread in the pool
-                      to process this new task.  Once a free thread is available the task
-                      is handed off to that thread which then calls (obj.*funct)()
+                    - the task is queued and the call to this function returns without
+                      waiting for it.  One of the threads in the pool later calls
+                      (obj.*funct)().
                 - returns a task id that can be used by this->wait_for_task() to wait
                   for the submitted task to finish.
         !*/
@@ -328,13 +332,13 @@ namespace dlib
                 - funct == a valid member function pointer for class T
             ensures
                 - makes a copy of obj, call it OBJ_COPY.
-                - if (is_task_thread() == true and there aren't any free threads available) then
+                - if (is_task_thread() == true) then
                     - calls (OBJ_COPY.*funct)() within the calling thread and returns 
                       when it finishes.
                 - else
-                    - the call to this function blocks until there is a free thread in the pool
-                      to process this new task.  Once a free thread is available the task
-                      is handed off to that thread which then calls (OBJ_COPY.*funct)().
+                    - the task is queued and the call to this function returns without
+                      waiting for it.  One of the threads in the pool later calls
+                      (OBJ_COPY.*funct)().
                 - returns a task id that can be used by this->wait_for_task() to wait
                   for the submitted task to finish.
         !*/
@@ -352,13 +356,13 @@ namespace dlib
                   this function passes obj to the task by reference.  If you want to avoid
                   this restriction then use add_task_by_value())
             ensures
-                - if (is_task_thread() == true and there aren't any free threads available) then
+                - if (is_task_thread() == true) then
                     - calls (obj.*funct)(arg1) within the calling thread and returns
                       when it finishes
                 - else
-                    - the call to this function blocks until there is a free thread in the pool
-                      to process this new task.  Once a free thread is available the task
-                      is handed off to that thread which then calls (obj.*funct)(arg1)
+                    - the task is queued and the call to this function returns without
+                      waiting for it.  One of the threads in the pool later calls
+                      (obj.*funct)(arg1).
                 - returns a task id that can be used by this->wait_for_task() to wait
                   for the submitted task to finish.
         !*/
@@ -377,13 +381,13 @@ namespace dlib
                   this function passes obj to the task by reference.  If you want to avoid
                   this restriction then use add_task_by_value())
             ensures
-                - if (is_task_thread() == true and there aren't any free threads available) then
+                - if (is_task_thread() == true) then
                     - calls (obj.*funct)(arg1,arg2) within the calling thread and returns
                       when it finishes
                 - else
-                    - the call to this function blocks until there is a free thread in the pool
-                      to process this new task.  Once a free thread is available the task
-                      is handed off to that thread which then calls (obj.*funct)(arg1,arg2)
+                    - the task is queued and the call to this function returns without
+                      waiting for it.  One of the threads in the pool later calls
+                      (obj.*funct)(arg1,arg2).
                 - returns a task id that can be used by this->wait_for_task() to wait
                   for the submitted task to finish.
         !*/
@@ -423,13 +427,13 @@ namespace dlib
                   this function passes function_object to the task by reference.  If you want to avoid
                   this restriction then use add_task_by_value())
             ensures
-                - if (is_task_thread() == true and there aren't any free threads available) then
+                - if (is_task_thread() == true) then
                     - calls function_object(arg1.get()) within the calling thread and returns
                       when it finishes
                 - else
-                    - the call to this function blocks until there is a free thread in the pool
-                      to process this new task.  Once a free thread is available the task
-                      is handed off to that thread which then calls function_object(arg1.get()).
+                    - the task is queued and the call to this function returns without
+                      waiting for it.  One of the threads in the pool later calls
+                      function_object(arg1.get()).
                 - #arg1.is_ready() == false 
                 - returns a task id that can be used by this->wait_for_task() to wait
                   for the submitted task to finish.
@@ -446,12 +450,12 @@ namespace dlib
                   (i.e. The A1 type stored in the future must be a type that can be passed into the given function object)
             ensures
                 - makes a copy of function_object, call it FCOPY.
-                - if (is_task_thread() == true and there aren't any free threads available) then
+                - if (is_task_thread() == true) then
                     - calls FCOPY(arg1.get()) within the calling thread and returns when it finishes
                 - else
-                    - the call to this function blocks until there is a free thread in the pool
-                      to process this new task.  Once a free thread is available the task
-                      is handed off to that thread which then calls FCOPY(arg1.get()).
+                    - the task is queued and the call to this function returns without
+                      waiting for it.  One of the threads in the pool later calls
+                      FCOPY(arg1.get()).
                 - #arg1.is_ready() == false 
                 - returns a task id that can be used by this->wait_for_task() to wait
                   for the submitted task to finish.
@@ -472,13 +476,13 @@ namespace dlib
                   this function passes obj to the task by reference.  If you want to avoid
                   this restriction then use add_task_by_value())
             ensures
-                - if (is_task_thread() == true and there aren't any free threads available) then
+                - if (is_task_thread() == true) then
                     - calls (obj.*funct)(arg1.get()) within the calling thread and returns
                       when it finishes
                 - else
-                    - the call to this function blocks until there is a free thread in the pool
-                      to process this new task.  Once a free thread is available the task
-                      is handed off to that thread which then calls (obj.*funct)(arg1.get()).
+                    - the task is queued and the call to this function returns without
+                      waiting for it.  One of the threads in the pool later calls
+                      (obj.*funct)(arg1.get()).
                 - #arg1.is_ready() == false 
                 - returns a task id that can be used by this->wait_for_task() to wait
                   for the submitted task to finish.
@@ -497,13 +501,13 @@ namespace dlib
                   (i.e. The A1 type stored in the future must be a type that can be passed into the given function)
             ensures
                 - makes a copy of obj, call it OBJ_COPY.
-                - if (is_task_thread() == true and there aren't any free threads available) then
+                - if (is_task_thread() == true) then
                     - calls (OBJ_COPY.*funct)(arg1.get()) within the calling thread and returns 
                       when it finishes.
                 - else
-                    - the call to this function blocks until there is a free thread in the pool
-                      to process this new task.  Once a free thread is available the task
-                      is handed off to that thread which then calls (OBJ_COPY.*funct)(arg1.get()).
+                    - the task is queued and the call to this function returns without
+                      waiting for it.  One of the threads in the pool later calls
+                      (OBJ_COPY.*funct)(arg1.get()).
                 - returns a task id that can be used by this->wait_for_task() to wait
                   for the submitted task to finish.
         !*/
@@ -523,13 +527,13 @@ namespace dlib
                   this function passes obj to the task by reference.  If you want to avoid
                   this restriction then use add_task_by_value())
             ensures
-                - if (is_task_thread() == true and there aren't any free threads available) then
+                - if (is_task_thread() == true) then
                     - calls (obj.*funct)(arg1.get()) within the calling thread and returns
                       when it finishes
                 - else
-                    - the call to this function blocks until there is a free thread in the pool
-                      to process this new task.  Once a free thread is available the task
-                      is handed off to that thread which then calls (obj.*funct)(arg1.get()).
+                    - the task is queued and the call to this function returns without
+                      waiting for it.  One of the threads in the pool later calls
+                      (obj.*funct)(arg1.get()).
                 - #arg1.is_ready() == false 
                 - returns a task id that can be used by this->wait_for_task() to wait
                   for the submitted task to finish.
@@ -548,13 +552,13 @@ namespace dlib
                   (i.e. The A1 type stored in the future must be a type that can be passed into the given function)
             ensures
                 - makes a copy of obj, call it OBJ_COPY.
-                - if (is_task_thread() == true and there aren't any free threads available) then
+                - if (is_task_thread() == true) then
                     - calls (OBJ_COPY.*funct)(arg1.get()) within the calling thread and returns 
                       when it finishes.
                 - else
-                    - the call to this function blocks until there is a free thread in the pool
-                      to process this new task.  Once a free thread is available the task
-                      is handed off to that thread which then calls (OBJ_COPY.*funct)(arg1.get()).
+                    - the task is queued and the call to this function returns without
+                      waiting for it.  One of the threads in the pool later calls
+                      (OBJ_COPY.*funct)(arg1.get()).
                 - returns a task id that can be used by this->wait_for_task() to wait
                   for the submitted task to finish.
         !*/
@@ -570,13 +574,13 @@ namespace dlib
                 - (funct)(arg1.get()) must be a valid expression.
                   (i.e. The A1 type stored in the future must be a type that can be passed into the given function)
             ensures
-                - if (is_task_thread() == true and there aren't any free threads available) then
+                - if (is_task_thread() == true) then
                     - calls funct(arg1.get()) within the calling thread and returns
                       when it finishes
                 - else
-                    - the call to this function blocks until there is a free thread in the pool
-                      to process this new task.  Once a free thread is available the task
-                      is handed off to that thread which then calls funct(arg1.get()).
+                    - the task is queued and the call to this function returns without
+                      waiting for it.  One of the threads in the pool later calls
+                      funct(arg1.get()).
                 - #arg1.is_ready() == false 
                 - returns a task id that can be used by this->wait_for_task() to wait
                   for the submitted task to finish.